@@ -16,1751 +16,5843 @@
  ******************************************************************************
  */
 
+#include <stddef.h>
 #include <string.h>
 #include "iis2dulpx_reg.h"
 
-int32_t __weak iis2dulpx_read_reg(const stmdev_ctx_t *ctx, uint8_t reg, uint8_t *data,
-                                  uint16_t len)
+#ifdef IIS2DULPX_STATS
+/*
+ * Account one bus transfer. The bank is followed from the writes to
+ * FUNC_CFG_ACCESS, whoever issues them.
+ */
+static void iis2dulpx_stats_add(const stmdev_ctx_t *ctx, uint8_t reg, const uint8_t *data,
+                                uint16_t len, uint8_t write, int32_t ret, uint32_t cycles)
 {
-  if (ctx == NULL)
+  iis2dulpx_func_cfg_access_t func_cfg_access;
+  iis2dulpx_stats_reg_t *cnt;
+  iis2dulpx_stats_t *st;
+
+  if (ctx->priv_data == NULL)
   {
-    return -1;
+    return;
   }
 
-  return ctx->read_reg(ctx->handle, reg, data, len);
-}
+  st = &((iis2dulpx_priv_t *)ctx->priv_data)->stats;
+  cnt = &st->reg[st->bank][reg & 0x7FU];
 
-int32_t __weak iis2dulpx_write_reg(const stmdev_ctx_t *ctx, uint8_t reg, uint8_t *data,
-                                   uint16_t len)
-{
-  if (ctx == NULL)
+  cnt->xfer++;
+  cnt->bytes += len;
+  st->cycles += cycles;
+  if (write != 0U)
   {
-    return -1;
+    st->wr_xfer++;
+    st->wr_bytes += len;
+  }
+  else
+  {
+    st->rd_xfer++;
+    st->rd_bytes += len;
   }
 
-  return ctx->write_reg(ctx->handle, reg, data, len);
-}
-
-float_t iis2dulpx_from_fs2g_to_mg(int16_t lsb)
-{
-  return (float_t)lsb * 0.061f;
-}
-
-float_t iis2dulpx_from_fs4g_to_mg(int16_t lsb)
-{
-  return (float_t)lsb * 0.122f;
-}
-
-float_t iis2dulpx_from_fs8g_to_mg(int16_t lsb)
-{
-  return (float_t)lsb * 0.244f;
+  if (ret != 0)
+  {
+    cnt->errors++;
+    st->errors++;
+  }
+  else if ((write != 0U) && (reg == IIS2DULPX_FUNC_CFG_ACCESS) && (len > 0U))
+  {
+    (void)memcpy(&func_cfg_access, &data[0], 1);
+    if (func_cfg_access.emb_func_reg_access != st->bank)
+    {
+      st->bank = func_cfg_access.emb_func_reg_access;
+      st->bank_switches++;
+    }
+  }
+  else
+  {
+    /* nothing else to follow */
+  }
 }
+#endif /* IIS2DULPX_STATS */
 
-float_t iis2dulpx_from_fs16g_to_mg(int16_t lsb)
+#ifdef IIS2DULPX_REC
+/* buffer one FIFO record, DATA block written when the run is full */
+static void iis2dulpx_rec_append(iis2dulpx_rec_t *rec, uint8_t tag, const uint8_t *data)
 {
-  return (float_t)lsb * 0.488f;
-}
+  uint8_t *dst = &rec->run[IIS2DULPX_REC_BLOCK_LEN + (rec->num * IIS2DULPX_FIFO_RECORD_LEN)];
 
-float_t iis2dulpx_from_lsb_to_celsius(int16_t lsb)
-{
-  return ((float_t)lsb / 355.5f) + 25.0f;
-}
+  dst[0] = tag;
+  (void)memcpy(&dst[1], data, IIS2DULPX_FIFO_RECORD_LEN - 1U);
+  rec->num++;
+  rec->records++;
 
-float_t iis2dulpx_from_lsb_to_mv(int16_t lsb)
-{
-  return ((float_t)lsb) / 74.4f;
+  if (rec->num == IIS2DULPX_REC_RUN)
+  {
+    (void)iis2dulpx_rec_flush(rec);
+  }
 }
 
-int32_t iis2dulpx_device_id_get(const stmdev_ctx_t *ctx, uint8_t *val)
+/*
+ * Capture the FIFO records of a main page read: a single TAG read opens
+ * a record that the X_L .. Z_H read completes, a longer TAG read carries
+ * whole records.
+ */
+static void iis2dulpx_rec_feed(const stmdev_ctx_t *ctx, uint8_t reg, const uint8_t *data,
+                               uint16_t len)
 {
-  int32_t ret = 0;
+  iis2dulpx_priv_t *priv = (iis2dulpx_priv_t *)ctx->priv_data;
+  iis2dulpx_rec_t *rec;
+  uint16_t i;
 
-  ret = iis2dulpx_read_reg(ctx, IIS2DULPX_WHO_AM_I, val, 1);
+  if ((priv == NULL) || (priv->rec == NULL) ||
+      (priv->func_cfg_access_main.emb_func_reg_access != 0U))
+  {
+    return;
+  }
 
-  return ret;
+  rec = priv->rec;
+  if ((reg == IIS2DULPX_FIFO_DATA_OUT_TAG) && (len == 1U))
+  {
+    rec->tag = data[0];
+    rec->tag_valid = PROPERTY_ENABLE;
+  }
+  else if (reg == IIS2DULPX_FIFO_DATA_OUT_TAG)
+  {
+    for (i = 0U; (i + IIS2DULPX_FIFO_RECORD_LEN) <= len; i += IIS2DULPX_FIFO_RECORD_LEN)
+    {
+      iis2dulpx_rec_append(rec, data[i], &data[i + 1U]);
+    }
+    rec->tag_valid = PROPERTY_DISABLE;
+  }
+  else if ((reg == IIS2DULPX_FIFO_DATA_OUT_X_L) && (len == (IIS2DULPX_FIFO_RECORD_LEN - 1U)) &&
+           (rec->tag_valid == PROPERTY_ENABLE))
+  {
+    iis2dulpx_rec_append(rec, rec->tag, data);
+    rec->tag_valid = PROPERTY_DISABLE;
+  }
+  else
+  {
+    /* not a FIFO output read */
+  }
 }
+#endif /* IIS2DULPX_REC */
 
-int32_t iis2dulpx_init_set(const stmdev_ctx_t *ctx)
+static void iis2dulpx_lock(const stmdev_ctx_t *ctx)
 {
-  iis2dulpx_ctrl1_t ctrl1 = {0};
-  iis2dulpx_ctrl4_t ctrl4 = {0};
-  int32_t ret = 0;
+  iis2dulpx_priv_t *priv = (iis2dulpx_priv_t *)ctx->priv_data;
 
-  ret += iis2dulpx_read_reg(ctx, IIS2DULPX_CTRL1, (uint8_t *)&ctrl1, 1);
-  ret += iis2dulpx_read_reg(ctx, IIS2DULPX_CTRL4, (uint8_t *)&ctrl4, 1);
-  if (ret != 0)
+  if ((priv != NULL) && (priv->lock != NULL))
   {
-    return ret;
+    priv->lock(priv->lock_arg);
   }
+}
 
-  ctrl4.bdu = PROPERTY_ENABLE;
-  ctrl1.if_add_inc = PROPERTY_ENABLE;
-
-  ret += iis2dulpx_write_reg(ctx, IIS2DULPX_CTRL4, (uint8_t *)&ctrl4, 1);
-  ret += iis2dulpx_write_reg(ctx, IIS2DULPX_CTRL1, (uint8_t *)&ctrl1, 1);
+static void iis2dulpx_unlock(const stmdev_ctx_t *ctx)
+{
+  iis2dulpx_priv_t *priv = (iis2dulpx_priv_t *)ctx->priv_data;
 
-  if (ctx->priv_data != NULL)
+  if ((priv != NULL) && (priv->unlock != NULL))
   {
-    (void)memset(ctx->priv_data, 0, sizeof(iis2dulpx_priv_t));
+    priv->unlock(priv->lock_arg);
   }
-
-  return ret;
 }
 
-int32_t iis2dulpx_embedded_state_set(const stmdev_ctx_t *ctx, uint8_t state)
+static int32_t iis2dulpx_read_xfer(const stmdev_ctx_t *ctx, uint8_t reg, uint8_t *data,
+                                   uint16_t len)
 {
-  int32_t ret = 0;
-  iis2dulpx_ctrl4_t ctrl4 = {0};
+  int32_t ret;
+#ifdef IIS2DULPX_STATS
+  uint32_t start;
+#endif /* IIS2DULPX_STATS */
 
-  ret = iis2dulpx_read_reg(ctx, IIS2DULPX_CTRL4, (uint8_t *)&ctrl4, 1);
+#ifdef IIS2DULPX_STATS
+  start = IIS2DULPX_STATS_CYCLES();
+  ret = ctx->read_reg(ctx->handle, reg, data, len);
+  iis2dulpx_stats_add(ctx, reg, data, len, 0U, ret, IIS2DULPX_STATS_CYCLES() - start);
+#else
+  ret = ctx->read_reg(ctx->handle, reg, data, len);
+#endif /* IIS2DULPX_STATS */
 
-  if (ret != 0)
+#ifdef IIS2DULPX_REC
+  if (ret == 0)
   {
-    goto exit;
+    iis2dulpx_rec_feed(ctx, reg, data, len);
   }
+#endif /* IIS2DULPX_REC */
 
-  ctrl4.emb_func_en = state & 0x01U;
-
-  ret += iis2dulpx_write_reg(ctx, IIS2DULPX_CTRL4, (uint8_t *)&ctrl4, 1);
-
-
-exit:
   return ret;
 }
 
-int32_t iis2dulpx_reboot(const stmdev_ctx_t *ctx)
+int32_t __weak iis2dulpx_read_reg(const stmdev_ctx_t *ctx, uint8_t reg, uint8_t *data,
+                                  uint16_t len)
 {
-  iis2dulpx_ctrl4_t ctrl4 = {0};
-  uint8_t cnt = 0;
-  int32_t ret = 0;
+  iis2dulpx_priv_t *priv;
+  uint32_t seq;
+  int32_t ret;
 
-  ret = iis2dulpx_read_reg(ctx, IIS2DULPX_CTRL4, (uint8_t *)&ctrl4, 1);
-  if (ret != 0)
+  if (ctx == NULL)
   {
-    goto exit;
+    return -1;
   }
 
-  ctrl4.boot = PROPERTY_ENABLE;
-  ret = iis2dulpx_write_reg(ctx, IIS2DULPX_CTRL4, (uint8_t *)&ctrl4, 1);
-  if (ret != 0)
+  priv = (iis2dulpx_priv_t *)ctx->priv_data;
+  if ((priv == NULL) || (priv->lock == NULL))
   {
-    goto exit;
+    return iis2dulpx_read_xfer(ctx, reg, data, len);
   }
 
-  do
+  /*
+   * Lock-free path: one main page register that can be read twice (not
+   * the event sources latched until read, not the FIFO output), valid
+   * if no embedded bank selection started or ended meanwhile.
+   */
+  if ((len == 1U) &&
+      ((reg < IIS2DULPX_WAKE_UP_SRC) || (reg > IIS2DULPX_ALL_INT_SRC)) &&
+      ((reg < IIS2DULPX_FIFO_DATA_OUT_TAG) || (reg > IIS2DULPX_FIFO_DATA_OUT_Z_H)))
   {
-    if (ctx->mdelay != NULL)
+    seq = priv->bank_seq;
+    if ((seq & 1U) == 0U)
     {
-      ctx->mdelay(25); /* 25 ms of boot time */
-    }
-
-    ret = iis2dulpx_read_reg(ctx, IIS2DULPX_CTRL4, (uint8_t *)&ctrl4, 1);
-    if (ret != 0)
-    {
-      break;
+      ret = iis2dulpx_read_xfer(ctx, reg, data, len);
+      if (priv->bank_seq == seq)
+      {
+        return ret;
+      }
     }
+  }
 
-    /* boot procedure ended correctly */
-    if (ctrl4.boot == 0U)
-    {
-      break;
-    }
+  iis2dulpx_lock(ctx);
+  ret = iis2dulpx_read_xfer(ctx, reg, data, len);
+  iis2dulpx_unlock(ctx);
 
+  return ret;
+}
 
-  } while (cnt++ < 5U);
+int32_t __weak iis2dulpx_write_reg(const stmdev_ctx_t *ctx, uint8_t reg, uint8_t *data,
+                                   uint16_t len)
+{
+  int32_t ret;
+#ifdef IIS2DULPX_STATS
+  uint32_t start;
+#endif /* IIS2DULPX_STATS */
 
-  if (cnt >= 5U)
+  if (ctx == NULL)
   {
-    ret = -1;  /* boot procedure failed */
+    return -1;
   }
 
-exit:
+  iis2dulpx_lock(ctx);
+
+#ifdef IIS2DULPX_STATS
+  start = IIS2DULPX_STATS_CYCLES();
+  ret = ctx->write_reg(ctx->handle, reg, data, len);
+  iis2dulpx_stats_add(ctx, reg, data, len, 1U, ret, IIS2DULPX_STATS_CYCLES() - start);
+#else
+  ret = ctx->write_reg(ctx->handle, reg, data, len);
+#endif /* IIS2DULPX_STATS */
+
+  iis2dulpx_unlock(ctx);
+
   return ret;
 }
 
-int32_t iis2dulpx_sw_por(const stmdev_ctx_t *ctx)
+static iis2dulpx_shadow_t *iis2dulpx_shadow_of(const stmdev_ctx_t *ctx, uint8_t reg)
 {
-  int32_t ret = iis2dulpx_enter_deep_power_down(ctx, 1);
+  iis2dulpx_shadow_t *shadow = NULL;
 
-  if (ret == 0)
+  if ((ctx != NULL) && (ctx->priv_data != NULL) &&
+      (reg >= IIS2DULPX_SHADOW_FIRST) && (reg <= IIS2DULPX_SHADOW_LAST))
   {
-    if (ctx->priv_data != NULL)
+    shadow = &((iis2dulpx_priv_t *)ctx->priv_data)->shadow;
+    if (shadow->enable == PROPERTY_DISABLE)
     {
-      (void)memset(ctx->priv_data, 0, sizeof(iis2dulpx_priv_t));
+      shadow = NULL;
     }
-
-    ret = iis2dulpx_exit_deep_power_down(ctx);
   }
 
-  return ret;
+  return shadow;
 }
 
-int32_t iis2dulpx_sw_reset(const stmdev_ctx_t *ctx)
+static void iis2dulpx_shadow_store(iis2dulpx_shadow_t *shadow, uint8_t reg, uint8_t val)
 {
-  iis2dulpx_ctrl1_t ctrl1 = {0};
-  uint8_t cnt = 0;
-  int32_t ret = 0;
+  uint8_t idx = (uint8_t)(reg - IIS2DULPX_SHADOW_FIRST);
+  uint8_t data = val;
 
-  ctrl1.sw_reset = PROPERTY_ENABLE;
-
-  ret = iis2dulpx_write_reg(ctx, IIS2DULPX_CTRL1, (uint8_t *)&ctrl1, 1);
-  if (ret != 0)
+  /* never cache self-clearing command bits */
+  if (reg == IIS2DULPX_CTRL1)
   {
-    goto exit;
+    data &= (uint8_t)~0x20U; /* sw_reset */
   }
-
-  do
+  else if (reg == IIS2DULPX_CTRL4)
   {
-    if (ctx->mdelay != NULL)
-    {
-      ctx->mdelay(1); /* should be 50 us */
-    }
-
-    ret = iis2dulpx_read_reg(ctx, IIS2DULPX_CTRL1, (uint8_t *)&ctrl1, 1);
-    if (ret != 0)
-    {
-      break;
-    }
-
-    /* sw-reset procedure ended correctly */
-    if (ctrl1.sw_reset == 0U)
-    {
-      break;
-    }
-  } while (cnt++ < 5U);
-
-  if (cnt >= 5U)
+    data &= (uint8_t)~0x03U; /* boot, soc */
+  }
+  else
   {
-    ret = -1;  /* sw-reset procedure failed */
+    /* register cached as is */
   }
 
-exit:
-  return ret;
+  shadow->reg[idx] = data;
+  shadow->valid[idx / 8U] |= (uint8_t)(1U << (idx % 8U));
 }
 
-int32_t iis2dulpx_status_get(const stmdev_ctx_t *ctx, iis2dulpx_status_t *val)
+static void iis2dulpx_shadow_invalidate(const stmdev_ctx_t *ctx)
 {
-  iis2dulpx_status_register_t status_register = {0};
-  iis2dulpx_ctrl1_t ctrl1 = {0};
-  iis2dulpx_ctrl4_t ctrl4 = {0};
-  int32_t ret = 0;
+  if ((ctx != NULL) && (ctx->priv_data != NULL))
+  {
+    iis2dulpx_shadow_t *shadow = &((iis2dulpx_priv_t *)ctx->priv_data)->shadow;
 
-  ret = iis2dulpx_read_reg(ctx, IIS2DULPX_STATUS,
-                           (uint8_t *)&status_register, 1);
-  ret += iis2dulpx_read_reg(ctx, IIS2DULPX_CTRL1, (uint8_t *)&ctrl1, 1);
-  ret += iis2dulpx_read_reg(ctx, IIS2DULPX_CTRL4, (uint8_t *)&ctrl4, 1);
+    (void)memset(shadow->valid, 0, sizeof(shadow->valid));
+    shadow->page_rw_valid = PROPERTY_DISABLE;
+  }
+}
 
-  if (ret == 0)
+/*
+ * Read one configuration register, served from the shadow copy when
+ * caching is enabled and the entry is valid.
+ */
+static uint8_t iis2dulpx_shadow_hit(const stmdev_ctx_t *ctx, uint8_t reg)
+{
+  iis2dulpx_shadow_t *shadow = iis2dulpx_shadow_of(ctx, reg);
+  uint8_t idx = (uint8_t)(reg - IIS2DULPX_SHADOW_FIRST);
+  uint8_t hit = PROPERTY_DISABLE;
+
+  if ((shadow != NULL) && ((shadow->valid[idx / 8U] & (uint8_t)(1U << (idx % 8U))) != 0U))
   {
-    val->sw_reset = ctrl1.sw_reset;
-    val->boot     = ctrl4.boot;
-    val->drdy     = status_register.drdy;
+    hit = PROPERTY_ENABLE;
   }
 
-  return ret;
+  return hit;
 }
 
-int32_t iis2dulpx_embedded_status_get(const stmdev_ctx_t *ctx, iis2dulpx_embedded_status_t *val)
+static int32_t iis2dulpx_shadow_read(const stmdev_ctx_t *ctx, uint8_t reg, uint8_t *data)
 {
-  iis2dulpx_emb_func_status_mainpage_t status = {0};
-  int32_t ret = 0;
+  iis2dulpx_shadow_t *shadow = iis2dulpx_shadow_of(ctx, reg);
+  int32_t ret;
 
-  ret = iis2dulpx_read_reg(ctx, IIS2DULPX_EMB_FUNC_STATUS_MAINPAGE, (uint8_t *)&status, 1);
+  if (iis2dulpx_shadow_hit(ctx, reg) == PROPERTY_ENABLE)
+  {
+    *data = shadow->reg[reg - IIS2DULPX_SHADOW_FIRST];
+    return 0;
+  }
 
-  if (ret == 0)
+  ret = iis2dulpx_read_reg(ctx, reg, data, 1);
+  if ((ret == 0) && (shadow != NULL))
   {
-    val->is_step_det = status.is_step_det;
-    val->is_tilt = status.is_tilt;
-    val->is_sigmot = status.is_sigmot;
+    iis2dulpx_shadow_store(shadow, reg, *data);
   }
 
   return ret;
 }
 
-int32_t iis2dulpx_data_ready_mode_set(const stmdev_ctx_t *ctx, iis2dulpx_data_ready_mode_t val)
+/*
+ * Write one configuration register and keep the shadow copy in sync.
+ * On a bus error the entry is dropped, the device content is unknown.
+ */
+static int32_t iis2dulpx_shadow_write(const stmdev_ctx_t *ctx, uint8_t reg, uint8_t *data)
 {
-  iis2dulpx_ctrl1_t ctrl1 = {0};
-  int32_t ret = 0;
-
-  ret = iis2dulpx_read_reg(ctx, IIS2DULPX_CTRL1, (uint8_t *)&ctrl1, 1);
+  iis2dulpx_shadow_t *shadow = iis2dulpx_shadow_of(ctx, reg);
+  int32_t ret;
 
-  if (ret == 0)
+  ret = iis2dulpx_write_reg(ctx, reg, data, 1);
+  if (shadow != NULL)
   {
-    ctrl1.drdy_pulsed = ((uint8_t)val & 0x1U);
-    ret = iis2dulpx_write_reg(ctx, IIS2DULPX_CTRL1, (uint8_t *)&ctrl1, 1);
+    if (ret == 0)
+    {
+      iis2dulpx_shadow_store(shadow, reg, *data);
+    }
+    else
+    {
+      uint8_t idx = (uint8_t)(reg - IIS2DULPX_SHADOW_FIRST);
+
+      shadow->valid[idx / 8U] &= (uint8_t)~(1U << (idx % 8U));
+    }
   }
 
   return ret;
 }
 
-int32_t iis2dulpx_data_ready_mode_get(const stmdev_ctx_t *ctx, iis2dulpx_data_ready_mode_t *val)
+/* cache a value transferred without iis2dulpx_shadow_read/write */
+static void iis2dulpx_shadow_update(const stmdev_ctx_t *ctx, uint8_t reg, uint8_t val)
 {
-  iis2dulpx_ctrl1_t ctrl1 = {0};
-  int32_t ret = 0;
+  iis2dulpx_shadow_t *shadow = iis2dulpx_shadow_of(ctx, reg);
 
-  ret = iis2dulpx_read_reg(ctx, IIS2DULPX_CTRL1, (uint8_t *)&ctrl1, 1);
-
-  if (ret != 0)
+  if (shadow != NULL)
   {
-    return ret;
+    iis2dulpx_shadow_store(shadow, reg, val);
   }
+}
 
-  switch ((ctrl1.drdy_pulsed))
+/*
+ * Record a configuration register read, unless it can be served from
+ * the shadow copy right away.
+ */
+static int32_t iis2dulpx_txn_shadow_read(iis2dulpx_txn_t *txn, uint8_t reg, uint8_t *data)
+{
+  if (iis2dulpx_shadow_hit(txn->ctx, reg) == PROPERTY_ENABLE)
   {
-    case 0x0:
-      *val = IIS2DULPX_DRDY_LATCHED;
-      break;
-
-    case 0x1:
-      *val = IIS2DULPX_DRDY_PULSED;
-      break;
-
-    default:
-      *val = IIS2DULPX_DRDY_LATCHED;
-      break;
+    *data = iis2dulpx_shadow_of(txn->ctx, reg)->reg[reg - IIS2DULPX_SHADOW_FIRST];
+    return 0;
   }
-  return ret;
+
+  return iis2dulpx_txn_read(txn, reg, data, 1);
 }
 
-int32_t iis2dulpx_mode_set(const stmdev_ctx_t *ctx, const iis2dulpx_md_t *val)
+/*
+ * Clear the driver private data. Caching stays enabled if the user
+ * asked for it, only the cached content is dropped.
+ */
+static void iis2dulpx_priv_reset(const stmdev_ctx_t *ctx)
 {
-  iis2dulpx_ctrl3_t ctrl3 = {0};
-  iis2dulpx_ctrl5_t ctrl5 = {0};
-  int32_t ret = 0;
-
-  ret = iis2dulpx_read_reg(ctx, IIS2DULPX_CTRL5, (uint8_t *)&ctrl5, 1);
-  if (ret != 0)
+  if (ctx->priv_data != NULL)
   {
-    return ret;
+    iis2dulpx_priv_t *priv = (iis2dulpx_priv_t *)ctx->priv_data;
+    uint8_t shadow_en;
+    iis2dulpx_txn_ptr txn_hook;
+    iis2dulpx_udelay_ptr udelay;
+    iis2dulpx_lock_ptr lock;
+    iis2dulpx_lock_ptr unlock;
+    void *lock_arg;
+    uint32_t bank_seq;
+#ifdef IIS2DULPX_REC
+    iis2dulpx_rec_t *rec;
+#endif /* IIS2DULPX_REC */
+
+    iis2dulpx_lock(ctx);
+
+    /* the device is back on main bank: end a pending embedded bracket */
+    if ((priv->bank_seq & 1U) != 0U)
+    {
+      priv->bank_seq++;
+      iis2dulpx_unlock(ctx);
+    }
+
+    shadow_en = priv->shadow.enable;
+    txn_hook = priv->txn_hook;
+    udelay = priv->udelay;
+    lock = priv->lock;
+    unlock = priv->unlock;
+    lock_arg = priv->lock_arg;
+    bank_seq = priv->bank_seq;
+#ifdef IIS2DULPX_REC
+    rec = priv->rec;
+#endif /* IIS2DULPX_REC */
+
+#ifdef IIS2DULPX_STATS
+    /* bus statistics, last member, are cumulative */
+    (void)memset(priv, 0, offsetof(iis2dulpx_priv_t, stats));
+#else
+    (void)memset(priv, 0, sizeof(iis2dulpx_priv_t));
+#endif /* IIS2DULPX_STATS */
+    priv->shadow.enable = shadow_en;
+    priv->txn_hook = txn_hook;
+    priv->udelay = udelay;
+    priv->lock = lock;
+    priv->unlock = unlock;
+    priv->lock_arg = lock_arg;
+    priv->bank_seq = bank_seq;
+#ifdef IIS2DULPX_REC
+    priv->rec = rec;
+#endif /* IIS2DULPX_REC */
+
+    iis2dulpx_unlock(ctx);
   }
+}
 
-  ctrl5.odr = (uint8_t)val->odr & 0xFU;
-  ctrl5.fs = (uint8_t)val->fs & 0x03U;
+float_t iis2dulpx_from_fs2g_to_mg(int16_t lsb)
+{
+  return (float_t)lsb * 0.061f;
+}
 
-  /* set the bandwidth */
-  switch (val->odr)
-  {
-    /* no anti-aliasing filter present */
-    case IIS2DULPX_OFF:
-    case IIS2DULPX_1Hz6_ULP:
-    case IIS2DULPX_3Hz_ULP:
-    case IIS2DULPX_25Hz_ULP:
-      ctrl5.bw = 0x0U;
-      break;
-
-    /* low-power mode with ODR < 50 Hz */
-    case IIS2DULPX_6Hz_LP:
-      switch (val->bw)
-      {
-        case IIS2DULPX_ODR_div_2:
-        case IIS2DULPX_ODR_div_4:
-        case IIS2DULPX_ODR_div_8:
-        default:
-          /* value not allowed */
-          ret = -1;
-          break;
-        case IIS2DULPX_ODR_div_16:
-          ctrl5.bw = 0x3U;
-          break;
-      }
-      break;
-    case IIS2DULPX_12Hz5_LP:
-      switch (val->bw)
-      {
-        case IIS2DULPX_ODR_div_2:
-        case IIS2DULPX_ODR_div_4:
-        default:
-          /* value not allowed */
-          ret = -1;
-          break;
-        case IIS2DULPX_ODR_div_8:
-          ctrl5.bw = 0x2U;
-          break;
-        case IIS2DULPX_ODR_div_16:
-          ctrl5.bw = 0x3U;
-          break;
-      }
-      break;
-    case IIS2DULPX_25Hz_LP:
-      switch (val->bw)
-      {
-        case IIS2DULPX_ODR_div_2:
-        default:
-          /* value not allowed */
-          ret = -1;
-          break;
-        case IIS2DULPX_ODR_div_4:
-          ctrl5.bw = 0x1U;
-          break;
-        case IIS2DULPX_ODR_div_8:
-          ctrl5.bw = 0x2U;
-          break;
-        case IIS2DULPX_ODR_div_16:
-          ctrl5.bw = 0x3U;
-          break;
-      }
-      break;
+float_t iis2dulpx_from_fs4g_to_mg(int16_t lsb)
+{
+  return (float_t)lsb * 0.122f;
+}
 
-    /* standard cases */
-    case IIS2DULPX_50Hz_LP:
-    case IIS2DULPX_100Hz_LP:
-    case IIS2DULPX_200Hz_LP:
-    case IIS2DULPX_400Hz_LP:
-    case IIS2DULPX_800Hz_LP:
-    case IIS2DULPX_TRIG_PIN:
-    case IIS2DULPX_TRIG_SW:
-    case IIS2DULPX_6Hz_HP:
-    case IIS2DULPX_12Hz5_HP:
-    case IIS2DULPX_25Hz_HP:
-    case IIS2DULPX_50Hz_HP:
-    case IIS2DULPX_100Hz_HP:
-    case IIS2DULPX_200Hz_HP:
-    case IIS2DULPX_400Hz_HP:
-    case IIS2DULPX_800Hz_HP:
-    default:
-      ctrl5.bw = (uint8_t)val->bw & 0x03U;
-      break;
-  }
+float_t iis2dulpx_from_fs8g_to_mg(int16_t lsb)
+{
+  return (float_t)lsb * 0.244f;
+}
 
-  if (ret != 0)
-  {
-    return ret;
-  }
+float_t iis2dulpx_from_fs16g_to_mg(int16_t lsb)
+{
+  return (float_t)lsb * 0.488f;
+}
 
-  ret = iis2dulpx_read_reg(ctx, IIS2DULPX_CTRL3, (uint8_t *)&ctrl3, 1);
+float_t iis2dulpx_from_lsb_to_celsius(int16_t lsb)
+{
+  return ((float_t)lsb / 355.5f) + 25.0f;
+}
 
-  ctrl3.hp_en = (((uint8_t)val->odr & 0x30U) == 0x10U) ? 1U : 0U;
+float_t iis2dulpx_from_lsb_to_mv(int16_t lsb)
+{
+  return ((float_t)lsb) / 74.4f;
+}
 
-  if (ret == 0)
-  {
-    ret = iis2dulpx_write_reg(ctx, IIS2DULPX_CTRL5, (uint8_t *)&ctrl5, 1);
-    ret += iis2dulpx_write_reg(ctx, IIS2DULPX_CTRL3, (uint8_t *)&ctrl3, 1);
-  }
+int32_t iis2dulpx_from_fs2g_to_ug(int16_t lsb)
+{
+  return (int32_t)lsb * 61;
+}
 
-  return ret;
+int32_t iis2dulpx_from_fs4g_to_ug(int16_t lsb)
+{
+  return (int32_t)lsb * 122;
 }
 
-int32_t iis2dulpx_mode_get(const stmdev_ctx_t *ctx, iis2dulpx_md_t *val)
+int32_t iis2dulpx_from_fs8g_to_ug(int16_t lsb)
 {
-  iis2dulpx_ctrl3_t ctrl3 = {0};
-  iis2dulpx_ctrl5_t ctrl5 = {0};
-  int32_t ret = 0;
+  return (int32_t)lsb * 244;
+}
 
-  ret = iis2dulpx_read_reg(ctx, IIS2DULPX_CTRL5, (uint8_t *)&ctrl5, 1);
-  ret += iis2dulpx_read_reg(ctx, IIS2DULPX_CTRL3, (uint8_t *)&ctrl3, 1);
+int32_t iis2dulpx_from_fs16g_to_ug(int16_t lsb)
+{
+  return (int32_t)lsb * 488;
+}
 
-  if (ret != 0)
-  {
-    return ret;
-  }
+int16_t iis2dulpx_from_lsb_to_centi_celsius(int16_t lsb)
+{
+  /* 355.5 LSB/degC */
+  return (int16_t)((((int32_t)lsb * 200) / 711) + 2500);
+}
 
-  switch (ctrl5.odr)
-  {
-    case 0x00:
-      val->odr = IIS2DULPX_OFF;
-      break;
-    case 0x01:
-      val->odr = IIS2DULPX_1Hz6_ULP;
-      break;
-    case 0x02:
-      val->odr = IIS2DULPX_3Hz_ULP;
-      break;
-    case 0x03:
-      val->odr = IIS2DULPX_25Hz_ULP;
-      break;
-    case 0x04:
-      val->odr = (ctrl3.hp_en == 0x1U) ? IIS2DULPX_6Hz_HP : IIS2DULPX_6Hz_LP;
-      break;
-    case 0x05:
-      val->odr = (ctrl3.hp_en == 0x1U) ? IIS2DULPX_12Hz5_HP : IIS2DULPX_12Hz5_LP;
-      break;
-    case 0x06:
-      val->odr = (ctrl3.hp_en == 0x1U) ? IIS2DULPX_25Hz_HP : IIS2DULPX_25Hz_LP;
-      break;
-    case 0x07:
-      val->odr = (ctrl3.hp_en == 0x1U) ? IIS2DULPX_50Hz_HP : IIS2DULPX_50Hz_LP;
-      break;
-    case 0x08:
-      val->odr = (ctrl3.hp_en == 0x1U) ? IIS2DULPX_100Hz_HP : IIS2DULPX_100Hz_LP;
-      break;
-    case 0x09:
-      val->odr = (ctrl3.hp_en == 0x1U) ? IIS2DULPX_200Hz_HP : IIS2DULPX_200Hz_LP;
-      break;
-    case 0x0A:
-      val->odr = (ctrl3.hp_en == 0x1U) ? IIS2DULPX_400Hz_HP : IIS2DULPX_400Hz_LP;
-      break;
-    case 0x0B:
-      val->odr = (ctrl3.hp_en == 0x1U) ? IIS2DULPX_800Hz_HP : IIS2DULPX_800Hz_LP;
-      break;
-    case 0xe:
-      val->odr = IIS2DULPX_TRIG_PIN;
-      break;
-    case 0xf:
-      val->odr = IIS2DULPX_TRIG_SW;
-      break;
-    default:
-      val->odr = IIS2DULPX_OFF;
-      break;
-  }
+int32_t iis2dulpx_from_lsb_to_uv(int16_t lsb)
+{
+  /* 74.4 LSB/mV */
+  return ((int32_t)lsb * 10000) / 744;
+}
 
-  switch (ctrl5.fs)
-  {
-    case 0:
-      val->fs = IIS2DULPX_2g;
-      break;
-    case 1:
-      val->fs = IIS2DULPX_4g;
-      break;
-    case 2:
-      val->fs = IIS2DULPX_8g;
-      break;
-    case 3:
-      val->fs = IIS2DULPX_16g;
-      break;
-    default:
-      val->fs = IIS2DULPX_2g;
-      break;
-  }
+int32_t iis2dulpx_from_fs_to_ug(iis2dulpx_fs_t fs, int16_t lsb)
+{
+  int32_t ug;
 
-  switch (ctrl5.bw)
+  switch (fs)
   {
-    case 0:
-      val->bw = IIS2DULPX_ODR_div_2;
+    case IIS2DULPX_2g:
+      ug = iis2dulpx_from_fs2g_to_ug(lsb);
       break;
-    case 1:
-      val->bw = IIS2DULPX_ODR_div_4;
+    case IIS2DULPX_4g:
+      ug = iis2dulpx_from_fs4g_to_ug(lsb);
       break;
-    case 2:
-      val->bw = IIS2DULPX_ODR_div_8;
+    case IIS2DULPX_8g:
+      ug = iis2dulpx_from_fs8g_to_ug(lsb);
       break;
-    case 3:
-      val->bw = IIS2DULPX_ODR_div_16;
+    case IIS2DULPX_16g:
+      ug = iis2dulpx_from_fs16g_to_ug(lsb);
       break;
     default:
-      val->bw = IIS2DULPX_ODR_div_2;
+      ug = 0;
       break;
   }
 
-  return ret;
+  return ug;
 }
 
-int32_t iis2dulpx_t_ah_qvar_dis_set(const stmdev_ctx_t *ctx, uint8_t val)
+int32_t iis2dulpx_device_id_get(const stmdev_ctx_t *ctx, uint8_t *val)
 {
-  iis2dulpx_self_test_t temp = {0};
   int32_t ret = 0;
 
-  ret = iis2dulpx_read_reg(ctx, IIS2DULPX_SELF_TEST, (uint8_t *)&temp, 1);
-
-  if (ret == 0)
-  {
-    temp.t_ah_qvar_dis = val & 0x01U;
-    ret = iis2dulpx_write_reg(ctx, IIS2DULPX_SELF_TEST, (uint8_t *)&temp, 1);
-  }
+  ret = iis2dulpx_read_reg(ctx, IIS2DULPX_WHO_AM_I, val, 1);
 
   return ret;
 }
 
-int32_t iis2dulpx_t_ah_qvar_dis_get(const stmdev_ctx_t *ctx, uint8_t *val)
+int32_t iis2dulpx_init_set(const stmdev_ctx_t *ctx)
 {
-  iis2dulpx_self_test_t temp = {0};
+  iis2dulpx_ctrl1_t ctrl1 = {0};
+  iis2dulpx_ctrl4_t ctrl4 = {0};
+  iis2dulpx_txn_t txn;
   int32_t ret = 0;
 
-  ret = iis2dulpx_read_reg(ctx, IIS2DULPX_SELF_TEST, (uint8_t *)&temp, 1);
-  if (ret == 0)
+  iis2dulpx_priv_reset(ctx);
+
+  iis2dulpx_txn_init(&txn, ctx);
+  ret += iis2dulpx_txn_shadow_read(&txn, IIS2DULPX_CTRL1, (uint8_t *)&ctrl1);
+  ret += iis2dulpx_txn_shadow_read(&txn, IIS2DULPX_CTRL4, (uint8_t *)&ctrl4);
+  ret += iis2dulpx_txn_run(&txn);
+  if (ret != 0)
   {
-    *val = temp.t_ah_qvar_dis;
+    return ret;
   }
 
+  ctrl4.bdu = PROPERTY_ENABLE;
+  ctrl1.if_add_inc = PROPERTY_ENABLE;
+
+  ret += iis2dulpx_txn_write(&txn, IIS2DULPX_CTRL4, (uint8_t *)&ctrl4, 1);
+  ret += iis2dulpx_txn_write(&txn, IIS2DULPX_CTRL1, (uint8_t *)&ctrl1, 1);
+  ret += iis2dulpx_txn_run(&txn);
+
   return ret;
 }
 
-int32_t iis2dulpx_enter_deep_power_down(const stmdev_ctx_t *ctx, uint8_t val)
+int32_t iis2dulpx_embedded_state_set(const stmdev_ctx_t *ctx, uint8_t state)
 {
-  iis2dulpx_sleep_t sleep = {0};
   int32_t ret = 0;
+  iis2dulpx_ctrl4_t ctrl4 = {0};
 
-  ret = iis2dulpx_read_reg(ctx, IIS2DULPX_SLEEP, (uint8_t *)&sleep, 1);
+  ret = iis2dulpx_shadow_read(ctx, IIS2DULPX_CTRL4, (uint8_t *)&ctrl4);
 
-  if (ret == 0)
+  if (ret != 0)
   {
-    sleep.deep_pd = val & 0x01U;
-    ret = iis2dulpx_write_reg(ctx, IIS2DULPX_SLEEP, (uint8_t *)&sleep, 1);
+    goto exit;
   }
 
-  return ret;
-}
-
-int32_t iis2dulpx_exit_deep_power_down(const stmdev_ctx_t *ctx)
-{
-  iis2dulpx_en_device_config_t en_device_config = {0};
-  int32_t ret = 0;
+  ctrl4.emb_func_en = state & 0x01U;
 
-  en_device_config.soft_pd = PROPERTY_ENABLE;
-  ret = iis2dulpx_write_reg(ctx, IIS2DULPX_EN_DEVICE_CONFIG, (uint8_t *)&en_device_config, 1);
+  ret += iis2dulpx_shadow_write(ctx, IIS2DULPX_CTRL4, (uint8_t *)&ctrl4);
 
-  if (ctx->mdelay != NULL)
-  {
-    ctx->mdelay(25); /* See AN5812 - paragraphs 3.1.1.1 and 3.1.1.2 */
-  }
 
+exit:
   return ret;
 }
 
-int32_t iis2dulpx_disable_hard_reset_from_cs_set(const stmdev_ctx_t *ctx, uint8_t val)
+/* blocking power transition */
+static int32_t iis2dulpx_pwr_run(const stmdev_ctx_t *ctx, iis2dulpx_pwr_cmd_t cmd)
 {
-  iis2dulpx_fifo_ctrl_t fifo_ctrl = {0};
+  iis2dulpx_pwr_t pwr;
   int32_t ret = 0;
 
-  ret = iis2dulpx_read_reg(ctx, IIS2DULPX_FIFO_CTRL, (uint8_t *)&fifo_ctrl, 1);
-  fifo_ctrl.dis_hard_rst_cs = (val == 1U) ? PROPERTY_ENABLE : PROPERTY_DISABLE;
+  /* nothing is written if the waits cannot be timed */
+  if ((ctx->mdelay == NULL) &&
+      ((ctx->priv_data == NULL) || (((iis2dulpx_priv_t *)ctx->priv_data)->udelay == NULL)))
+  {
+    return -1;
+  }
+
+  iis2dulpx_pwr_init(&pwr);
+  ret = iis2dulpx_pwr_start(ctx, &pwr, cmd, NULL, NULL);
   if (ret == 0)
   {
-    ret += iis2dulpx_write_reg(ctx, IIS2DULPX_FIFO_CTRL, (uint8_t *)&fifo_ctrl, 1);
+    ret = iis2dulpx_pwr_wait(&pwr);
   }
 
   return ret;
 }
 
-int32_t iis2dulpx_disable_hard_reset_from_cs_get(const stmdev_ctx_t *ctx, uint8_t *val)
+int32_t iis2dulpx_reboot(const stmdev_ctx_t *ctx)
 {
-  iis2dulpx_fifo_ctrl_t fifo_ctrl = {0};
-  int32_t ret = 0;
+  return iis2dulpx_pwr_run(ctx, IIS2DULPX_PWR_REBOOT);
+}
 
-  ret = iis2dulpx_read_reg(ctx, IIS2DULPX_FIFO_CTRL, (uint8_t *)&fifo_ctrl, 1);
-  if (ret == 0)
+int32_t iis2dulpx_sw_por(const stmdev_ctx_t *ctx)
+{
+  return iis2dulpx_pwr_run(ctx, IIS2DULPX_PWR_SW_POR);
+}
+
+int32_t iis2dulpx_sw_reset(const stmdev_ctx_t *ctx)
+{
+  return iis2dulpx_pwr_run(ctx, IIS2DULPX_PWR_SW_RESET);
+}
+
+int32_t iis2dulpx_shadow_set(const stmdev_ctx_t *ctx, uint8_t val)
+{
+  iis2dulpx_priv_t *priv;
+
+  if (ctx->priv_data == NULL)
   {
-    *val = fifo_ctrl.dis_hard_rst_cs;
+    return -1;
   }
 
-  return ret;
+  priv = (iis2dulpx_priv_t *)ctx->priv_data;
+  priv->shadow.enable = (val != 0U) ? PROPERTY_ENABLE : PROPERTY_DISABLE;
+  iis2dulpx_shadow_invalidate(ctx);
+
+  return 0;
 }
 
-int32_t iis2dulpx_trigger_sw(const stmdev_ctx_t *ctx, const iis2dulpx_md_t *md)
+int32_t iis2dulpx_shadow_get(const stmdev_ctx_t *ctx, uint8_t *val)
 {
-  iis2dulpx_ctrl4_t ctrl4 = {0};
-  int32_t ret = 0;
-
-  if (md->odr == IIS2DULPX_TRIG_SW)
+  if (ctx->priv_data == NULL)
   {
-    ret = iis2dulpx_read_reg(ctx, IIS2DULPX_CTRL4, (uint8_t *)&ctrl4, 1);
-    ctrl4.soc = PROPERTY_ENABLE;
-    if (ret == 0)
-    {
-      ret = iis2dulpx_write_reg(ctx, IIS2DULPX_CTRL4, (uint8_t *)&ctrl4, 1);
-    }
+    return -1;
   }
-  return ret;
+
+  *val = ((iis2dulpx_priv_t *)ctx->priv_data)->shadow.enable;
+
+  return 0;
 }
 
-int32_t iis2dulpx_all_sources_get(const stmdev_ctx_t *ctx, iis2dulpx_all_sources_t *val)
+/* configuration runs only: data, source and FIFO output registers are skipped */
+static const uint8_t iis2dulpx_shadow_runs[][2] =
 {
-  iis2dulpx_status_register_t status = {0};
-  int32_t ret = 0;
+  { IIS2DULPX_EXT_CLK_CFG, 1U },
+  { IIS2DULPX_PIN_CTRL, 1U },
+  { IIS2DULPX_WAKE_UP_DUR_EXT, 1U },
+  { IIS2DULPX_CTRL1, 9U },          /* CTRL1 .. SIXD */
+  { IIS2DULPX_WAKE_UP_THS, 5U },    /* WAKE_UP_THS .. MD2_CFG */
+  { IIS2DULPX_AH_QVAR_CFG, 3U },    /* AH_QVAR_CFG .. I3C_IF_CTRL */
+  { IIS2DULPX_SLEEP, 1U },
+  { IIS2DULPX_FIFO_BATCH_DEC, 1U },
+};
 
-  ret = iis2dulpx_read_reg(ctx, IIS2DULPX_STATUS, (uint8_t *)&status, 1);
-  val->drdy = status.drdy;
+int32_t iis2dulpx_shadow_refresh(const stmdev_ctx_t *ctx)
+{
+  const uint8_t (*run)[2] = iis2dulpx_shadow_runs;
+  iis2dulpx_shadow_t *shadow;
+  uint8_t buff[9];
+  uint8_t i, j;
+  int32_t ret = 0;
 
-  if (ret == 0 && status.int_global == 0x1U)
+  shadow = iis2dulpx_shadow_of(ctx, IIS2DULPX_SHADOW_FIRST);
+  if (shadow == NULL)
   {
-    iis2dulpx_wake_up_src_t wu_src;
-    iis2dulpx_tap_src_t tap_src;
-    iis2dulpx_sixd_src_t sixd_src;
+    return -1;
+  }
 
-    ret = iis2dulpx_read_reg(ctx, IIS2DULPX_SIXD_SRC, (uint8_t *)&sixd_src, 1);
-    ret += iis2dulpx_read_reg(ctx, IIS2DULPX_WAKE_UP_SRC, (uint8_t *)&wu_src, 1);
-    ret += iis2dulpx_read_reg(ctx, IIS2DULPX_TAP_SRC, (uint8_t *)&tap_src, 1);
+  (void)memset(shadow->valid, 0, sizeof(shadow->valid));
 
+  for (i = 0U; i < (uint8_t)(sizeof(iis2dulpx_shadow_runs) / sizeof(iis2dulpx_shadow_runs[0])); i++)
+  {
+    ret = iis2dulpx_read_reg(ctx, run[i][0], buff, run[i][1]);
     if (ret != 0)
     {
-      return ret;
+      break;
     }
 
-    val->six_d    = sixd_src.d6d_ia;
-    val->six_d_xl = sixd_src.xl;
-    val->six_d_xh = sixd_src.xh;
-    val->six_d_yl = sixd_src.yl;
-    val->six_d_yh = sixd_src.yh;
-    val->six_d_zl = sixd_src.zl;
-    val->six_d_zh = sixd_src.zh;
-
-    val->wake_up      = wu_src.wu_ia;
-    val->wake_up_z    = wu_src.z_wu;
-    val->wake_up_y    = wu_src.y_wu;
-    val->wake_up_x    = wu_src.x_wu;
-    val->free_fall    = wu_src.ff_ia;
-    val->sleep_change = wu_src.sleep_change_ia;
-    val->sleep_state  = wu_src.sleep_state;
-
-    val->single_tap = tap_src.single_tap_ia;
-    val->double_tap = tap_src.double_tap_ia;
-    val->triple_tap = tap_src.triple_tap_ia;
+    for (j = 0U; j < run[i][1]; j++)
+    {
+      iis2dulpx_shadow_store(shadow, run[i][0] + j, buff[j]);
+    }
   }
 
   return ret;
 }
 
-int32_t iis2dulpx_xl_data_get(const stmdev_ctx_t *ctx, const iis2dulpx_md_t *md,
-                              iis2dulpx_xl_data_t *data)
+int32_t iis2dulpx_txn_hook_set(const stmdev_ctx_t *ctx, iis2dulpx_txn_ptr hook)
 {
-  uint8_t buff[6] = {0};
-  int32_t ret = 0;
-  uint8_t i = 0;
-  uint8_t j = 0;
+  if (ctx->priv_data == NULL)
+  {
+    return -1;
+  }
 
-  ret = iis2dulpx_read_reg(ctx, IIS2DULPX_OUT_X_L, buff, 6);
+  ((iis2dulpx_priv_t *)ctx->priv_data)->txn_hook = hook;
 
-  if (ret != 0)
+  return 0;
+}
+
+int32_t iis2dulpx_lock_set(const stmdev_ctx_t *ctx, iis2dulpx_lock_ptr lock,
+                           iis2dulpx_lock_ptr unlock, void *arg)
+{
+  iis2dulpx_priv_t *priv = (iis2dulpx_priv_t *)ctx->priv_data;
+
+  /* hooks set in pairs, not in the middle of an embedded bracket */
+  if ((priv == NULL) || ((lock == NULL) != (unlock == NULL)) || ((priv->bank_seq & 1U) != 0U))
   {
-    return ret;
+    return -1;
   }
 
-  /* acceleration conversion */
-  j = 0U;
-  for (i = 0U; i < 3U; i++)
+  priv->lock = lock;
+  priv->unlock = unlock;
+  priv->lock_arg = arg;
+
+  return 0;
+}
+
+int32_t iis2dulpx_lock_take(const stmdev_ctx_t *ctx)
+{
+  if (ctx->priv_data == NULL)
   {
-    data->raw[i] = (int16_t)(buff[j] | (uint16_t)buff[j + 1U] << 8);
-    j += 2U;
-    switch (md->fs)
-    {
-      case IIS2DULPX_2g:
-        data->mg[i] = iis2dulpx_from_fs2g_to_mg(data->raw[i]);
-        break;
-      case IIS2DULPX_4g:
-        data->mg[i] = iis2dulpx_from_fs4g_to_mg(data->raw[i]);
-        break;
-      case IIS2DULPX_8g:
-        data->mg[i] = iis2dulpx_from_fs8g_to_mg(data->raw[i]);
-        break;
-      case IIS2DULPX_16g:
-        data->mg[i] = iis2dulpx_from_fs16g_to_mg(data->raw[i]);
-        break;
-      default:
-        data->mg[i] = 0.0f;
-        break;
-    }
+    return -1;
   }
 
-  return ret;
+  iis2dulpx_lock(ctx);
+
+  return 0;
 }
 
-int32_t iis2dulpx_outt_data_get(const stmdev_ctx_t *ctx,
-                                iis2dulpx_outt_data_t *data)
+int32_t iis2dulpx_lock_release(const stmdev_ctx_t *ctx)
 {
-  uint8_t buff[2] = {0};
-  int32_t ret = 0;
+  if (ctx->priv_data == NULL)
+  {
+    return -1;
+  }
 
-  ret = iis2dulpx_read_reg(ctx, IIS2DULPX_OUT_T_AH_QVAR_L, buff, 2);
+  iis2dulpx_unlock(ctx);
 
-  if (ret != 0)
+  return 0;
+}
+
+void iis2dulpx_txn_init(iis2dulpx_txn_t *txn, const stmdev_ctx_t *ctx)
+{
+  txn->ctx = ctx;
+  txn->num = 0U;
+  txn->overflow = 0U;
+}
+
+static int32_t iis2dulpx_txn_add(iis2dulpx_txn_t *txn, uint8_t read, uint8_t reg,
+                                 uint8_t *data, uint16_t len)
+{
+  if (txn->num >= IIS2DULPX_TXN_MAX)
   {
-    return ret;
+    txn->overflow = 1U;
+    return -1;
   }
 
-  data->heat.raw = (int16_t)(buff[0] | ((uint16_t)buff[1U] << 8));
-  /* temperature conversion */
-  data->heat.deg_c = iis2dulpx_from_lsb_to_celsius(data->heat.raw);
+  txn->op[txn->num].read = read;
+  txn->op[txn->num].reg = reg;
+  txn->op[txn->num].data = data;
+  txn->op[txn->num].len = len;
+  txn->num++;
 
-  return ret;
+  return 0;
 }
 
-int32_t iis2dulpx_ah_qvar_data_get(const stmdev_ctx_t *ctx,
-                                   iis2dulpx_ah_qvar_data_t *data)
+int32_t iis2dulpx_txn_read(iis2dulpx_txn_t *txn, uint8_t reg, uint8_t *data, uint16_t len)
 {
-  uint8_t buff[3] = {0};
-  int32_t ret = 0;
+  return iis2dulpx_txn_add(txn, 1U, reg, data, len);
+}
 
-  /* Read and discard also OUT_Z_H reg to clear drdy */
-  ret = iis2dulpx_read_reg(ctx, IIS2DULPX_OUT_T_AH_QVAR_L - 1U, buff, 3);
+int32_t iis2dulpx_txn_write(iis2dulpx_txn_t *txn, uint8_t reg, uint8_t *data, uint16_t len)
+{
+  return iis2dulpx_txn_add(txn, 0U, reg, data, len);
+}
 
-  if (ret != 0)
+/*
+ * Bring the shadow copy in line with a completed (ok) or failed
+ * transfer. Failed writes leave the device content unknown.
+ */
+static void iis2dulpx_txn_shadow_sync(const stmdev_ctx_t *ctx, const iis2dulpx_txn_op_t *op,
+                                      uint8_t ok)
+{
+  iis2dulpx_shadow_t *shadow;
+  uint16_t i;
+  uint16_t reg;
+  uint8_t idx;
+
+  for (i = 0U; i < op->len; i++)
   {
-    return ret;
-  }
+    reg = (uint16_t)op->reg + i;
+    if (reg > IIS2DULPX_SHADOW_LAST)
+    {
+      break;
+    }
 
-  data->raw = (int16_t)(buff[1U] | (uint16_t)buff[2U] << 8);
+    shadow = iis2dulpx_shadow_of(ctx, (uint8_t)reg);
+    if (shadow == NULL)
+    {
+      continue;
+    }
 
-  data->mv = iis2dulpx_from_lsb_to_mv(data->raw);
-  return ret;
+    if (ok == PROPERTY_ENABLE)
+    {
+      iis2dulpx_shadow_store(shadow, (uint8_t)reg, op->data[i]);
+    }
+    else if (op->read == 0U)
+    {
+      idx = (uint8_t)(reg - IIS2DULPX_SHADOW_FIRST);
+      shadow->valid[idx / 8U] &= (uint8_t)~(1U << (idx % 8U));
+    }
+    else
+    {
+      /* failed read: cached content still valid */
+    }
+  }
 }
 
-int32_t iis2dulpx_self_test_sign_set(const stmdev_ctx_t *ctx, iis2dulpx_xl_self_test_t val)
+int32_t iis2dulpx_txn_run(iis2dulpx_txn_t *txn)
 {
-  iis2dulpx_ctrl3_t ctrl3 = {0};
-  iis2dulpx_wake_up_dur_t wkup_dur = {0};
+  const stmdev_ctx_t *ctx = txn->ctx;
+  iis2dulpx_txn_ptr hook = NULL;
+  uint8_t done = 0U;
+  uint8_t failed = 0U;
+  uint8_t i;
   int32_t ret = 0;
 
-  ret = iis2dulpx_read_reg(ctx, IIS2DULPX_CTRL3, (uint8_t *)&ctrl3, 1);
-  ret += iis2dulpx_read_reg(ctx, IIS2DULPX_WAKE_UP_DUR, (uint8_t *)&wkup_dur, 1);
-  if (ret != 0)
+  if (txn->overflow != 0U)
   {
-    return ret;
+    ret = -1;
+    goto exit;
   }
 
-  switch (val)
+  if (ctx->priv_data != NULL)
   {
-    case IIS2DULPX_XL_ST_POSITIVE:
-      ctrl3.st_sign_x = 1;
-      ctrl3.st_sign_y = 1;
-      wkup_dur.st_sign_z = 0;
-      break;
+    hook = ((iis2dulpx_priv_t *)ctx->priv_data)->txn_hook;
+  }
 
-    case IIS2DULPX_XL_ST_NEGATIVE:
-      ctrl3.st_sign_x = 0;
-      ctrl3.st_sign_y = 0;
-      wkup_dur.st_sign_z = 1;
-      break;
+  iis2dulpx_lock(ctx);
 
-    case IIS2DULPX_XL_ST_DISABLE:
-    default:
-      ret = -1;
-      break;
+  if ((hook != NULL) && (txn->num > 1U))
+  {
+#ifdef IIS2DULPX_STATS
+    uint32_t start = IIS2DULPX_STATS_CYCLES();
+#endif /* IIS2DULPX_STATS */
+
+    ret = hook(ctx->handle, txn->op, txn->num);
+    done = (ret == 0) ? txn->num : 0U;
+    failed = txn->num;
+
+#ifdef IIS2DULPX_STATS
+    for (i = 0U; i < txn->num; i++)
+    {
+      iis2dulpx_stats_add(ctx, txn->op[i].reg, txn->op[i].data, txn->op[i].len,
+                          (uint8_t)((txn->op[i].read != 0U) ? 0U : 1U), ret,
+                          (i == 0U) ? (IIS2DULPX_STATS_CYCLES() - start) : 0U);
+    }
+#endif /* IIS2DULPX_STATS */
+  }
+  else
+  {
+    for (i = 0U; i < txn->num; i++)
+    {
+      if (txn->op[i].read != 0U)
+      {
+        ret = iis2dulpx_read_reg(ctx, txn->op[i].reg, txn->op[i].data, txn->op[i].len);
+      }
+      else
+      {
+        ret = iis2dulpx_write_reg(ctx, txn->op[i].reg, txn->op[i].data, txn->op[i].len);
+      }
+
+      if (ret != 0)
+      {
+        failed = done + 1U;
+        break;
+      }
+      done++;
+    }
+  }
+
+  /* transfers past the failing one were not sent */
+  for (i = 0U; i < done; i++)
+  {
+    iis2dulpx_txn_shadow_sync(ctx, &txn->op[i], PROPERTY_ENABLE);
+  }
+  for (i = done; i < failed; i++)
+  {
+    iis2dulpx_txn_shadow_sync(ctx, &txn->op[i], PROPERTY_DISABLE);
   }
 
+  iis2dulpx_unlock(ctx);
 
-  ret += iis2dulpx_write_reg(ctx, IIS2DULPX_CTRL3, (uint8_t *)&ctrl3, 1);
-  ret += iis2dulpx_write_reg(ctx, IIS2DULPX_WAKE_UP_DUR, (uint8_t *)&wkup_dur, 1);
+exit:
+  txn->num = 0U;
+  txn->overflow = 0U;
 
   return ret;
 }
 
-int32_t iis2dulpx_self_test_start(const stmdev_ctx_t *ctx, uint8_t val)
+#ifdef IIS2DULPX_STATS
+int32_t iis2dulpx_stats_get(const stmdev_ctx_t *ctx, iis2dulpx_stats_t *val)
 {
-  iis2dulpx_self_test_t self_test = {0};
-  int32_t ret = 0;
-
-  if (val != 1U && val != 2U)
+  if (ctx->priv_data == NULL)
   {
     return -1;
   }
 
-  ret = iis2dulpx_read_reg(ctx, IIS2DULPX_SELF_TEST, (uint8_t *)&self_test, 1);
-  if (ret == 0)
+  (void)memcpy(val, &((iis2dulpx_priv_t *)ctx->priv_data)->stats, sizeof(iis2dulpx_stats_t));
+
+  return 0;
+}
+
+int32_t iis2dulpx_stats_reset(const stmdev_ctx_t *ctx)
+{
+  iis2dulpx_stats_t *st;
+  uint8_t bank;
+
+  if (ctx->priv_data == NULL)
   {
-    self_test.st = (uint8_t) val & 0x03U;
-    ret = iis2dulpx_write_reg(ctx, IIS2DULPX_SELF_TEST, (uint8_t *)&self_test, 1);
+    return -1;
   }
-  return ret;
+
+  st = &((iis2dulpx_priv_t *)ctx->priv_data)->stats;
+  bank = st->bank;
+  (void)memset(st, 0, sizeof(iis2dulpx_stats_t));
+  st->bank = bank;
+
+  return 0;
 }
+#endif /* IIS2DULPX_STATS */
 
-int32_t iis2dulpx_self_test_stop(const stmdev_ctx_t *ctx)
+int32_t iis2dulpx_status_get(const stmdev_ctx_t *ctx, iis2dulpx_status_t *val)
 {
-  iis2dulpx_self_test_t self_test = {0};
+  iis2dulpx_status_register_t status_register = {0};
+  iis2dulpx_ctrl1_t ctrl1 = {0};
+  iis2dulpx_ctrl4_t ctrl4 = {0};
   int32_t ret = 0;
 
-  ret = iis2dulpx_read_reg(ctx, IIS2DULPX_SELF_TEST, (uint8_t *)&self_test, 1);
+  ret = iis2dulpx_read_reg(ctx, IIS2DULPX_STATUS,
+                           (uint8_t *)&status_register, 1);
+  ret += iis2dulpx_read_reg(ctx, IIS2DULPX_CTRL1, (uint8_t *)&ctrl1, 1);
+  ret += iis2dulpx_read_reg(ctx, IIS2DULPX_CTRL4, (uint8_t *)&ctrl4, 1);
+
   if (ret == 0)
   {
-    self_test.st = 0;
-    ret = iis2dulpx_write_reg(ctx, IIS2DULPX_SELF_TEST, (uint8_t *)&self_test, 1);
+    val->sw_reset = ctrl1.sw_reset;
+    val->boot     = ctrl4.boot;
+    val->drdy     = status_register.drdy;
   }
+
   return ret;
 }
 
-int32_t iis2dulpx_i3c_configure_set(const stmdev_ctx_t *ctx, const iis2dulpx_i3c_cfg_t *val)
+int32_t iis2dulpx_embedded_status_get(const stmdev_ctx_t *ctx, iis2dulpx_embedded_status_t *val)
 {
-  iis2dulpx_i3c_if_ctrl_t i3c_cfg = {0};
+  iis2dulpx_emb_func_status_mainpage_t status = {0};
   int32_t ret = 0;
 
-  ret = iis2dulpx_read_reg(ctx, IIS2DULPX_I3C_IF_CTRL, (uint8_t *)&i3c_cfg, 1);
+  ret = iis2dulpx_read_reg(ctx, IIS2DULPX_EMB_FUNC_STATUS_MAINPAGE, (uint8_t *)&status, 1);
 
   if (ret == 0)
   {
-    i3c_cfg.bus_act_sel = (uint8_t)val->bus_act_sel & 0x03U;
-    i3c_cfg.dis_drstdaa = val->drstdaa_en;
-    i3c_cfg.asf_on = val->asf_on;
-    ret = iis2dulpx_write_reg(ctx, IIS2DULPX_I3C_IF_CTRL, (uint8_t *)&i3c_cfg, 1);
+    val->is_step_det = status.is_step_det;
+    val->is_tilt = status.is_tilt;
+    val->is_sigmot = status.is_sigmot;
   }
 
   return ret;
 }
 
-int32_t iis2dulpx_i3c_configure_get(const stmdev_ctx_t *ctx, iis2dulpx_i3c_cfg_t *val)
+int32_t iis2dulpx_data_ready_mode_set(const stmdev_ctx_t *ctx, iis2dulpx_data_ready_mode_t val)
 {
-  iis2dulpx_i3c_if_ctrl_t i3c_cfg = {0};
+  iis2dulpx_ctrl1_t ctrl1 = {0};
   int32_t ret = 0;
 
-  ret = iis2dulpx_read_reg(ctx, IIS2DULPX_I3C_IF_CTRL, (uint8_t *)&i3c_cfg, 1);
+  ret = iis2dulpx_shadow_read(ctx, IIS2DULPX_CTRL1, (uint8_t *)&ctrl1);
 
-  if (ret != 0)
+  if (ret == 0)
   {
-    return ret;
+    ctrl1.drdy_pulsed = ((uint8_t)val & 0x1U);
+    ret = iis2dulpx_shadow_write(ctx, IIS2DULPX_CTRL1, (uint8_t *)&ctrl1);
   }
 
-  val->drstdaa_en = i3c_cfg.dis_drstdaa;
-  val->asf_on = i3c_cfg.asf_on;
+  return ret;
+}
+
+int32_t iis2dulpx_data_ready_mode_get(const stmdev_ctx_t *ctx, iis2dulpx_data_ready_mode_t *val)
+{
+  iis2dulpx_ctrl1_t ctrl1 = {0};
+  int32_t ret = 0;
+
+  ret = iis2dulpx_read_reg(ctx, IIS2DULPX_CTRL1, (uint8_t *)&ctrl1, 1);
+
+  if (ret != 0)
+  {
+    return ret;
+  }
+
+  switch ((ctrl1.drdy_pulsed))
+  {
+    case 0x0:
+      *val = IIS2DULPX_DRDY_LATCHED;
+      break;
+
+    case 0x1:
+      *val = IIS2DULPX_DRDY_PULSED;
+      break;
+
+    default:
+      *val = IIS2DULPX_DRDY_LATCHED;
+      break;
+  }
+  return ret;
+}
+
+/* CTRL5 fields (odr, fs, bw) for the requested mode, -1 if not allowed */
+static int32_t iis2dulpx_mode_ctrl5_get(const iis2dulpx_md_t *val, iis2dulpx_ctrl5_t *ctrl5)
+{
+  int32_t ret = 0;
+
+  ctrl5->odr = (uint8_t)val->odr & 0xFU;
+  ctrl5->fs = (uint8_t)val->fs & 0x03U;
+
+  /* set the bandwidth */
+  switch (val->odr)
+  {
+    /* no anti-aliasing filter present */
+    case IIS2DULPX_OFF:
+    case IIS2DULPX_1Hz6_ULP:
+    case IIS2DULPX_3Hz_ULP:
+    case IIS2DULPX_25Hz_ULP:
+      ctrl5->bw = 0x0U;
+      break;
+
+    /* low-power mode with ODR < 50 Hz */
+    case IIS2DULPX_6Hz_LP:
+      switch (val->bw)
+      {
+        case IIS2DULPX_ODR_div_2:
+        case IIS2DULPX_ODR_div_4:
+        case IIS2DULPX_ODR_div_8:
+        default:
+          /* value not allowed */
+          ret = -1;
+          break;
+        case IIS2DULPX_ODR_div_16:
+          ctrl5->bw = 0x3U;
+          break;
+      }
+      break;
+    case IIS2DULPX_12Hz5_LP:
+      switch (val->bw)
+      {
+        case IIS2DULPX_ODR_div_2:
+        case IIS2DULPX_ODR_div_4:
+        default:
+          /* value not allowed */
+          ret = -1;
+          break;
+        case IIS2DULPX_ODR_div_8:
+          ctrl5->bw = 0x2U;
+          break;
+        case IIS2DULPX_ODR_div_16:
+          ctrl5->bw = 0x3U;
+          break;
+      }
+      break;
+    case IIS2DULPX_25Hz_LP:
+      switch (val->bw)
+      {
+        case IIS2DULPX_ODR_div_2:
+        default:
+          /* value not allowed */
+          ret = -1;
+          break;
+        case IIS2DULPX_ODR_div_4:
+          ctrl5->bw = 0x1U;
+          break;
+        case IIS2DULPX_ODR_div_8:
+          ctrl5->bw = 0x2U;
+          break;
+        case IIS2DULPX_ODR_div_16:
+          ctrl5->bw = 0x3U;
+          break;
+      }
+      break;
+
+    /* standard cases */
+    case IIS2DULPX_50Hz_LP:
+    case IIS2DULPX_100Hz_LP:
+    case IIS2DULPX_200Hz_LP:
+    case IIS2DULPX_400Hz_LP:
+    case IIS2DULPX_800Hz_LP:
+    case IIS2DULPX_TRIG_PIN:
+    case IIS2DULPX_TRIG_SW:
+    case IIS2DULPX_6Hz_HP:
+    case IIS2DULPX_12Hz5_HP:
+    case IIS2DULPX_25Hz_HP:
+    case IIS2DULPX_50Hz_HP:
+    case IIS2DULPX_100Hz_HP:
+    case IIS2DULPX_200Hz_HP:
+    case IIS2DULPX_400Hz_HP:
+    case IIS2DULPX_800Hz_HP:
+    default:
+      ctrl5->bw = (uint8_t)val->bw & 0x03U;
+      break;
+  }
+
+  return ret;
+}
+
+int32_t iis2dulpx_mode_set(const stmdev_ctx_t *ctx, const iis2dulpx_md_t *val)
+{
+  iis2dulpx_ctrl3_t ctrl3 = {0};
+  iis2dulpx_ctrl5_t ctrl5 = {0};
+  iis2dulpx_txn_t txn;
+  int32_t ret = 0;
+
+  /* all CTRL5 fields come from val: no read needed */
+  ret = iis2dulpx_mode_ctrl5_get(val, &ctrl5);
+  if (ret != 0)
+  {
+    return ret;
+  }
+
+  iis2dulpx_txn_init(&txn, ctx);
+  ret = iis2dulpx_txn_shadow_read(&txn, IIS2DULPX_CTRL3, (uint8_t *)&ctrl3);
+  ret += iis2dulpx_txn_run(&txn);
+  if (ret != 0)
+  {
+    return ret;
+  }
+
+  ctrl3.hp_en = (((uint8_t)val->odr & 0x30U) == 0x10U) ? 1U : 0U;
+
+  ret = iis2dulpx_txn_write(&txn, IIS2DULPX_CTRL5, (uint8_t *)&ctrl5, 1);
+  ret += iis2dulpx_txn_write(&txn, IIS2DULPX_CTRL3, (uint8_t *)&ctrl3, 1);
+  ret += iis2dulpx_txn_run(&txn);
+
+  return ret;
+}
+
+int32_t iis2dulpx_mode_get(const stmdev_ctx_t *ctx, iis2dulpx_md_t *val)
+{
+  iis2dulpx_ctrl3_t ctrl3 = {0};
+  iis2dulpx_ctrl5_t ctrl5 = {0};
+  int32_t ret = 0;
+
+  ret = iis2dulpx_read_reg(ctx, IIS2DULPX_CTRL5, (uint8_t *)&ctrl5, 1);
+  ret += iis2dulpx_read_reg(ctx, IIS2DULPX_CTRL3, (uint8_t *)&ctrl3, 1);
+
+  if (ret != 0)
+  {
+    return ret;
+  }
+
+  switch (ctrl5.odr)
+  {
+    case 0x00:
+      val->odr = IIS2DULPX_OFF;
+      break;
+    case 0x01:
+      val->odr = IIS2DULPX_1Hz6_ULP;
+      break;
+    case 0x02:
+      val->odr = IIS2DULPX_3Hz_ULP;
+      break;
+    case 0x03:
+      val->odr = IIS2DULPX_25Hz_ULP;
+      break;
+    case 0x04:
+      val->odr = (ctrl3.hp_en == 0x1U) ? IIS2DULPX_6Hz_HP : IIS2DULPX_6Hz_LP;
+      break;
+    case 0x05:
+      val->odr = (ctrl3.hp_en == 0x1U) ? IIS2DULPX_12Hz5_HP : IIS2DULPX_12Hz5_LP;
+      break;
+    case 0x06:
+      val->odr = (ctrl3.hp_en == 0x1U) ? IIS2DULPX_25Hz_HP : IIS2DULPX_25Hz_LP;
+      break;
+    case 0x07:
+      val->odr = (ctrl3.hp_en == 0x1U) ? IIS2DULPX_50Hz_HP : IIS2DULPX_50Hz_LP;
+      break;
+    case 0x08:
+      val->odr = (ctrl3.hp_en == 0x1U) ? IIS2DULPX_100Hz_HP : IIS2DULPX_100Hz_LP;
+      break;
+    case 0x09:
+      val->odr = (ctrl3.hp_en == 0x1U) ? IIS2DULPX_200Hz_HP : IIS2DULPX_200Hz_LP;
+      break;
+    case 0x0A:
+      val->odr = (ctrl3.hp_en == 0x1U) ? IIS2DULPX_400Hz_HP : IIS2DULPX_400Hz_LP;
+      break;
+    case 0x0B:
+      val->odr = (ctrl3.hp_en == 0x1U) ? IIS2DULPX_800Hz_HP : IIS2DULPX_800Hz_LP;
+      break;
+    case 0xe:
+      val->odr = IIS2DULPX_TRIG_PIN;
+      break;
+    case 0xf:
+      val->odr = IIS2DULPX_TRIG_SW;
+      break;
+    default:
+      val->odr = IIS2DULPX_OFF;
+      break;
+  }
+
+  switch (ctrl5.fs)
+  {
+    case 0:
+      val->fs = IIS2DULPX_2g;
+      break;
+    case 1:
+      val->fs = IIS2DULPX_4g;
+      break;
+    case 2:
+      val->fs = IIS2DULPX_8g;
+      break;
+    case 3:
+      val->fs = IIS2DULPX_16g;
+      break;
+    default:
+      val->fs = IIS2DULPX_2g;
+      break;
+  }
+
+  switch (ctrl5.bw)
+  {
+    case 0:
+      val->bw = IIS2DULPX_ODR_div_2;
+      break;
+    case 1:
+      val->bw = IIS2DULPX_ODR_div_4;
+      break;
+    case 2:
+      val->bw = IIS2DULPX_ODR_div_8;
+      break;
+    case 3:
+      val->bw = IIS2DULPX_ODR_div_16;
+      break;
+    default:
+      val->bw = IIS2DULPX_ODR_div_2;
+      break;
+  }
+
+  return ret;
+}
+
+int32_t iis2dulpx_t_ah_qvar_dis_set(const stmdev_ctx_t *ctx, uint8_t val)
+{
+  iis2dulpx_self_test_t temp = {0};
+  int32_t ret = 0;
+
+  ret = iis2dulpx_shadow_read(ctx, IIS2DULPX_SELF_TEST, (uint8_t *)&temp);
+
+  if (ret == 0)
+  {
+    temp.t_ah_qvar_dis = val & 0x01U;
+    ret = iis2dulpx_shadow_write(ctx, IIS2DULPX_SELF_TEST, (uint8_t *)&temp);
+  }
+
+  return ret;
+}
+
+int32_t iis2dulpx_t_ah_qvar_dis_get(const stmdev_ctx_t *ctx, uint8_t *val)
+{
+  iis2dulpx_self_test_t temp = {0};
+  int32_t ret = 0;
+
+  ret = iis2dulpx_read_reg(ctx, IIS2DULPX_SELF_TEST, (uint8_t *)&temp, 1);
+  if (ret == 0)
+  {
+    *val = temp.t_ah_qvar_dis;
+  }
+
+  return ret;
+}
+
+int32_t iis2dulpx_enter_deep_power_down(const stmdev_ctx_t *ctx, uint8_t val)
+{
+  iis2dulpx_sleep_t sleep = {0};
+  int32_t ret = 0;
+
+  ret = iis2dulpx_shadow_read(ctx, IIS2DULPX_SLEEP, (uint8_t *)&sleep);
+
+  if (ret == 0)
+  {
+    sleep.deep_pd = val & 0x01U;
+    ret = iis2dulpx_shadow_write(ctx, IIS2DULPX_SLEEP, (uint8_t *)&sleep);
+  }
+
+  return ret;
+}
+
+int32_t iis2dulpx_exit_deep_power_down(const stmdev_ctx_t *ctx)
+{
+  return iis2dulpx_pwr_run(ctx, IIS2DULPX_PWR_DPD_EXIT);
+}
+
+int32_t iis2dulpx_disable_hard_reset_from_cs_set(const stmdev_ctx_t *ctx, uint8_t val)
+{
+  iis2dulpx_fifo_ctrl_t fifo_ctrl = {0};
+  int32_t ret = 0;
+
+  ret = iis2dulpx_shadow_read(ctx, IIS2DULPX_FIFO_CTRL, (uint8_t *)&fifo_ctrl);
+  fifo_ctrl.dis_hard_rst_cs = (val == 1U) ? PROPERTY_ENABLE : PROPERTY_DISABLE;
+  if (ret == 0)
+  {
+    ret += iis2dulpx_shadow_write(ctx, IIS2DULPX_FIFO_CTRL, (uint8_t *)&fifo_ctrl);
+  }
+
+  return ret;
+}
+
+int32_t iis2dulpx_disable_hard_reset_from_cs_get(const stmdev_ctx_t *ctx, uint8_t *val)
+{
+  iis2dulpx_fifo_ctrl_t fifo_ctrl = {0};
+  int32_t ret = 0;
+
+  ret = iis2dulpx_read_reg(ctx, IIS2DULPX_FIFO_CTRL, (uint8_t *)&fifo_ctrl, 1);
+  if (ret == 0)
+  {
+    *val = fifo_ctrl.dis_hard_rst_cs;
+  }
+
+  return ret;
+}
+
+int32_t iis2dulpx_trigger_sw(const stmdev_ctx_t *ctx, const iis2dulpx_md_t *md)
+{
+  iis2dulpx_ctrl4_t ctrl4 = {0};
+  int32_t ret = 0;
+
+  if (md->odr == IIS2DULPX_TRIG_SW)
+  {
+    ret = iis2dulpx_shadow_read(ctx, IIS2DULPX_CTRL4, (uint8_t *)&ctrl4);
+    ctrl4.soc = PROPERTY_ENABLE;
+    if (ret == 0)
+    {
+      ret = iis2dulpx_shadow_write(ctx, IIS2DULPX_CTRL4, (uint8_t *)&ctrl4);
+    }
+  }
+  return ret;
+}
+
+static void iis2dulpx_all_sources_decode(const uint8_t *buff, iis2dulpx_all_sources_t *val)
+{
+  iis2dulpx_wake_up_src_t wu_src;
+  iis2dulpx_tap_src_t tap_src;
+  iis2dulpx_sixd_src_t sixd_src;
+  iis2dulpx_status_register_t status;
+
+  /* buff holds WAKE_UP_SRC, TAP_SRC, SIXD_SRC, ALL_INT_SRC, STATUS */
+  (void)memcpy(&wu_src, &buff[0], 1);
+  (void)memcpy(&tap_src, &buff[1], 1);
+  (void)memcpy(&sixd_src, &buff[2], 1);
+  (void)memcpy(&status, &buff[4], 1);
+
+  val->drdy = status.drdy;
+
+  val->six_d    = sixd_src.d6d_ia;
+  val->six_d_xl = sixd_src.xl;
+  val->six_d_xh = sixd_src.xh;
+  val->six_d_yl = sixd_src.yl;
+  val->six_d_yh = sixd_src.yh;
+  val->six_d_zl = sixd_src.zl;
+  val->six_d_zh = sixd_src.zh;
+
+  val->wake_up      = wu_src.wu_ia;
+  val->wake_up_z    = wu_src.z_wu;
+  val->wake_up_y    = wu_src.y_wu;
+  val->wake_up_x    = wu_src.x_wu;
+  val->free_fall    = wu_src.ff_ia;
+  val->sleep_change = wu_src.sleep_change_ia;
+  val->sleep_state  = wu_src.sleep_state;
+
+  val->single_tap = tap_src.single_tap_ia;
+  val->double_tap = tap_src.double_tap_ia;
+  val->triple_tap = tap_src.triple_tap_ia;
+}
+
+int32_t iis2dulpx_all_sources_get(const stmdev_ctx_t *ctx, iis2dulpx_all_sources_t *val)
+{
+  uint8_t buff[5];
+  int32_t ret = 0;
+
+  /* WAKE_UP_SRC .. STATUS in one transaction */
+  ret = iis2dulpx_read_reg(ctx, IIS2DULPX_WAKE_UP_SRC, buff, 5);
+
+  if (ret == 0)
+  {
+    iis2dulpx_all_sources_decode(buff, val);
+  }
+
+  return ret;
+}
+
+int32_t iis2dulpx_all_sources_data_get(const stmdev_ctx_t *ctx, iis2dulpx_src_burst_t burst,
+                                       iis2dulpx_all_sources_data_t *val)
+{
+  iis2dulpx_fifo_status1_t fifo_status1;
+  uint8_t buff[15];
+  uint16_t len;
+  uint8_t i;
+  int32_t ret = 0;
+
+  switch (burst)
+  {
+    case IIS2DULPX_SRC_ONLY:
+      len = 5U;
+      break;
+    case IIS2DULPX_SRC_FIFO:
+      len = 7U;
+      break;
+    case IIS2DULPX_SRC_FIFO_DATA:
+      len = 15U;
+      break;
+    default:
+      return -1;
+  }
+
+  /* WAKE_UP_SRC .. OUT_T_AH_QVAR_H are contiguous starting at 0x21 */
+  ret = iis2dulpx_read_reg(ctx, IIS2DULPX_WAKE_UP_SRC, buff, len);
+  if (ret != 0)
+  {
+    return ret;
+  }
+
+  iis2dulpx_all_sources_decode(buff, &val->src);
+
+  if (len >= 7U)
+  {
+    (void)memcpy(&fifo_status1, &buff[5], 1);
+    val->fifo_wtm = fifo_status1.fifo_wtm_ia;
+    val->fifo_ovr = fifo_status1.fifo_ovr_ia;
+    val->fifo_level = buff[6];
+  }
+
+  if (len == 15U)
+  {
+    /* OUT_X_L is at offset 7 */
+    for (i = 0U; i < 3U; i++)
+    {
+      val->xl_raw[i] = (int16_t)(buff[7U + (2U * i)] | (uint16_t)buff[8U + (2U * i)] << 8);
+    }
+
+    val->t_ah_qvar_raw = (int16_t)(buff[13] | (uint16_t)buff[14] << 8);
+  }
+
+  return ret;
+}
+
+/* buff holds OUT_X_L .. OUT_Z_H */
+static void iis2dulpx_xl_data_decode(const uint8_t *buff, const iis2dulpx_md_t *md,
+                                     iis2dulpx_xl_data_t *data)
+{
+  uint8_t i = 0;
+  uint8_t j = 0;
+
+  /* acceleration conversion */
+  j = 0U;
+  for (i = 0U; i < 3U; i++)
+  {
+    data->raw[i] = (int16_t)(buff[j] | (uint16_t)buff[j + 1U] << 8);
+    j += 2U;
+
+    /* raw data only */
+    if (md == NULL)
+    {
+      continue;
+    }
+
+    switch (md->fs)
+    {
+      case IIS2DULPX_2g:
+        data->mg[i] = iis2dulpx_from_fs2g_to_mg(data->raw[i]);
+        break;
+      case IIS2DULPX_4g:
+        data->mg[i] = iis2dulpx_from_fs4g_to_mg(data->raw[i]);
+        break;
+      case IIS2DULPX_8g:
+        data->mg[i] = iis2dulpx_from_fs8g_to_mg(data->raw[i]);
+        break;
+      case IIS2DULPX_16g:
+        data->mg[i] = iis2dulpx_from_fs16g_to_mg(data->raw[i]);
+        break;
+      default:
+        data->mg[i] = 0.0f;
+        break;
+    }
+  }
+}
+
+int32_t iis2dulpx_xl_data_get(const stmdev_ctx_t *ctx, const iis2dulpx_md_t *md,
+                              iis2dulpx_xl_data_t *data)
+{
+  uint8_t buff[6] = {0};
+  int32_t ret = 0;
+
+  ret = iis2dulpx_read_reg(ctx, IIS2DULPX_OUT_X_L, buff, 6);
+
+  if (ret != 0)
+  {
+    return ret;
+  }
+
+  iis2dulpx_xl_data_decode(buff, md, data);
+
+  return ret;
+}
+
+/*
+ * Fixed full scale variants of iis2dulpx_xl_data_get: the sensitivity
+ * is a constant, no switch per axis.
+ */
+#define IIS2DULPX_XL_DATA_GET_DEFINE(fs, sens)                                   \
+  int32_t iis2dulpx_xl_data_get_##fs(const stmdev_ctx_t *ctx, iis2dulpx_xl_data_t *data) \
+  {                                                                              \
+    uint8_t buff[6] = {0};                                                       \
+    int32_t ret;                                                                 \
+                                                                                 \
+    ret = iis2dulpx_read_reg(ctx, IIS2DULPX_OUT_X_L, buff, 6);                   \
+    if (ret == 0)                                                                \
+    {                                                                            \
+      data->raw[0] = (int16_t)(buff[0] | ((uint16_t)buff[1] << 8));              \
+      data->raw[1] = (int16_t)(buff[2] | ((uint16_t)buff[3] << 8));              \
+      data->raw[2] = (int16_t)(buff[4] | ((uint16_t)buff[5] << 8));              \
+      data->mg[0] = (float_t)data->raw[0] * (sens);                              \
+      data->mg[1] = (float_t)data->raw[1] * (sens);                              \
+      data->mg[2] = (float_t)data->raw[2] * (sens);                              \
+    }                                                                            \
+                                                                                 \
+    return ret;                                                                  \
+  }
+
+IIS2DULPX_XL_DATA_GET_DEFINE(fs2g, 0.061f)
+IIS2DULPX_XL_DATA_GET_DEFINE(fs4g, 0.122f)
+IIS2DULPX_XL_DATA_GET_DEFINE(fs8g, 0.244f)
+IIS2DULPX_XL_DATA_GET_DEFINE(fs16g, 0.488f)
+
+int32_t iis2dulpx_outt_data_get(const stmdev_ctx_t *ctx,
+                                iis2dulpx_outt_data_t *data)
+{
+  uint8_t buff[2] = {0};
+  int32_t ret = 0;
+
+  ret = iis2dulpx_read_reg(ctx, IIS2DULPX_OUT_T_AH_QVAR_L, buff, 2);
+
+  if (ret != 0)
+  {
+    return ret;
+  }
+
+  data->heat.raw = (int16_t)(buff[0] | ((uint16_t)buff[1U] << 8));
+  /* temperature conversion */
+  data->heat.deg_c = iis2dulpx_from_lsb_to_celsius(data->heat.raw);
+
+  return ret;
+}
+
+int32_t iis2dulpx_ah_qvar_data_get(const stmdev_ctx_t *ctx,
+                                   iis2dulpx_ah_qvar_data_t *data)
+{
+  uint8_t buff[3] = {0};
+  int32_t ret = 0;
+
+  /* Read and discard also OUT_Z_H reg to clear drdy */
+  ret = iis2dulpx_read_reg(ctx, IIS2DULPX_OUT_T_AH_QVAR_L - 1U, buff, 3);
+
+  if (ret != 0)
+  {
+    return ret;
+  }
+
+  data->raw = (int16_t)(buff[1U] | (uint16_t)buff[2U] << 8);
+
+  data->mv = iis2dulpx_from_lsb_to_mv(data->raw);
+  return ret;
+}
+
+int32_t iis2dulpx_sample_get(const stmdev_ctx_t *ctx, const iis2dulpx_md_t *md,
+                             iis2dulpx_sample_t *data)
+{
+  iis2dulpx_status_register_t status;
+  iis2dulpx_ah_qvar_cfg_t ah_qvar_cfg;
+  iis2dulpx_self_test_t self_test;
+  uint8_t buff[11];
+  int32_t ret = 0;
+
+  /* AH_QVAR_CFG, SELF_TEST */
+  if ((iis2dulpx_shadow_hit(ctx, IIS2DULPX_AH_QVAR_CFG) == PROPERTY_ENABLE) &&
+      (iis2dulpx_shadow_hit(ctx, IIS2DULPX_SELF_TEST) == PROPERTY_ENABLE))
+  {
+    ret = iis2dulpx_shadow_read(ctx, IIS2DULPX_AH_QVAR_CFG, &buff[0]);
+    ret += iis2dulpx_shadow_read(ctx, IIS2DULPX_SELF_TEST, &buff[1]);
+  }
+  else
+  {
+    ret = iis2dulpx_read_reg(ctx, IIS2DULPX_AH_QVAR_CFG, buff, 2);
+    if (ret == 0)
+    {
+      iis2dulpx_shadow_update(ctx, IIS2DULPX_AH_QVAR_CFG, buff[0]);
+      iis2dulpx_shadow_update(ctx, IIS2DULPX_SELF_TEST, buff[1]);
+    }
+  }
+
+  if (ret != 0)
+  {
+    return ret;
+  }
+
+  (void)memcpy(&ah_qvar_cfg, &buff[0], 1);
+  (void)memcpy(&self_test, &buff[1], 1);
+
+  /* STATUS, FIFO_STATUS1/2, OUT_X_L .. OUT_T_AH_QVAR_H */
+  ret = iis2dulpx_read_reg(ctx, IIS2DULPX_STATUS, buff, 11);
+  if (ret != 0)
+  {
+    return ret;
+  }
+
+  (void)memcpy(&status, &buff[0], 1);
+  data->drdy = status.drdy;
+  if (data->drdy == 0U)
+  {
+    return ret;
+  }
+
+  iis2dulpx_xl_data_decode(&buff[3], md, &data->xl);
+
+  if (self_test.t_ah_qvar_dis == 1U)
+  {
+    data->out_t = IIS2DULPX_OUT_T_NONE;
+  }
+  else if (ah_qvar_cfg.ah_qvar_en == 1U)
+  {
+    data->out_t = IIS2DULPX_OUT_T_AH_QVAR;
+    data->ah_qvar.raw = (int16_t)(buff[9] | ((uint16_t)buff[10] << 8));
+    data->ah_qvar.mv = iis2dulpx_from_lsb_to_mv(data->ah_qvar.raw);
+  }
+  else
+  {
+    data->out_t = IIS2DULPX_OUT_T_TEMP;
+    data->temp.heat.raw = (int16_t)(buff[9] | ((uint16_t)buff[10] << 8));
+    data->temp.heat.deg_c = iis2dulpx_from_lsb_to_celsius(data->temp.heat.raw);
+  }
+
+  return ret;
+}
+
+int32_t iis2dulpx_self_test_sign_set(const stmdev_ctx_t *ctx, iis2dulpx_xl_self_test_t val)
+{
+  iis2dulpx_ctrl3_t ctrl3 = {0};
+  iis2dulpx_wake_up_dur_t wkup_dur = {0};
+  iis2dulpx_txn_t txn;
+  int32_t ret = 0;
+
+  iis2dulpx_txn_init(&txn, ctx);
+  ret = iis2dulpx_txn_shadow_read(&txn, IIS2DULPX_CTRL3, (uint8_t *)&ctrl3);
+  ret += iis2dulpx_txn_shadow_read(&txn, IIS2DULPX_WAKE_UP_DUR, (uint8_t *)&wkup_dur);
+  ret += iis2dulpx_txn_run(&txn);
+  if (ret != 0)
+  {
+    return ret;
+  }
+
+  switch (val)
+  {
+    case IIS2DULPX_XL_ST_POSITIVE:
+      ctrl3.st_sign_x = 1;
+      ctrl3.st_sign_y = 1;
+      wkup_dur.st_sign_z = 0;
+      break;
+
+    case IIS2DULPX_XL_ST_NEGATIVE:
+      ctrl3.st_sign_x = 0;
+      ctrl3.st_sign_y = 0;
+      wkup_dur.st_sign_z = 1;
+      break;
+
+    case IIS2DULPX_XL_ST_DISABLE:
+    default:
+      ret = -1;
+      break;
+  }
+
+
+  ret += iis2dulpx_txn_write(&txn, IIS2DULPX_CTRL3, (uint8_t *)&ctrl3, 1);
+  ret += iis2dulpx_txn_write(&txn, IIS2DULPX_WAKE_UP_DUR, (uint8_t *)&wkup_dur, 1);
+  ret += iis2dulpx_txn_run(&txn);
+
+  return ret;
+}
+
+int32_t iis2dulpx_self_test_start(const stmdev_ctx_t *ctx, uint8_t val)
+{
+  iis2dulpx_self_test_t self_test = {0};
+  int32_t ret = 0;
+
+  if (val != 1U && val != 2U)
+  {
+    return -1;
+  }
+
+  ret = iis2dulpx_shadow_read(ctx, IIS2DULPX_SELF_TEST, (uint8_t *)&self_test);
+  if (ret == 0)
+  {
+    self_test.st = (uint8_t) val & 0x03U;
+    ret = iis2dulpx_shadow_write(ctx, IIS2DULPX_SELF_TEST, (uint8_t *)&self_test);
+  }
+  return ret;
+}
+
+int32_t iis2dulpx_self_test_stop(const stmdev_ctx_t *ctx)
+{
+  iis2dulpx_self_test_t self_test = {0};
+  int32_t ret = 0;
+
+  ret = iis2dulpx_shadow_read(ctx, IIS2DULPX_SELF_TEST, (uint8_t *)&self_test);
+  if (ret == 0)
+  {
+    self_test.st = 0;
+    ret = iis2dulpx_shadow_write(ctx, IIS2DULPX_SELF_TEST, (uint8_t *)&self_test);
+  }
+  return ret;
+}
+
+int32_t iis2dulpx_i3c_configure_set(const stmdev_ctx_t *ctx, const iis2dulpx_i3c_cfg_t *val)
+{
+  iis2dulpx_i3c_if_ctrl_t i3c_cfg = {0};
+  int32_t ret = 0;
+
+  ret = iis2dulpx_shadow_read(ctx, IIS2DULPX_I3C_IF_CTRL, (uint8_t *)&i3c_cfg);
+
+  if (ret == 0)
+  {
+    i3c_cfg.bus_act_sel = (uint8_t)val->bus_act_sel & 0x03U;
+    i3c_cfg.dis_drstdaa = val->drstdaa_en;
+    i3c_cfg.asf_on = val->asf_on;
+    ret = iis2dulpx_shadow_write(ctx, IIS2DULPX_I3C_IF_CTRL, (uint8_t *)&i3c_cfg);
+  }
+
+  return ret;
+}
+
+int32_t iis2dulpx_i3c_configure_get(const stmdev_ctx_t *ctx, iis2dulpx_i3c_cfg_t *val)
+{
+  iis2dulpx_i3c_if_ctrl_t i3c_cfg = {0};
+  int32_t ret = 0;
+
+  ret = iis2dulpx_read_reg(ctx, IIS2DULPX_I3C_IF_CTRL, (uint8_t *)&i3c_cfg, 1);
+
+  if (ret != 0)
+  {
+    return ret;
+  }
+
+  val->drstdaa_en = i3c_cfg.dis_drstdaa;
+  val->asf_on = i3c_cfg.asf_on;
+
+  switch (i3c_cfg.bus_act_sel)
+  {
+    case 0x00:
+      val->bus_act_sel = IIS2DULPX_I3C_BUS_AVAIL_TIME_20US;
+      break;
+
+    case 0x01:
+      val->bus_act_sel = IIS2DULPX_I3C_BUS_AVAIL_TIME_50US;
+      break;
+
+    case 0x02:
+      val->bus_act_sel = IIS2DULPX_I3C_BUS_AVAIL_TIME_1MS;
+      break;
+
+    case 0x03:
+    default:
+      val->bus_act_sel = IIS2DULPX_I3C_BUS_AVAIL_TIME_25MS;
+      break;
+  }
+
+  return ret;
+}
+
+int32_t iis2dulpx_mem_bank_set(const stmdev_ctx_t *ctx, iis2dulpx_mem_bank_t val)
+{
+  iis2dulpx_func_cfg_access_t func_cfg_access = {0};
+  iis2dulpx_priv_t *priv;
+  uint8_t unlock = 1U;
+  int32_t ret = 0;
+
+  if (ctx->priv_data == NULL)
+  {
+    return -1;
+  }
+
+  priv = (iis2dulpx_priv_t *)ctx->priv_data;
+  iis2dulpx_lock(ctx);
+
+  /* bank held by iis2dulpx_emb_session_begin() */
+  if (priv->emb_session > 0U)
+  {
+    goto exit;
+  }
+
+  /* init from saved register */
+  func_cfg_access = priv->func_cfg_access_main;
+
+  /* requested bank already selected */
+  if (func_cfg_access.emb_func_reg_access == ((uint8_t)val & 0x1U))
+  {
+    goto exit;
+  }
+
+  if (func_cfg_access.emb_func_reg_access == 0U)
+  {
+    /* MAIN page */
+    ret = iis2dulpx_read_reg(ctx, IIS2DULPX_FUNC_CFG_ACCESS, (uint8_t *)&func_cfg_access, 1);
+  }
+
+  if (ret == 0)
+  {
+    func_cfg_access.emb_func_reg_access = ((uint8_t)val & 0x1U);
+
+    if (func_cfg_access.emb_func_reg_access == 1U)
+    {
+      /* lock-free reads off before the switch, lock held until back to main */
+      priv->bank_seq++;
+      ret = iis2dulpx_write_reg(ctx, IIS2DULPX_FUNC_CFG_ACCESS, (uint8_t *)&func_cfg_access, 1);
+      if (ret == 0)
+      {
+        /* save register in private data */
+        priv->func_cfg_access_main = func_cfg_access;
+        unlock = 0U;
+      }
+      else
+      {
+        priv->bank_seq++;
+      }
+    }
+    else
+    {
+      ret = iis2dulpx_write_reg(ctx, IIS2DULPX_FUNC_CFG_ACCESS, (uint8_t *)&func_cfg_access, 1);
+      if (ret == 0)
+      {
+        /* save register in private data */
+        priv->func_cfg_access_main = func_cfg_access;
+        priv->bank_seq++;
+        unlock = 2U;
+      }
+    }
+  }
+
+exit:
+  while (unlock > 0U)
+  {
+    iis2dulpx_unlock(ctx);
+    unlock--;
+  }
+
+  return ret;
+}
+
+int32_t iis2dulpx_mem_bank_get(const stmdev_ctx_t *ctx, iis2dulpx_mem_bank_t *val)
+{
+  iis2dulpx_func_cfg_access_t func_cfg_access = {0};
+  int32_t ret = 0;
+
+  if (ctx->priv_data == NULL)
+  {
+    ret = -1;
+    goto exit;
+  }
+
+  /* init from saved register */
+  func_cfg_access = ((iis2dulpx_priv_t *)ctx->priv_data)->func_cfg_access_main;
+
+  if (func_cfg_access.emb_func_reg_access == 0U)
+  {
+    /* MAIN page */
+    ret = iis2dulpx_read_reg(ctx, IIS2DULPX_FUNC_CFG_ACCESS, (uint8_t *)&func_cfg_access, 1);
+    if (ret != 0)
+    {
+      goto exit;
+    }
+
+    /* save register in private data */
+    ((iis2dulpx_priv_t *)ctx->priv_data)->func_cfg_access_main = func_cfg_access;
+  }
+
+  switch ((func_cfg_access.emb_func_reg_access))
+  {
+    case 0x0:
+      *val = IIS2DULPX_MAIN_MEM_BANK;
+      break;
+
+    case 0x1:
+      *val = IIS2DULPX_EMBED_FUNC_MEM_BANK;
+      break;
+
+    default:
+      *val = IIS2DULPX_MAIN_MEM_BANK;
+      break;
+  }
+
+exit:
+  return ret;
+}
+
+int32_t iis2dulpx_emb_session_begin(const stmdev_ctx_t *ctx)
+{
+  iis2dulpx_priv_t *priv;
+  int32_t ret = 0;
+
+  if (ctx->priv_data == NULL)
+  {
+    return -1;
+  }
+
+  priv = (iis2dulpx_priv_t *)ctx->priv_data;
+  if (priv->emb_session == 0xFFU)
+  {
+    return -1;
+  }
+
+  if (priv->emb_session == 0U)
+  {
+    ret = iis2dulpx_mem_bank_set(ctx, IIS2DULPX_EMBED_FUNC_MEM_BANK);
+  }
+
+  if (ret == 0)
+  {
+    priv->emb_session++;
+  }
+
+  return ret;
+}
+
+int32_t iis2dulpx_emb_session_end(const stmdev_ctx_t *ctx)
+{
+  iis2dulpx_priv_t *priv;
+  int32_t ret = 0;
+
+  if (ctx->priv_data == NULL)
+  {
+    return -1;
+  }
+
+  priv = (iis2dulpx_priv_t *)ctx->priv_data;
+  if (priv->emb_session == 0U)
+  {
+    return -1;
+  }
+
+  priv->emb_session--;
+  if (priv->emb_session == 0U)
+  {
+    ret = iis2dulpx_mem_bank_set(ctx, IIS2DULPX_MAIN_MEM_BANK);
+  }
+
+  return ret;
+}
+
+int32_t iis2dulpx_fsm_wr_ctrl_en_set(const stmdev_ctx_t *ctx, uint8_t val)
+{
+  iis2dulpx_func_cfg_access_t func_cfg_access = {0};
+  int32_t ret = 0;
+
+  if (ctx->priv_data == NULL)
+  {
+    ret = -1;
+    goto exit;
+  }
+
+  /* init from saved register */
+  func_cfg_access = ((iis2dulpx_priv_t *)ctx->priv_data)->func_cfg_access_main;
+
+  if (func_cfg_access.emb_func_reg_access == 0U)
+  {
+    /* MAIN page */
+    ret = iis2dulpx_read_reg(ctx, IIS2DULPX_FUNC_CFG_ACCESS, (uint8_t *)&func_cfg_access, 1);
+  }
+
+  if (ret == 0)
+  {
+    func_cfg_access.fsm_wr_ctrl_en = ((uint8_t)val & 0x1U);
+    ret = iis2dulpx_write_reg(ctx, IIS2DULPX_FUNC_CFG_ACCESS, (uint8_t *)&func_cfg_access, 1);
+
+    if (ret == 0)
+    {
+      /* save register in private data */
+      ((iis2dulpx_priv_t *)ctx->priv_data)->func_cfg_access_main = func_cfg_access;
+    }
+  }
+
+exit:
+  return ret;
+}
+
+int32_t iis2dulpx_fsm_wr_ctrl_en_get(const stmdev_ctx_t *ctx, uint8_t *val)
+{
+  iis2dulpx_func_cfg_access_t func_cfg_access = {0};
+  int32_t ret = 0;
+
+  if (ctx->priv_data == NULL)
+  {
+    ret = -1;
+    goto exit;
+  }
+
+  /* init from saved register */
+  func_cfg_access = ((iis2dulpx_priv_t *)ctx->priv_data)->func_cfg_access_main;
+
+  if (func_cfg_access.emb_func_reg_access == 0U)
+  {
+    /* MAIN page */
+    ret = iis2dulpx_read_reg(ctx, IIS2DULPX_FUNC_CFG_ACCESS, (uint8_t *)&func_cfg_access, 1);
+    if (ret != 0)
+    {
+      goto exit;
+    }
+
+    /* save register in private data */
+    ((iis2dulpx_priv_t *)ctx->priv_data)->func_cfg_access_main = func_cfg_access;
+  }
+
+  *val = func_cfg_access.fsm_wr_ctrl_en;
+
+exit:
+  return ret;
+}
+
+/*
+ * PAGE_RW access with the value kept in the shadow when enabled.
+ * Must be called with the embedded functions bank selected.
+ */
+static int32_t iis2dulpx_page_rw_set(const stmdev_ctx_t *ctx, uint8_t page_read,
+                                     uint8_t page_write)
+{
+  iis2dulpx_shadow_t *shadow = iis2dulpx_shadow_of(ctx, IIS2DULPX_SHADOW_FIRST);
+  iis2dulpx_page_rw_t page_rw = {0};
+  int32_t ret = 0;
+
+  if ((shadow != NULL) && (shadow->page_rw_valid == PROPERTY_ENABLE))
+  {
+    (void)memcpy(&page_rw, &shadow->page_rw, 1);
+  }
+  else
+  {
+    ret = iis2dulpx_read_reg(ctx, IIS2DULPX_PAGE_RW, (uint8_t *)&page_rw, 1);
+    if (ret != 0)
+    {
+      return ret;
+    }
+  }
+
+  page_rw.page_read = page_read & 0x1U;
+  page_rw.page_write = page_write & 0x1U;
+  ret = iis2dulpx_write_reg(ctx, IIS2DULPX_PAGE_RW, (uint8_t *)&page_rw, 1);
+
+  if (shadow != NULL)
+  {
+    (void)memcpy(&shadow->page_rw, &page_rw, 1);
+    shadow->page_rw_valid = (ret == 0) ? PROPERTY_ENABLE : PROPERTY_DISABLE;
+  }
+
+  return ret;
+}
+
+/*
+ * PAGE_SEL holds only the page number, the lower nibble must be
+ * written at its default value: no need to read it back.
+ */
+static int32_t iis2dulpx_page_sel_set(const stmdev_ctx_t *ctx, uint8_t page)
+{
+  iis2dulpx_page_sel_t page_sel = {0};
+
+  page_sel.page_sel = page & 0x0FU;
+  page_sel.not_used0 = 1U; // Default value
+
+  return iis2dulpx_write_reg(ctx, IIS2DULPX_PAGE_SEL, (uint8_t *)&page_sel, 1);
+}
+
+static int32_t iis2dulpx_ln_pg_close(const stmdev_ctx_t *ctx)
+{
+  int32_t ret = 0;
+
+  ret += iis2dulpx_page_sel_set(ctx, 0U);
+  ret += iis2dulpx_page_rw_set(ctx, PROPERTY_DISABLE, PROPERTY_DISABLE);
+  ret += iis2dulpx_mem_bank_set(ctx, IIS2DULPX_MAIN_MEM_BANK);
+
+  return ret;
+}
+
+int32_t iis2dulpx_ln_pg_write(const stmdev_ctx_t *ctx, uint16_t address, uint8_t *buf, uint8_t len)
+{
+  return iis2dulpx_ln_pg_write_burst(ctx, address, buf, len);
+}
+
+int32_t iis2dulpx_ln_pg_write_burst(const stmdev_ctx_t *ctx, uint16_t address, uint8_t *buf,
+                                    uint16_t len)
+{
+  iis2dulpx_page_address_t page_address = {0};
+  iis2dulpx_ctrl1_t ctrl1 = {0};
+  uint8_t if_add_inc = PROPERTY_DISABLE;
+  uint8_t stream = PROPERTY_DISABLE;
+  uint16_t idx = 0;
+  uint16_t run = 0;
+  uint16_t i = 0;
+  uint8_t msb = 0;
+  uint8_t lsb = 0;
+  int32_t ret = 0;
+
+  msb = ((uint8_t)(address >> 8) & 0x0FU);
+  lsb = (uint8_t)address & 0xFFU;
+
+  /*
+   * Streaming keeps the bus address on PAGE_VALUE while the page address
+   * auto-increments: register address increment must be off. Toggling
+   * CTRL1 costs up to three transactions, so short buffers are written
+   * one byte at a time. CTRL1 is not reachable inside an embedded
+   * session: fall back to single byte writes there too. The lock is
+   * held until CTRL1 is restored, so that no other thread bursts with
+   * increment off.
+   */
+  iis2dulpx_lock(ctx);
+
+  if ((len > 3U) && (ctx->priv_data != NULL) &&
+      (((iis2dulpx_priv_t *)ctx->priv_data)->emb_session == 0U))
+  {
+    ret = iis2dulpx_shadow_read(ctx, IIS2DULPX_CTRL1, (uint8_t *)&ctrl1);
+    if (ret != 0)
+    {
+      iis2dulpx_unlock(ctx);
+      return ret;
+    }
+
+    if_add_inc = ctrl1.if_add_inc;
+    if (if_add_inc == PROPERTY_ENABLE)
+    {
+      ctrl1.if_add_inc = PROPERTY_DISABLE;
+      ret = iis2dulpx_shadow_write(ctx, IIS2DULPX_CTRL1, (uint8_t *)&ctrl1);
+      if (ret != 0)
+      {
+        iis2dulpx_unlock(ctx);
+        return ret;
+      }
+    }
+    stream = PROPERTY_ENABLE;
+  }
+
+  ret = iis2dulpx_mem_bank_set(ctx, IIS2DULPX_EMBED_FUNC_MEM_BANK);
+  if (ret != 0)
+  {
+    goto exit;
+  }
+
+  /* page write */
+  ret = iis2dulpx_page_rw_set(ctx, PROPERTY_DISABLE, PROPERTY_ENABLE);
+
+  /* set page num */
+  ret += iis2dulpx_page_sel_set(ctx, msb);
+
+  /* set page addr */
+  page_address.page_addr = lsb;
+  ret += iis2dulpx_write_reg(ctx, IIS2DULPX_PAGE_ADDRESS, (uint8_t *)&page_address, 1);
+
+  while ((ret == 0) && (idx < len))
+  {
+    /* bytes left up to the page boundary */
+    run = 256U - (uint16_t)lsb;
+    if (run > (len - idx))
+    {
+      run = len - idx;
+    }
+
+    if (stream == PROPERTY_ENABLE)
+    {
+      ret = iis2dulpx_write_reg(ctx, IIS2DULPX_PAGE_VALUE, &buf[idx], run);
+    }
+    else
+    {
+      for (i = 0U; (i < run) && (ret == 0); i++)
+      {
+        ret = iis2dulpx_write_reg(ctx, IIS2DULPX_PAGE_VALUE, &buf[idx + i], 1);
+      }
+    }
+
+    idx += run;
+    lsb = (uint8_t)(lsb + run);
+
+    /* Check if page wrap */
+    if ((ret == 0) && (lsb == 0x00U) && (idx < len))
+    {
+      msb++;
+      ret = iis2dulpx_page_sel_set(ctx, msb);
+    }
+  }
+
+exit:
+  ret += iis2dulpx_ln_pg_close(ctx);
+
+  if (if_add_inc == PROPERTY_ENABLE)
+  {
+    ctrl1.if_add_inc = PROPERTY_ENABLE;
+    ret += iis2dulpx_shadow_write(ctx, IIS2DULPX_CTRL1, (uint8_t *)&ctrl1);
+  }
+
+  iis2dulpx_unlock(ctx);
+
+  return ret;
+}
+
+int32_t iis2dulpx_ln_pg_read(const stmdev_ctx_t *ctx, uint16_t address, uint8_t *buf, uint8_t len)
+{
+  iis2dulpx_page_address_t page_address = {0};
+  uint8_t msb = 0;
+  uint8_t lsb = 0;
+  int32_t ret = 0;
+  uint8_t i = 0;
+
+  msb = ((uint8_t)(address >> 8) & 0x0FU);
+  lsb = (uint8_t)address & 0xFFU;
+
+  ret = iis2dulpx_mem_bank_set(ctx, IIS2DULPX_EMBED_FUNC_MEM_BANK);
+  if (ret != 0)
+  {
+    goto exit;
+  }
+
+  /* page read */
+  ret = iis2dulpx_page_rw_set(ctx, PROPERTY_ENABLE, PROPERTY_DISABLE);
+  if (ret != 0)
+  {
+    goto exit;
+  }
+
+  /* set page num */
+  ret = iis2dulpx_page_sel_set(ctx, msb);
+  if (ret != 0)
+  {
+    goto exit;
+  }
+
+  for (i = 0; i < len; i++)
+  {
+    /* Sequential readings are not allowed. Set page address every loop */
+    page_address.page_addr = lsb++;
+    ret = iis2dulpx_write_reg(ctx, IIS2DULPX_PAGE_ADDRESS, (uint8_t *)&page_address, 1);
+
+    /* read value */
+    ret += iis2dulpx_read_reg(ctx, IIS2DULPX_PAGE_VALUE, &buf[i], 1);
+
+    /* Check if page wrap */
+    if (((lsb & 0xFFU) == 0x00U) && (ret == 0))
+    {
+      msb++;
+      lsb = 0;
+
+      /* set page */
+      ret = iis2dulpx_page_sel_set(ctx, msb);
+    }
+
+    if (ret != 0)
+    {
+      goto exit;
+    }
+  }
+
+exit:
+  ret += iis2dulpx_ln_pg_close(ctx);
+
+  return ret;
+}
+
+/*
+ * Number of lines, starting at ucf[idx], that can be sent in a single
+ * transfer: ascending addresses when register address auto-increment is
+ * on, repeated address when it is off. Bank switches and main page CTRL1
+ * writes (if_add_inc may change) are always sent alone.
+ */
+static uint16_t iis2dulpx_ucf_run(const ucf_line_t *ucf, uint16_t idx, uint16_t len,
+                                  uint8_t inc, uint8_t emb)
+{
+  uint16_t run = 1U;
+  uint8_t next;
+
+  if ((ucf[idx].address == IIS2DULPX_FUNC_CFG_ACCESS) ||
+      ((emb == 0U) && (ucf[idx].address == IIS2DULPX_CTRL1)))
+  {
+    return run;
+  }
+
+  while (((idx + run) < len) && (run < IIS2DULPX_UCF_BURST_LEN))
+  {
+    next = ucf[idx + run].address;
+
+    if ((next == IIS2DULPX_FUNC_CFG_ACCESS) || ((emb == 0U) && (next == IIS2DULPX_CTRL1)))
+    {
+      break;
+    }
+
+    if (inc == PROPERTY_ENABLE)
+    {
+      if ((uint16_t)next != ((uint16_t)ucf[idx].address + run))
+      {
+        break;
+      }
+    }
+    else if (next != ucf[idx].address)
+    {
+      break;
+    }
+    else
+    {
+      /* same address, keep streaming */
+    }
+
+    run++;
+  }
+
+  return run;
+}
+
+int32_t iis2dulpx_ucf_load(const stmdev_ctx_t *ctx, const ucf_line_t *ucf, uint16_t len,
+                           uint32_t *txn)
+{
+  iis2dulpx_func_cfg_access_t func_cfg_access = {0};
+  iis2dulpx_func_cfg_access_t func_cfg_main = {0};
+  iis2dulpx_shadow_t *shadow = NULL;
+  iis2dulpx_ctrl1_t ctrl1 = {0};
+  uint8_t buff[IIS2DULPX_UCF_BURST_LEN];
+  uint8_t final_inc = PROPERTY_ENABLE;
+  uint8_t inc = PROPERTY_ENABLE;
+  uint16_t same = 0;
+  uint16_t asc = 0;
+  uint16_t run = 0;
+  uint16_t idx = 0;
+  uint16_t i = 0;
+  uint32_t cnt = 0;
+  uint8_t bank = 0;
+  int32_t ret = 0;
+
+  if (ctx->priv_data == NULL)
+  {
+    return -1;
+  }
+
+  iis2dulpx_lock(ctx);
+
+  if (((iis2dulpx_priv_t *)ctx->priv_data)->emb_session > 0U)
+  {
+    iis2dulpx_unlock(ctx);
+    return -1;
+  }
+
+  /* bank state as tracked by iis2dulpx_mem_bank_set() */
+  func_cfg_access = ((iis2dulpx_priv_t *)ctx->priv_data)->func_cfg_access_main;
+  bank = func_cfg_access.emb_func_reg_access;
+  if (bank == 0U)
+  {
+    /* no lock-free reads while loading */
+    ((iis2dulpx_priv_t *)ctx->priv_data)->bank_seq++;
+  }
+
+  if (func_cfg_access.emb_func_reg_access == 0U)
+  {
+    ret = iis2dulpx_read_reg(ctx, IIS2DULPX_FUNC_CFG_ACCESS, (uint8_t *)&func_cfg_access, 1);
+    cnt++;
+  }
+  else
+  {
+    /* CTRL1 is on main page */
+    func_cfg_access.emb_func_reg_access = 0U;
+    ret = iis2dulpx_write_reg(ctx, IIS2DULPX_FUNC_CFG_ACCESS, (uint8_t *)&func_cfg_access, 1);
+    cnt++;
+  }
+
+  if (ret != 0)
+  {
+    goto exit;
+  }
+
+  if (iis2dulpx_shadow_hit(ctx, IIS2DULPX_CTRL1) == PROPERTY_DISABLE)
+  {
+    cnt++;
+  }
+  ret = iis2dulpx_shadow_read(ctx, IIS2DULPX_CTRL1, (uint8_t *)&ctrl1);
+  if (ret != 0)
+  {
+    goto exit;
+  }
+  final_inc = ctrl1.if_add_inc;
+
+  /*
+   * PAGE_VALUE programs are streamed to the same address and need
+   * if_add_inc off, plain register blocks need it on: pick the mode
+   * which saves more transfers for this program.
+   */
+  for (i = 1U; i < len; i++)
+  {
+    if (ucf[i].address == ucf[i - 1U].address)
+    {
+      same++;
+    }
+    else if ((uint16_t)ucf[i].address == ((uint16_t)ucf[i - 1U].address + 1U))
+    {
+      asc++;
+    }
+    else
+    {
+      /* not coalesced */
+    }
+  }
+
+  inc = (uint8_t)((same > (asc + 2U)) ? PROPERTY_DISABLE : PROPERTY_ENABLE);
+  if (ctrl1.if_add_inc != inc)
+  {
+    ctrl1.if_add_inc = inc & 0x1U;
+    ret = iis2dulpx_shadow_write(ctx, IIS2DULPX_CTRL1, (uint8_t *)&ctrl1);
+    cnt++;
+  }
+
+  shadow = iis2dulpx_shadow_of(ctx, IIS2DULPX_SHADOW_FIRST);
+
+  while ((ret == 0) && (idx < len))
+  {
+    if (ucf[idx].address == IIS2DULPX_FUNC_CFG_ACCESS)
+    {
+      /* drop redundant bank switches */
+      if (memcmp(&ucf[idx].data, &func_cfg_access, 1) != 0)
+      {
+        buff[0] = ucf[idx].data;
+        ret = iis2dulpx_write_reg(ctx, IIS2DULPX_FUNC_CFG_ACCESS, buff, 1);
+        cnt++;
+        (void)memcpy(&func_cfg_access, &buff[0], 1);
+      }
+      idx++;
+      continue;
+    }
+
+    run = iis2dulpx_ucf_run(ucf, idx, len, inc, func_cfg_access.emb_func_reg_access);
+    for (i = 0U; i < run; i++)
+    {
+      buff[i] = ucf[idx + i].data;
+    }
+
+    if ((func_cfg_access.emb_func_reg_access == 0U) && (ucf[idx].address == IIS2DULPX_CTRL1))
+    {
+      /* apply if_add_inc requested by the program only at the end */
+      (void)memcpy(&ctrl1, &buff[0], 1);
+      final_inc = ctrl1.if_add_inc;
+      ctrl1.if_add_inc = inc & 0x1U;
+      ret = iis2dulpx_shadow_write(ctx, IIS2DULPX_CTRL1, (uint8_t *)&ctrl1);
+    }
+    else
+    {
+      ret = iis2dulpx_write_reg(ctx, ucf[idx].address, buff, run);
+    }
+    cnt++;
+
+    /* keep the shadow in line with what has been written */
+    if ((ret == 0) && (shadow != NULL))
+    {
+      if (func_cfg_access.emb_func_reg_access == 0U)
+      {
+        for (i = 0U; i < run; i++)
+        {
+          uint8_t reg = (inc == PROPERTY_ENABLE) ? (ucf[idx].address + (uint8_t)i) : ucf[idx].address;
+
+          if ((reg >= IIS2DULPX_SHADOW_FIRST) && (reg <= IIS2DULPX_SHADOW_LAST) &&
+              (reg != IIS2DULPX_CTRL1))
+          {
+            iis2dulpx_shadow_store(shadow, reg, buff[i]);
+          }
+        }
+      }
+      else if (ucf[idx].address <= IIS2DULPX_PAGE_RW)
+      {
+        /* PAGE_RW may be in the run */
+        shadow->page_rw_valid = PROPERTY_DISABLE;
+      }
+      else
+      {
+        /* embedded register not cached */
+      }
+    }
+
+    idx += run;
+  }
+
+  if (final_inc != inc)
+  {
+    func_cfg_main = func_cfg_access;
+    func_cfg_main.emb_func_reg_access = 0U;
+
+    if (func_cfg_access.emb_func_reg_access == 1U)
+    {
+      ret += iis2dulpx_write_reg(ctx, IIS2DULPX_FUNC_CFG_ACCESS, (uint8_t *)&func_cfg_main, 1);
+      cnt++;
+    }
+
+    ctrl1.if_add_inc = final_inc & 0x1U;
+    ret += iis2dulpx_shadow_write(ctx, IIS2DULPX_CTRL1, (uint8_t *)&ctrl1);
+    cnt++;
+
+    if (func_cfg_access.emb_func_reg_access == 1U)
+    {
+      ret += iis2dulpx_write_reg(ctx, IIS2DULPX_FUNC_CFG_ACCESS, (uint8_t *)&func_cfg_access, 1);
+      cnt++;
+    }
+  }
+
+exit:
+  ((iis2dulpx_priv_t *)ctx->priv_data)->func_cfg_access_main = func_cfg_access;
+
+  /* left on embedded bank: lock held as by iis2dulpx_mem_bank_set() */
+  if (func_cfg_access.emb_func_reg_access == 0U)
+  {
+    ((iis2dulpx_priv_t *)ctx->priv_data)->bank_seq++;
+    iis2dulpx_unlock(ctx);
+  }
+  if (bank == 1U)
+  {
+    iis2dulpx_unlock(ctx);
+  }
+
+  if (txn != NULL)
+  {
+    *txn = cnt;
+  }
+
+  return ret;
+}
+
+int32_t iis2dulpx_ext_clk_en_set(const stmdev_ctx_t *ctx, uint8_t val)
+{
+  iis2dulpx_ext_clk_cfg_t clk = {0};
+  int32_t ret = 0;
+
+  ret = iis2dulpx_shadow_read(ctx, IIS2DULPX_EXT_CLK_CFG, (uint8_t *)&clk);
+  if (ret == 0)
+  {
+    clk.ext_clk_en = val & 0x01U;
+    ret += iis2dulpx_shadow_write(ctx, IIS2DULPX_EXT_CLK_CFG, (uint8_t *)&clk);
+  }
+
+  return ret;
+}
+
+
+int32_t iis2dulpx_ext_clk_en_get(const stmdev_ctx_t *ctx, uint8_t *val)
+{
+  iis2dulpx_ext_clk_cfg_t clk = {0};
+  int32_t ret = 0;
+
+  ret = iis2dulpx_read_reg(ctx, IIS2DULPX_EXT_CLK_CFG, (uint8_t *)&clk, 1);
+  if (ret == 0)
+  {
+    *val = clk.ext_clk_en;
+  }
+
+  return ret;
+}
+
+int32_t iis2dulpx_pin_conf_set(const stmdev_ctx_t *ctx, const iis2dulpx_pin_conf_t *val)
+{
+  iis2dulpx_pin_ctrl_t pin_ctrl = {0};
+  int32_t ret = 0;
+
+  ret = iis2dulpx_shadow_read(ctx, IIS2DULPX_PIN_CTRL, (uint8_t *)&pin_ctrl);
+
+  if (ret == 0)
+  {
+    pin_ctrl.cs_pu_dis = ~val->cs_pull_up;
+    pin_ctrl.pd_dis_int1 = ~val->int1_pull_down;
+    pin_ctrl.pd_dis_int2 = ~val->int2_pull_down;
+    pin_ctrl.sda_pu_en = val->sda_pull_up;
+    pin_ctrl.sdo_pu_en = val->sdo_pull_up;
+    pin_ctrl.pp_od = ~val->int1_int2_push_pull;
+
+    ret = iis2dulpx_shadow_write(ctx, IIS2DULPX_PIN_CTRL, (uint8_t *)&pin_ctrl);
+  }
+
+  return ret;
+}
+
+int32_t iis2dulpx_pin_conf_get(const stmdev_ctx_t *ctx, iis2dulpx_pin_conf_t *val)
+{
+  iis2dulpx_pin_ctrl_t pin_ctrl = {0};
+  int32_t ret = 0;
+
+  ret = iis2dulpx_read_reg(ctx, IIS2DULPX_PIN_CTRL, (uint8_t *)&pin_ctrl, 1);
+
+  if (ret == 0)
+  {
+    val->cs_pull_up = ~pin_ctrl.cs_pu_dis;
+    val->int1_pull_down = ~pin_ctrl.pd_dis_int1;
+    val->int2_pull_down = ~pin_ctrl.pd_dis_int2;
+    val->sda_pull_up = pin_ctrl.sda_pu_en;
+    val->sdo_pull_up = pin_ctrl.sdo_pu_en;
+    val->int1_int2_push_pull = ~pin_ctrl.pp_od;
+  }
+
+  return ret;
+}
+
+int32_t iis2dulpx_int_pin_polarity_set(const stmdev_ctx_t *ctx, iis2dulpx_int_pin_polarity_t val)
+{
+  iis2dulpx_pin_ctrl_t pin_ctrl = {0};
+  int32_t ret = 0;
+
+  ret = iis2dulpx_shadow_read(ctx, IIS2DULPX_PIN_CTRL, (uint8_t *)&pin_ctrl);
+
+  if (ret == 0)
+  {
+    pin_ctrl.h_lactive = (uint8_t)val & 0x01U;
+    ret = iis2dulpx_shadow_write(ctx, IIS2DULPX_PIN_CTRL, (uint8_t *)&pin_ctrl);
+  }
+
+  return ret;
+}
+
+int32_t iis2dulpx_int_pin_polarity_get(const stmdev_ctx_t *ctx, iis2dulpx_int_pin_polarity_t *val)
+{
+  iis2dulpx_pin_ctrl_t pin_ctrl = {0};
+  int32_t ret = 0;
+
+  ret = iis2dulpx_read_reg(ctx, IIS2DULPX_PIN_CTRL, (uint8_t *)&pin_ctrl, 1);
+
+  if (ret != 0)
+  {
+    return ret;
+  }
+
+  switch ((pin_ctrl.h_lactive))
+  {
+    case 0x0:
+      *val = IIS2DULPX_ACTIVE_HIGH;
+      break;
+
+    case 0x1:
+      *val = IIS2DULPX_ACTIVE_LOW;
+      break;
+
+    default:
+      *val = IIS2DULPX_ACTIVE_HIGH;
+      break;
+  }
+  return ret;
+}
+
+int32_t iis2dulpx_spi_mode_set(const stmdev_ctx_t *ctx, iis2dulpx_spi_mode val)
+{
+  iis2dulpx_pin_ctrl_t pin_ctrl = {0};
+  int32_t ret = 0;
+
+  ret = iis2dulpx_shadow_read(ctx, IIS2DULPX_PIN_CTRL, (uint8_t *)&pin_ctrl);
+
+  if (ret == 0)
+  {
+    pin_ctrl.sim = (uint8_t)val & 0x01U;
+    ret = iis2dulpx_shadow_write(ctx, IIS2DULPX_PIN_CTRL, (uint8_t *)&pin_ctrl);
+  }
+
+  return ret;
+}
+
+int32_t iis2dulpx_spi_mode_get(const stmdev_ctx_t *ctx, iis2dulpx_spi_mode *val)
+{
+  iis2dulpx_pin_ctrl_t pin_ctrl = {0};
+  int32_t ret = 0;
+
+  ret = iis2dulpx_read_reg(ctx, IIS2DULPX_PIN_CTRL, (uint8_t *)&pin_ctrl, 1);
+  if (ret != 0)
+  {
+    return ret;
+  }
+
+  switch ((pin_ctrl.sim))
+  {
+    case 0x0:
+      *val = IIS2DULPX_SPI_4_WIRE;
+      break;
+
+    case 0x1:
+      *val = IIS2DULPX_SPI_3_WIRE;
+      break;
+
+    default:
+      *val = IIS2DULPX_SPI_4_WIRE;
+      break;
+  }
+  return ret;
+}
+
+int32_t iis2dulpx_pin_int1_route_set(const stmdev_ctx_t *ctx, const iis2dulpx_pin_int_route_t *val)
+{
+  iis2dulpx_ctrl1_t ctrl1 = {0};
+  iis2dulpx_ctrl2_t ctrl2 = {0};
+  iis2dulpx_md1_cfg_t md1_cfg = {0};
+  int32_t ret = 0;
+
+  ret = iis2dulpx_shadow_read(ctx, IIS2DULPX_CTRL1, (uint8_t *)&ctrl1);
+
+  if (ret == 0)
+  {
+    ctrl1.int1_on_res = val->int_on_res;
+
+    ret = iis2dulpx_shadow_write(ctx, IIS2DULPX_CTRL1, (uint8_t *)&ctrl1);
+  }
+
+  if (ret == 0)
+  {
+    ret = iis2dulpx_shadow_read(ctx, IIS2DULPX_CTRL2, (uint8_t *)&ctrl2);
+
+    if (ret == 0)
+    {
+      ctrl2.int1_drdy = val->drdy;
+      ctrl2.int1_fifo_ovr = val->fifo_ovr;
+      ctrl2.int1_fifo_th = val->fifo_th;
+      ctrl2.int1_fifo_full = val->fifo_full;
+      ctrl2.int1_boot = val->boot;
+
+      ret = iis2dulpx_shadow_write(ctx, IIS2DULPX_CTRL2, (uint8_t *)&ctrl2);
+    }
+  }
+
+  if (ret == 0)
+  {
+    ret = iis2dulpx_shadow_read(ctx, IIS2DULPX_MD1_CFG, (uint8_t *)&md1_cfg);
+
+    if (ret == 0)
+    {
+      md1_cfg.int1_ff = val->free_fall;
+      md1_cfg.int1_6d = val->six_d;
+      md1_cfg.int1_tap = val->tap;
+      md1_cfg.int1_wu = val->wake_up;
+      md1_cfg.int1_sleep_change = val->sleep_change;
+      md1_cfg.int1_emb_func = val->emb_function;
+      md1_cfg.int1_timestamp = val->timestamp;
+
+      ret = iis2dulpx_shadow_write(ctx, IIS2DULPX_MD1_CFG, (uint8_t *)&md1_cfg);
+    }
+  }
+
+  return ret;
+}
+
+int32_t iis2dulpx_pin_int1_route_get(const stmdev_ctx_t *ctx, iis2dulpx_pin_int_route_t *val)
+{
+  iis2dulpx_ctrl1_t ctrl1 = {0};
+  iis2dulpx_ctrl2_t ctrl2 = {0};
+  iis2dulpx_md1_cfg_t md1_cfg = {0};
+  int32_t ret = 0;
+
+  ret = iis2dulpx_read_reg(ctx, IIS2DULPX_CTRL1, (uint8_t *)&ctrl1, 1);
+  ret += iis2dulpx_read_reg(ctx, IIS2DULPX_CTRL2, (uint8_t *)&ctrl2, 1);
+  ret += iis2dulpx_read_reg(ctx, IIS2DULPX_MD1_CFG, (uint8_t *)&md1_cfg, 1);
+
+  if (ret == 0)
+  {
+    val->int_on_res = ctrl1.int1_on_res;
+    val->drdy = ctrl2.int1_drdy;
+    val->fifo_ovr = ctrl2.int1_fifo_ovr;
+    val->fifo_th = ctrl2.int1_fifo_th;
+    val->fifo_full = ctrl2.int1_fifo_full;
+    val->boot = ctrl2.int1_boot;
+    val->free_fall = md1_cfg.int1_ff;
+    val->six_d = md1_cfg.int1_6d;
+    val->tap = md1_cfg.int1_tap;
+    val->wake_up = md1_cfg.int1_wu;
+    val->sleep_change = md1_cfg.int1_sleep_change;
+    val->emb_function = md1_cfg.int1_emb_func;
+    val->timestamp = md1_cfg.int1_timestamp;
+  }
+
+  return ret;
+}
+
+int32_t iis2dulpx_emb_pin_int1_route_set(const stmdev_ctx_t *ctx,
+                                         const iis2dulpx_emb_pin_int_route_t *val)
+{
+  iis2dulpx_emb_func_int1_t emb_func_int1 = {0};
+  iis2dulpx_md1_cfg_t md1_cfg = {0};
+  int32_t ret = 0;
+
+  ret = iis2dulpx_mem_bank_set(ctx, IIS2DULPX_EMBED_FUNC_MEM_BANK);
+  if (ret == 0)
+  {
+    ret = iis2dulpx_read_reg(ctx, IIS2DULPX_EMB_FUNC_INT1, (uint8_t *)&emb_func_int1, 1);
+  }
+
+  if (ret == 0)
+  {
+    emb_func_int1.int1_tilt = val->tilt;
+    emb_func_int1.int1_sig_mot = val->sig_mot;
+    emb_func_int1.int1_step_det = val->step_det;
+    emb_func_int1.int1_fsm_lc = val->fsm_lc;
+
+    ret = iis2dulpx_write_reg(ctx, IIS2DULPX_EMB_FUNC_INT1, (uint8_t *)&emb_func_int1, 1);
+  }
+  ret += iis2dulpx_mem_bank_set(ctx, IIS2DULPX_MAIN_MEM_BANK);
+
+  ret += iis2dulpx_shadow_read(ctx, IIS2DULPX_MD1_CFG, (uint8_t *)&md1_cfg);
+  if (ret == 0)
+  {
+    md1_cfg.int1_emb_func = 1;
+    ret = iis2dulpx_shadow_write(ctx, IIS2DULPX_MD1_CFG, (uint8_t *)&md1_cfg);
+  }
+
+  return ret;
+}
+
+int32_t iis2dulpx_emb_pin_int1_route_get(const stmdev_ctx_t *ctx,
+                                         iis2dulpx_emb_pin_int_route_t *val)
+{
+  iis2dulpx_emb_func_int1_t emb_func_int1 = {0};
+  int32_t ret = 0;
+
+  ret = iis2dulpx_mem_bank_set(ctx, IIS2DULPX_EMBED_FUNC_MEM_BANK);
+  if (ret == 0)
+  {
+    ret = iis2dulpx_read_reg(ctx, IIS2DULPX_EMB_FUNC_INT1, (uint8_t *)&emb_func_int1, 1);
+  }
+
+  if (ret == 0)
+  {
+    val->tilt = emb_func_int1.int1_tilt;
+    val->sig_mot = emb_func_int1.int1_sig_mot;
+    val->step_det = emb_func_int1.int1_step_det;
+    val->fsm_lc = emb_func_int1.int1_fsm_lc;
+  }
+  ret = iis2dulpx_mem_bank_set(ctx, IIS2DULPX_MAIN_MEM_BANK);
+
+  return ret;
+}
+
+int32_t iis2dulpx_pin_int2_route_set(const stmdev_ctx_t *ctx, const iis2dulpx_pin_int_route_t *val)
+{
+  iis2dulpx_ctrl3_t ctrl3 = {0};
+  iis2dulpx_md2_cfg_t md2_cfg = {0};
+  int32_t ret = 0;
+
+  ret = iis2dulpx_shadow_read(ctx, IIS2DULPX_CTRL3, (uint8_t *)&ctrl3);
+
+  if (ret == 0)
+  {
+    ctrl3.int2_drdy = val->drdy;
+    ctrl3.int2_fifo_ovr = val->fifo_ovr;
+    ctrl3.int2_fifo_th = val->fifo_th;
+    ctrl3.int2_fifo_full = val->fifo_full;
+    ctrl3.int2_boot = val->boot;
+
+    ret = iis2dulpx_shadow_write(ctx, IIS2DULPX_CTRL3, (uint8_t *)&ctrl3);
+  }
+
+  if (ret == 0)
+  {
+    ret = iis2dulpx_shadow_read(ctx, IIS2DULPX_MD2_CFG, (uint8_t *)&md2_cfg);
+
+    if (ret == 0)
+    {
+      md2_cfg.int2_ff = val->free_fall;
+      md2_cfg.int2_6d = val->six_d;
+      md2_cfg.int2_tap = val->tap;
+      md2_cfg.int2_wu = val->wake_up;
+      md2_cfg.int2_sleep_change = val->sleep_change;
+      md2_cfg.int2_emb_func = val->emb_function;
+      md2_cfg.int2_timestamp = val->timestamp;
+
+      ret = iis2dulpx_shadow_write(ctx, IIS2DULPX_MD2_CFG, (uint8_t *)&md2_cfg);
+    }
+  }
+
+  return ret;
+}
+
+int32_t iis2dulpx_pin_int2_route_get(const stmdev_ctx_t *ctx, iis2dulpx_pin_int_route_t *val)
+{
+  iis2dulpx_ctrl3_t ctrl3 = {0};
+  iis2dulpx_md2_cfg_t md2_cfg = {0};
+  int32_t ret = 0;
+
+  ret = iis2dulpx_read_reg(ctx, IIS2DULPX_CTRL3, (uint8_t *)&ctrl3, 1);
+  ret += iis2dulpx_read_reg(ctx, IIS2DULPX_MD2_CFG, (uint8_t *)&md2_cfg, 1);
+
+  if (ret == 0)
+  {
+    val->drdy = ctrl3.int2_drdy;
+    val->fifo_ovr = ctrl3.int2_fifo_ovr;
+    val->fifo_th = ctrl3.int2_fifo_th;
+    val->fifo_full = ctrl3.int2_fifo_full;
+    val->boot = ctrl3.int2_boot;
+    val->free_fall = md2_cfg.int2_ff;
+    val->six_d = md2_cfg.int2_6d;
+    val->tap = md2_cfg.int2_tap;
+    val->wake_up = md2_cfg.int2_wu;
+    val->sleep_change = md2_cfg.int2_sleep_change;
+    val->emb_function = md2_cfg.int2_emb_func;
+    val->timestamp = md2_cfg.int2_timestamp;
+  }
+
+  return ret;
+}
+
+int32_t iis2dulpx_emb_pin_int2_route_set(const stmdev_ctx_t *ctx,
+                                         const iis2dulpx_emb_pin_int_route_t *val)
+{
+  iis2dulpx_emb_func_int2_t emb_func_int2 = {0};
+  iis2dulpx_md2_cfg_t md2_cfg = {0};
+  int32_t ret = 0;
+
+  ret = iis2dulpx_mem_bank_set(ctx, IIS2DULPX_EMBED_FUNC_MEM_BANK);
+  if (ret == 0)
+  {
+    ret = iis2dulpx_read_reg(ctx, IIS2DULPX_EMB_FUNC_INT2, (uint8_t *)&emb_func_int2, 1);
+  }
+
+  if (ret == 0)
+  {
+    emb_func_int2.int2_tilt = val->tilt;
+    emb_func_int2.int2_sig_mot = val->sig_mot;
+    emb_func_int2.int2_step_det = val->step_det;
+    emb_func_int2.int2_fsm_lc = val->fsm_lc;
+
+    ret = iis2dulpx_write_reg(ctx, IIS2DULPX_EMB_FUNC_INT2, (uint8_t *)&emb_func_int2, 1);
+  }
+  ret += iis2dulpx_mem_bank_set(ctx, IIS2DULPX_MAIN_MEM_BANK);
+
+  ret += iis2dulpx_shadow_read(ctx, IIS2DULPX_MD2_CFG, (uint8_t *)&md2_cfg);
+  if (ret == 0)
+  {
+    md2_cfg.int2_emb_func = 1;
+    ret = iis2dulpx_shadow_write(ctx, IIS2DULPX_MD2_CFG, (uint8_t *)&md2_cfg);
+  }
+
+  return ret;
+}
+
+int32_t iis2dulpx_emb_pin_int2_route_get(const stmdev_ctx_t *ctx,
+                                         iis2dulpx_emb_pin_int_route_t *val)
+{
+  iis2dulpx_emb_func_int2_t emb_func_int2 = {0};
+  int32_t ret = 0;
+
+  ret = iis2dulpx_mem_bank_set(ctx, IIS2DULPX_EMBED_FUNC_MEM_BANK);
+  if (ret == 0)
+  {
+    ret = iis2dulpx_read_reg(ctx, IIS2DULPX_EMB_FUNC_INT2, (uint8_t *)&emb_func_int2, 1);
+  }
+
+  if (ret == 0)
+  {
+    val->tilt = emb_func_int2.int2_tilt;
+    val->sig_mot = emb_func_int2.int2_sig_mot;
+    val->step_det = emb_func_int2.int2_step_det;
+    val->fsm_lc = emb_func_int2.int2_fsm_lc;
+  }
+  ret = iis2dulpx_mem_bank_set(ctx, IIS2DULPX_MAIN_MEM_BANK);
+
+  return ret;
+}
+
+int32_t iis2dulpx_int_config_set(const stmdev_ctx_t *ctx, const iis2dulpx_int_config_t *val)
+{
+  iis2dulpx_interrupt_cfg_t interrupt_cfg = {0};
+  int32_t ret = 0;
+
+  ret = iis2dulpx_shadow_read(ctx, IIS2DULPX_INTERRUPT_CFG, (uint8_t *)&interrupt_cfg);
+
+  if (ret == 0)
+  {
+    switch (val->int_cfg)
+    {
+      case IIS2DULPX_INT_DISABLED:
+        interrupt_cfg.interrupts_enable = 0;
+        break;
+
+      case IIS2DULPX_INT_LEVEL:
+        interrupt_cfg.interrupts_enable = 1;
+        interrupt_cfg.lir = 0;
+        break;
+
+      case IIS2DULPX_INT_LATCHED:
+      default:
+        interrupt_cfg.interrupts_enable = 1;
+        interrupt_cfg.lir = 1;
+        break;
+    }
+
+    interrupt_cfg.dis_rst_lir_all_int = val->dis_rst_lir_all_int;
+    interrupt_cfg.sleep_status_on_int = val->sleep_status_on_int;
+
+    ret = iis2dulpx_shadow_write(ctx, IIS2DULPX_INTERRUPT_CFG, (uint8_t *)&interrupt_cfg);
+  }
+
+  return ret;
+}
+
+int32_t iis2dulpx_int_config_get(const stmdev_ctx_t *ctx, iis2dulpx_int_config_t *val)
+{
+  iis2dulpx_interrupt_cfg_t interrupt_cfg = {0};
+  int32_t ret = 0;
+
+  ret = iis2dulpx_read_reg(ctx, IIS2DULPX_INTERRUPT_CFG, (uint8_t *)&interrupt_cfg, 1);
+
+  if (ret == 0)
+  {
+    val->dis_rst_lir_all_int = interrupt_cfg.dis_rst_lir_all_int;
+    val->sleep_status_on_int = interrupt_cfg.sleep_status_on_int;
+
+    if (interrupt_cfg.interrupts_enable == 0U)
+    {
+      val->int_cfg = IIS2DULPX_INT_DISABLED;
+    }
+    else if (interrupt_cfg.lir == 0U)
+    {
+      val->int_cfg = IIS2DULPX_INT_LEVEL;
+    }
+    else
+    {
+      val->int_cfg = IIS2DULPX_INT_LATCHED;
+    }
+  }
+
+  return ret;
+}
+
+int32_t iis2dulpx_embedded_int_cfg_set(const stmdev_ctx_t *ctx, iis2dulpx_embedded_int_config_t val)
+{
+  iis2dulpx_shadow_t *shadow;
+  iis2dulpx_page_rw_t page_rw = {0};
+  int32_t ret = 0;
+
+  ret = iis2dulpx_mem_bank_set(ctx, IIS2DULPX_EMBED_FUNC_MEM_BANK);
+  if (ret == 0)
+  {
+    ret = iis2dulpx_read_reg(ctx, IIS2DULPX_PAGE_RW, (uint8_t *)&page_rw, 1);
+
+    if (ret == 0)
+    {
+      switch (val)
+      {
+        case IIS2DULPX_EMBEDDED_INT_LEVEL:
+          page_rw.emb_func_lir = 0;
+          break;
+
+        case IIS2DULPX_EMBEDDED_INT_LATCHED:
+        default:
+          page_rw.emb_func_lir = 1;
+          break;
+      }
+
+      ret += iis2dulpx_write_reg(ctx, IIS2DULPX_PAGE_RW, (uint8_t *)&page_rw, 1);
+
+      shadow = iis2dulpx_shadow_of(ctx, IIS2DULPX_SHADOW_FIRST);
+      if (shadow != NULL)
+      {
+        (void)memcpy(&shadow->page_rw, &page_rw, 1);
+        shadow->page_rw_valid = (ret == 0) ? PROPERTY_ENABLE : PROPERTY_DISABLE;
+      }
+    }
+  }
+
+  ret += iis2dulpx_mem_bank_set(ctx, IIS2DULPX_MAIN_MEM_BANK);
+
+  return ret;
+}
+
+int32_t iis2dulpx_embedded_int_cfg_get(const stmdev_ctx_t *ctx,
+                                       iis2dulpx_embedded_int_config_t *val)
+{
+  iis2dulpx_page_rw_t page_rw = {0};
+  int32_t ret = 0;
+
+  ret = iis2dulpx_mem_bank_set(ctx, IIS2DULPX_EMBED_FUNC_MEM_BANK);
+  if (ret == 0)
+  {
+    ret = iis2dulpx_read_reg(ctx, IIS2DULPX_PAGE_RW, (uint8_t *)&page_rw, 1);
+
+    if (ret == 0)
+    {
+      if (page_rw.emb_func_lir == 0U)
+      {
+        *val = IIS2DULPX_EMBEDDED_INT_LEVEL;
+      }
+      else
+      {
+        *val = IIS2DULPX_EMBEDDED_INT_LATCHED;
+      }
+    }
+  }
+
+  ret += iis2dulpx_mem_bank_set(ctx, IIS2DULPX_MAIN_MEM_BANK);
+
+  return ret;
+}
+
+int32_t iis2dulpx_fifo_mode_set(const stmdev_ctx_t *ctx, iis2dulpx_fifo_mode_t val)
+{
+  iis2dulpx_ctrl4_t ctrl4 = {0};
+  iis2dulpx_fifo_ctrl_t fifo_ctrl = {0};
+  iis2dulpx_fifo_wtm_t fifo_wtm = {0};
+  iis2dulpx_txn_t txn;
+  int32_t ret = 0;
+
+  iis2dulpx_txn_init(&txn, ctx);
+  ret = iis2dulpx_txn_shadow_read(&txn, IIS2DULPX_CTRL4, (uint8_t *)&ctrl4);
+  ret += iis2dulpx_txn_shadow_read(&txn, IIS2DULPX_FIFO_CTRL, (uint8_t *)&fifo_ctrl);
+  ret += iis2dulpx_txn_shadow_read(&txn, IIS2DULPX_FIFO_WTM, (uint8_t *)&fifo_wtm);
+  ret += iis2dulpx_txn_run(&txn);
+
+  if (ret == 0)
+  {
+    /* set FIFO mode */
+    if (val.operation != IIS2DULPX_FIFO_OFF)
+    {
+      ctrl4.fifo_en = 1;
+      fifo_ctrl.fifo_mode = ((uint8_t)val.operation & 0x7U);
+    }
+    else
+    {
+      ctrl4.fifo_en = 0;
+    }
+
+    /* set fifo depth (1X/2X) */
+    fifo_ctrl.fifo_depth = (uint8_t)val.store & 0x01U;
+
+    /* Set xl_only_fifo */
+    fifo_wtm.xl_only_fifo = val.xl_only & 0x01U;
+
+    fifo_ctrl.cfg_chg_en = val.cfg_change_in_fifo & 0x01U;
+
+    ret += iis2dulpx_txn_write(&txn, IIS2DULPX_CTRL4, (uint8_t *)&ctrl4, 1);
+    ret += iis2dulpx_txn_write(&txn, IIS2DULPX_FIFO_CTRL, (uint8_t *)&fifo_ctrl, 1);
+    ret += iis2dulpx_txn_write(&txn, IIS2DULPX_FIFO_WTM, (uint8_t *)&fifo_wtm, 1);
+    ret += iis2dulpx_txn_run(&txn);
+  }
+
+  return ret;
+}
+
+int32_t iis2dulpx_fifo_mode_get(const stmdev_ctx_t *ctx, iis2dulpx_fifo_mode_t *val)
+{
+  iis2dulpx_ctrl4_t ctrl4 = {0};
+  iis2dulpx_fifo_ctrl_t fifo_ctrl = {0};
+  iis2dulpx_fifo_wtm_t fifo_wtm = {0};
+  int32_t ret = 0;
+
+  ret = iis2dulpx_read_reg(ctx, IIS2DULPX_CTRL4, (uint8_t *)&ctrl4, 1);
+  ret += iis2dulpx_read_reg(ctx, IIS2DULPX_FIFO_CTRL, (uint8_t *)&fifo_ctrl, 1);
+  ret += iis2dulpx_read_reg(ctx, IIS2DULPX_FIFO_WTM, (uint8_t *)&fifo_wtm, 1);
+
+  if (ret == 0)
+  {
+    /* get FIFO mode */
+    if (ctrl4.fifo_en == 0U)
+    {
+      val->operation = IIS2DULPX_FIFO_OFF;
+    }
+    else
+    {
+      val->operation = (iis2dulpx_operation_t)fifo_ctrl.fifo_mode;
+    }
+    val->cfg_change_in_fifo = fifo_ctrl.cfg_chg_en;
+
+    /* get fifo depth (1X/2X) */
+    val->store = (iis2dulpx_store_t)fifo_ctrl.fifo_depth;
+
+    /* Get xl_only_fifo */
+    val->xl_only = fifo_wtm.xl_only_fifo;
+
+  }
+
+  return ret;
+}
+
+int32_t iis2dulpx_fifo_watermark_set(const stmdev_ctx_t *ctx, uint8_t val)
+{
+  iis2dulpx_fifo_wtm_t fifo_wtm = {0};
+  int32_t ret = 0;
+
+  ret = iis2dulpx_shadow_read(ctx, IIS2DULPX_FIFO_WTM, (uint8_t *)&fifo_wtm);
+
+  if (ret == 0)
+  {
+    fifo_wtm.fth = val & 0x7FU;
+    ret += iis2dulpx_shadow_write(ctx, IIS2DULPX_FIFO_WTM, (uint8_t *)&fifo_wtm);
+  }
+
+  return ret;
+}
+
+int32_t iis2dulpx_fifo_watermark_get(const stmdev_ctx_t *ctx, uint8_t *val)
+{
+  iis2dulpx_fifo_wtm_t fifo_wtm = {0};
+  int32_t ret = 0;
+
+  ret = iis2dulpx_read_reg(ctx, IIS2DULPX_FIFO_WTM, (uint8_t *)&fifo_wtm, 1);
+
+  if (ret == 0)
+  {
+    *val = fifo_wtm.fth;
+  }
+
+  return ret;
+}
+
+int32_t iis2dulpx_fifo_batch_set(const stmdev_ctx_t *ctx, iis2dulpx_fifo_batch_t val)
+{
+  iis2dulpx_fifo_batch_dec_t fifo_batch = {0};
+  int32_t ret = 0;
+
+  ret = iis2dulpx_shadow_read(ctx, IIS2DULPX_FIFO_BATCH_DEC, (uint8_t *)&fifo_batch);
+
+  if (ret == 0)
+  {
+    fifo_batch.dec_ts_batch = (uint8_t)val.dec_ts & 0x03U;
+    fifo_batch.bdr_xl = (uint8_t)val.bdr_xl & 0x07U;
+
+    ret += iis2dulpx_shadow_write(ctx, IIS2DULPX_FIFO_BATCH_DEC, (uint8_t *)&fifo_batch);
+  }
+
+  return ret;
+}
+
+int32_t iis2dulpx_fifo_batch_get(const stmdev_ctx_t *ctx, iis2dulpx_fifo_batch_t *val)
+{
+  iis2dulpx_fifo_batch_dec_t fifo_batch = {0};
+  int32_t ret = 0;
+
+  ret = iis2dulpx_read_reg(ctx, IIS2DULPX_FIFO_BATCH_DEC, (uint8_t *)&fifo_batch, 1);
+
+  if (ret == 0)
+  {
+    val->dec_ts = (iis2dulpx_dec_ts_t)fifo_batch.dec_ts_batch;
+    val->bdr_xl = (iis2dulpx_bdr_xl_t)fifo_batch.bdr_xl;
+  }
+
+  return ret;
+}
+
+int32_t iis2dulpx_fifo_stop_on_wtm_set(const stmdev_ctx_t *ctx, iis2dulpx_fifo_event_t val)
+{
+  iis2dulpx_fifo_ctrl_t fifo_ctrl = {0};
+  int32_t ret = 0;
+
+  ret = iis2dulpx_shadow_read(ctx, IIS2DULPX_FIFO_CTRL, (uint8_t *)&fifo_ctrl);
+
+  if (ret == 0)
+  {
+    fifo_ctrl.stop_on_fth = (val == IIS2DULPX_FIFO_EV_WTM) ? 1U : 0U;
+    ret += iis2dulpx_shadow_write(ctx, IIS2DULPX_FIFO_CTRL, (uint8_t *)&fifo_ctrl);
+  }
+
+  return ret;
+}
+
+int32_t iis2dulpx_fifo_stop_on_wtm_get(const stmdev_ctx_t *ctx, iis2dulpx_fifo_event_t *val)
+{
+  iis2dulpx_fifo_ctrl_t fifo_ctrl = {0};
+  int32_t ret = 0;
+
+  ret = iis2dulpx_read_reg(ctx, IIS2DULPX_FIFO_CTRL, (uint8_t *)&fifo_ctrl, 1);
+
+  if (ret == 0)
+  {
+    *val = (fifo_ctrl.stop_on_fth == 1U) ? IIS2DULPX_FIFO_EV_WTM : IIS2DULPX_FIFO_EV_FULL;
+  }
+
+  return ret;
+}
+
+int32_t iis2dulpx_fifo_data_level_get(const stmdev_ctx_t *ctx, uint16_t *val)
+{
+  uint8_t buff = 0;
+  int32_t ret = 0;
+
+  ret = iis2dulpx_read_reg(ctx, IIS2DULPX_FIFO_STATUS2, &buff, 1);
+
+  if (ret == 0)
+  {
+    *val = buff;
+  }
+
+  return ret;
+}
+
+int32_t iis2dulpx_fifo_wtm_flag_get(const stmdev_ctx_t *ctx, uint8_t *val)
+{
+  iis2dulpx_fifo_status1_t fifo_status1 = {0};
+  int32_t ret = 0;
+
+  ret = iis2dulpx_read_reg(ctx, IIS2DULPX_FIFO_STATUS1, (uint8_t *)&fifo_status1, 1);
+
+  if (ret == 0)
+  {
+    *val = fifo_status1.fifo_wtm_ia;
+  }
+
+  return ret;
+}
+
+int32_t iis2dulpx_fifo_sensor_tag_get(const stmdev_ctx_t *ctx, iis2dulpx_fifo_sensor_tag_t *val)
+{
+  iis2dulpx_fifo_data_out_tag_t fifo_tag = {0};
+  int32_t ret = 0;
+
+  ret = iis2dulpx_read_reg(ctx, IIS2DULPX_FIFO_DATA_OUT_TAG, (uint8_t *)&fifo_tag, 1);
+
+  if (ret == 0)
+  {
+    *val = (iis2dulpx_fifo_sensor_tag_t) fifo_tag.tag_sensor;
+  }
+
+  return ret;
+}
+
+int32_t iis2dulpx_fifo_out_raw_get(const stmdev_ctx_t *ctx, uint8_t *buff)
+{
+  int32_t ret = 0;
+
+  ret = iis2dulpx_read_reg(ctx, IIS2DULPX_FIFO_DATA_OUT_X_L, buff, 6);
+
+  return ret;
+}
+
+int32_t iis2dulpx_fifo_out_raw_batch_get(const stmdev_ctx_t *ctx, uint8_t *buff, uint16_t num)
+{
+  int32_t ret = 0;
+
+  if (num > (0xFFFFU / IIS2DULPX_FIFO_RECORD_LEN))
+  {
+    return -1;
+  }
+
+  if (num == 0U)
+  {
+    return ret;
+  }
+
+  /* TAG + 6 bytes per record: address rolls back from Z_H to TAG */
+  ret = iis2dulpx_read_reg(ctx, IIS2DULPX_FIFO_DATA_OUT_TAG, buff,
+                           (uint16_t)(num * IIS2DULPX_FIFO_RECORD_LEN));
+
+  return ret;
+}
+
+/* A FIFO sample consists of 2X 8-bits 3-axis XL at ODR/2 */
+static void iis2dulpx_fifo_unpack_2x(const uint8_t *raw, int16_t *xl0, int16_t *xl1)
+{
+  xl0[0] = (int16_t)raw[0] * 256;
+  xl0[1] = (int16_t)raw[1] * 256;
+  xl0[2] = (int16_t)raw[2] * 256;
+  xl1[0] = (int16_t)raw[3] * 256;
+  xl1[1] = (int16_t)raw[4] * 256;
+  xl1[2] = (int16_t)raw[5] * 256;
+}
+
+/* A FIFO sample consists of 12-bits 3-axis XL + T (or AH_QVAR) at ODR */
+static void iis2dulpx_fifo_unpack_12bit(const uint8_t *raw, int16_t *xl, int16_t *aux)
+{
+  xl[0] = (int16_t)((raw[0] | ((uint16_t)raw[1] << 8)) << 4);
+  xl[1] = (int16_t)(((raw[1] >> 4) | ((uint16_t)raw[2] << 4)) << 4);
+  xl[2] = (int16_t)((raw[3] | ((uint16_t)raw[4] << 8)) << 4);
+  *aux = (int16_t)(((raw[4] >> 4) + ((uint16_t)raw[5] << 4)) << 4);
+}
+
+/* A FIFO sample consists of 16-bits 3-axis XL at ODR */
+static void iis2dulpx_fifo_unpack_16bit(const uint8_t *raw, int16_t *xl)
+{
+  xl[0] = (int16_t)(raw[0] | ((uint16_t)raw[1] << 8));
+  xl[1] = (int16_t)(raw[2] | ((uint16_t)raw[3] << 8));
+  xl[2] = (int16_t)(raw[4] | ((uint16_t)raw[5] << 8));
+}
+
+static void iis2dulpx_fifo_win_add(iis2dulpx_fifo_win_t *win, const int16_t *xl)
+{
+  uint8_t i;
+
+  for (i = 0U; i < 3U; i++)
+  {
+    win->sum[i] += xl[i];
+    win->sum_sq[i] += (uint64_t)((int32_t)xl[i] * (int32_t)xl[i]);
+    if (xl[i] < win->min[i])
+    {
+      win->min[i] = xl[i];
+    }
+    if (xl[i] > win->max[i])
+    {
+      win->max[i] = xl[i];
+    }
+  }
+  win->num++;
+}
+
+/* step counter, FSM and MLC records: type NONE for any other tag */
+static void iis2dulpx_fifo_emb_decode(uint8_t tag, const uint8_t *raw, iis2dulpx_emb_ev_t *ev)
+{
+  ev->type = IIS2DULPX_EMB_EV_NONE;
+  ev->index = 0;
+  ev->value = 0;
+  ev->smp_index = 0;
+  ev->timestamp = raw[5];
+  ev->timestamp = (ev->timestamp * 256U) + raw[4];
+  ev->timestamp = (ev->timestamp * 256U) + raw[3];
+  ev->timestamp = (ev->timestamp * 256U) + raw[2];
+
+  switch (tag)
+  {
+    case (uint8_t)IIS2DULPX_STEP_COUNTER_TAG:
+      ev->type = IIS2DULPX_EMB_EV_STEP;
+      ev->value = (uint16_t)(((uint16_t)raw[1] * 256U) + raw[0]);
+      break;
+    case (uint8_t)IIS2DULPX_FSM_RESULT_TAG:
+      ev->type = IIS2DULPX_EMB_EV_FSM;
+      ev->value = raw[0];
+      ev->index = raw[1];
+      break;
+    case (uint8_t)IIS2DULPX_MLC_RESULT_TAG:
+      ev->type = IIS2DULPX_EMB_EV_MLC;
+      ev->value = raw[0];
+      ev->index = raw[1];
+      break;
+    case (uint8_t)IIS2DULPX_MLC_FILTER_TAG:
+    case (uint8_t)IIS2DULPX_MLC_FEATURE:
+      ev->type = (tag == (uint8_t)IIS2DULPX_MLC_FILTER_TAG) ?
+                 IIS2DULPX_EMB_EV_MLC_FILTER : IIS2DULPX_EMB_EV_MLC_FEATURE;
+      ev->value = (uint16_t)(((uint16_t)raw[1] * 256U) + raw[0]);
+      ev->index = raw[2];
+      ev->timestamp = 0;
+      break;
+    default:
+      ev->timestamp = 0;
+      break;
+  }
+}
+
+int32_t iis2dulpx_fifo_data_decode(const iis2dulpx_md_t *md, const iis2dulpx_fifo_mode_t *fmd,
+                                   const uint8_t *buff, iis2dulpx_fifo_data_t *data)
+{
+  iis2dulpx_fifo_data_out_tag_t fifo_tag = {0};
+  const uint8_t *fifo_raw = &buff[1];
+  int32_t ret = 0, i = 0;
+
+  (void)memcpy(&fifo_tag, &buff[0], 1);
+  data->tag = fifo_tag.tag_sensor;
+  iis2dulpx_fifo_emb_decode(fifo_tag.tag_sensor, fifo_raw, &data->emb);
+
+  switch (fifo_tag.tag_sensor)
+  {
+    case (uint8_t)IIS2DULPX_XL_ONLY_2X_TAG:
+    case (uint8_t)IIS2DULPX_XL_ONLY_2X_TAG_2ND:
+      iis2dulpx_fifo_unpack_2x(fifo_raw, data->xl[0].raw, data->xl[1].raw);
+      break;
+    case (uint8_t)IIS2DULPX_XL_AND_QVAR:
+    case (uint8_t)IIS2DULPX_XL_TEMP_TAG:
+      if (fmd->xl_only == 0x0U)
+      {
+        iis2dulpx_fifo_unpack_12bit(fifo_raw, data->xl[0].raw, &data->heat.raw);
+        if (fifo_tag.tag_sensor == (uint8_t)IIS2DULPX_XL_TEMP_TAG)
+        {
+          if (md != NULL)
+          {
+            data->heat.deg_c = iis2dulpx_from_lsb_to_celsius(data->heat.raw);
+          }
+        }
+        else
+        {
+          data->ah_qvar.raw = data->heat.raw;
+          if (md != NULL)
+          {
+            data->ah_qvar.mv = iis2dulpx_from_lsb_to_mv(data->ah_qvar.raw);
+          }
+        }
+      }
+      else
+      {
+        iis2dulpx_fifo_unpack_16bit(fifo_raw, data->xl[0].raw);
+      }
+      break;
+    case (uint8_t)IIS2DULPX_TIMESTAMP_TAG:
+      data->cfg_chg.cfg_change = (fifo_raw[0] >> 7) & 0x01U;
+      data->cfg_chg.odr = (fifo_raw[0] >> 3) & 0xFU;
+      data->cfg_chg.bw = (fifo_raw[0] >> 1) & 0x3U;
+      data->cfg_chg.lp_hp = fifo_raw[0] & 0x1U;
+      data->cfg_chg.qvar_en = (fifo_raw[1] >> 7) & 0x01U;
+      data->cfg_chg.fs = (fifo_raw[1] >> 5) & 0x3U;
+      data->cfg_chg.dec_ts = (fifo_raw[1] >> 3) & 0x3U;
+      data->cfg_chg.odr_xl_batch = fifo_raw[1] & 0x1U;
+
+      data->cfg_chg.timestamp = fifo_raw[5];
+      data->cfg_chg.timestamp = (data->cfg_chg.timestamp * 256U) +  fifo_raw[4];
+      data->cfg_chg.timestamp = (data->cfg_chg.timestamp * 256U) +  fifo_raw[3];
+      data->cfg_chg.timestamp = (data->cfg_chg.timestamp * 256U) +  fifo_raw[2];
+      break;
+
+    case (uint8_t)IIS2DULPX_STEP_COUNTER_TAG:
+      data->pedo.steps = fifo_raw[1];
+      data->pedo.steps = (data->pedo.steps * 256U) +  fifo_raw[0];
+
+      data->pedo.timestamp = fifo_raw[5];
+      data->pedo.timestamp = (data->pedo.timestamp * 256U) +  fifo_raw[4];
+      data->pedo.timestamp = (data->pedo.timestamp * 256U) +  fifo_raw[3];
+      data->pedo.timestamp = (data->pedo.timestamp * 256U) +  fifo_raw[2];
+
+      break;
+
+    case (uint8_t)IIS2DULPX_FIFO_EMPTY:
+    default:
+      /* do nothing */
+      break;
+  }
+
+  /* raw data only, no floating point conversion */
+  if (md == NULL)
+  {
+    return ret;
+  }
+
+  for (i = 0; i < 3; i++)
+  {
+    switch (md->fs)
+    {
+      case IIS2DULPX_2g:
+        data->xl[0].mg[i] = iis2dulpx_from_fs2g_to_mg(data->xl[0].raw[i]);
+        data->xl[1].mg[i] = iis2dulpx_from_fs2g_to_mg(data->xl[1].raw[i]);
+        break;
+      case IIS2DULPX_4g:
+        data->xl[0].mg[i] = iis2dulpx_from_fs4g_to_mg(data->xl[0].raw[i]);
+        data->xl[1].mg[i] = iis2dulpx_from_fs4g_to_mg(data->xl[1].raw[i]);
+        break;
+      case IIS2DULPX_8g:
+        data->xl[0].mg[i] = iis2dulpx_from_fs8g_to_mg(data->xl[0].raw[i]);
+        data->xl[1].mg[i] = iis2dulpx_from_fs8g_to_mg(data->xl[1].raw[i]);
+        break;
+      case IIS2DULPX_16g:
+        data->xl[0].mg[i] = iis2dulpx_from_fs16g_to_mg(data->xl[0].raw[i]);
+        data->xl[1].mg[i] = iis2dulpx_from_fs16g_to_mg(data->xl[1].raw[i]);
+        break;
+      default:
+        data->xl[0].mg[i] = 0.0f;
+        data->xl[1].mg[i] = 0.0f;
+        break;
+    }
+  }
+
+  return ret;
+}
+
+/*
+ * Fixed full scale and record layout variants of the FIFO decode: one
+ * tag compare per record selects the accelerometer records of the
+ * layout, unpack and scaling are straight-line code.
+ */
+#define IIS2DULPX_FIFO_XLONLY_TAG(t)  (((t) == (uint8_t)IIS2DULPX_XL_TEMP_TAG) || \
+                                       ((t) == (uint8_t)IIS2DULPX_XL_AND_QVAR))
+#define IIS2DULPX_FIFO_XLAUX_TAG(t)   IIS2DULPX_FIFO_XLONLY_TAG(t)
+#define IIS2DULPX_FIFO_2X_TAG(t)      (((t) == (uint8_t)IIS2DULPX_XL_ONLY_2X_TAG) || \
+                                       ((t) == (uint8_t)IIS2DULPX_XL_ONLY_2X_TAG_2ND))
+
+#define IIS2DULPX_FIFO_XLONLY_UNPACK(src, dst, aux) iis2dulpx_fifo_unpack_16bit((src), (dst)[0].raw)
+#define IIS2DULPX_FIFO_XLAUX_UNPACK(src, dst, aux)  iis2dulpx_fifo_unpack_12bit((src), (dst)[0].raw, &(aux))
+#define IIS2DULPX_FIFO_2X_UNPACK(src, dst, aux)     iis2dulpx_fifo_unpack_2x((src), (dst)[0].raw, (dst)[1].raw)
+
+#define IIS2DULPX_FIFO_XLONLY_STEP  1U
+#define IIS2DULPX_FIFO_XLAUX_STEP   1U
+#define IIS2DULPX_FIFO_2X_STEP      2U
+
+#define IIS2DULPX_FIFO_DECODER_DEFINE(fs, sens, layout, LAYOUT)                  \
+  int32_t iis2dulpx_fifo_decode_##fs##_##layout(const uint8_t *buff, uint16_t num, \
+                                               iis2dulpx_xl_data_t *out, int16_t *aux, \
+                                               uint16_t out_max, uint16_t *samples) \
+  {                                                                              \
+    iis2dulpx_fifo_data_out_tag_t fifo_tag;                                      \
+    const uint8_t *rec;                                                          \
+    uint16_t cnt = 0;                                                            \
+    int16_t val = 0;                                                             \
+    uint16_t i;                                                                  \
+    uint8_t k;                                                                   \
+                                                                                 \
+    for (i = 0U; i < num; i++)                                                   \
+    {                                                                            \
+      rec = &buff[i * IIS2DULPX_FIFO_RECORD_LEN];                                \
+      (void)memcpy(&fifo_tag, &rec[0], 1);                                       \
+      if (!(IIS2DULPX_FIFO_##LAYOUT##_TAG(fifo_tag.tag_sensor)))                 \
+      {                                                                          \
+        continue;                                                                \
+      }                                                                          \
+                                                                                 \
+      if ((cnt + IIS2DULPX_FIFO_##LAYOUT##_STEP) > out_max)                      \
+      {                                                                          \
+        break;                                                                   \
+      }                                                                          \
+                                                                                 \
+      IIS2DULPX_FIFO_##LAYOUT##_UNPACK(&rec[1], &out[cnt], val);                 \
+      for (k = 0U; k < IIS2DULPX_FIFO_##LAYOUT##_STEP; k++)                      \
+      {                                                                          \
+        out[cnt].mg[0] = (float_t)out[cnt].raw[0] * (sens);                      \
+        out[cnt].mg[1] = (float_t)out[cnt].raw[1] * (sens);                      \
+        out[cnt].mg[2] = (float_t)out[cnt].raw[2] * (sens);                      \
+        if (aux != NULL)                                                         \
+        {                                                                        \
+          aux[cnt] = val;                                                        \
+        }                                                                        \
+        cnt++;                                                                   \
+      }                                                                          \
+    }                                                                            \
+                                                                                 \
+    *samples = cnt;                                                              \
+                                                                                 \
+    return 0;                                                                    \
+  }
+
+IIS2DULPX_FIFO_DECODER_DEFINE(fs2g, 0.061f, xlonly, XLONLY)
+IIS2DULPX_FIFO_DECODER_DEFINE(fs4g, 0.122f, xlonly, XLONLY)
+IIS2DULPX_FIFO_DECODER_DEFINE(fs8g, 0.244f, xlonly, XLONLY)
+IIS2DULPX_FIFO_DECODER_DEFINE(fs16g, 0.488f, xlonly, XLONLY)
+IIS2DULPX_FIFO_DECODER_DEFINE(fs2g, 0.061f, xlaux, XLAUX)
+IIS2DULPX_FIFO_DECODER_DEFINE(fs4g, 0.122f, xlaux, XLAUX)
+IIS2DULPX_FIFO_DECODER_DEFINE(fs8g, 0.244f, xlaux, XLAUX)
+IIS2DULPX_FIFO_DECODER_DEFINE(fs16g, 0.488f, xlaux, XLAUX)
+IIS2DULPX_FIFO_DECODER_DEFINE(fs2g, 0.061f, 2x, 2X)
+IIS2DULPX_FIFO_DECODER_DEFINE(fs4g, 0.122f, 2x, 2X)
+IIS2DULPX_FIFO_DECODER_DEFINE(fs8g, 0.244f, 2x, 2X)
+IIS2DULPX_FIFO_DECODER_DEFINE(fs16g, 0.488f, 2x, 2X)
+
+int32_t iis2dulpx_fifo_unpack_soa(const iis2dulpx_fifo_mode_t *fmd, const uint8_t *buff,
+                                  uint16_t num, iis2dulpx_fifo_soa_t *out, uint16_t max,
+                                  uint16_t *samples)
+{
+  iis2dulpx_fifo_data_out_tag_t fifo_tag;
+  const uint8_t *raw;
+  int16_t xl[2][3];
+  int16_t aux;
+  uint16_t cnt = 0;
+  uint16_t rec = 0;
+  uint16_t run;
+  uint16_t room;
+  uint16_t j;
+  uint8_t full = 0;
+  uint8_t tag;
+
+  while ((rec < num) && (full == 0U))
+  {
+    (void)memcpy(&fifo_tag, &buff[rec * IIS2DULPX_FIFO_RECORD_LEN], 1);
+    tag = fifo_tag.tag_sensor;
+
+    /* run of records sharing the same tag: one branch-free loop each */
+    run = 1U;
+    while ((rec + run) < num)
+    {
+      (void)memcpy(&fifo_tag, &buff[(rec + run) * IIS2DULPX_FIFO_RECORD_LEN], 1);
+      if (fifo_tag.tag_sensor != tag)
+      {
+        break;
+      }
+      run++;
+    }
+
+    room = max - cnt;
+    raw = &buff[(rec * IIS2DULPX_FIFO_RECORD_LEN) + 1U];
+
+    switch (tag)
+    {
+      case (uint8_t)IIS2DULPX_XL_ONLY_2X_TAG:
+      case (uint8_t)IIS2DULPX_XL_ONLY_2X_TAG_2ND:
+        if (run > (room / 2U))
+        {
+          run = room / 2U;
+          full = 1U;
+        }
+        for (j = 0U; j < run; j++)
+        {
+          iis2dulpx_fifo_unpack_2x(&raw[j * IIS2DULPX_FIFO_RECORD_LEN], xl[0], xl[1]);
+          out->x[cnt + (2U * j)] = xl[0][0];
+          out->y[cnt + (2U * j)] = xl[0][1];
+          out->z[cnt + (2U * j)] = xl[0][2];
+          out->x[cnt + (2U * j) + 1U] = xl[1][0];
+          out->y[cnt + (2U * j) + 1U] = xl[1][1];
+          out->z[cnt + (2U * j) + 1U] = xl[1][2];
+        }
+        if (out->aux != NULL)
+        {
+          for (j = 0U; j < (2U * run); j++)
+          {
+            out->aux[cnt + j] = 0;
+          }
+        }
+        cnt = (uint16_t)(cnt + (2U * run));
+        break;
+      case (uint8_t)IIS2DULPX_XL_AND_QVAR:
+      case (uint8_t)IIS2DULPX_XL_TEMP_TAG:
+        if (run > room)
+        {
+          run = room;
+          full = 1U;
+        }
+        if (fmd->xl_only == 0x0U)
+        {
+          for (j = 0U; j < run; j++)
+          {
+            iis2dulpx_fifo_unpack_12bit(&raw[j * IIS2DULPX_FIFO_RECORD_LEN], xl[0], &aux);
+            out->x[cnt + j] = xl[0][0];
+            out->y[cnt + j] = xl[0][1];
+            out->z[cnt + j] = xl[0][2];
+            if (out->aux != NULL)
+            {
+              out->aux[cnt + j] = aux;
+            }
+          }
+        }
+        else
+        {
+          for (j = 0U; j < run; j++)
+          {
+            iis2dulpx_fifo_unpack_16bit(&raw[j * IIS2DULPX_FIFO_RECORD_LEN], xl[0]);
+            out->x[cnt + j] = xl[0][0];
+            out->y[cnt + j] = xl[0][1];
+            out->z[cnt + j] = xl[0][2];
+            if (out->aux != NULL)
+            {
+              out->aux[cnt + j] = 0;
+            }
+          }
+        }
+        cnt += run;
+        break;
+      default:
+        /* not an accelerometer record: skipped */
+        break;
+    }
+
+    rec += run;
+  }
+
+  *samples = cnt;
+
+  return 0;
+}
+
+int32_t iis2dulpx_fifo_data_get(const stmdev_ctx_t *ctx, const iis2dulpx_md_t *md,
+                                const iis2dulpx_fifo_mode_t *fmd,
+                                iis2dulpx_fifo_data_t *data)
+{
+  iis2dulpx_fifo_data_out_tag_t fifo_tag = {0};
+  uint8_t fifo_rec[IIS2DULPX_FIFO_RECORD_LEN] = {0};
+  int32_t ret = 0;
+
+  ret = iis2dulpx_read_reg(ctx, IIS2DULPX_FIFO_DATA_OUT_TAG, (uint8_t *)&fifo_tag, 1);
+  if (ret != 0)
+  {
+    return ret;
+  }
+  (void)memcpy(&fifo_rec[0], &fifo_tag, 1);
+
+  switch (fifo_tag.tag_sensor)
+  {
+    case (uint8_t)IIS2DULPX_XL_ONLY_2X_TAG:
+    case (uint8_t)IIS2DULPX_XL_ONLY_2X_TAG_2ND:
+    case (uint8_t)IIS2DULPX_XL_AND_QVAR:
+    case (uint8_t)IIS2DULPX_XL_TEMP_TAG:
+    case (uint8_t)IIS2DULPX_TIMESTAMP_TAG:
+    case (uint8_t)IIS2DULPX_STEP_COUNTER_TAG:
+    case (uint8_t)IIS2DULPX_MLC_RESULT_TAG:
+    case (uint8_t)IIS2DULPX_MLC_FILTER_TAG:
+    case (uint8_t)IIS2DULPX_MLC_FEATURE:
+    case (uint8_t)IIS2DULPX_FSM_RESULT_TAG:
+      ret = iis2dulpx_fifo_out_raw_get(ctx, &fifo_rec[1]);
+      if (ret != 0)
+      {
+        return ret;
+      }
+      break;
+
+    case (uint8_t)IIS2DULPX_FIFO_EMPTY:
+    default:
+      /* do nothing */
+      break;
+  }
+
+  ret = iis2dulpx_fifo_data_decode(md, fmd, fifo_rec, data);
+
+  return ret;
+}
+
+int32_t iis2dulpx_fifo_data_get_batch(const stmdev_ctx_t *ctx, const iis2dulpx_md_t *md,
+                                      const iis2dulpx_fifo_mode_t *fmd, uint8_t *buff,
+                                      iis2dulpx_fifo_data_t *data, uint16_t max,
+                                      uint16_t *num)
+{
+  uint16_t level = 0;
+  int32_t ret = 0;
+  uint16_t i = 0;
+
+  *num = 0;
+
+  ret = iis2dulpx_fifo_data_level_get(ctx, &level);
+  if (ret != 0)
+  {
+    return ret;
+  }
+
+  if (level > max)
+  {
+    level = max;
+  }
+
+  ret = iis2dulpx_fifo_out_raw_batch_get(ctx, buff, level);
+  if (ret != 0)
+  {
+    return ret;
+  }
+
+  if (data != NULL)
+  {
+    for (i = 0; i < level; i++)
+    {
+      ret += iis2dulpx_fifo_data_decode(md, fmd, &buff[i * IIS2DULPX_FIFO_RECORD_LEN], &data[i]);
+    }
+  }
+
+  *num = level;
+
+  return ret;
+}
+
+int32_t iis2dulpx_fifo_compact_decode(const iis2dulpx_fifo_mode_t *fmd, const uint8_t *buff,
+                                      uint16_t num, iis2dulpx_fifo_compact_t *out)
+{
+  iis2dulpx_fifo_data_out_tag_t fifo_tag;
+  iis2dulpx_fifo_sample_t *smp;
+  iis2dulpx_fifo_ts_t *ts;
+  const uint8_t *raw;
+  uint16_t rec = 0;
+
+  out->smp_num = 0;
+  out->ts_num = 0;
+  out->ev_num = 0;
+
+  for (rec = 0U; rec < num; rec++)
+  {
+    (void)memcpy(&fifo_tag, &buff[rec * IIS2DULPX_FIFO_RECORD_LEN], 1);
+    raw = &buff[(rec * IIS2DULPX_FIFO_RECORD_LEN) + 1U];
+    smp = &out->smp[out->smp_num];
+
+    switch (fifo_tag.tag_sensor)
+    {
+      case (uint8_t)IIS2DULPX_XL_ONLY_2X_TAG:
+      case (uint8_t)IIS2DULPX_XL_ONLY_2X_TAG_2ND:
+        if ((uint16_t)(out->smp_max - out->smp_num) < 2U)
+        {
+          goto exit;
+        }
+        iis2dulpx_fifo_unpack_2x(raw, smp[0].xl, smp[1].xl);
+        smp[0].tag = fifo_tag.tag_sensor;
+        smp[0].aux = 0;
+        smp[1].tag = fifo_tag.tag_sensor;
+        smp[1].aux = 0;
+        out->smp_num += 2U;
+        if (out->win != NULL)
+        {
+          iis2dulpx_fifo_win_add(out->win, smp[0].xl);
+          iis2dulpx_fifo_win_add(out->win, smp[1].xl);
+        }
+        break;
+      case (uint8_t)IIS2DULPX_XL_AND_QVAR:
+      case (uint8_t)IIS2DULPX_XL_TEMP_TAG:
+        if (out->smp_num == out->smp_max)
+        {
+          goto exit;
+        }
+        if (fmd->xl_only == 0x0U)
+        {
+          iis2dulpx_fifo_unpack_12bit(raw, smp->xl, &smp->aux);
+        }
+        else
+        {
+          iis2dulpx_fifo_unpack_16bit(raw, smp->xl);
+          smp->aux = 0;
+        }
+        smp->tag = fifo_tag.tag_sensor;
+        out->smp_num++;
+        if (out->win != NULL)
+        {
+          iis2dulpx_fifo_win_add(out->win, smp->xl);
+        }
+        break;
+      case (uint8_t)IIS2DULPX_TIMESTAMP_TAG:
+        if (out->ts == NULL)
+        {
+          break;
+        }
+        if (out->ts_num == out->ts_max)
+        {
+          goto exit;
+        }
+        ts = &out->ts[out->ts_num];
+        ts->index = out->smp_num;
+        ts->cfg_change = (raw[0] >> 7) & 0x01U;
+        ts->odr = (raw[0] >> 3) & 0xFU;
+        ts->bw = (raw[0] >> 1) & 0x3U;
+        ts->lp_hp = raw[0] & 0x1U;
+        ts->qvar_en = (raw[1] >> 7) & 0x01U;
+        ts->fs = (raw[1] >> 5) & 0x3U;
+        ts->dec_ts = (raw[1] >> 3) & 0x3U;
+        ts->odr_xl_batch = raw[1] & 0x1U;
+        ts->timestamp = raw[5];
+        ts->timestamp = (ts->timestamp * 256U) + raw[4];
+        ts->timestamp = (ts->timestamp * 256U) + raw[3];
+        ts->timestamp = (ts->timestamp * 256U) + raw[2];
+        out->ts_num++;
+        break;
+      case (uint8_t)IIS2DULPX_STEP_COUNTER_TAG:
+      case (uint8_t)IIS2DULPX_MLC_RESULT_TAG:
+      case (uint8_t)IIS2DULPX_MLC_FILTER_TAG:
+      case (uint8_t)IIS2DULPX_MLC_FEATURE:
+      case (uint8_t)IIS2DULPX_FSM_RESULT_TAG:
+        if (out->ev == NULL)
+        {
+          break;
+        }
+        if (out->ev_num == out->ev_max)
+        {
+          goto exit;
+        }
+        iis2dulpx_fifo_emb_decode(fifo_tag.tag_sensor, raw, &out->ev[out->ev_num]);
+        out->ev[out->ev_num].smp_index = out->smp_num;
+        out->ev_num++;
+        break;
+      default:
+        /* other records are not stored */
+        break;
+    }
+  }
+
+exit:
+  out->rec_num = rec;
+
+  return 0;
+}
+
+int32_t iis2dulpx_fifo_compact_get(const stmdev_ctx_t *ctx, const iis2dulpx_fifo_mode_t *fmd,
+                                   uint8_t *buff, uint16_t max, iis2dulpx_fifo_compact_t *out)
+{
+  uint16_t level = 0;
+  int32_t ret = 0;
+
+  out->rec_num = 0;
+  out->smp_num = 0;
+  out->ts_num = 0;
+  out->ev_num = 0;
+
+  ret = iis2dulpx_fifo_data_level_get(ctx, &level);
+  if (ret != 0)
+  {
+    return ret;
+  }
+
+  if (level > max)
+  {
+    level = max;
+  }
+
+  ret = iis2dulpx_fifo_out_raw_batch_get(ctx, buff, level);
+  if (ret != 0)
+  {
+    return ret;
+  }
+
+  ret = iis2dulpx_fifo_compact_decode(fmd, buff, level, out);
+
+  return ret;
+}
+
+int32_t iis2dulpx_emb_fifo_set(const stmdev_ctx_t *ctx, iis2dulpx_emb_fifo_t val)
+{
+  iis2dulpx_emb_func_fifo_en_t fifo_reg = {0};
+  int32_t ret = 0;
+
+  ret = iis2dulpx_mem_bank_set(ctx, IIS2DULPX_EMBED_FUNC_MEM_BANK);
+  ret += iis2dulpx_read_reg(ctx, IIS2DULPX_EMB_FUNC_FIFO_EN, (uint8_t *)&fifo_reg, 1);
+  if (ret == 0)
+  {
+    fifo_reg.step_counter_fifo_en = val.step_counter;
+    fifo_reg.fsm_fifo_en = val.fsm;
+    fifo_reg.mlc_fifo_en = val.mlc;
+    fifo_reg.mlc_filter_feature_fifo_en = val.mlc_filter_feature;
+    ret += iis2dulpx_write_reg(ctx, IIS2DULPX_EMB_FUNC_FIFO_EN, (uint8_t *)&fifo_reg, 1);
+  }
+
+  ret += iis2dulpx_mem_bank_set(ctx, IIS2DULPX_MAIN_MEM_BANK);
+
+  return ret;
+}
+
+int32_t iis2dulpx_emb_fifo_get(const stmdev_ctx_t *ctx, iis2dulpx_emb_fifo_t *val)
+{
+  iis2dulpx_emb_func_fifo_en_t fifo_reg = {0};
+  int32_t ret = 0;
+
+  ret = iis2dulpx_mem_bank_set(ctx, IIS2DULPX_EMBED_FUNC_MEM_BANK);
+  ret += iis2dulpx_read_reg(ctx, IIS2DULPX_EMB_FUNC_FIFO_EN, (uint8_t *)&fifo_reg, 1);
+  if (ret == 0)
+  {
+    val->step_counter = fifo_reg.step_counter_fifo_en;
+    val->fsm = fifo_reg.fsm_fifo_en;
+    val->mlc = fifo_reg.mlc_fifo_en;
+    val->mlc_filter_feature = fifo_reg.mlc_filter_feature_fifo_en;
+  }
+
+  ret += iis2dulpx_mem_bank_set(ctx, IIS2DULPX_MAIN_MEM_BANK);
+
+  return ret;
+}
+
+int32_t iis2dulpx_fifo_win_reset(iis2dulpx_fifo_win_t *win)
+{
+  uint8_t i;
+
+  (void)memset(win, 0x00, sizeof(iis2dulpx_fifo_win_t));
+  for (i = 0U; i < 3U; i++)
+  {
+    win->min[i] = INT16_MAX;
+    win->max[i] = INT16_MIN;
+  }
+
+  return 0;
+}
+
+int32_t iis2dulpx_fifo_win_update(const iis2dulpx_fifo_mode_t *fmd, const uint8_t *buff,
+                                  uint16_t num, iis2dulpx_fifo_win_t *win)
+{
+  iis2dulpx_fifo_data_out_tag_t fifo_tag;
+  const uint8_t *raw;
+  int16_t xl[2][3];
+  int16_t aux;
+  uint16_t rec;
+
+  for (rec = 0U; rec < num; rec++)
+  {
+    (void)memcpy(&fifo_tag, &buff[rec * IIS2DULPX_FIFO_RECORD_LEN], 1);
+    raw = &buff[(rec * IIS2DULPX_FIFO_RECORD_LEN) + 1U];
+
+    switch (fifo_tag.tag_sensor)
+    {
+      case (uint8_t)IIS2DULPX_XL_ONLY_2X_TAG:
+      case (uint8_t)IIS2DULPX_XL_ONLY_2X_TAG_2ND:
+        iis2dulpx_fifo_unpack_2x(raw, xl[0], xl[1]);
+        iis2dulpx_fifo_win_add(win, xl[0]);
+        iis2dulpx_fifo_win_add(win, xl[1]);
+        break;
+      case (uint8_t)IIS2DULPX_XL_AND_QVAR:
+      case (uint8_t)IIS2DULPX_XL_TEMP_TAG:
+        if (fmd->xl_only == 0x0U)
+        {
+          iis2dulpx_fifo_unpack_12bit(raw, xl[0], &aux);
+        }
+        else
+        {
+          iis2dulpx_fifo_unpack_16bit(raw, xl[0]);
+        }
+        iis2dulpx_fifo_win_add(win, xl[0]);
+        break;
+      default:
+        /* not an accelerometer record */
+        break;
+    }
+  }
+
+  return 0;
+}
+
+/* integer square root, rounded down */
+static uint64_t iis2dulpx_isqrt(uint64_t val)
+{
+  uint64_t rem = val;
+  uint64_t res = 0;
+  uint64_t bit = (uint64_t)1U << 62;
+
+  while (bit > rem)
+  {
+    bit >>= 2;
+  }
+
+  while (bit != 0U)
+  {
+    if (rem >= (res + bit))
+    {
+      rem -= res + bit;
+      res = (res >> 1) + bit;
+    }
+    else
+    {
+      res >>= 1;
+    }
+    bit >>= 2;
+  }
+
+  return res;
+}
+
+int32_t iis2dulpx_fifo_win_features(const iis2dulpx_fifo_win_t *win, iis2dulpx_fs_t fs,
+                                    iis2dulpx_fifo_feat_t *feat)
+{
+  /* ug/LSB, as iis2dulpx_from_fs<fs>_to_mg */
+  static const uint32_t sens[4] = { 61U, 122U, 244U, 488U };
+  uint64_t mean_sq;
+  uint64_t ex2;
+  uint64_t var;
+  int64_t mean;
+  int32_t lo;
+  int32_t hi;
+  uint32_t n = win->num;
+  uint32_t k;
+  uint8_t i;
+
+  (void)memset(feat, 0x00, sizeof(iis2dulpx_fifo_feat_t));
+
+  if ((uint32_t)fs > 3U)
+  {
+    return -1;
+  }
+
+  k = sens[fs];
+  feat->num = n;
+  if (n == 0U)
+  {
+    return 0;
+  }
+
+  for (i = 0U; i < 3U; i++)
+  {
+    /* mean in LSB / 2^8, mean square in LSB^2 / 2^16 */
+    mean = (win->sum[i] * 256) / (int64_t)n;
+    ex2 = ((win->sum_sq[i] / n) << 16) + (((win->sum_sq[i] % n) << 16) / n);
+    mean_sq = (uint64_t)(mean * mean);
+    var = (ex2 > mean_sq) ? (ex2 - mean_sq) : 0U;
+
+    feat->mean[i] = (int32_t)((mean * (int64_t)k) / 256);
+    feat->rms[i] = (uint32_t)((iis2dulpx_isqrt(ex2) * k) >> 8);
+    feat->var[i] = (((var >> 8) * k) * k) >> 8;
+
+    lo = (win->min[i] < 0) ? -(int32_t)win->min[i] : (int32_t)win->min[i];
+    hi = (win->max[i] < 0) ? -(int32_t)win->max[i] : (int32_t)win->max[i];
+    feat->peak[i] = (uint32_t)((lo > hi) ? lo : hi) * k;
+  }
+
+  return 0;
+}
+
+int32_t iis2dulpx_fifo_ring_init(iis2dulpx_fifo_ring_t *ring, uint8_t *buff, uint16_t size)
+{
+  if ((buff == NULL) || (size == 0U) || (size > (0xFFFFU / IIS2DULPX_FIFO_RECORD_LEN)))
+  {
+    return -1;
+  }
+
+  ring->buff = buff;
+  ring->size = size;
+  ring->head = 0;
+  ring->tail = 0;
+  ring->count = 0;
+
+  return 0;
+}
+
+int32_t iis2dulpx_fifo_ring_drain(const stmdev_ctx_t *ctx, iis2dulpx_fifo_ring_t *ring,
+                                  uint16_t *num)
+{
+  uint16_t level = 0;
+  uint16_t first = 0;
+  int32_t ret = 0;
+
+  *num = 0;
+
+  ret = iis2dulpx_fifo_data_level_get(ctx, &level);
+  if (ret != 0)
+  {
+    return ret;
+  }
+
+  if (level > (ring->size - ring->count))
+  {
+    level = ring->size - ring->count;
+  }
+
+  /* records never straddle the end: at most two bursts on wrap */
+  first = ring->size - ring->head;
+  if (first > level)
+  {
+    first = level;
+  }
+
+  ret = iis2dulpx_fifo_out_raw_batch_get(ctx, &ring->buff[ring->head * IIS2DULPX_FIFO_RECORD_LEN],
+                                         first);
+  if ((ret == 0) && (level > first))
+  {
+    ret = iis2dulpx_fifo_out_raw_batch_get(ctx, ring->buff, level - first);
+  }
+
+  if (ret != 0)
+  {
+    return ret;
+  }
+
+  ring->head = (uint16_t)((ring->head + level) % ring->size);
+  ring->count += level;
+  *num = level;
+
+  return ret;
+}
+
+int32_t iis2dulpx_fifo_ring_peek(const iis2dulpx_fifo_ring_t *ring, const uint8_t **raw,
+                                 uint16_t *num)
+{
+  uint16_t n = ring->size - ring->tail;
+
+  if (n > ring->count)
+  {
+    n = ring->count;
+  }
+
+  *raw = &ring->buff[ring->tail * IIS2DULPX_FIFO_RECORD_LEN];
+  *num = n;
+
+  return 0;
+}
+
+int32_t iis2dulpx_fifo_ring_release(iis2dulpx_fifo_ring_t *ring, uint16_t num)
+{
+  if (num > ring->count)
+  {
+    return -1;
+  }
+
+  ring->tail = (uint16_t)((ring->tail + num) % ring->size);
+  ring->count -= num;
+
+  return 0;
+}
+
+void iis2dulpx_fifo_iter_init(iis2dulpx_fifo_iter_t *it, const iis2dulpx_fifo_ring_t *ring)
+{
+  it->ring = ring;
+  it->pos = ring->tail;
+  it->left = ring->count;
+  it->rec = NULL;
+}
+
+const uint8_t *iis2dulpx_fifo_iter_next(iis2dulpx_fifo_iter_t *it)
+{
+  if (it->left == 0U)
+  {
+    it->rec = NULL;
+  }
+  else
+  {
+    it->rec = &it->ring->buff[it->pos * IIS2DULPX_FIFO_RECORD_LEN];
+    it->pos = (uint16_t)((it->pos + 1U) % it->ring->size);
+    it->left--;
+  }
+
+  return it->rec;
+}
+
+int32_t iis2dulpx_fifo_iter_decode(const iis2dulpx_fifo_iter_t *it, const iis2dulpx_md_t *md,
+                                   const iis2dulpx_fifo_mode_t *fmd, iis2dulpx_fifo_data_t *data)
+{
+  if (it->rec == NULL)
+  {
+    return -1;
+  }
+
+  return iis2dulpx_fifo_data_decode(md, fmd, it->rec, data);
+}
+
+int32_t iis2dulpx_ah_qvar_mode_set(const stmdev_ctx_t *ctx,
+                                   iis2dulpx_ah_qvar_mode_t val)
+{
+  iis2dulpx_ah_qvar_cfg_t ah_qvar_cfg = {0};
+  int32_t ret = 0;
+
+  ret = iis2dulpx_shadow_read(ctx, IIS2DULPX_AH_QVAR_CFG, (uint8_t *)&ah_qvar_cfg);
+  if (ret == 0)
+  {
+    ah_qvar_cfg.ah_qvar_gain = (uint8_t)val.ah_qvar_gain & 0x03U;
+    ah_qvar_cfg.ah_qvar_c_zin = (uint8_t)val.ah_qvar_zin & 0x03U;
+    ah_qvar_cfg.ah_qvar_notch_cutoff = (uint8_t)val.ah_qvar_notch & 0x01U;
+    ah_qvar_cfg.ah_qvar_notch_en = val.ah_qvar_notch_en & 0x01U;
+    ah_qvar_cfg.ah_qvar_en = val.ah_qvar_en & 0x01U;
+    ret = iis2dulpx_shadow_write(ctx, IIS2DULPX_AH_QVAR_CFG, (uint8_t *)&ah_qvar_cfg);
+  }
+
+  return ret;
+}
+
+int32_t iis2dulpx_ah_qvar_mode_get(const stmdev_ctx_t *ctx,
+                                   iis2dulpx_ah_qvar_mode_t *val)
+{
+  iis2dulpx_ah_qvar_cfg_t ah_qvar_cfg = {0};
+  int32_t ret = 0;
+
+  ret = iis2dulpx_read_reg(ctx, IIS2DULPX_AH_QVAR_CFG, (uint8_t *)&ah_qvar_cfg, 1);
+  if (ret != 0)
+  {
+    return ret;
+  }
+
+  switch (ah_qvar_cfg.ah_qvar_gain)
+  {
+    case 0x0:
+      val->ah_qvar_gain = IIS2DULPX_GAIN_0_5;
+      break;
+
+    case 0x1:
+      val->ah_qvar_gain = IIS2DULPX_GAIN_1;
+      break;
+
+    case 0x2:
+      val->ah_qvar_gain = IIS2DULPX_GAIN_2;
+      break;
+
+    case 0x3:
+    default:
+      val->ah_qvar_gain = IIS2DULPX_GAIN_4;
+      break;
+  }
+
+  switch (ah_qvar_cfg.ah_qvar_c_zin)
+  {
+    case 0x0:
+      val->ah_qvar_zin = IIS2DULPX_520MOhm;
+      break;
+
+    case 0x1:
+      val->ah_qvar_zin = IIS2DULPX_175MOhm;
+      break;
+
+    case 0x2:
+      val->ah_qvar_zin = IIS2DULPX_310MOhm;
+      break;
+
+    case 0x3:
+    default:
+      val->ah_qvar_zin = IIS2DULPX_75MOhm;
+      break;
+  }
+
+  switch (ah_qvar_cfg.ah_qvar_notch_cutoff)
+  {
+    case 0x0:
+      val->ah_qvar_notch = IIS2DULPX_NOTCH_50HZ;
+      break;
+
+    case 0x1:
+    default:
+      val->ah_qvar_notch = IIS2DULPX_NOTCH_60HZ;
+      break;
+  }
+
+  val->ah_qvar_notch_en = ah_qvar_cfg.ah_qvar_notch_en;
+  val->ah_qvar_en = ah_qvar_cfg.ah_qvar_en;
+
+  return ret;
+}
+
+int32_t iis2dulpx_stpcnt_mode_set(const stmdev_ctx_t *ctx, iis2dulpx_stpcnt_mode_t val)
+{
+  iis2dulpx_emb_func_en_a_t emb_func_en_a = {0};
+  iis2dulpx_emb_func_en_b_t emb_func_en_b = {0};
+  iis2dulpx_emb_func_fifo_en_t emb_func_fifo_en = {0};
+  iis2dulpx_pedo_cmd_reg_t pedo_cmd_reg = {0};
+  int32_t ret = 0;
+
+  ret = iis2dulpx_mem_bank_set(ctx, IIS2DULPX_EMBED_FUNC_MEM_BANK);
+  ret += iis2dulpx_read_reg(ctx, IIS2DULPX_EMB_FUNC_EN_A, (uint8_t *)&emb_func_en_a, 1);
+  ret += iis2dulpx_read_reg(ctx, IIS2DULPX_EMB_FUNC_EN_B, (uint8_t *)&emb_func_en_b, 1);
+  ret += iis2dulpx_read_reg(ctx, IIS2DULPX_EMB_FUNC_FIFO_EN, (uint8_t *)&emb_func_fifo_en, 1);
+
+  if (ret == 0)
+  {
+    if ((val.false_step_rej == PROPERTY_ENABLE)
+        && ((emb_func_en_a.mlc_before_fsm_en & emb_func_en_b.mlc_en) == PROPERTY_DISABLE))
+    {
+      emb_func_en_a.mlc_before_fsm_en = PROPERTY_ENABLE;
+    }
+
+    emb_func_fifo_en.step_counter_fifo_en = val.step_counter_in_fifo;
+    ret += iis2dulpx_write_reg(ctx, IIS2DULPX_EMB_FUNC_FIFO_EN, (uint8_t *)&emb_func_fifo_en, 1);
+
+    emb_func_en_a.pedo_en = val.step_counter_enable;
+    ret += iis2dulpx_write_reg(ctx, IIS2DULPX_EMB_FUNC_EN_A, (uint8_t *)&emb_func_en_a, 1);
+  }
+
+  ret += iis2dulpx_mem_bank_set(ctx, IIS2DULPX_MAIN_MEM_BANK);
+
+  ret += iis2dulpx_ln_pg_read(ctx, IIS2DULPX_EMB_ADV_PG_0 + IIS2DULPX_PEDO_CMD_REG,
+                              (uint8_t *)&pedo_cmd_reg, 1);
+
+  if (ret == 0)
+  {
+    pedo_cmd_reg.fp_rejection_en = val.false_step_rej;
+    ret += iis2dulpx_ln_pg_write(ctx, IIS2DULPX_EMB_ADV_PG_0 + IIS2DULPX_PEDO_CMD_REG,
+                                 (uint8_t *)&pedo_cmd_reg, 1);
+  }
+
+  return ret;
+}
+
+int32_t iis2dulpx_stpcnt_mode_get(const stmdev_ctx_t *ctx, iis2dulpx_stpcnt_mode_t *val)
+{
+  iis2dulpx_emb_func_en_a_t emb_func_en_a = {0};
+  iis2dulpx_emb_func_fifo_en_t emb_func_fifo_en = {0};
+  iis2dulpx_pedo_cmd_reg_t pedo_cmd_reg = {0};
+  int32_t ret = 0;
+
+  ret = iis2dulpx_mem_bank_set(ctx, IIS2DULPX_EMBED_FUNC_MEM_BANK);
+  ret += iis2dulpx_read_reg(ctx, IIS2DULPX_EMB_FUNC_EN_A, (uint8_t *)&emb_func_en_a, 1);
+  ret += iis2dulpx_read_reg(ctx, IIS2DULPX_EMB_FUNC_FIFO_EN, (uint8_t *)&emb_func_fifo_en, 1);
+  ret += iis2dulpx_mem_bank_set(ctx, IIS2DULPX_MAIN_MEM_BANK);
+
+  ret += iis2dulpx_ln_pg_read(ctx, IIS2DULPX_EMB_ADV_PG_0 + IIS2DULPX_PEDO_CMD_REG,
+                              (uint8_t *)&pedo_cmd_reg, 1);
+
+  if (ret == 0)
+  {
+    val->false_step_rej = pedo_cmd_reg.fp_rejection_en;
+    val->step_counter_enable = emb_func_en_a.pedo_en;
+    val->step_counter_in_fifo = emb_func_fifo_en.step_counter_fifo_en;
+  }
+
+  return ret;
+}
+
+int32_t iis2dulpx_stpcnt_steps_get(const stmdev_ctx_t *ctx, uint16_t *val)
+{
+  uint8_t buff[2] = {0};
+  int32_t ret = 0;
+
+  ret = iis2dulpx_mem_bank_set(ctx, IIS2DULPX_EMBED_FUNC_MEM_BANK);
+  ret += iis2dulpx_read_reg(ctx, IIS2DULPX_STEP_COUNTER_L, &buff[0], 2);
+  ret += iis2dulpx_mem_bank_set(ctx, IIS2DULPX_MAIN_MEM_BANK);
+
+  if (ret == 0)
+  {
+    *val = (uint16_t)(buff[0] | ((uint16_t)buff[1] << 8));
+  }
+
+  return ret;
+}
+
+int32_t iis2dulpx_stpcnt_rst_step_set(const stmdev_ctx_t *ctx)
+{
+  iis2dulpx_emb_func_src_t emb_func_src = {0};
+  int32_t ret = 0;
+
+  ret = iis2dulpx_mem_bank_set(ctx, IIS2DULPX_EMBED_FUNC_MEM_BANK);
+  if (ret == 0)
+  {
+    ret = iis2dulpx_read_reg(ctx, IIS2DULPX_EMB_FUNC_SRC, (uint8_t *)&emb_func_src, 1);
+  }
+  if (ret == 0)
+  {
+    emb_func_src.pedo_rst_step = 1;
+    ret += iis2dulpx_write_reg(ctx, IIS2DULPX_EMB_FUNC_SRC, (uint8_t *)&emb_func_src, 1);
+  }
+
+  ret += iis2dulpx_mem_bank_set(ctx, IIS2DULPX_MAIN_MEM_BANK);
+
+  return ret;
+}
+
+int32_t iis2dulpx_stpcnt_debounce_set(const stmdev_ctx_t *ctx, uint8_t val)
+{
+  iis2dulpx_pedo_deb_steps_conf_t pedo_deb_steps_conf = {0};
+  int32_t ret = 0;
+
+  pedo_deb_steps_conf.deb_step = val;
+  ret = iis2dulpx_ln_pg_write(ctx, IIS2DULPX_EMB_ADV_PG_0 + IIS2DULPX_PEDO_DEB_STEPS_CONF,
+                              (uint8_t *)&pedo_deb_steps_conf, 1);
+
+  return ret;
+}
+
+int32_t iis2dulpx_stpcnt_debounce_get(const stmdev_ctx_t *ctx, uint8_t *val)
+{
+  iis2dulpx_pedo_deb_steps_conf_t pedo_deb_steps_conf = {0};
+  int32_t ret = 0;
+
+  ret = iis2dulpx_ln_pg_read(ctx, IIS2DULPX_EMB_ADV_PG_0 + IIS2DULPX_PEDO_DEB_STEPS_CONF,
+                             (uint8_t *)&pedo_deb_steps_conf, 1);
+  if (ret == 0)
+  {
+    *val = pedo_deb_steps_conf.deb_step;
+  }
+
+  return ret;
+}
+
+int32_t iis2dulpx_stpcnt_period_set(const stmdev_ctx_t *ctx, uint16_t val)
+{
+  uint8_t buff[2] = {0};
+  int32_t ret = 0;
+
+  buff[1] = (uint8_t)(val / 256U);
+  buff[0] = (uint8_t)(val - (buff[1] * 256U));
+
+  ret = iis2dulpx_ln_pg_write(ctx, IIS2DULPX_EMB_ADV_PG_0 + IIS2DULPX_PEDO_SC_DELTAT_L,
+                              (uint8_t *)buff, 2);
+
+  return ret;
+}
+
+int32_t iis2dulpx_stpcnt_period_get(const stmdev_ctx_t *ctx, uint16_t *val)
+{
+  uint8_t buff[2] = {0};
+  int32_t ret = 0;
+
+  ret = iis2dulpx_ln_pg_read(ctx, IIS2DULPX_EMB_ADV_PG_0 + IIS2DULPX_PEDO_SC_DELTAT_L,
+                             (uint8_t *)buff, 2);
+  if (ret == 0)
+  {
+    *val = (uint16_t)(buff[0] | ((uint16_t)buff[1] << 8));
+  }
+
+  return ret;
+}
+
+int32_t iis2dulpx_smart_power_set(const stmdev_ctx_t *ctx, iis2dulpx_smart_power_cfg_t val)
+{
+  iis2dulpx_ctrl1_t ctrl1 = {0};
+  iis2dulpx_smart_power_ctrl_t smart_power_ctrl = {0};
+  int32_t ret = 0;
+
+  ret = iis2dulpx_shadow_read(ctx, IIS2DULPX_CTRL1, (uint8_t *)&ctrl1);
+  if (ret != 0)
+  {
+    return ret;
+  }
+  ctrl1.smart_power_en = val.enable;
+  ret += iis2dulpx_shadow_write(ctx, IIS2DULPX_CTRL1, (uint8_t *)&ctrl1);
+
+  if (val.enable == 0U)
+  {
+    /* if disabling smart_power no need to set win/dur fields */
+    return ret;
+  }
+
+  smart_power_ctrl.smart_power_ctrl_win = val.window;
+  smart_power_ctrl.smart_power_ctrl_dur = val.duration;
+  ret += iis2dulpx_ln_pg_write(ctx, IIS2DULPX_EMB_ADV_PG_0 + IIS2DULPX_SMART_POWER_CTRL,
+                               (uint8_t *)&smart_power_ctrl, 1);
+
+  return ret;
+}
+
+int32_t iis2dulpx_smart_power_get(const stmdev_ctx_t *ctx, iis2dulpx_smart_power_cfg_t *val)
+{
+  iis2dulpx_ctrl1_t ctrl1 = {0};
+  iis2dulpx_smart_power_ctrl_t smart_power_ctrl = {0};
+  int32_t ret = 0;
+
+  ret = iis2dulpx_read_reg(ctx, IIS2DULPX_CTRL1, (uint8_t *)&ctrl1, 1);
+
+  ret += iis2dulpx_ln_pg_read(ctx, IIS2DULPX_EMB_ADV_PG_0 + IIS2DULPX_SMART_POWER_CTRL,
+                              (uint8_t *)&smart_power_ctrl, 1);
+
+  if (ret == 0)
+  {
+    val->enable = ctrl1.smart_power_en;
+    val->window = smart_power_ctrl.smart_power_ctrl_win;
+    val->duration = smart_power_ctrl.smart_power_ctrl_dur;
+  }
+
+  return ret;
+}
+
+int32_t iis2dulpx_tilt_mode_set(const stmdev_ctx_t *ctx, uint8_t val)
+{
+  iis2dulpx_emb_func_en_a_t emb_func_en_a = {0};
+  int32_t ret = 0;
+
+  ret = iis2dulpx_mem_bank_set(ctx, IIS2DULPX_EMBED_FUNC_MEM_BANK);
+  ret += iis2dulpx_read_reg(ctx, IIS2DULPX_EMB_FUNC_EN_A, (uint8_t *)&emb_func_en_a, 1);
+  if (ret == 0)
+  {
+    emb_func_en_a.tilt_en = val & 0x01U;
+    ret += iis2dulpx_write_reg(ctx, IIS2DULPX_EMB_FUNC_EN_A, (uint8_t *)&emb_func_en_a, 1);
+  }
+
+  ret += iis2dulpx_mem_bank_set(ctx, IIS2DULPX_MAIN_MEM_BANK);
+
+  return ret;
+}
+
+int32_t iis2dulpx_tilt_mode_get(const stmdev_ctx_t *ctx, uint8_t *val)
+{
+  iis2dulpx_emb_func_en_a_t emb_func_en_a = {0};
+  int32_t ret = 0;
+
+  ret = iis2dulpx_mem_bank_set(ctx, IIS2DULPX_EMBED_FUNC_MEM_BANK);
+  ret += iis2dulpx_read_reg(ctx, IIS2DULPX_EMB_FUNC_EN_A, (uint8_t *)&emb_func_en_a, 1);
+  if (ret == 0)
+  {
+    *val = emb_func_en_a.tilt_en;
+  }
+
+  ret += iis2dulpx_mem_bank_set(ctx, IIS2DULPX_MAIN_MEM_BANK);
+
+  return ret;
+}
+
+int32_t iis2dulpx_sigmot_mode_set(const stmdev_ctx_t *ctx, uint8_t val)
+{
+  iis2dulpx_emb_func_en_a_t emb_func_en_a = {0};
+  int32_t ret = 0;
+
+  ret = iis2dulpx_mem_bank_set(ctx, IIS2DULPX_EMBED_FUNC_MEM_BANK);
+  ret += iis2dulpx_read_reg(ctx, IIS2DULPX_EMB_FUNC_EN_A, (uint8_t *)&emb_func_en_a, 1);
+  if (ret == 0)
+  {
+    emb_func_en_a.sign_motion_en = val & 0x01U;
+    ret += iis2dulpx_write_reg(ctx, IIS2DULPX_EMB_FUNC_EN_A, (uint8_t *)&emb_func_en_a, 1);
+  }
+
+  ret += iis2dulpx_mem_bank_set(ctx, IIS2DULPX_MAIN_MEM_BANK);
+
+  return ret;
+}
+
+int32_t iis2dulpx_sigmot_mode_get(const stmdev_ctx_t *ctx, uint8_t *val)
+{
+  iis2dulpx_emb_func_en_a_t emb_func_en_a = {0};
+  int32_t ret = 0;
+
+  ret = iis2dulpx_mem_bank_set(ctx, IIS2DULPX_EMBED_FUNC_MEM_BANK);
+  ret += iis2dulpx_read_reg(ctx, IIS2DULPX_EMB_FUNC_EN_A, (uint8_t *)&emb_func_en_a, 1);
+  if (ret == 0)
+  {
+    *val = emb_func_en_a.sign_motion_en;
+  }
+
+  ret += iis2dulpx_mem_bank_set(ctx, IIS2DULPX_MAIN_MEM_BANK);
+
+  return ret;
+}
+
+int32_t iis2dulpx_ff_duration_set(const stmdev_ctx_t *ctx, uint8_t val)
+{
+  iis2dulpx_wake_up_dur_t wake_up_dur = {0};
+  iis2dulpx_free_fall_t free_fall = {0};
+  int32_t ret = 0;
+
+  ret = iis2dulpx_shadow_read(ctx, IIS2DULPX_WAKE_UP_DUR, (uint8_t *)&wake_up_dur);
+
+  if (ret == 0)
+  {
+    wake_up_dur.ff_dur = (val >> 5) & 0x1U;
+    ret = iis2dulpx_shadow_write(ctx, IIS2DULPX_WAKE_UP_DUR, (uint8_t *)&wake_up_dur);
+  }
+
+  ret += iis2dulpx_shadow_read(ctx, IIS2DULPX_FREE_FALL, (uint8_t *)&free_fall);
+  if (ret == 0)
+  {
+    free_fall.ff_dur = val & 0x1FU;
+    ret += iis2dulpx_shadow_write(ctx, IIS2DULPX_FREE_FALL, (uint8_t *)&free_fall);
+  }
+
+  return ret;
+}
+
+int32_t iis2dulpx_ff_duration_get(const stmdev_ctx_t *ctx, uint8_t *val)
+{
+  iis2dulpx_wake_up_dur_t wake_up_dur = {0};
+  iis2dulpx_free_fall_t free_fall = {0};
+  int32_t ret = 0;
+
+  ret = iis2dulpx_read_reg(ctx, IIS2DULPX_WAKE_UP_DUR, (uint8_t *)&wake_up_dur, 1);
+  ret += iis2dulpx_read_reg(ctx, IIS2DULPX_FREE_FALL, (uint8_t *)&free_fall, 1);
+
+  if (ret == 0)
+  {
+    *val = (uint8_t)((wake_up_dur.ff_dur << 5) | free_fall.ff_dur);
+  }
+
+  return ret;
+}
+
+int32_t iis2dulpx_ff_thresholds_set(const stmdev_ctx_t *ctx, iis2dulpx_ff_thresholds_t val)
+{
+  iis2dulpx_free_fall_t free_fall = {0};
+  int32_t ret = 0;
+
+  ret = iis2dulpx_shadow_read(ctx, IIS2DULPX_FREE_FALL, (uint8_t *)&free_fall);
+  if (ret == 0)
+  {
+    free_fall.ff_ths = ((uint8_t)val & 0x7U);
+    ret += iis2dulpx_shadow_write(ctx, IIS2DULPX_FREE_FALL, (uint8_t *)&free_fall);
+  }
+
+  return ret;
+}
+
+int32_t iis2dulpx_ff_thresholds_get(const stmdev_ctx_t *ctx, iis2dulpx_ff_thresholds_t *val)
+{
+  iis2dulpx_free_fall_t free_fall = {0};
+  int32_t ret = 0;
+
+  ret = iis2dulpx_read_reg(ctx, IIS2DULPX_FREE_FALL, (uint8_t *)&free_fall, 1);
+
+  if (ret != 0)
+  {
+    return ret;
+  }
+
+  switch (free_fall.ff_ths)
+  {
+    case 0x0:
+      *val = IIS2DULPX_156_mg;
+      break;
+
+    case 0x1:
+      *val = IIS2DULPX_219_mg;
+      break;
 
-  switch (i3c_cfg.bus_act_sel)
-  {
-    case 0x00:
-      val->bus_act_sel = IIS2DULPX_I3C_BUS_AVAIL_TIME_20US;
+    case 0x2:
+      *val = IIS2DULPX_250_mg;
       break;
 
-    case 0x01:
-      val->bus_act_sel = IIS2DULPX_I3C_BUS_AVAIL_TIME_50US;
+    case 0x3:
+      *val = IIS2DULPX_312_mg;
       break;
 
-    case 0x02:
-      val->bus_act_sel = IIS2DULPX_I3C_BUS_AVAIL_TIME_1MS;
+    case 0x4:
+      *val = IIS2DULPX_344_mg;
+      break;
+
+    case 0x5:
+      *val = IIS2DULPX_406_mg;
+      break;
+
+    case 0x6:
+      *val = IIS2DULPX_469_mg;
+      break;
+
+    case 0x7:
+      *val = IIS2DULPX_500_mg;
       break;
 
-    case 0x03:
     default:
-      val->bus_act_sel = IIS2DULPX_I3C_BUS_AVAIL_TIME_25MS;
+      *val = IIS2DULPX_156_mg;
       break;
   }
-
   return ret;
 }
 
-int32_t iis2dulpx_mem_bank_set(const stmdev_ctx_t *ctx, iis2dulpx_mem_bank_t val)
+int32_t iis2dulpx_sixd_config_set(const stmdev_ctx_t *ctx, iis2dulpx_sixd_config_t val)
 {
-  iis2dulpx_func_cfg_access_t func_cfg_access = {0};
+  iis2dulpx_sixd_t sixd = {0};
   int32_t ret = 0;
 
-  if (ctx->priv_data == NULL)
-  {
-    ret = -1;
-    goto exit;
-  }
-
-  /* init from saved register */
-  func_cfg_access = ((iis2dulpx_priv_t *)ctx->priv_data)->func_cfg_access_main;
-
-  if (func_cfg_access.emb_func_reg_access == 0U)
-  {
-    /* MAIN page */
-    ret = iis2dulpx_read_reg(ctx, IIS2DULPX_FUNC_CFG_ACCESS, (uint8_t *)&func_cfg_access, 1);
-  }
+  ret = iis2dulpx_shadow_read(ctx, IIS2DULPX_SIXD, (uint8_t *)&sixd);
 
   if (ret == 0)
   {
-    func_cfg_access.emb_func_reg_access = ((uint8_t)val & 0x1U);
-    ret = iis2dulpx_write_reg(ctx, IIS2DULPX_FUNC_CFG_ACCESS, (uint8_t *)&func_cfg_access, 1);
-
-    if (ret == 0)
-    {
-      /* save register in private data */
-      ((iis2dulpx_priv_t *)ctx->priv_data)->func_cfg_access_main = func_cfg_access;
-    }
+    sixd.d4d_en = ((uint8_t)val.mode) & 0x01U;
+    sixd.d6d_ths = ((uint8_t)val.threshold) & 0x03U;
+    ret = iis2dulpx_shadow_write(ctx, IIS2DULPX_SIXD, (uint8_t *)&sixd);
   }
 
-exit:
   return ret;
 }
 
-int32_t iis2dulpx_mem_bank_get(const stmdev_ctx_t *ctx, iis2dulpx_mem_bank_t *val)
+int32_t iis2dulpx_sixd_config_get(const stmdev_ctx_t *ctx, iis2dulpx_sixd_config_t *val)
 {
-  iis2dulpx_func_cfg_access_t func_cfg_access = {0};
+  iis2dulpx_sixd_t sixd = {0};
   int32_t ret = 0;
 
-  if (ctx->priv_data == NULL)
+  ret = iis2dulpx_read_reg(ctx, IIS2DULPX_SIXD, (uint8_t *)&sixd, 1);
+  if (ret != 0)
   {
-    ret = -1;
-    goto exit;
+    return ret;
   }
 
-  /* init from saved register */
-  func_cfg_access = ((iis2dulpx_priv_t *)ctx->priv_data)->func_cfg_access_main;
-
-  if (func_cfg_access.emb_func_reg_access == 0U)
-  {
-    /* MAIN page */
-    ret = iis2dulpx_read_reg(ctx, IIS2DULPX_FUNC_CFG_ACCESS, (uint8_t *)&func_cfg_access, 1);
-    if (ret != 0)
-    {
-      goto exit;
-    }
-
-    /* save register in private data */
-    ((iis2dulpx_priv_t *)ctx->priv_data)->func_cfg_access_main = func_cfg_access;
-  }
+  val->mode = (iis2dulpx_mode_t)sixd.d4d_en;
 
-  switch ((func_cfg_access.emb_func_reg_access))
+  switch ((sixd.d6d_ths))
   {
     case 0x0:
-      *val = IIS2DULPX_MAIN_MEM_BANK;
+      val->threshold = IIS2DULPX_DEG_80;
       break;
 
     case 0x1:
-      *val = IIS2DULPX_EMBED_FUNC_MEM_BANK;
+      val->threshold = IIS2DULPX_DEG_70;
+      break;
+
+    case 0x2:
+      val->threshold = IIS2DULPX_DEG_60;
+      break;
+
+    case 0x3:
+      val->threshold = IIS2DULPX_DEG_50;
       break;
 
     default:
-      *val = IIS2DULPX_MAIN_MEM_BANK;
+      val->threshold = IIS2DULPX_DEG_80;
       break;
   }
 
-exit:
   return ret;
 }
 
-int32_t iis2dulpx_fsm_wr_ctrl_en_set(const stmdev_ctx_t *ctx, uint8_t val)
+int32_t iis2dulpx_wakeup_config_set(const stmdev_ctx_t *ctx, iis2dulpx_wakeup_config_t val)
 {
-  iis2dulpx_func_cfg_access_t func_cfg_access = {0};
+  iis2dulpx_wake_up_ths_t wup_ths = {0};
+  iis2dulpx_wake_up_dur_t wup_dur = {0};
+  iis2dulpx_wake_up_dur_ext_t wup_dur_ext = {0};
+  iis2dulpx_interrupt_cfg_t int_cfg = {0};
+  iis2dulpx_ctrl1_t ctrl1 = {0};
+  iis2dulpx_ctrl4_t ctrl4 = {0};
+  iis2dulpx_txn_t txn;
   int32_t ret = 0;
 
-  if (ctx->priv_data == NULL)
-  {
-    ret = -1;
-    goto exit;
-  }
-
-  /* init from saved register */
-  func_cfg_access = ((iis2dulpx_priv_t *)ctx->priv_data)->func_cfg_access_main;
-
-  if (func_cfg_access.emb_func_reg_access == 0U)
-  {
-    /* MAIN page */
-    ret = iis2dulpx_read_reg(ctx, IIS2DULPX_FUNC_CFG_ACCESS, (uint8_t *)&func_cfg_access, 1);
-  }
+  iis2dulpx_txn_init(&txn, ctx);
+  ret = iis2dulpx_txn_shadow_read(&txn, IIS2DULPX_WAKE_UP_THS, (uint8_t *)&wup_ths);
+  ret += iis2dulpx_txn_shadow_read(&txn, IIS2DULPX_WAKE_UP_DUR, (uint8_t *)&wup_dur);
+  ret += iis2dulpx_txn_shadow_read(&txn, IIS2DULPX_WAKE_UP_DUR_EXT, (uint8_t *)&wup_dur_ext);
+  ret += iis2dulpx_txn_shadow_read(&txn, IIS2DULPX_INTERRUPT_CFG, (uint8_t *)&int_cfg);
+  ret += iis2dulpx_txn_shadow_read(&txn, IIS2DULPX_CTRL1, (uint8_t *)&ctrl1);
+  ret += iis2dulpx_txn_shadow_read(&txn, IIS2DULPX_CTRL4, (uint8_t *)&ctrl4);
+  ret += iis2dulpx_txn_run(&txn);
 
   if (ret == 0)
   {
-    func_cfg_access.fsm_wr_ctrl_en = ((uint8_t)val & 0x1U);
-    ret = iis2dulpx_write_reg(ctx, IIS2DULPX_FUNC_CFG_ACCESS, (uint8_t *)&func_cfg_access, 1);
+    wup_dur.wake_dur = (uint8_t)val.wake_dur & 0x3U;
+    wup_dur_ext.wu_dur_extended = ((uint8_t)val.wake_dur >> 4) & 0x01U;
+    wup_dur.sleep_dur = val.sleep_dur & 0x0FU;
 
-    if (ret == 0)
+    int_cfg.wake_ths_w = val.wake_ths_weight;
+    wup_ths.wk_ths = val.wake_ths & 0x3FU;
+    wup_ths.sleep_on = (uint8_t)val.wake_enable & 0x01U;
+    ctrl4.inact_odr = (uint8_t)val.inact_odr & 0x03U;
+
+    if (val.wake_enable == IIS2DULPX_SLEEP_ON)
     {
-      /* save register in private data */
-      ((iis2dulpx_priv_t *)ctx->priv_data)->func_cfg_access_main = func_cfg_access;
+      ctrl1.wu_x_en = 1;
+      ctrl1.wu_y_en = 1;
+      ctrl1.wu_z_en = 1;
+    }
+    else
+    {
+      ctrl1.wu_x_en = 0;
+      ctrl1.wu_y_en = 0;
+      ctrl1.wu_z_en = 0;
     }
+
+    ret += iis2dulpx_txn_write(&txn, IIS2DULPX_WAKE_UP_THS, (uint8_t *)&wup_ths, 1);
+    ret += iis2dulpx_txn_write(&txn, IIS2DULPX_WAKE_UP_DUR, (uint8_t *)&wup_dur, 1);
+    ret += iis2dulpx_txn_write(&txn, IIS2DULPX_WAKE_UP_DUR_EXT, (uint8_t *)&wup_dur_ext, 1);
+    ret += iis2dulpx_txn_write(&txn, IIS2DULPX_INTERRUPT_CFG, (uint8_t *)&int_cfg, 1);
+    ret += iis2dulpx_txn_write(&txn, IIS2DULPX_CTRL1, (uint8_t *)&ctrl1, 1);
+    ret += iis2dulpx_txn_write(&txn, IIS2DULPX_CTRL4, (uint8_t *)&ctrl4, 1);
+    ret += iis2dulpx_txn_run(&txn);
   }
 
-exit:
   return ret;
 }
 
-int32_t iis2dulpx_fsm_wr_ctrl_en_get(const stmdev_ctx_t *ctx, uint8_t *val)
+int32_t iis2dulpx_wakeup_config_get(const stmdev_ctx_t *ctx, iis2dulpx_wakeup_config_t *val)
 {
-  iis2dulpx_func_cfg_access_t func_cfg_access = {0};
+  iis2dulpx_wake_up_ths_t wup_ths = {0};
+  iis2dulpx_wake_up_dur_t wup_dur = {0};
+  iis2dulpx_wake_up_dur_ext_t wup_dur_ext = {0};
+  iis2dulpx_interrupt_cfg_t int_cfg = {0};
+  iis2dulpx_ctrl4_t ctrl4 = {0};
   int32_t ret = 0;
 
-  if (ctx->priv_data == NULL)
+  ret = iis2dulpx_read_reg(ctx, IIS2DULPX_WAKE_UP_THS, (uint8_t *)&wup_ths, 1);
+  ret += iis2dulpx_read_reg(ctx, IIS2DULPX_WAKE_UP_DUR, (uint8_t *)&wup_dur, 1);
+  ret += iis2dulpx_read_reg(ctx, IIS2DULPX_WAKE_UP_DUR_EXT, (uint8_t *)&wup_dur_ext, 1);
+  ret += iis2dulpx_read_reg(ctx, IIS2DULPX_INTERRUPT_CFG, (uint8_t *)&int_cfg, 1);
+  ret += iis2dulpx_read_reg(ctx, IIS2DULPX_CTRL4, (uint8_t *)&ctrl4, 1);
+
+  if (ret == 0)
   {
-    ret = -1;
-    goto exit;
+    switch (wup_dur.wake_dur)
+    {
+      case 0x0:
+        val->wake_dur = (wup_dur_ext.wu_dur_extended == 1U) ?
+                        IIS2DULPX_3_ODR : IIS2DULPX_0_ODR;
+        break;
+
+      case 0x1:
+        val->wake_dur = (wup_dur_ext.wu_dur_extended == 1U) ?
+                        IIS2DULPX_7_ODR : IIS2DULPX_1_ODR;
+        break;
+
+      case 0x2:
+        val->wake_dur = (wup_dur_ext.wu_dur_extended == 1U) ?
+                        IIS2DULPX_11_ODR : IIS2DULPX_2_ODR;
+        break;
+
+      case 0x3:
+      default:
+        val->wake_dur = IIS2DULPX_15_ODR;
+        break;
+    }
+
+    val->sleep_dur = wup_dur.sleep_dur;
+
+    val->wake_ths_weight = int_cfg.wake_ths_w;
+    val->wake_ths = wup_ths.wk_ths;
+    val->wake_enable = (iis2dulpx_wake_enable_t)wup_ths.sleep_on;
+    val->inact_odr = (iis2dulpx_inact_odr_t)ctrl4.inact_odr;
   }
 
-  /* init from saved register */
-  func_cfg_access = ((iis2dulpx_priv_t *)ctx->priv_data)->func_cfg_access_main;
+  return ret;
+}
 
-  if (func_cfg_access.emb_func_reg_access == 0U)
+int32_t iis2dulpx_tap_config_set(const stmdev_ctx_t *ctx, iis2dulpx_tap_config_t val)
+{
+  iis2dulpx_tap_cfg0_t tap_cfg0 = {0};
+  iis2dulpx_tap_cfg1_t tap_cfg1 = {0};
+  iis2dulpx_tap_cfg2_t tap_cfg2 = {0};
+  iis2dulpx_tap_cfg3_t tap_cfg3 = {0};
+  iis2dulpx_tap_cfg4_t tap_cfg4 = {0};
+  iis2dulpx_tap_cfg5_t tap_cfg5 = {0};
+  iis2dulpx_tap_cfg6_t tap_cfg6 = {0};
+  iis2dulpx_txn_t txn;
+  int32_t ret = 0;
+
+  iis2dulpx_txn_init(&txn, ctx);
+  ret = iis2dulpx_txn_read(&txn, IIS2DULPX_TAP_CFG0, (uint8_t *)&tap_cfg0, 1);
+  ret += iis2dulpx_txn_read(&txn, IIS2DULPX_TAP_CFG1, (uint8_t *)&tap_cfg1, 1);
+  ret += iis2dulpx_txn_read(&txn, IIS2DULPX_TAP_CFG2, (uint8_t *)&tap_cfg2, 1);
+  ret += iis2dulpx_txn_read(&txn, IIS2DULPX_TAP_CFG3, (uint8_t *)&tap_cfg3, 1);
+  ret += iis2dulpx_txn_read(&txn, IIS2DULPX_TAP_CFG4, (uint8_t *)&tap_cfg4, 1);
+  ret += iis2dulpx_txn_read(&txn, IIS2DULPX_TAP_CFG5, (uint8_t *)&tap_cfg5, 1);
+  ret += iis2dulpx_txn_read(&txn, IIS2DULPX_TAP_CFG6, (uint8_t *)&tap_cfg6, 1);
+  ret += iis2dulpx_txn_run(&txn);
+
+  if (ret == 0)
   {
-    /* MAIN page */
-    ret = iis2dulpx_read_reg(ctx, IIS2DULPX_FUNC_CFG_ACCESS, (uint8_t *)&func_cfg_access, 1);
-    if (ret != 0)
-    {
-      goto exit;
-    }
+    tap_cfg0.axis = (uint8_t)val.axis & 0x03U;
+    tap_cfg0.invert_t = val.inverted_peak_time & 0x1FU;
+    tap_cfg1.pre_still_ths = val.pre_still_ths & 0x0FU;
+    tap_cfg3.post_still_ths = val.post_still_ths & 0x0FU;
+    tap_cfg1.post_still_t = val.post_still_time & 0xFU;
+    tap_cfg2.post_still_t = (val.post_still_time >> 4) & 0x03U;
+    tap_cfg2.wait_t = val.shock_wait_time & 0x3FU;
+    tap_cfg3.latency_t = val.latency & 0x0FU;
+    tap_cfg4.wait_end_latency = val.wait_end_latency & 0x01U;
+    tap_cfg4.peak_ths = val.peak_ths & 0x3FU;
+    tap_cfg5.rebound_t = val.rebound & 0x1FU;
+    tap_cfg5.single_tap_en = val.single_tap_on & 0x01U;
+    tap_cfg5.double_tap_en = val.double_tap_on & 0x01U;
+    tap_cfg5.triple_tap_en = val.triple_tap_on & 0x01U;
+    tap_cfg6.pre_still_st = val.pre_still_start & 0x0FU;
+    tap_cfg6.pre_still_n = val.pre_still_n & 0x0FU;
 
-    /* save register in private data */
-    ((iis2dulpx_priv_t *)ctx->priv_data)->func_cfg_access_main = func_cfg_access;
+    ret += iis2dulpx_txn_write(&txn, IIS2DULPX_TAP_CFG0, (uint8_t *)&tap_cfg0, 1);
+    ret += iis2dulpx_txn_write(&txn, IIS2DULPX_TAP_CFG1, (uint8_t *)&tap_cfg1, 1);
+    ret += iis2dulpx_txn_write(&txn, IIS2DULPX_TAP_CFG2, (uint8_t *)&tap_cfg2, 1);
+    ret += iis2dulpx_txn_write(&txn, IIS2DULPX_TAP_CFG3, (uint8_t *)&tap_cfg3, 1);
+    ret += iis2dulpx_txn_write(&txn, IIS2DULPX_TAP_CFG4, (uint8_t *)&tap_cfg4, 1);
+    ret += iis2dulpx_txn_write(&txn, IIS2DULPX_TAP_CFG5, (uint8_t *)&tap_cfg5, 1);
+    ret += iis2dulpx_txn_write(&txn, IIS2DULPX_TAP_CFG6, (uint8_t *)&tap_cfg6, 1);
+    ret += iis2dulpx_txn_run(&txn);
   }
 
-  *val = func_cfg_access.fsm_wr_ctrl_en;
+  return ret;
+}
+
+int32_t iis2dulpx_tap_config_get(const stmdev_ctx_t *ctx, iis2dulpx_tap_config_t *val)
+{
+  iis2dulpx_tap_cfg0_t tap_cfg0 = {0};
+  iis2dulpx_tap_cfg1_t tap_cfg1 = {0};
+  iis2dulpx_tap_cfg2_t tap_cfg2 = {0};
+  iis2dulpx_tap_cfg3_t tap_cfg3 = {0};
+  iis2dulpx_tap_cfg4_t tap_cfg4 = {0};
+  iis2dulpx_tap_cfg5_t tap_cfg5 = {0};
+  iis2dulpx_tap_cfg6_t tap_cfg6 = {0};
+  iis2dulpx_txn_t txn;
+  int32_t ret = 0;
+
+  iis2dulpx_txn_init(&txn, ctx);
+  ret = iis2dulpx_txn_read(&txn, IIS2DULPX_TAP_CFG0, (uint8_t *)&tap_cfg0, 1);
+  ret += iis2dulpx_txn_read(&txn, IIS2DULPX_TAP_CFG1, (uint8_t *)&tap_cfg1, 1);
+  ret += iis2dulpx_txn_read(&txn, IIS2DULPX_TAP_CFG2, (uint8_t *)&tap_cfg2, 1);
+  ret += iis2dulpx_txn_read(&txn, IIS2DULPX_TAP_CFG3, (uint8_t *)&tap_cfg3, 1);
+  ret += iis2dulpx_txn_read(&txn, IIS2DULPX_TAP_CFG4, (uint8_t *)&tap_cfg4, 1);
+  ret += iis2dulpx_txn_read(&txn, IIS2DULPX_TAP_CFG5, (uint8_t *)&tap_cfg5, 1);
+  ret += iis2dulpx_txn_read(&txn, IIS2DULPX_TAP_CFG6, (uint8_t *)&tap_cfg6, 1);
+  ret += iis2dulpx_txn_run(&txn);
+
+  if (ret == 0)
+  {
+    val->axis = (iis2dulpx_axis_t)tap_cfg0.axis;
+    val->inverted_peak_time = tap_cfg0.invert_t & 0x1FU;
+    val->pre_still_ths = tap_cfg1.pre_still_ths & 0x0FU;
+    val->post_still_ths = tap_cfg3.post_still_ths & 0x0FU;
+    val->post_still_time = (uint8_t)((tap_cfg2.post_still_t << 4) | tap_cfg1.post_still_t) & 0x3FU;
+    val->shock_wait_time = tap_cfg2.wait_t & 0x3FU;
+    val->latency = tap_cfg3.latency_t & 0x0FU;
+    val->wait_end_latency = tap_cfg4.wait_end_latency & 0x01U;
+    val->peak_ths = tap_cfg4.peak_ths & 0x3FU;
+    val->rebound = tap_cfg5.rebound_t & 0x1FU;
+    val->single_tap_on = tap_cfg5.single_tap_en & 0x01U;
+    val->double_tap_on = tap_cfg5.double_tap_en & 0x01U;
+    val->triple_tap_on = tap_cfg5.triple_tap_en & 0x01U;
+    val->pre_still_start = tap_cfg6.pre_still_st & 0x0FU;
+    val->pre_still_n = tap_cfg6.pre_still_n & 0x0FU;
+  }
 
-exit:
   return ret;
 }
 
-int32_t iis2dulpx_ln_pg_write(const stmdev_ctx_t *ctx, uint16_t address, uint8_t *buf, uint8_t len)
+int32_t iis2dulpx_timestamp_set(const stmdev_ctx_t *ctx, uint8_t val)
 {
-  iis2dulpx_page_address_t page_address = {0};
-  iis2dulpx_page_sel_t page_sel = {0};
-  iis2dulpx_page_rw_t page_rw = {0};
-  uint8_t msb = 0;
-  uint8_t lsb = 0;
+  iis2dulpx_interrupt_cfg_t int_cfg = {0};
   int32_t ret = 0;
-  uint8_t i = 0;
-
-  msb = ((uint8_t)(address >> 8) & 0x0FU);
-  lsb = (uint8_t)address & 0xFFU;
 
-  ret = iis2dulpx_mem_bank_set(ctx, IIS2DULPX_EMBED_FUNC_MEM_BANK);
-  if (ret != 0)
-  {
-    goto exit;
-  }
+  ret = iis2dulpx_shadow_read(ctx, IIS2DULPX_INTERRUPT_CFG, (uint8_t *)&int_cfg);
 
-  /* page write */
-  ret = iis2dulpx_read_reg(ctx, IIS2DULPX_PAGE_RW, (uint8_t *)&page_rw, 1);
-  if (ret != 0)
+  if (ret == 0)
   {
-    goto exit;
+    int_cfg.timestamp_en = (uint8_t)val & 0x01U;
+    ret = iis2dulpx_shadow_write(ctx, IIS2DULPX_INTERRUPT_CFG, (uint8_t *)&int_cfg);
   }
-  page_rw.page_read = PROPERTY_DISABLE;
-  page_rw.page_write = PROPERTY_ENABLE;
-  ret += iis2dulpx_write_reg(ctx, IIS2DULPX_PAGE_RW, (uint8_t *)&page_rw, 1);
 
-  /* set page num */
-  ret += iis2dulpx_read_reg(ctx, IIS2DULPX_PAGE_SEL, (uint8_t *)&page_sel, 1);
-  if (ret != 0)
-  {
-    goto exit;
-  }
-  page_sel.page_sel = msb & 0x0FU;
-  page_sel.not_used0 = 1U; // Default value
-  ret += iis2dulpx_write_reg(ctx, IIS2DULPX_PAGE_SEL, (uint8_t *)&page_sel, 1);
+  return ret;
+}
 
-  /* set page addr */
-  page_address.page_addr = lsb;
-  ret += iis2dulpx_write_reg(ctx, IIS2DULPX_PAGE_ADDRESS, (uint8_t *)&page_address, 1);
+int32_t iis2dulpx_timestamp_get(const stmdev_ctx_t *ctx, uint8_t *val)
+{
+  iis2dulpx_interrupt_cfg_t int_cfg = {0};
+  int32_t ret = 0;
 
-  for (i = 0; i < len; i++)
+  ret = iis2dulpx_read_reg(ctx, IIS2DULPX_INTERRUPT_CFG, (uint8_t *)&int_cfg, 1);
+  if (ret == 0)
   {
-    /* read value */
-    ret += iis2dulpx_write_reg(ctx, IIS2DULPX_PAGE_VALUE, &buf[i], 1);
-    lsb++;
-
-    /* Check if page wrap */
-    if (((lsb & 0xFFU) == 0x00U) && (ret == 0))
-    {
-      msb++;
-      ret += iis2dulpx_read_reg(ctx, IIS2DULPX_PAGE_SEL, (uint8_t *)&page_sel, 1);
-      if (ret != 0)
-      {
-        goto exit;
-      }
-      page_sel.page_sel = msb & 0x0FU;
-      page_sel.not_used0 = 1U; // Default value
-      ret += iis2dulpx_write_reg(ctx, IIS2DULPX_PAGE_SEL, (uint8_t *)&page_sel, 1);
-    }
-
-    if (ret != 0)
-    {
-      break;
-    }
+    *val = int_cfg.timestamp_en;
   }
 
-exit:
-  page_sel.page_sel = 0U;
-  page_sel.not_used0 = 1U;// Default value
-  ret += iis2dulpx_write_reg(ctx, IIS2DULPX_PAGE_SEL, (uint8_t *)&page_sel, 1);
-
-  ret += iis2dulpx_read_reg(ctx, IIS2DULPX_PAGE_RW, (uint8_t *)&page_rw, 1);
-  page_rw.page_read = PROPERTY_DISABLE;
-  page_rw.page_write = PROPERTY_DISABLE;
-  ret += iis2dulpx_write_reg(ctx, IIS2DULPX_PAGE_RW, (uint8_t *)&page_rw, 1);
-
-  ret += iis2dulpx_mem_bank_set(ctx, IIS2DULPX_MAIN_MEM_BANK);
-
   return ret;
 }
 
-int32_t iis2dulpx_ln_pg_read(const stmdev_ctx_t *ctx, uint16_t address, uint8_t *buf, uint8_t len)
+int32_t iis2dulpx_timestamp_raw_get(const stmdev_ctx_t *ctx, uint32_t *val)
 {
-  iis2dulpx_page_address_t page_address = {0};
-  iis2dulpx_page_sel_t page_sel = {0};
-  iis2dulpx_page_rw_t page_rw = {0};
-  uint8_t msb = 0;
-  uint8_t lsb = 0;
+  uint8_t buff[4] = {0};
   int32_t ret = 0;
-  uint8_t i = 0;
-
-  msb = ((uint8_t)(address >> 8) & 0x0FU);
-  lsb = (uint8_t)address & 0xFFU;
 
-  ret = iis2dulpx_mem_bank_set(ctx, IIS2DULPX_EMBED_FUNC_MEM_BANK);
+  ret = iis2dulpx_read_reg(ctx, IIS2DULPX_TIMESTAMP0, buff, 4);
   if (ret != 0)
   {
-    goto exit;
+    return ret;
   }
+  *val = buff[3];
+  *val = (*val * 256U) +  buff[2];
+  *val = (*val * 256U) +  buff[1];
+  *val = (*val * 256U) +  buff[0];
 
-  /* page read */
-  ret = iis2dulpx_read_reg(ctx, IIS2DULPX_PAGE_RW, (uint8_t *)&page_rw, 1);
-  if (ret != 0)
-  {
-    goto exit;
-  }
-  page_rw.page_read = PROPERTY_ENABLE;
-  page_rw.page_write = PROPERTY_DISABLE;
-  ret += iis2dulpx_write_reg(ctx, IIS2DULPX_PAGE_RW, (uint8_t *)&page_rw, 1);
-  if (ret != 0)
-  {
-    goto exit;
-  }
+  return ret;
+}
 
-  /* set page num */
-  ret = iis2dulpx_read_reg(ctx, IIS2DULPX_PAGE_SEL, (uint8_t *)&page_sel, 1);
-  if (ret != 0)
+/* nominal output data period in ns, indexed by the 4-bit ODR code */
+static const uint32_t iis2dulpx_odr_period_ns[16] =
+{
+  0U, 625000000U, 333333333U, 40000000U, 166666667U, 80000000U, 40000000U, 20000000U,
+  10000000U, 5000000U, 2500000U, 1250000U, 0U, 0U, 0U, 0U,
+};
+
+/* extend a 32-bit device timestamp to 64 bits, closest to a reference */
+static uint64_t iis2dulpx_ts_extend(uint64_t ref, uint32_t raw)
+{
+  uint64_t ext = (ref & 0xFFFFFFFF00000000ULL) | raw;
+
+  if ((ext > ref) && ((ext - ref) > 0x80000000ULL) && (ext >= 0x100000000ULL))
   {
-    goto exit;
+    ext -= 0x100000000ULL;
   }
-  page_sel.page_sel = msb & 0x0FU;
-  page_sel.not_used0 = 1U; // Default value
-  ret += iis2dulpx_write_reg(ctx, IIS2DULPX_PAGE_SEL, (uint8_t *)&page_sel, 1);
-  if (ret != 0)
+  else if ((ref > ext) && ((ref - ext) > 0x80000000ULL))
   {
-    goto exit;
+    ext += 0x100000000ULL;
   }
-
-  for (i = 0; i < len; i++)
+  else
   {
-    /* Sequential readings are not allowed. Set page address every loop */
-    page_address.page_addr = lsb++;
-    ret = iis2dulpx_write_reg(ctx, IIS2DULPX_PAGE_ADDRESS, (uint8_t *)&page_address, 1);
+    /* same 32-bit epoch */
+  }
 
-    /* read value */
-    ret += iis2dulpx_read_reg(ctx, IIS2DULPX_PAGE_VALUE, &buf[i], 1);
+  return ext;
+}
 
-    /* Check if page wrap */
-    if (((lsb & 0xFFU) == 0x00U) && (ret == 0))
-    {
-      msb++;
-      lsb = 0;
+static void iis2dulpx_fifo_ts_period_set(iis2dulpx_fifo_ts_engine_t *eng, uint8_t odr)
+{
+  eng->odr = odr & 0x0FU;
+  eng->nominal_q8 = ((uint64_t)iis2dulpx_odr_period_ns[eng->odr] << eng->bdr_xl) * 256U;
+  eng->period_q8 = eng->nominal_q8;
+}
 
-      /* set page */
-      ret += iis2dulpx_read_reg(ctx, IIS2DULPX_PAGE_SEL, (uint8_t *)&page_sel, 1);
-      if (ret != 0)
-      {
-        goto exit;
-      }
-      page_sel.page_sel = msb & 0x0FU;
-      page_sel.not_used0 = 1U; // Default value
-      ret += iis2dulpx_write_reg(ctx, IIS2DULPX_PAGE_SEL, (uint8_t *)&page_sel, 1);
-    }
+/* timestamp record: the next accelerometer sample is taken at raw */
+static void iis2dulpx_fifo_ts_anchor(iis2dulpx_fifo_ts_engine_t *eng, uint32_t raw, uint8_t odr,
+                                     uint8_t cfg_change)
+{
+  uint64_t ext = iis2dulpx_ts_extend(eng->last_ext, raw);
+  uint64_t now_ns = ext * IIS2DULPX_TS_LSB_NS;
+  uint64_t measured;
 
-    if (ret != 0)
+  if ((cfg_change != 0U) || ((odr & 0x0FU) != eng->odr) || (eng->synced == 0U))
+  {
+    iis2dulpx_fifo_ts_period_set(eng, odr);
+  }
+  else if ((eng->since_anchor > 0U) && (now_ns > eng->anchor_ns))
+  {
+    /* follow the actual device ODR, within +/- 12.5% of nominal */
+    measured = ((now_ns - eng->anchor_ns) * 256U) / eng->since_anchor;
+    if ((measured > (eng->nominal_q8 - (eng->nominal_q8 / 8U))) &&
+        (measured < (eng->nominal_q8 + (eng->nominal_q8 / 8U))))
     {
-      goto exit;
+      eng->period_q8 = ((3U * eng->period_q8) + measured) / 4U;
     }
   }
+  else
+  {
+    /* nothing to measure */
+  }
 
-exit:
-  page_sel.page_sel = 0U;
-  page_sel.not_used0 = 1U;// Default value
-  ret += iis2dulpx_write_reg(ctx, IIS2DULPX_PAGE_SEL, (uint8_t *)&page_sel, 1);
+  eng->last_ext = ext;
+  eng->anchor_ns = now_ns;
+  eng->next_q8 = now_ns * 256U;
+  eng->since_anchor = 0U;
+  eng->synced = PROPERTY_ENABLE;
+}
 
-  ret += iis2dulpx_read_reg(ctx, IIS2DULPX_PAGE_RW, (uint8_t *)&page_rw, 1);
-  page_rw.page_read = PROPERTY_DISABLE;
-  page_rw.page_write = PROPERTY_DISABLE;
-  ret += iis2dulpx_write_reg(ctx, IIS2DULPX_PAGE_RW, (uint8_t *)&page_rw, 1);
+static uint64_t iis2dulpx_fifo_ts_next(iis2dulpx_fifo_ts_engine_t *eng)
+{
+  uint64_t ts_ns = eng->next_q8 / 256U;
 
-  ret += iis2dulpx_mem_bank_set(ctx, IIS2DULPX_MAIN_MEM_BANK);
+  eng->next_q8 += eng->period_q8;
+  eng->since_anchor++;
 
-  return ret;
+  return ts_ns;
 }
 
-int32_t iis2dulpx_ext_clk_en_set(const stmdev_ctx_t *ctx, uint8_t val)
+int32_t iis2dulpx_fifo_ts_init(iis2dulpx_fifo_ts_engine_t *eng, iis2dulpx_odr_t odr,
+                               iis2dulpx_bdr_xl_t bdr_xl)
 {
-  iis2dulpx_ext_clk_cfg_t clk = {0};
-  int32_t ret = 0;
-
-  ret = iis2dulpx_read_reg(ctx, IIS2DULPX_EXT_CLK_CFG, (uint8_t *)&clk, 1);
-  if (ret == 0)
+  if (bdr_xl >= IIS2DULPX_BDR_XL_ODR_OFF)
   {
-    clk.ext_clk_en = val & 0x01U;
-    ret += iis2dulpx_write_reg(ctx, IIS2DULPX_EXT_CLK_CFG, (uint8_t *)&clk, 1);
+    return -1;
   }
 
-  return ret;
-}
+  (void)memset(eng, 0, sizeof(iis2dulpx_fifo_ts_engine_t));
+  eng->bdr_xl = (uint8_t)bdr_xl;
+  iis2dulpx_fifo_ts_period_set(eng, (uint8_t)odr);
 
+  return 0;
+}
 
-int32_t iis2dulpx_ext_clk_en_get(const stmdev_ctx_t *ctx, uint8_t *val)
+int32_t iis2dulpx_fifo_ts_update(iis2dulpx_fifo_ts_engine_t *eng, const uint8_t *rec,
+                                 uint64_t *ts_ns, uint8_t *num)
 {
-  iis2dulpx_ext_clk_cfg_t clk = {0};
-  int32_t ret = 0;
+  iis2dulpx_fifo_data_out_tag_t fifo_tag;
+  const uint8_t *raw = &rec[1];
+  uint32_t ts;
 
-  ret = iis2dulpx_read_reg(ctx, IIS2DULPX_EXT_CLK_CFG, (uint8_t *)&clk, 1);
-  if (ret == 0)
+  *num = 0U;
+  (void)memcpy(&fifo_tag, &rec[0], 1);
+
+  switch (fifo_tag.tag_sensor)
   {
-    *val = clk.ext_clk_en;
+    case (uint8_t)IIS2DULPX_TIMESTAMP_TAG:
+      ts = raw[5];
+      ts = (ts * 256U) + raw[4];
+      ts = (ts * 256U) + raw[3];
+      ts = (ts * 256U) + raw[2];
+      iis2dulpx_fifo_ts_anchor(eng, ts, (raw[0] >> 3) & 0xFU, (raw[0] >> 7) & 0x01U);
+      break;
+    case (uint8_t)IIS2DULPX_XL_ONLY_2X_TAG:
+    case (uint8_t)IIS2DULPX_XL_ONLY_2X_TAG_2ND:
+      ts_ns[0] = iis2dulpx_fifo_ts_next(eng);
+      ts_ns[1] = iis2dulpx_fifo_ts_next(eng);
+      *num = 2U;
+      break;
+    case (uint8_t)IIS2DULPX_XL_AND_QVAR:
+    case (uint8_t)IIS2DULPX_XL_TEMP_TAG:
+      ts_ns[0] = iis2dulpx_fifo_ts_next(eng);
+      *num = 1U;
+      break;
+    default:
+      /* not an accelerometer sample */
+      break;
   }
 
-  return ret;
+  return (eng->synced == PROPERTY_ENABLE) ? 0 : -1;
 }
 
-int32_t iis2dulpx_pin_conf_set(const stmdev_ctx_t *ctx, const iis2dulpx_pin_conf_t *val)
+int32_t iis2dulpx_fifo_ts_compact(iis2dulpx_fifo_ts_engine_t *eng,
+                                  const iis2dulpx_fifo_compact_t *cmp, uint64_t *ts_ns)
 {
-  iis2dulpx_pin_ctrl_t pin_ctrl = {0};
-  int32_t ret = 0;
-
-  ret = iis2dulpx_read_reg(ctx, IIS2DULPX_PIN_CTRL, (uint8_t *)&pin_ctrl, 1);
+  uint16_t t = 0;
+  uint16_t i = 0;
 
-  if (ret == 0)
+  for (i = 0U; i <= cmp->smp_num; i++)
   {
-    pin_ctrl.cs_pu_dis = ~val->cs_pull_up;
-    pin_ctrl.pd_dis_int1 = ~val->int1_pull_down;
-    pin_ctrl.pd_dis_int2 = ~val->int2_pull_down;
-    pin_ctrl.sda_pu_en = val->sda_pull_up;
-    pin_ctrl.sdo_pu_en = val->sdo_pull_up;
-    pin_ctrl.pp_od = ~val->int1_int2_push_pull;
+    /* timestamp records placed before sample i */
+    while ((cmp->ts != NULL) && (t < cmp->ts_num) && (cmp->ts[t].index == i))
+    {
+      iis2dulpx_fifo_ts_anchor(eng, cmp->ts[t].timestamp, cmp->ts[t].odr, cmp->ts[t].cfg_change);
+      t++;
+    }
 
-    ret = iis2dulpx_write_reg(ctx, IIS2DULPX_PIN_CTRL, (uint8_t *)&pin_ctrl, 1);
+    if (i < cmp->smp_num)
+    {
+      ts_ns[i] = iis2dulpx_fifo_ts_next(eng);
+    }
   }
 
-  return ret;
+  return (eng->synced == PROPERTY_ENABLE) ? 0 : -1;
 }
 
-int32_t iis2dulpx_pin_conf_get(const stmdev_ctx_t *ctx, iis2dulpx_pin_conf_t *val)
+int32_t iis2dulpx_fifo_ts_host_sync(const stmdev_ctx_t *ctx, iis2dulpx_fifo_ts_engine_t *eng,
+                                    uint64_t host_ns)
 {
-  iis2dulpx_pin_ctrl_t pin_ctrl = {0};
+  uint64_t ref;
+  uint64_t dev_ns;
+  int64_t span;
+  int64_t diff;
+  int64_t drift;
+  uint32_t raw;
   int32_t ret = 0;
 
-  ret = iis2dulpx_read_reg(ctx, IIS2DULPX_PIN_CTRL, (uint8_t *)&pin_ctrl, 1);
-
-  if (ret == 0)
+  ret = iis2dulpx_timestamp_raw_get(ctx, &raw);
+  if (ret != 0)
   {
-    val->cs_pull_up = ~pin_ctrl.cs_pu_dis;
-    val->int1_pull_down = ~pin_ctrl.pd_dis_int1;
-    val->int2_pull_down = ~pin_ctrl.pd_dis_int2;
-    val->sda_pull_up = pin_ctrl.sda_pu_en;
-    val->sdo_pull_up = pin_ctrl.sdo_pu_en;
-    val->int1_int2_push_pull = ~pin_ctrl.pp_od;
+    return ret;
   }
 
-  return ret;
-}
+  ref = (eng->host_pairs > 0U) ? eng->sync_ext : eng->last_ext;
+  eng->sync_ext = iis2dulpx_ts_extend(ref, raw);
+  dev_ns = eng->sync_ext * IIS2DULPX_TS_LSB_NS;
 
-int32_t iis2dulpx_int_pin_polarity_set(const stmdev_ctx_t *ctx, iis2dulpx_int_pin_polarity_t val)
-{
-  iis2dulpx_pin_ctrl_t pin_ctrl = {0};
-  int32_t ret = 0;
+  if ((eng->host_pairs > 0U) && (dev_ns > eng->dev_ref_ns))
+  {
+    /* device clock drift against host clock, parts per billion */
+    span = (int64_t)(dev_ns - eng->dev_ref_ns);
+    diff = (int64_t)(host_ns - eng->host_ref_ns) - span;
 
-  ret = iis2dulpx_read_reg(ctx, IIS2DULPX_PIN_CTRL, (uint8_t *)&pin_ctrl, 1);
+    /* a host time step of more than span is not a drift: skipped */
+    if ((diff <= span) && (diff >= -span))
+    {
+      /* same ratio on fewer digits, diff * 10^9 must fit in 63 bits */
+      while (span > 9000000000LL)
+      {
+        span /= 10;
+        diff /= 10;
+      }
 
-  if (ret == 0)
+      drift = (diff * 1000000000LL) / span;
+      eng->drift_ppb = (eng->host_pairs > 1U) ? (((3 * eng->drift_ppb) + drift) / 4) : drift;
+    }
+  }
+
+  eng->dev_ref_ns = dev_ns;
+  eng->host_ref_ns = host_ns;
+  if (eng->host_pairs < 0xFFU)
   {
-    pin_ctrl.h_lactive = (uint8_t)val & 0x01U;
-    ret = iis2dulpx_write_reg(ctx, IIS2DULPX_PIN_CTRL, (uint8_t *)&pin_ctrl, 1);
+    eng->host_pairs++;
   }
 
   return ret;
 }
 
-int32_t iis2dulpx_int_pin_polarity_get(const stmdev_ctx_t *ctx, iis2dulpx_int_pin_polarity_t *val)
+int32_t iis2dulpx_fifo_ts_to_host(const iis2dulpx_fifo_ts_engine_t *eng, uint64_t dev_ns,
+                                  uint64_t *host_ns)
 {
-  iis2dulpx_pin_ctrl_t pin_ctrl = {0};
-  int32_t ret = 0;
-
-  ret = iis2dulpx_read_reg(ctx, IIS2DULPX_PIN_CTRL, (uint8_t *)&pin_ctrl, 1);
-
-  if (ret != 0)
-  {
-    return ret;
-  }
+  int64_t delta;
+  int64_t corr;
 
-  switch ((pin_ctrl.h_lactive))
+  if (eng->host_pairs == 0U)
   {
-    case 0x0:
-      *val = IIS2DULPX_ACTIVE_HIGH;
-      break;
-
-    case 0x1:
-      *val = IIS2DULPX_ACTIVE_LOW;
-      break;
-
-    default:
-      *val = IIS2DULPX_ACTIVE_HIGH;
-      break;
+    return -1;
   }
-  return ret;
+
+  /* delta * drift_ppb / 10^9 split on whole seconds, |drift_ppb| <= 10^9 */
+  delta = (int64_t)(dev_ns - eng->dev_ref_ns);
+  corr = ((delta / 1000000000LL) * eng->drift_ppb) +
+         (((delta % 1000000000LL) * eng->drift_ppb) / 1000000000LL);
+  *host_ns = eng->host_ref_ns + (uint64_t)(delta + corr);
+
+  return 0;
 }
 
-int32_t iis2dulpx_spi_mode_set(const stmdev_ctx_t *ctx, iis2dulpx_spi_mode val)
+/* samples missing between the predicted time and a timestamp record */
+static uint32_t iis2dulpx_fifo_ts_gap(const iis2dulpx_fifo_ts_engine_t *eng, const uint8_t *raw)
 {
-  iis2dulpx_pin_ctrl_t pin_ctrl = {0};
-  int32_t ret = 0;
+  uint64_t period = eng->period_q8 / 256U;
+  uint64_t expect = eng->next_q8 / 256U;
+  uint64_t now_ns;
+  uint32_t ts;
 
-  ret = iis2dulpx_read_reg(ctx, IIS2DULPX_PIN_CTRL, (uint8_t *)&pin_ctrl, 1);
+  if ((eng->synced == 0U) || (period == 0U) || ((raw[0] & 0x80U) != 0U) ||
+      (((raw[0] >> 3) & 0xFU) != eng->odr))
+  {
+    /* first record or configuration change: nothing to compare */
+    return 0U;
+  }
 
-  if (ret == 0)
+  ts = raw[5];
+  ts = (ts * 256U) + raw[4];
+  ts = (ts * 256U) + raw[3];
+  ts = (ts * 256U) + raw[2];
+  now_ns = iis2dulpx_ts_extend(eng->last_ext, ts) * IIS2DULPX_TS_LSB_NS;
+
+  if (now_ns <= (expect + (period / 2U)))
   {
-    pin_ctrl.sim = (uint8_t)val & 0x01U;
-    ret = iis2dulpx_write_reg(ctx, IIS2DULPX_PIN_CTRL, (uint8_t *)&pin_ctrl, 1);
+    return 0U;
   }
 
-  return ret;
+  return (uint32_t)((now_ns - expect + (period / 2U)) / period);
 }
 
-int32_t iis2dulpx_spi_mode_get(const stmdev_ctx_t *ctx, iis2dulpx_spi_mode *val)
+int32_t iis2dulpx_fifo_drain_tracked(const stmdev_ctx_t *ctx, iis2dulpx_fifo_ts_engine_t *eng,
+                                     uint8_t *buff, uint16_t max, uint64_t host_ns,
+                                     iis2dulpx_fifo_loss_t *loss, uint16_t *num)
 {
-  iis2dulpx_pin_ctrl_t pin_ctrl = {0};
+  iis2dulpx_fifo_status1_t fifo_status1;
+  iis2dulpx_fifo_data_out_tag_t fifo_tag;
+  uint64_t ts_ns[2];
+  uint64_t period;
+  uint64_t expect;
+  uint32_t samples = 0;
+  uint32_t pending = 0;
+  uint32_t lost = 0;
+  uint32_t gap;
+  uint16_t level;
+  uint16_t i;
+  uint8_t status[2];
+  uint8_t resync = 0;
+  uint8_t n;
   int32_t ret = 0;
 
-  ret = iis2dulpx_read_reg(ctx, IIS2DULPX_PIN_CTRL, (uint8_t *)&pin_ctrl, 1);
+  *num = 0;
+
+  /* FIFO_STATUS1 and FIFO_STATUS2 in one access */
+  ret = iis2dulpx_read_reg(ctx, IIS2DULPX_FIFO_STATUS1, status, 2);
   if (ret != 0)
   {
     return ret;
   }
 
-  switch ((pin_ctrl.sim))
-  {
-    case 0x0:
-      *val = IIS2DULPX_SPI_4_WIRE;
-      break;
-
-    case 0x1:
-      *val = IIS2DULPX_SPI_3_WIRE;
-      break;
+  (void)memcpy(&fifo_status1, &status[0], 1);
+  level = status[1];
 
-    default:
-      *val = IIS2DULPX_SPI_4_WIRE;
-      break;
+  loss->drains++;
+  if (fifo_status1.fifo_ovr_ia == PROPERTY_ENABLE)
+  {
+    loss->overruns++;
+  }
+  if (level >= IIS2DULPX_FIFO_SIZE)
+  {
+    loss->full++;
+  }
+  if (level > loss->level_peak)
+  {
+    loss->level_peak = level;
   }
-  return ret;
-}
-
-int32_t iis2dulpx_pin_int1_route_set(const stmdev_ctx_t *ctx, const iis2dulpx_pin_int_route_t *val)
-{
-  iis2dulpx_ctrl1_t ctrl1 = {0};
-  iis2dulpx_ctrl2_t ctrl2 = {0};
-  iis2dulpx_md1_cfg_t md1_cfg = {0};
-  int32_t ret = 0;
-
-  ret = iis2dulpx_read_reg(ctx, IIS2DULPX_CTRL1, (uint8_t *)&ctrl1, 1);
 
-  if (ret == 0)
+  if (level > max)
   {
-    ctrl1.int1_on_res = val->int_on_res;
+    level = max;
+  }
 
-    ret = iis2dulpx_write_reg(ctx, IIS2DULPX_CTRL1, (uint8_t *)&ctrl1, 1);
+  ret = iis2dulpx_fifo_out_raw_batch_get(ctx, buff, level);
+  if (ret != 0)
+  {
+    return ret;
   }
 
-  if (ret == 0)
+  for (i = 0U; i < level; i++)
   {
-    ret = iis2dulpx_read_reg(ctx, IIS2DULPX_CTRL2, (uint8_t *)&ctrl2, 1);
+    const uint8_t *rec = &buff[i * IIS2DULPX_FIFO_RECORD_LEN];
 
-    if (ret == 0)
+    (void)memcpy(&fifo_tag, &rec[0], 1);
+    if ((eng != NULL) && (fifo_tag.tag_sensor == (uint8_t)IIS2DULPX_TIMESTAMP_TAG))
     {
-      ctrl2.int1_drdy = val->drdy;
-      ctrl2.int1_fifo_ovr = val->fifo_ovr;
-      ctrl2.int1_fifo_th = val->fifo_th;
-      ctrl2.int1_fifo_full = val->fifo_full;
-      ctrl2.int1_boot = val->boot;
+      gap = iis2dulpx_fifo_ts_gap(eng, &rec[1]);
+      if (gap > 0U)
+      {
+        lost += gap;
+        loss->resyncs++;
+      }
+      resync = 1U;
+    }
 
-      ret = iis2dulpx_write_reg(ctx, IIS2DULPX_CTRL2, (uint8_t *)&ctrl2, 1);
+    n = 0U;
+    if (eng != NULL)
+    {
+      (void)iis2dulpx_fifo_ts_update(eng, rec, ts_ns, &n);
+    }
+    else if ((fifo_tag.tag_sensor == (uint8_t)IIS2DULPX_XL_ONLY_2X_TAG) ||
+             (fifo_tag.tag_sensor == (uint8_t)IIS2DULPX_XL_ONLY_2X_TAG_2ND))
+    {
+      n = 2U;
     }
+    else if ((fifo_tag.tag_sensor == (uint8_t)IIS2DULPX_XL_AND_QVAR) ||
+             (fifo_tag.tag_sensor == (uint8_t)IIS2DULPX_XL_TEMP_TAG))
+    {
+      n = 1U;
+    }
+    else
+    {
+      /* not an accelerometer sample */
+    }
+    samples += n;
   }
 
-  if (ret == 0)
+  /*
+   * No timestamp record to resync on: after an overrun compare the
+   * samples read with what the ODR produced since the last drain.
+   */
+  if ((resync == 0U) && (fifo_status1.fifo_ovr_ia == PROPERTY_ENABLE) && (eng != NULL) &&
+      (host_ns > loss->last_host_ns) && (loss->last_host_ns != 0U))
   {
-    ret = iis2dulpx_read_reg(ctx, IIS2DULPX_MD1_CFG, (uint8_t *)&md1_cfg, 1);
-
-    if (ret == 0)
+    period = eng->period_q8 / 256U;
+    expect = (period != 0U) ? ((host_ns - loss->last_host_ns) / period) : 0U;
+    if (expect > ((uint64_t)samples + loss->pending))
     {
-      md1_cfg.int1_ff = val->free_fall;
-      md1_cfg.int1_6d = val->six_d;
-      md1_cfg.int1_tap = val->tap;
-      md1_cfg.int1_wu = val->wake_up;
-      md1_cfg.int1_sleep_change = val->sleep_change;
-      md1_cfg.int1_emb_func = val->emb_function;
-      md1_cfg.int1_timestamp = val->timestamp;
-
-      ret = iis2dulpx_write_reg(ctx, IIS2DULPX_MD1_CFG, (uint8_t *)&md1_cfg, 1);
+      lost += (uint32_t)(expect - samples - loss->pending);
     }
   }
 
-  return ret;
-}
-
-int32_t iis2dulpx_pin_int1_route_get(const stmdev_ctx_t *ctx, iis2dulpx_pin_int_route_t *val)
-{
-  iis2dulpx_ctrl1_t ctrl1 = {0};
-  iis2dulpx_ctrl2_t ctrl2 = {0};
-  iis2dulpx_md1_cfg_t md1_cfg = {0};
-  int32_t ret = 0;
-
-  ret = iis2dulpx_read_reg(ctx, IIS2DULPX_CTRL1, (uint8_t *)&ctrl1, 1);
-  ret += iis2dulpx_read_reg(ctx, IIS2DULPX_CTRL2, (uint8_t *)&ctrl2, 1);
-  ret += iis2dulpx_read_reg(ctx, IIS2DULPX_MD1_CFG, (uint8_t *)&md1_cfg, 1);
-
-  if (ret == 0)
+  /* samples left in FIFO were produced before this drain */
+  if ((status[1] > level) && (level > 0U))
   {
-    val->int_on_res = ctrl1.int1_on_res;
-    val->drdy = ctrl2.int1_drdy;
-    val->fifo_ovr = ctrl2.int1_fifo_ovr;
-    val->fifo_th = ctrl2.int1_fifo_th;
-    val->fifo_full = ctrl2.int1_fifo_full;
-    val->boot = ctrl2.int1_boot;
-    val->free_fall = md1_cfg.int1_ff;
-    val->six_d = md1_cfg.int1_6d;
-    val->tap = md1_cfg.int1_tap;
-    val->wake_up = md1_cfg.int1_wu;
-    val->sleep_change = md1_cfg.int1_sleep_change;
-    val->emb_function = md1_cfg.int1_emb_func;
-    val->timestamp = md1_cfg.int1_timestamp;
+    pending = (((uint32_t)status[1] - level) * samples) / level;
+  }
+  loss->pending = pending;
+  if (host_ns != 0U)
+  {
+    loss->last_host_ns = host_ns;
   }
 
+  loss->records += level;
+  loss->samples += samples;
+  loss->lost += lost;
+  *num = level;
+
   return ret;
 }
 
-int32_t iis2dulpx_emb_pin_int1_route_set(const stmdev_ctx_t *ctx,
-                                         const iis2dulpx_emb_pin_int_route_t *val)
+/*
+ * Pick watermark and batch rate for the current estimates: the oldest
+ * record at drain time (watermark plus records that arrive while the
+ * host is reacting) must not be older than the latency target.
+ */
+static void iis2dulpx_wtm_ctrl_solve(iis2dulpx_wtm_ctrl_t *ctrl)
 {
-  iis2dulpx_emb_func_int1_t emb_func_int1 = {0};
-  iis2dulpx_md1_cfg_t md1_cfg = {0};
-  int32_t ret = 0;
+  uint32_t target;
+  uint32_t excess = ((uint32_t)ctrl->excess_q4 + 15U) / 16U;
+  uint32_t limit;
+  uint32_t wtm;
 
-  ret = iis2dulpx_mem_bank_set(ctx, IIS2DULPX_EMBED_FUNC_MEM_BANK);
-  if (ret == 0)
+  target = (uint32_t)(((uint64_t)ctrl->latency_us * 1000U) / ctrl->period_ns);
+
+  limit = (uint32_t)ctrl->margin + ctrl->excess_peak;
+  limit = (limit < IIS2DULPX_FIFO_SIZE) ? (IIS2DULPX_FIFO_SIZE - limit) : 1U;
+  if (limit > 127U)
   {
-    ret = iis2dulpx_read_reg(ctx, IIS2DULPX_EMB_FUNC_INT1, (uint8_t *)&emb_func_int1, 1);
+    limit = 127U;
   }
 
-  if (ret == 0)
+  if ((target > (limit + excess)) && (ctrl->bdr < ctrl->bdr_max))
   {
-    emb_func_int1.int1_tilt = val->tilt;
-    emb_func_int1.int1_sig_mot = val->sig_mot;
-    emb_func_int1.int1_step_det = val->step_det;
-    emb_func_int1.int1_fsm_lc = val->fsm_lc;
-
-    ret = iis2dulpx_write_reg(ctx, IIS2DULPX_EMB_FUNC_INT1, (uint8_t *)&emb_func_int1, 1);
+    /* FIFO too small for the target: batch fewer records */
+    ctrl->bdr++;
+    ctrl->period_ns *= 2U;
+    target /= 2U;
+  }
+  else if ((target <= excess) && (ctrl->bdr > ctrl->bdr_min))
+  {
+    /* target missed even with watermark 1: batch more records */
+    ctrl->bdr--;
+    ctrl->period_ns /= 2U;
+    target *= 2U;
+  }
+  else
+  {
+    /* batch rate unchanged */
   }
-  ret += iis2dulpx_mem_bank_set(ctx, IIS2DULPX_MAIN_MEM_BANK);
 
-  ret += iis2dulpx_read_reg(ctx, IIS2DULPX_MD1_CFG, (uint8_t *)&md1_cfg, 1);
-  if (ret == 0)
+  wtm = (target > excess) ? (target - excess) : 1U;
+  if (wtm > limit)
   {
-    md1_cfg.int1_emb_func = 1;
-    ret = iis2dulpx_write_reg(ctx, IIS2DULPX_MD1_CFG, (uint8_t *)&md1_cfg, 1);
+    wtm = limit;
   }
 
-  return ret;
+  ctrl->wtm_next = (wtm == 0U) ? 1U : (uint8_t)wtm;
 }
 
-int32_t iis2dulpx_emb_pin_int1_route_get(const stmdev_ctx_t *ctx,
-                                         iis2dulpx_emb_pin_int_route_t *val)
+static int32_t iis2dulpx_wtm_ctrl_apply(const stmdev_ctx_t *ctx, iis2dulpx_wtm_ctrl_t *ctrl,
+                                        uint8_t force)
 {
-  iis2dulpx_emb_func_int1_t emb_func_int1 = {0};
+  iis2dulpx_fifo_batch_t batch = {0};
   int32_t ret = 0;
 
-  ret = iis2dulpx_mem_bank_set(ctx, IIS2DULPX_EMBED_FUNC_MEM_BANK);
-  if (ret == 0)
+  if ((force != 0U) || (ctrl->bdr != ctrl->bdr_set))
   {
-    ret = iis2dulpx_read_reg(ctx, IIS2DULPX_EMB_FUNC_INT1, (uint8_t *)&emb_func_int1, 1);
+    batch.dec_ts = (iis2dulpx_dec_ts_t)ctrl->dec_ts;
+    batch.bdr_xl = (iis2dulpx_bdr_xl_t)ctrl->bdr;
+    ret = iis2dulpx_fifo_batch_set(ctx, batch);
+    if (ret != 0)
+    {
+      return ret;
+    }
+    ctrl->bdr_set = ctrl->bdr;
   }
 
-  if (ret == 0)
+  /* lower at once, raise with one record of hysteresis */
+  if ((force != 0U) || (ctrl->wtm_next < ctrl->wtm) || (ctrl->wtm_next > (ctrl->wtm + 1U)))
   {
-    val->tilt = emb_func_int1.int1_tilt;
-    val->sig_mot = emb_func_int1.int1_sig_mot;
-    val->step_det = emb_func_int1.int1_step_det;
-    val->fsm_lc = emb_func_int1.int1_fsm_lc;
+    ret = iis2dulpx_fifo_watermark_set(ctx, ctrl->wtm_next);
+    if (ret == 0)
+    {
+      ctrl->wtm = ctrl->wtm_next;
+    }
   }
-  ret = iis2dulpx_mem_bank_set(ctx, IIS2DULPX_MAIN_MEM_BANK);
 
   return ret;
 }
 
-int32_t iis2dulpx_pin_int2_route_set(const stmdev_ctx_t *ctx, const iis2dulpx_pin_int_route_t *val)
+int32_t iis2dulpx_wtm_ctrl_init(const stmdev_ctx_t *ctx, iis2dulpx_wtm_ctrl_t *ctrl,
+                                uint32_t latency_us, iis2dulpx_bdr_xl_t bdr_min,
+                                iis2dulpx_bdr_xl_t bdr_max)
 {
-  iis2dulpx_ctrl3_t ctrl3 = {0};
-  iis2dulpx_md2_cfg_t md2_cfg = {0};
+  iis2dulpx_fifo_batch_t batch = {0};
+  iis2dulpx_md_t md;
   int32_t ret = 0;
 
-  ret = iis2dulpx_read_reg(ctx, IIS2DULPX_CTRL3, (uint8_t *)&ctrl3, 1);
-
-  if (ret == 0)
+  if ((bdr_min > bdr_max) || (bdr_max >= IIS2DULPX_BDR_XL_ODR_OFF) || (latency_us == 0U))
   {
-    ctrl3.int2_drdy = val->drdy;
-    ctrl3.int2_fifo_ovr = val->fifo_ovr;
-    ctrl3.int2_fifo_th = val->fifo_th;
-    ctrl3.int2_fifo_full = val->fifo_full;
-    ctrl3.int2_boot = val->boot;
+    return -1;
+  }
 
-    ret = iis2dulpx_write_reg(ctx, IIS2DULPX_CTRL3, (uint8_t *)&ctrl3, 1);
+  ret = iis2dulpx_mode_get(ctx, &md);
+  ret += iis2dulpx_fifo_batch_get(ctx, &batch);
+  if (ret != 0)
+  {
+    return ret;
   }
 
-  if (ret == 0)
+  if (iis2dulpx_odr_period_ns[(uint8_t)md.odr & 0x0FU] == 0U)
   {
-    ret = iis2dulpx_read_reg(ctx, IIS2DULPX_MD2_CFG, (uint8_t *)&md2_cfg, 1);
+    return -1;
+  }
 
-    if (ret == 0)
-    {
-      md2_cfg.int2_ff = val->free_fall;
-      md2_cfg.int2_6d = val->six_d;
-      md2_cfg.int2_tap = val->tap;
-      md2_cfg.int2_wu = val->wake_up;
-      md2_cfg.int2_sleep_change = val->sleep_change;
-      md2_cfg.int2_emb_func = val->emb_function;
-      md2_cfg.int2_timestamp = val->timestamp;
+  (void)memset(ctrl, 0, sizeof(iis2dulpx_wtm_ctrl_t));
+  ctrl->latency_us = latency_us;
+  ctrl->bdr_min = (uint8_t)bdr_min;
+  ctrl->bdr_max = (uint8_t)bdr_max;
+  ctrl->margin = IIS2DULPX_WTM_CTRL_MARGIN;
+  ctrl->odr = (uint8_t)md.odr & 0x0FU;
+  ctrl->dec_ts = (uint8_t)batch.dec_ts;
+  ctrl->bdr = (uint8_t)bdr_min;
+  ctrl->period_ns = (uint64_t)iis2dulpx_odr_period_ns[ctrl->odr] << ctrl->bdr;
+
+  iis2dulpx_wtm_ctrl_solve(ctrl);
+
+  return iis2dulpx_wtm_ctrl_apply(ctx, ctrl, PROPERTY_ENABLE);
+}
 
-      ret = iis2dulpx_write_reg(ctx, IIS2DULPX_MD2_CFG, (uint8_t *)&md2_cfg, 1);
+int32_t iis2dulpx_wtm_ctrl_update(const stmdev_ctx_t *ctx, iis2dulpx_wtm_ctrl_t *ctrl,
+                                  uint16_t level, uint64_t now_ns)
+{
+  uint64_t nominal = (uint64_t)iis2dulpx_odr_period_ns[ctrl->odr] << ctrl->bdr;
+  uint32_t excess = (level > ctrl->wtm) ? ((uint32_t)level - ctrl->wtm) : 0U;
+  uint64_t period;
+
+  ctrl->wakeups++;
+
+  /* records drained at the previous wakeup and now: measured batch period */
+  if ((ctrl->last_ns != 0U) && (now_ns > ctrl->last_ns) && (level > 0U))
+  {
+    period = (now_ns - ctrl->last_ns) / level;
+    if ((period > (nominal / 2U)) && (period < (nominal * 2U)))
+    {
+      ctrl->period_ns = ((ctrl->period_ns * 3U) + period) / 4U;
     }
   }
+  ctrl->last_ns = now_ns;
 
-  return ret;
+  /* host reaction time, in records: average and decaying peak */
+  ctrl->excess_q4 = (uint16_t)((((uint32_t)ctrl->excess_q4 * 7U) + (excess * 16U)) / 8U);
+  ctrl->excess_peak -= ctrl->excess_peak / 8U;
+  if (excess > ctrl->excess_peak)
+  {
+    ctrl->excess_peak = (uint16_t)excess;
+  }
+
+  iis2dulpx_wtm_ctrl_solve(ctrl);
+
+  return iis2dulpx_wtm_ctrl_apply(ctx, ctrl, PROPERTY_DISABLE);
 }
 
-int32_t iis2dulpx_pin_int2_route_get(const stmdev_ctx_t *ctx, iis2dulpx_pin_int_route_t *val)
+/* engine registers, in write order */
+static const uint8_t iis2dulpx_duty_reg[4] =
 {
-  iis2dulpx_ctrl3_t ctrl3 = {0};
-  iis2dulpx_md2_cfg_t md2_cfg = {0};
+  IIS2DULPX_CTRL5, IIS2DULPX_CTRL3, IIS2DULPX_FIFO_WTM, IIS2DULPX_FIFO_BATCH_DEC
+};
+
+/*
+ * Move to a profile writing only the registers whose content changes
+ * (all of them after a failed transition).
+ */
+static int32_t iis2dulpx_duty_apply(const stmdev_ctx_t *ctx, iis2dulpx_duty_t *duty,
+                                    uint8_t level)
+{
+  iis2dulpx_fifo_batch_dec_t fifo_batch;
+  iis2dulpx_fifo_wtm_t fifo_wtm;
+  iis2dulpx_ctrl3_t ctrl3;
+  iis2dulpx_ctrl5_t ctrl5;
+  iis2dulpx_txn_t txn;
+  uint8_t img[4];
+  uint8_t writes = 0U;
+  uint8_t i;
   int32_t ret = 0;
 
-  ret = iis2dulpx_read_reg(ctx, IIS2DULPX_CTRL3, (uint8_t *)&ctrl3, 1);
-  ret += iis2dulpx_read_reg(ctx, IIS2DULPX_MD2_CFG, (uint8_t *)&md2_cfg, 1);
+  (void)memcpy(&ctrl5, &duty->img[0], 1);
+  (void)memcpy(&ctrl3, &duty->img[1], 1);
+  (void)memcpy(&fifo_wtm, &duty->img[2], 1);
+  (void)memcpy(&fifo_batch, &duty->img[3], 1);
 
-  if (ret == 0)
+  if ((level != (uint8_t)IIS2DULPX_DUTY_ULP) || (duty->hw_ulp == PROPERTY_DISABLE))
   {
-    val->drdy = ctrl3.int2_drdy;
-    val->fifo_ovr = ctrl3.int2_fifo_ovr;
-    val->fifo_th = ctrl3.int2_fifo_th;
-    val->fifo_full = ctrl3.int2_fifo_full;
-    val->boot = ctrl3.int2_boot;
-    val->free_fall = md2_cfg.int2_ff;
-    val->six_d = md2_cfg.int2_6d;
-    val->tap = md2_cfg.int2_tap;
-    val->wake_up = md2_cfg.int2_wu;
-    val->sleep_change = md2_cfg.int2_sleep_change;
-    val->emb_function = md2_cfg.int2_emb_func;
-    val->timestamp = md2_cfg.int2_timestamp;
+    ret = iis2dulpx_mode_ctrl5_get(&duty->cfg.md[level], &ctrl5);
+    if (ret != 0)
+    {
+      return ret;
+    }
+    ctrl3.hp_en = (((uint8_t)duty->cfg.md[level].odr & 0x30U) == 0x10U) ? 1U : 0U;
+  }
+
+  fifo_wtm.fth = duty->cfg.wtm[level] & 0x7FU;
+  fifo_batch.bdr_xl = (uint8_t)duty->cfg.batch[level].bdr_xl & 0x07U;
+  fifo_batch.dec_ts_batch = (uint8_t)duty->cfg.batch[level].dec_ts & 0x03U;
+
+  (void)memcpy(&img[0], &ctrl5, 1);
+  (void)memcpy(&img[1], &ctrl3, 1);
+  (void)memcpy(&img[2], &fifo_wtm, 1);
+  (void)memcpy(&img[3], &fifo_batch, 1);
+
+  iis2dulpx_txn_init(&txn, ctx);
+  for (i = 0U; i < 4U; i++)
+  {
+    if ((duty->dirty != 0U) || (img[i] != duty->img[i]))
+    {
+      ret += iis2dulpx_txn_write(&txn, iis2dulpx_duty_reg[i], &img[i], 1);
+      writes++;
+    }
+  }
+  ret += iis2dulpx_txn_run(&txn);
+
+  if (ret != 0)
+  {
+    duty->dirty = PROPERTY_ENABLE;
+    duty->writes = 0U;
+    return ret;
   }
 
+  (void)memcpy(duty->img, img, sizeof(img));
+  duty->dirty = PROPERTY_DISABLE;
+  duty->writes = writes;
+  duty->level = level;
+
   return ret;
 }
 
-int32_t iis2dulpx_emb_pin_int2_route_set(const stmdev_ctx_t *ctx,
-                                         const iis2dulpx_emb_pin_int_route_t *val)
+int32_t iis2dulpx_duty_init(const stmdev_ctx_t *ctx, iis2dulpx_duty_t *duty,
+                            const iis2dulpx_duty_cfg_t *cfg)
 {
-  iis2dulpx_emb_func_int2_t emb_func_int2 = {0};
-  iis2dulpx_md2_cfg_t md2_cfg = {0};
+  iis2dulpx_wakeup_config_t wakeup;
+  iis2dulpx_ctrl5_t ctrl5;
+  iis2dulpx_txn_t txn;
+  uint8_t i;
   int32_t ret = 0;
 
-  ret = iis2dulpx_mem_bank_set(ctx, IIS2DULPX_EMBED_FUNC_MEM_BANK);
-  if (ret == 0)
-  {
-    ret = iis2dulpx_read_reg(ctx, IIS2DULPX_EMB_FUNC_INT2, (uint8_t *)&emb_func_int2, 1);
-  }
+  (void)memset(duty, 0x00, sizeof(iis2dulpx_duty_t));
+  (void)memcpy(&duty->cfg, cfg, sizeof(iis2dulpx_duty_cfg_t));
 
-  if (ret == 0)
+  for (i = 0U; i < 3U; i++)
   {
-    emb_func_int2.int2_tilt = val->tilt;
-    emb_func_int2.int2_sig_mot = val->sig_mot;
-    emb_func_int2.int2_step_det = val->step_det;
-    emb_func_int2.int2_fsm_lc = val->fsm_lc;
-
-    ret = iis2dulpx_write_reg(ctx, IIS2DULPX_EMB_FUNC_INT2, (uint8_t *)&emb_func_int2, 1);
+    if (iis2dulpx_mode_ctrl5_get(&cfg->md[i], &ctrl5) != 0)
+    {
+      return -1;
+    }
   }
-  ret += iis2dulpx_mem_bank_set(ctx, IIS2DULPX_MAIN_MEM_BANK);
 
-  ret += iis2dulpx_read_reg(ctx, IIS2DULPX_MD2_CFG, (uint8_t *)&md2_cfg, 1);
-  if (ret == 0)
+  /* inact_odr codes match the ULP ODR ones */
+  if (((uint8_t)cfg->md[IIS2DULPX_DUTY_ULP].odr >= (uint8_t)IIS2DULPX_1Hz6_ULP) &&
+      ((uint8_t)cfg->md[IIS2DULPX_DUTY_ULP].odr <= (uint8_t)IIS2DULPX_25Hz_ULP) &&
+      (cfg->md[IIS2DULPX_DUTY_ULP].fs == cfg->md[IIS2DULPX_DUTY_LP].fs) &&
+      (cfg->md[IIS2DULPX_DUTY_ULP].fs == cfg->md[IIS2DULPX_DUTY_HP].fs))
   {
-    md2_cfg.int2_emb_func = 1;
-    ret = iis2dulpx_write_reg(ctx, IIS2DULPX_MD2_CFG, (uint8_t *)&md2_cfg, 1);
+    duty->hw_ulp = PROPERTY_ENABLE;
   }
 
-  return ret;
-}
-
-int32_t iis2dulpx_emb_pin_int2_route_get(const stmdev_ctx_t *ctx,
-                                         iis2dulpx_emb_pin_int_route_t *val)
-{
-  iis2dulpx_emb_func_int2_t emb_func_int2 = {0};
-  int32_t ret = 0;
+  wakeup = cfg->wakeup;
+  wakeup.wake_enable = IIS2DULPX_SLEEP_ON;
+  wakeup.inact_odr = (duty->hw_ulp == PROPERTY_ENABLE) ?
+                     (iis2dulpx_inact_odr_t)cfg->md[IIS2DULPX_DUTY_ULP].odr : IIS2DULPX_ODR_NO_CHANGE;
 
-  ret = iis2dulpx_mem_bank_set(ctx, IIS2DULPX_EMBED_FUNC_MEM_BANK);
-  if (ret == 0)
+  ret = iis2dulpx_wakeup_config_set(ctx, wakeup);
+  ret += iis2dulpx_smart_power_set(ctx, cfg->smart_power);
+  if (ret != 0)
   {
-    ret = iis2dulpx_read_reg(ctx, IIS2DULPX_EMB_FUNC_INT2, (uint8_t *)&emb_func_int2, 1);
+    return ret;
   }
 
-  if (ret == 0)
+  iis2dulpx_txn_init(&txn, ctx);
+  for (i = 0U; i < 4U; i++)
   {
-    val->tilt = emb_func_int2.int2_tilt;
-    val->sig_mot = emb_func_int2.int2_sig_mot;
-    val->step_det = emb_func_int2.int2_step_det;
-    val->fsm_lc = emb_func_int2.int2_fsm_lc;
+    ret += iis2dulpx_txn_shadow_read(&txn, iis2dulpx_duty_reg[i], &duty->img[i]);
+  }
+  ret += iis2dulpx_txn_run(&txn);
+  if (ret != 0)
+  {
+    return ret;
   }
-  ret = iis2dulpx_mem_bank_set(ctx, IIS2DULPX_MAIN_MEM_BANK);
 
-  return ret;
+  return iis2dulpx_duty_apply(ctx, duty, (uint8_t)IIS2DULPX_DUTY_LP);
 }
 
-int32_t iis2dulpx_int_config_set(const stmdev_ctx_t *ctx, const iis2dulpx_int_config_t *val)
+int32_t iis2dulpx_duty_event(const stmdev_ctx_t *ctx, iis2dulpx_duty_t *duty,
+                             iis2dulpx_duty_ev_t ev)
 {
-  iis2dulpx_interrupt_cfg_t interrupt_cfg = {0};
-  int32_t ret = 0;
-
-  ret = iis2dulpx_read_reg(ctx, IIS2DULPX_INTERRUPT_CFG, (uint8_t *)&interrupt_cfg, 1);
+  uint8_t level = duty->level;
 
-  if (ret == 0)
+  switch (ev)
   {
-    switch (val->int_cfg)
-    {
-      case IIS2DULPX_INT_DISABLED:
-        interrupt_cfg.interrupts_enable = 0;
-        break;
+    case IIS2DULPX_DUTY_EV_INACTIVE:
+      level = (uint8_t)IIS2DULPX_DUTY_ULP;
+      duty->motion = 0U;
+      break;
 
-      case IIS2DULPX_INT_LEVEL:
-        interrupt_cfg.interrupts_enable = 1;
-        interrupt_cfg.lir = 0;
-        break;
+    case IIS2DULPX_DUTY_EV_ACTIVE:
+      if (level == (uint8_t)IIS2DULPX_DUTY_ULP)
+      {
+        level = (uint8_t)IIS2DULPX_DUTY_LP;
+      }
+      duty->motion = 0U;
+      break;
 
-      case IIS2DULPX_INT_LATCHED:
-      default:
-        interrupt_cfg.interrupts_enable = 1;
-        interrupt_cfg.lir = 1;
-        break;
-    }
+    case IIS2DULPX_DUTY_EV_MOTION:
+      if (level == (uint8_t)IIS2DULPX_DUTY_ULP)
+      {
+        /* sleep_change to active was missed */
+        level = (uint8_t)IIS2DULPX_DUTY_LP;
+      }
+      else if ((level == (uint8_t)IIS2DULPX_DUTY_LP) && (duty->cfg.hp_motion != 0U))
+      {
+        if (duty->motion < 0xFFU)
+        {
+          duty->motion++;
+        }
+        if (duty->motion >= duty->cfg.hp_motion)
+        {
+          level = (uint8_t)IIS2DULPX_DUTY_HP;
+          duty->motion = 0U;
+        }
+      }
+      else
+      {
+        /* stay in HP until inactivity */
+      }
+      break;
 
-    interrupt_cfg.dis_rst_lir_all_int = val->dis_rst_lir_all_int;
-    interrupt_cfg.sleep_status_on_int = val->sleep_status_on_int;
+    default:
+      return -1;
+  }
 
-    ret = iis2dulpx_write_reg(ctx, IIS2DULPX_INTERRUPT_CFG, (uint8_t *)&interrupt_cfg, 1);
+  if ((level == duty->level) && (duty->dirty == PROPERTY_DISABLE))
+  {
+    duty->writes = 0U;
+    return 0;
   }
 
-  return ret;
+  return iis2dulpx_duty_apply(ctx, duty, level);
 }
 
-int32_t iis2dulpx_int_config_get(const stmdev_ctx_t *ctx, iis2dulpx_int_config_t *val)
+int32_t iis2dulpx_duty_sources_update(const stmdev_ctx_t *ctx, iis2dulpx_duty_t *duty,
+                                      const iis2dulpx_all_sources_t *src)
 {
-  iis2dulpx_interrupt_cfg_t interrupt_cfg = {0};
   int32_t ret = 0;
 
-  ret = iis2dulpx_read_reg(ctx, IIS2DULPX_INTERRUPT_CFG, (uint8_t *)&interrupt_cfg, 1);
-
-  if (ret == 0)
+  if (src->sleep_change != 0U)
   {
-    val->dis_rst_lir_all_int = interrupt_cfg.dis_rst_lir_all_int;
-    val->sleep_status_on_int = interrupt_cfg.sleep_status_on_int;
-
-    if (interrupt_cfg.interrupts_enable == 0U)
-    {
-      val->int_cfg = IIS2DULPX_INT_DISABLED;
-    }
-    else if (interrupt_cfg.lir == 0U)
-    {
-      val->int_cfg = IIS2DULPX_INT_LEVEL;
-    }
-    else
-    {
-      val->int_cfg = IIS2DULPX_INT_LATCHED;
-    }
+    ret = iis2dulpx_duty_event(ctx, duty, (src->sleep_state != 0U) ?
+                               IIS2DULPX_DUTY_EV_INACTIVE : IIS2DULPX_DUTY_EV_ACTIVE);
+  }
+  else if (src->wake_up != 0U)
+  {
+    ret = iis2dulpx_duty_event(ctx, duty, IIS2DULPX_DUTY_EV_MOTION);
+  }
+  else
+  {
+    duty->writes = 0U;
   }
 
   return ret;
 }
 
-int32_t iis2dulpx_embedded_int_cfg_set(const stmdev_ctx_t *ctx, iis2dulpx_embedded_int_config_t val)
+int32_t iis2dulpx_long_cnt_flag_data_ready_get(const stmdev_ctx_t *ctx,
+                                               uint8_t *val)
 {
-  iis2dulpx_page_rw_t page_rw = {0};
+  iis2dulpx_emb_func_status_t emb_func_status = {0};
   int32_t ret = 0;
 
   ret = iis2dulpx_mem_bank_set(ctx, IIS2DULPX_EMBED_FUNC_MEM_BANK);
+  ret += iis2dulpx_read_reg(ctx, IIS2DULPX_EMB_FUNC_STATUS,
+                            (uint8_t *)&emb_func_status, 1);
   if (ret == 0)
   {
-    ret = iis2dulpx_read_reg(ctx, IIS2DULPX_PAGE_RW, (uint8_t *)&page_rw, 1);
-
-    if (ret == 0)
-    {
-      switch (val)
-      {
-        case IIS2DULPX_EMBEDDED_INT_LEVEL:
-          page_rw.emb_func_lir = 0;
-          break;
-
-        case IIS2DULPX_EMBEDDED_INT_LATCHED:
-        default:
-          page_rw.emb_func_lir = 1;
-          break;
-      }
-
-      ret += iis2dulpx_write_reg(ctx, IIS2DULPX_PAGE_RW, (uint8_t *)&page_rw, 1);
-    }
+    *val = emb_func_status.is_fsm_lc;
   }
 
   ret += iis2dulpx_mem_bank_set(ctx, IIS2DULPX_MAIN_MEM_BANK);
@@ -1768,28 +5860,20 @@ int32_t iis2dulpx_embedded_int_cfg_set(const stmdev_ctx_t *ctx, iis2dulpx_embedd
   return ret;
 }
 
-int32_t iis2dulpx_embedded_int_cfg_get(const stmdev_ctx_t *ctx,
-                                       iis2dulpx_embedded_int_config_t *val)
+int32_t iis2dulpx_emb_fsm_en_set(const stmdev_ctx_t *ctx, uint8_t val)
 {
-  iis2dulpx_page_rw_t page_rw = {0};
   int32_t ret = 0;
 
+  iis2dulpx_emb_func_en_b_t emb_func_en_b;
   ret = iis2dulpx_mem_bank_set(ctx, IIS2DULPX_EMBED_FUNC_MEM_BANK);
+  ret += iis2dulpx_read_reg(ctx, IIS2DULPX_EMB_FUNC_EN_B,
+                            (uint8_t *)&emb_func_en_b, 1);
   if (ret == 0)
   {
-    ret = iis2dulpx_read_reg(ctx, IIS2DULPX_PAGE_RW, (uint8_t *)&page_rw, 1);
+    emb_func_en_b.fsm_en = (uint8_t)val & 0x01U;
 
-    if (ret == 0)
-    {
-      if (page_rw.emb_func_lir == 0U)
-      {
-        *val = IIS2DULPX_EMBEDDED_INT_LEVEL;
-      }
-      else
-      {
-        *val = IIS2DULPX_EMBEDDED_INT_LATCHED;
-      }
-    }
+    ret += iis2dulpx_write_reg(ctx, IIS2DULPX_EMB_FUNC_EN_B,
+                               (uint8_t *)&emb_func_en_b, 1);
   }
 
   ret += iis2dulpx_mem_bank_set(ctx, IIS2DULPX_MAIN_MEM_BANK);
@@ -1797,559 +5881,572 @@ int32_t iis2dulpx_embedded_int_cfg_get(const stmdev_ctx_t *ctx,
   return ret;
 }
 
-int32_t iis2dulpx_fifo_mode_set(const stmdev_ctx_t *ctx, iis2dulpx_fifo_mode_t val)
+int32_t iis2dulpx_emb_fsm_en_get(const stmdev_ctx_t *ctx, uint8_t *val)
 {
-  iis2dulpx_ctrl4_t ctrl4 = {0};
-  iis2dulpx_fifo_ctrl_t fifo_ctrl = {0};
-  iis2dulpx_fifo_wtm_t fifo_wtm = {0};
   int32_t ret = 0;
 
-  ret = iis2dulpx_read_reg(ctx, IIS2DULPX_CTRL4, (uint8_t *)&ctrl4, 1);
-  ret += iis2dulpx_read_reg(ctx, IIS2DULPX_FIFO_CTRL, (uint8_t *)&fifo_ctrl, 1);
-  ret += iis2dulpx_read_reg(ctx, IIS2DULPX_FIFO_WTM, (uint8_t *)&fifo_wtm, 1);
-
+  iis2dulpx_emb_func_en_b_t emb_func_en_b;
+  ret = iis2dulpx_mem_bank_set(ctx, IIS2DULPX_EMBED_FUNC_MEM_BANK);
+  ret += iis2dulpx_read_reg(ctx, IIS2DULPX_EMB_FUNC_EN_B,
+                            (uint8_t *)&emb_func_en_b, 1);
   if (ret == 0)
   {
-    /* set FIFO mode */
-    if (val.operation != IIS2DULPX_FIFO_OFF)
-    {
-      ctrl4.fifo_en = 1;
-      fifo_ctrl.fifo_mode = ((uint8_t)val.operation & 0x7U);
-    }
-    else
-    {
-      ctrl4.fifo_en = 0;
-    }
-
-    /* set fifo depth (1X/2X) */
-    fifo_ctrl.fifo_depth = (uint8_t)val.store & 0x01U;
-
-    /* Set xl_only_fifo */
-    fifo_wtm.xl_only_fifo = val.xl_only & 0x01U;
-
-    fifo_ctrl.cfg_chg_en = val.cfg_change_in_fifo & 0x01U;
-
-    ret += iis2dulpx_write_reg(ctx, IIS2DULPX_CTRL4, (uint8_t *)&ctrl4, 1);
-    ret += iis2dulpx_write_reg(ctx, IIS2DULPX_FIFO_CTRL, (uint8_t *)&fifo_ctrl, 1);
-    ret += iis2dulpx_write_reg(ctx, IIS2DULPX_FIFO_WTM, (uint8_t *)&fifo_wtm, 1);
+    *val = emb_func_en_b.fsm_en;
   }
 
+  ret += iis2dulpx_mem_bank_set(ctx, IIS2DULPX_MAIN_MEM_BANK);
+
   return ret;
 }
 
-int32_t iis2dulpx_fifo_mode_get(const stmdev_ctx_t *ctx, iis2dulpx_fifo_mode_t *val)
+int32_t iis2dulpx_fsm_enable_set(const stmdev_ctx_t *ctx,
+                                 iis2dulpx_emb_fsm_enable_t *val)
 {
-  iis2dulpx_ctrl4_t ctrl4 = {0};
-  iis2dulpx_fifo_ctrl_t fifo_ctrl = {0};
-  iis2dulpx_fifo_wtm_t fifo_wtm = {0};
+  iis2dulpx_emb_func_en_b_t emb_func_en_b = {0};
   int32_t ret = 0;
 
-  ret = iis2dulpx_read_reg(ctx, IIS2DULPX_CTRL4, (uint8_t *)&ctrl4, 1);
-  ret += iis2dulpx_read_reg(ctx, IIS2DULPX_FIFO_CTRL, (uint8_t *)&fifo_ctrl, 1);
-  ret += iis2dulpx_read_reg(ctx, IIS2DULPX_FIFO_WTM, (uint8_t *)&fifo_wtm, 1);
+  ret = iis2dulpx_mem_bank_set(ctx, IIS2DULPX_EMBED_FUNC_MEM_BANK);
 
   if (ret == 0)
   {
-    /* get FIFO mode */
-    if (ctrl4.fifo_en == 0U)
+    ret = iis2dulpx_write_reg(ctx, IIS2DULPX_FSM_ENABLE,
+                              (uint8_t *)&val->fsm_enable, 1);
+  }
+
+  ret += iis2dulpx_read_reg(ctx, IIS2DULPX_EMB_FUNC_EN_B,
+                            (uint8_t *)&emb_func_en_b, 1);
+  if (ret == 0)
+  {
+    if ((val->fsm_enable.fsm1_en |
+         val->fsm_enable.fsm2_en |
+         val->fsm_enable.fsm3_en |
+         val->fsm_enable.fsm4_en |
+         val->fsm_enable.fsm5_en |
+         val->fsm_enable.fsm6_en |
+         val->fsm_enable.fsm7_en |
+         val->fsm_enable.fsm8_en) != PROPERTY_DISABLE)
     {
-      val->operation = IIS2DULPX_FIFO_OFF;
+      emb_func_en_b.fsm_en = PROPERTY_ENABLE;
     }
     else
     {
-      val->operation = (iis2dulpx_operation_t)fifo_ctrl.fifo_mode;
+      emb_func_en_b.fsm_en = PROPERTY_DISABLE;
     }
-    val->cfg_change_in_fifo = fifo_ctrl.cfg_chg_en;
-
-    /* get fifo depth (1X/2X) */
-    val->store = (iis2dulpx_store_t)fifo_ctrl.fifo_depth;
-
-    /* Get xl_only_fifo */
-    val->xl_only = fifo_wtm.xl_only_fifo;
 
+    ret += iis2dulpx_write_reg(ctx, IIS2DULPX_EMB_FUNC_EN_B,
+                               (uint8_t *)&emb_func_en_b, 1);
   }
 
-  return ret;
-}
-
-int32_t iis2dulpx_fifo_watermark_set(const stmdev_ctx_t *ctx, uint8_t val)
-{
-  iis2dulpx_fifo_wtm_t fifo_wtm = {0};
-  int32_t ret = 0;
-
-  ret = iis2dulpx_read_reg(ctx, IIS2DULPX_FIFO_WTM, (uint8_t *)&fifo_wtm, 1);
-
-  if (ret == 0)
-  {
-    fifo_wtm.fth = val & 0x7FU;
-    ret += iis2dulpx_write_reg(ctx, IIS2DULPX_FIFO_WTM, (uint8_t *)&fifo_wtm, 1);
-  }
+  ret += iis2dulpx_mem_bank_set(ctx, IIS2DULPX_MAIN_MEM_BANK);
 
   return ret;
 }
 
-int32_t iis2dulpx_fifo_watermark_get(const stmdev_ctx_t *ctx, uint8_t *val)
+int32_t iis2dulpx_fsm_enable_get(const stmdev_ctx_t *ctx,
+                                 iis2dulpx_emb_fsm_enable_t *val)
 {
-  iis2dulpx_fifo_wtm_t fifo_wtm = {0};
   int32_t ret = 0;
 
-  ret = iis2dulpx_read_reg(ctx, IIS2DULPX_FIFO_WTM, (uint8_t *)&fifo_wtm, 1);
+  ret = iis2dulpx_mem_bank_set(ctx, IIS2DULPX_EMBED_FUNC_MEM_BANK);
 
   if (ret == 0)
   {
-    *val = fifo_wtm.fth;
+    ret = iis2dulpx_read_reg(ctx, IIS2DULPX_FSM_ENABLE,
+                             (uint8_t *)&val->fsm_enable, 1);
   }
 
+  ret += iis2dulpx_mem_bank_set(ctx, IIS2DULPX_MAIN_MEM_BANK);
+
   return ret;
 }
 
-int32_t iis2dulpx_fifo_batch_set(const stmdev_ctx_t *ctx, iis2dulpx_fifo_batch_t val)
+int32_t iis2dulpx_long_cnt_set(const stmdev_ctx_t *ctx, uint16_t val)
 {
-  iis2dulpx_fifo_batch_dec_t fifo_batch = {0};
+  uint8_t buff[2] = {0};
   int32_t ret = 0;
 
-  ret = iis2dulpx_read_reg(ctx, IIS2DULPX_FIFO_BATCH_DEC, (uint8_t *)&fifo_batch, 1);
+  ret = iis2dulpx_mem_bank_set(ctx, IIS2DULPX_EMBED_FUNC_MEM_BANK);
 
   if (ret == 0)
   {
-    fifo_batch.dec_ts_batch = (uint8_t)val.dec_ts & 0x03U;
-    fifo_batch.bdr_xl = (uint8_t)val.bdr_xl & 0x07U;
-
-    ret += iis2dulpx_write_reg(ctx, IIS2DULPX_FIFO_BATCH_DEC, (uint8_t *)&fifo_batch, 1);
+    buff[1] = (uint8_t)(val / 256U);
+    buff[0] = (uint8_t)(val - (buff[1] * 256U));
+    ret = iis2dulpx_write_reg(ctx, IIS2DULPX_FSM_LONG_COUNTER_L, buff, 2);
   }
 
+  ret += iis2dulpx_mem_bank_set(ctx, IIS2DULPX_MAIN_MEM_BANK);
+
   return ret;
 }
 
-int32_t iis2dulpx_fifo_batch_get(const stmdev_ctx_t *ctx, iis2dulpx_fifo_batch_t *val)
+int32_t iis2dulpx_long_cnt_get(const stmdev_ctx_t *ctx, uint16_t *val)
 {
-  iis2dulpx_fifo_batch_dec_t fifo_batch = {0};
+  uint8_t buff[2] = {0};
   int32_t ret = 0;
 
-  ret = iis2dulpx_read_reg(ctx, IIS2DULPX_FIFO_BATCH_DEC, (uint8_t *)&fifo_batch, 1);
+  ret = iis2dulpx_mem_bank_set(ctx, IIS2DULPX_EMBED_FUNC_MEM_BANK);
 
   if (ret == 0)
   {
-    val->dec_ts = (iis2dulpx_dec_ts_t)fifo_batch.dec_ts_batch;
-    val->bdr_xl = (iis2dulpx_bdr_xl_t)fifo_batch.bdr_xl;
+    ret = iis2dulpx_read_reg(ctx, IIS2DULPX_FSM_LONG_COUNTER_L, buff, 2);
+    *val = (uint16_t)(buff[0] | ((uint16_t)buff[1] << 8));
   }
 
+  ret += iis2dulpx_mem_bank_set(ctx, IIS2DULPX_MAIN_MEM_BANK);
+
   return ret;
 }
 
-int32_t iis2dulpx_fifo_stop_on_wtm_set(const stmdev_ctx_t *ctx, iis2dulpx_fifo_event_t val)
+int32_t iis2dulpx_fsm_status_get(const stmdev_ctx_t *ctx,
+                                 iis2dulpx_fsm_status_mainpage_t *val)
+{
+  return iis2dulpx_read_reg(ctx, IIS2DULPX_FSM_STATUS_MAINPAGE,
+                            (uint8_t *) val, 1);
+}
+
+int32_t iis2dulpx_fsm_out_get(const stmdev_ctx_t *ctx, uint8_t *val)
 {
-  iis2dulpx_fifo_ctrl_t fifo_ctrl = {0};
   int32_t ret = 0;
 
-  ret = iis2dulpx_read_reg(ctx, IIS2DULPX_FIFO_CTRL, (uint8_t *)&fifo_ctrl, 1);
+  ret = iis2dulpx_mem_bank_set(ctx, IIS2DULPX_EMBED_FUNC_MEM_BANK);
 
   if (ret == 0)
   {
-    fifo_ctrl.stop_on_fth = (val == IIS2DULPX_FIFO_EV_WTM) ? 1U : 0U;
-    ret += iis2dulpx_write_reg(ctx, IIS2DULPX_FIFO_CTRL, (uint8_t *)&fifo_ctrl, 1);
+    ret = iis2dulpx_read_reg(ctx, IIS2DULPX_FSM_OUTS1, val, 8);
   }
 
+  ret += iis2dulpx_mem_bank_set(ctx, IIS2DULPX_MAIN_MEM_BANK);
+
   return ret;
 }
 
-int32_t iis2dulpx_fifo_stop_on_wtm_get(const stmdev_ctx_t *ctx, iis2dulpx_fifo_event_t *val)
+int32_t iis2dulpx_fsm_data_rate_set(const stmdev_ctx_t *ctx,
+                                    iis2dulpx_fsm_val_odr_t val)
 {
-  iis2dulpx_fifo_ctrl_t fifo_ctrl = {0};
+  iis2dulpx_fsm_odr_t fsm_odr_reg = {0};
   int32_t ret = 0;
 
-  ret = iis2dulpx_read_reg(ctx, IIS2DULPX_FIFO_CTRL, (uint8_t *)&fifo_ctrl, 1);
-
+  ret = iis2dulpx_mem_bank_set(ctx, IIS2DULPX_EMBED_FUNC_MEM_BANK);
+  ret += iis2dulpx_read_reg(ctx, IIS2DULPX_FSM_ODR,
+                            (uint8_t *)&fsm_odr_reg, 1);
   if (ret == 0)
   {
-    *val = (fifo_ctrl.stop_on_fth == 1U) ? IIS2DULPX_FIFO_EV_WTM : IIS2DULPX_FIFO_EV_FULL;
+    fsm_odr_reg.fsm_odr = (uint8_t)val & 0x07U;
+    ret += iis2dulpx_write_reg(ctx, IIS2DULPX_FSM_ODR,
+                               (uint8_t *)&fsm_odr_reg, 1);
   }
 
+  ret += iis2dulpx_mem_bank_set(ctx, IIS2DULPX_MAIN_MEM_BANK);
+
   return ret;
 }
 
-int32_t iis2dulpx_fifo_data_level_get(const stmdev_ctx_t *ctx, uint16_t *val)
+int32_t iis2dulpx_fsm_data_rate_get(const stmdev_ctx_t *ctx,
+                                    iis2dulpx_fsm_val_odr_t *val)
 {
-  uint8_t buff = 0;
+  iis2dulpx_fsm_odr_t fsm_odr_reg = {0};
   int32_t ret = 0;
 
-  ret = iis2dulpx_read_reg(ctx, IIS2DULPX_FIFO_STATUS2, &buff, 1);
+  ret = iis2dulpx_mem_bank_set(ctx, IIS2DULPX_EMBED_FUNC_MEM_BANK);
+  ret += iis2dulpx_read_reg(ctx, IIS2DULPX_FSM_ODR, (uint8_t *)&fsm_odr_reg, 1);
+  ret += iis2dulpx_mem_bank_set(ctx, IIS2DULPX_MAIN_MEM_BANK);
 
-  if (ret == 0)
+  if (ret != 0)
   {
-    *val = buff;
+    return ret;
+  }
+
+  switch (fsm_odr_reg.fsm_odr)
+  {
+    case 0:
+      *val = IIS2DULPX_ODR_FSM_12Hz5;
+      break;
+
+    case 1:
+      *val = IIS2DULPX_ODR_FSM_25Hz;
+      break;
+
+    case 2:
+      *val = IIS2DULPX_ODR_FSM_50Hz;
+      break;
+
+    case 3:
+      *val = IIS2DULPX_ODR_FSM_100Hz;
+      break;
+
+    case 4:
+      *val = IIS2DULPX_ODR_FSM_200Hz;
+      break;
+
+    case 5:
+      *val = IIS2DULPX_ODR_FSM_400Hz;
+      break;
+
+    case 6:
+      *val = IIS2DULPX_ODR_FSM_800Hz;
+      break;
+
+    default:
+      *val = IIS2DULPX_ODR_FSM_12Hz5;
+      break;
   }
 
   return ret;
 }
 
-int32_t iis2dulpx_fifo_wtm_flag_get(const stmdev_ctx_t *ctx, uint8_t *val)
+int32_t iis2dulpx_fsm_init_set(const stmdev_ctx_t *ctx, uint8_t val)
 {
-  iis2dulpx_fifo_status1_t fifo_status1 = {0};
+  iis2dulpx_emb_func_init_b_t emb_func_init_b = {0};
   int32_t ret = 0;
 
-  ret = iis2dulpx_read_reg(ctx, IIS2DULPX_FIFO_STATUS1, (uint8_t *)&fifo_status1, 1);
+  ret = iis2dulpx_mem_bank_set(ctx, IIS2DULPX_EMBED_FUNC_MEM_BANK);
+  ret += iis2dulpx_read_reg(ctx, IIS2DULPX_EMB_FUNC_INIT_B,
+                            (uint8_t *)&emb_func_init_b, 1);
 
   if (ret == 0)
   {
-    *val = fifo_status1.fifo_wtm_ia;
+    emb_func_init_b.fsm_init = (uint8_t)val & 0x01U;
+
+    ret += iis2dulpx_write_reg(ctx, IIS2DULPX_EMB_FUNC_INIT_B,
+                               (uint8_t *)&emb_func_init_b, 1);
   }
 
+  ret += iis2dulpx_mem_bank_set(ctx, IIS2DULPX_MAIN_MEM_BANK);
+
   return ret;
 }
 
-int32_t iis2dulpx_fifo_sensor_tag_get(const stmdev_ctx_t *ctx, iis2dulpx_fifo_sensor_tag_t *val)
+int32_t iis2dulpx_fsm_init_get(const stmdev_ctx_t *ctx, uint8_t *val)
 {
-  iis2dulpx_fifo_data_out_tag_t fifo_tag = {0};
+  iis2dulpx_emb_func_init_b_t emb_func_init_b = {0};
   int32_t ret = 0;
 
-  ret = iis2dulpx_read_reg(ctx, IIS2DULPX_FIFO_DATA_OUT_TAG, (uint8_t *)&fifo_tag, 1);
-
+  ret = iis2dulpx_mem_bank_set(ctx, IIS2DULPX_EMBED_FUNC_MEM_BANK);
+  ret += iis2dulpx_read_reg(ctx, IIS2DULPX_EMB_FUNC_INIT_B,
+                            (uint8_t *)&emb_func_init_b, 1);
   if (ret == 0)
   {
-    *val = (iis2dulpx_fifo_sensor_tag_t) fifo_tag.tag_sensor;
+    *val = emb_func_init_b.fsm_init;
   }
 
+  ret += iis2dulpx_mem_bank_set(ctx, IIS2DULPX_MAIN_MEM_BANK);
+
   return ret;
 }
 
-int32_t iis2dulpx_fifo_out_raw_get(const stmdev_ctx_t *ctx, uint8_t *buff)
+int32_t iis2dulpx_fsm_fifo_en_set(const stmdev_ctx_t *ctx, uint8_t val)
 {
+  iis2dulpx_emb_func_fifo_en_t fifo_reg = {0};
   int32_t ret = 0;
 
-  ret = iis2dulpx_read_reg(ctx, IIS2DULPX_FIFO_DATA_OUT_X_L, buff, 6);
+  ret = iis2dulpx_mem_bank_set(ctx, IIS2DULPX_EMBED_FUNC_MEM_BANK);
+  ret += iis2dulpx_read_reg(ctx, IIS2DULPX_EMB_FUNC_FIFO_EN, (uint8_t *)&fifo_reg, 1);
+  if (ret == 0)
+  {
+    fifo_reg.fsm_fifo_en = val & 0x01U;
+    ret += iis2dulpx_write_reg(ctx, IIS2DULPX_EMB_FUNC_FIFO_EN, (uint8_t *)&fifo_reg, 1);
+  }
+
+  ret += iis2dulpx_mem_bank_set(ctx, IIS2DULPX_MAIN_MEM_BANK);
 
   return ret;
 }
 
-int32_t iis2dulpx_fifo_data_get(const stmdev_ctx_t *ctx, const iis2dulpx_md_t *md,
-                                const iis2dulpx_fifo_mode_t *fmd,
-                                iis2dulpx_fifo_data_t *data)
+int32_t iis2dulpx_fsm_fifo_en_get(const stmdev_ctx_t *ctx, uint8_t *val)
 {
-  iis2dulpx_fifo_data_out_tag_t fifo_tag = {0};
-  uint8_t fifo_raw[6] = {0};
-  int32_t ret = 0, i = 0;
+  iis2dulpx_emb_func_fifo_en_t fifo_reg = {0};
+  int32_t ret = 0;
 
-  ret = iis2dulpx_read_reg(ctx, IIS2DULPX_FIFO_DATA_OUT_TAG, (uint8_t *)&fifo_tag, 1);
-  if (ret != 0)
+  ret = iis2dulpx_mem_bank_set(ctx, IIS2DULPX_EMBED_FUNC_MEM_BANK);
+  ret += iis2dulpx_read_reg(ctx, IIS2DULPX_EMB_FUNC_FIFO_EN, (uint8_t *)&fifo_reg, 1);
+  if (ret == 0)
   {
-    return ret;
+    *val = fifo_reg.fsm_fifo_en;
   }
-  data->tag = fifo_tag.tag_sensor;
-
-  switch (fifo_tag.tag_sensor)
-  {
-    case (uint8_t)IIS2DULPX_XL_ONLY_2X_TAG:
-    case (uint8_t)IIS2DULPX_XL_ONLY_2X_TAG_2ND:
-      /* A FIFO sample consists of 2X 8-bits 3-axis XL at ODR/2 */
-      ret = iis2dulpx_fifo_out_raw_get(ctx, fifo_raw);
-      if (ret != 0)
-      {
-        return ret;
-      }
-      for (i = 0; i < 3; i++)
-      {
-        data->xl[0].raw[i] = (int16_t)fifo_raw[i] * 256;
-        data->xl[1].raw[i] = (int16_t)fifo_raw[3 + i] * 256;
-      }
-      break;
-    case (uint8_t)IIS2DULPX_XL_AND_QVAR:
-    case (uint8_t)IIS2DULPX_XL_TEMP_TAG:
-      ret = iis2dulpx_fifo_out_raw_get(ctx, fifo_raw);
-      if (ret != 0)
-      {
-        return ret;
-      }
-      if (fmd->xl_only == 0x0U)
-      {
-        /* A FIFO sample consists of 12-bits 3-axis XL + T at ODR*/
-        data->xl[0].raw[0] = (int16_t)((fifo_raw[0] | ((uint16_t)fifo_raw[1] << 8)) << 4);
-        data->xl[0].raw[1] = (int16_t)(((fifo_raw[1] >> 4) | ((uint16_t) fifo_raw[2] << 4)) << 4);
-        data->xl[0].raw[2] = (int16_t)((fifo_raw[3] | ((uint16_t)fifo_raw[4] << 8)) << 4);
-
-        data->heat.raw = (int16_t)(((fifo_raw[4] >> 4) + ((uint16_t)fifo_raw[5] << 4)) << 4);
-        if (fifo_tag.tag_sensor == (uint8_t)IIS2DULPX_XL_TEMP_TAG)
-        {
-          data->heat.deg_c = iis2dulpx_from_lsb_to_celsius(data->heat.raw);
-        }
-        else
-        {
-          data->ah_qvar.raw = data->heat.raw;
-          data->ah_qvar.mv = iis2dulpx_from_lsb_to_mv(data->ah_qvar.raw);
-        }
-      }
-      else
-      {
-        /* A FIFO sample consists of 16-bits 3-axis XL at ODR  */
-        data->xl[0].raw[0] = (int16_t)(fifo_raw[0] | ((uint16_t)fifo_raw[1] << 8));
-        data->xl[0].raw[1] = (int16_t)(fifo_raw[2] | ((uint16_t)fifo_raw[3] << 8));
-        data->xl[0].raw[2] = (int16_t)(fifo_raw[4] | ((uint16_t)fifo_raw[5] << 8));
-      }
-      break;
-    case (uint8_t)IIS2DULPX_TIMESTAMP_TAG:
-      ret = iis2dulpx_fifo_out_raw_get(ctx, fifo_raw);
-      if (ret != 0)
-      {
-        return ret;
-      }
-
-      data->cfg_chg.cfg_change = (fifo_raw[0] >> 7) & 0x01U;
-      data->cfg_chg.odr = (fifo_raw[0] >> 3) & 0xFU;
-      data->cfg_chg.bw = (fifo_raw[0] >> 1) & 0x3U;
-      data->cfg_chg.lp_hp = fifo_raw[0] & 0x1U;
-      data->cfg_chg.qvar_en = (fifo_raw[1] >> 7) & 0x01U;
-      data->cfg_chg.fs = (fifo_raw[1] >> 5) & 0x3U;
-      data->cfg_chg.dec_ts = (fifo_raw[1] >> 3) & 0x3U;
-      data->cfg_chg.odr_xl_batch = fifo_raw[1] & 0x1U;
-
-      data->cfg_chg.timestamp = fifo_raw[5];
-      data->cfg_chg.timestamp = (data->cfg_chg.timestamp * 256U) +  fifo_raw[4];
-      data->cfg_chg.timestamp = (data->cfg_chg.timestamp * 256U) +  fifo_raw[3];
-      data->cfg_chg.timestamp = (data->cfg_chg.timestamp * 256U) +  fifo_raw[2];
-      break;
-
-    case (uint8_t)IIS2DULPX_STEP_COUNTER_TAG:
-      ret = iis2dulpx_fifo_out_raw_get(ctx, fifo_raw);
-      if (ret != 0)
-      {
-        return ret;
-      }
-
-      data->pedo.steps = fifo_raw[1];
-      data->pedo.steps = (data->pedo.steps * 256U) +  fifo_raw[0];
-
-      data->pedo.timestamp = fifo_raw[5];
-      data->pedo.timestamp = (data->pedo.timestamp * 256U) +  fifo_raw[4];
-      data->pedo.timestamp = (data->pedo.timestamp * 256U) +  fifo_raw[3];
-      data->pedo.timestamp = (data->pedo.timestamp * 256U) +  fifo_raw[2];
 
-      break;
+  ret += iis2dulpx_mem_bank_set(ctx, IIS2DULPX_MAIN_MEM_BANK);
 
-    case (uint8_t)IIS2DULPX_FIFO_EMPTY:
-    default:
-      /* do nothing */
-      break;
-  }
+  return ret;
+}
 
-  for (i = 0; i < 3; i++)
-  {
-    switch (md->fs)
-    {
-      case IIS2DULPX_2g:
-        data->xl[0].mg[i] = iis2dulpx_from_fs2g_to_mg(data->xl[0].raw[i]);
-        data->xl[1].mg[i] = iis2dulpx_from_fs2g_to_mg(data->xl[1].raw[i]);
-        break;
-      case IIS2DULPX_4g:
-        data->xl[0].mg[i] = iis2dulpx_from_fs4g_to_mg(data->xl[0].raw[i]);
-        data->xl[1].mg[i] = iis2dulpx_from_fs4g_to_mg(data->xl[1].raw[i]);
-        break;
-      case IIS2DULPX_8g:
-        data->xl[0].mg[i] = iis2dulpx_from_fs8g_to_mg(data->xl[0].raw[i]);
-        data->xl[1].mg[i] = iis2dulpx_from_fs8g_to_mg(data->xl[1].raw[i]);
-        break;
-      case IIS2DULPX_16g:
-        data->xl[0].mg[i] = iis2dulpx_from_fs16g_to_mg(data->xl[0].raw[i]);
-        data->xl[1].mg[i] = iis2dulpx_from_fs16g_to_mg(data->xl[1].raw[i]);
-        break;
-      default:
-        data->xl[0].mg[i] = 0.0f;
-        data->xl[1].mg[i] = 0.0f;
-        break;
-    }
-  }
+int32_t iis2dulpx_long_cnt_int_value_set(const stmdev_ctx_t *ctx,
+                                         uint16_t val)
+{
+  uint8_t buff[2] = {0};
+  int32_t ret = 0;
+
+  buff[1] = (uint8_t)(val / 256U);
+  buff[0] = (uint8_t)(val - (buff[1] * 256U));
+  ret = iis2dulpx_ln_pg_write(ctx, IIS2DULPX_FSM_LC_TIMEOUT_L, buff, 2);
 
   return ret;
 }
 
-int32_t iis2dulpx_ah_qvar_mode_set(const stmdev_ctx_t *ctx,
-                                   iis2dulpx_ah_qvar_mode_t val)
+int32_t iis2dulpx_long_cnt_int_value_get(const stmdev_ctx_t *ctx,
+                                         uint16_t *val)
 {
-  iis2dulpx_ah_qvar_cfg_t ah_qvar_cfg = {0};
+  uint8_t buff[2] = {0};
   int32_t ret = 0;
 
-  ret = iis2dulpx_read_reg(ctx, IIS2DULPX_AH_QVAR_CFG, (uint8_t *)&ah_qvar_cfg, 1);
+  ret = iis2dulpx_ln_pg_read(ctx, IIS2DULPX_FSM_LC_TIMEOUT_L, buff, 2);
   if (ret == 0)
   {
-    ah_qvar_cfg.ah_qvar_gain = (uint8_t)val.ah_qvar_gain & 0x03U;
-    ah_qvar_cfg.ah_qvar_c_zin = (uint8_t)val.ah_qvar_zin & 0x03U;
-    ah_qvar_cfg.ah_qvar_notch_cutoff = (uint8_t)val.ah_qvar_notch & 0x01U;
-    ah_qvar_cfg.ah_qvar_notch_en = val.ah_qvar_notch_en & 0x01U;
-    ah_qvar_cfg.ah_qvar_en = val.ah_qvar_en & 0x01U;
-    ret = iis2dulpx_write_reg(ctx, IIS2DULPX_AH_QVAR_CFG, (uint8_t *)&ah_qvar_cfg, 1);
+    *val = (uint16_t)(buff[0] | ((uint16_t)buff[1] << 8));
   }
 
   return ret;
 }
 
-int32_t iis2dulpx_ah_qvar_mode_get(const stmdev_ctx_t *ctx,
-                                   iis2dulpx_ah_qvar_mode_t *val)
+int32_t iis2dulpx_fsm_programs_num_set(const stmdev_ctx_t *ctx, uint8_t val)
 {
-  iis2dulpx_ah_qvar_cfg_t ah_qvar_cfg = {0};
   int32_t ret = 0;
 
-  ret = iis2dulpx_read_reg(ctx, IIS2DULPX_AH_QVAR_CFG, (uint8_t *)&ah_qvar_cfg, 1);
-  if (ret != 0)
-  {
-    return ret;
-  }
+  ret = iis2dulpx_ln_pg_write(ctx, IIS2DULPX_FSM_PROGRAMS, &val, 1);
 
-  switch (ah_qvar_cfg.ah_qvar_gain)
-  {
-    case 0x0:
-      val->ah_qvar_gain = IIS2DULPX_GAIN_0_5;
-      break;
+  return ret;
+}
 
-    case 0x1:
-      val->ah_qvar_gain = IIS2DULPX_GAIN_1;
-      break;
+int32_t iis2dulpx_fsm_programs_num_get(const stmdev_ctx_t *ctx, uint8_t *val)
+{
+  int32_t ret = 0;
 
-    case 0x2:
-      val->ah_qvar_gain = IIS2DULPX_GAIN_2;
-      break;
+  ret = iis2dulpx_ln_pg_read(ctx, IIS2DULPX_FSM_PROGRAMS, val, 1);
 
-    case 0x3:
-    default:
-      val->ah_qvar_gain = IIS2DULPX_GAIN_4;
-      break;
-  }
+  return ret;
+}
 
-  switch (ah_qvar_cfg.ah_qvar_c_zin)
-  {
-    case 0x0:
-      val->ah_qvar_zin = IIS2DULPX_520MOhm;
-      break;
 
-    case 0x1:
-      val->ah_qvar_zin = IIS2DULPX_175MOhm;
-      break;
+int32_t iis2dulpx_fsm_start_address_set(const stmdev_ctx_t *ctx,
+                                        uint16_t val)
+{
+  uint8_t buff[2] = {0};
+  int32_t ret = 0;
 
-    case 0x2:
-      val->ah_qvar_zin = IIS2DULPX_310MOhm;
-      break;
+  buff[1] = (uint8_t)(val / 256U);
+  buff[0] = (uint8_t)(val - (buff[1] * 256U));
+  ret = iis2dulpx_ln_pg_write(ctx, IIS2DULPX_FSM_START_ADD_L, buff, 2);
 
-    case 0x3:
-    default:
-      val->ah_qvar_zin = IIS2DULPX_75MOhm;
-      break;
+  return ret;
+}
+
+int32_t iis2dulpx_fsm_start_address_get(const stmdev_ctx_t *ctx,
+                                        uint16_t *val)
+{
+  uint8_t buff[2] = {0};
+  int32_t ret = 0;
+
+  ret = iis2dulpx_ln_pg_read(ctx, IIS2DULPX_FSM_START_ADD_L, buff, 2);
+  if (ret == 0)
+  {
+    *val = (uint16_t)(buff[0] | ((uint16_t)buff[1] << 8));
   }
 
-  switch (ah_qvar_cfg.ah_qvar_notch_cutoff)
+  return ret;
+}
+
+int32_t iis2dulpx_mlc_set(const stmdev_ctx_t *ctx, iis2dulpx_mlc_mode_t val)
+{
+  iis2dulpx_emb_func_en_a_t emb_en_a = {0};
+  iis2dulpx_emb_func_en_b_t emb_en_b = {0};
+  int32_t ret = 0;
+
+  ret = iis2dulpx_mem_bank_set(ctx, IIS2DULPX_EMBED_FUNC_MEM_BANK);
+
+  if (ret == 0)
   {
-    case 0x0:
-      val->ah_qvar_notch = IIS2DULPX_NOTCH_50HZ;
-      break;
+    ret = iis2dulpx_read_reg(ctx, IIS2DULPX_EMB_FUNC_EN_A, (uint8_t *)&emb_en_a, 1);
+    ret += iis2dulpx_read_reg(ctx, IIS2DULPX_EMB_FUNC_EN_B, (uint8_t *)&emb_en_b, 1);
 
-    case 0x1:
-    default:
-      val->ah_qvar_notch = IIS2DULPX_NOTCH_60HZ;
-      break;
+    if (ret == 0)
+    {
+      switch (val)
+      {
+        case IIS2DULPX_MLC_OFF:
+          emb_en_a.mlc_before_fsm_en = 0U;
+          emb_en_b.mlc_en = 0U;
+          break;
+        case IIS2DULPX_MLC_ON:
+          emb_en_a.mlc_before_fsm_en = 0U;
+          emb_en_b.mlc_en = 1U;
+          break;
+        case IIS2DULPX_MLC_ON_BEFORE_FSM:
+          emb_en_a.mlc_before_fsm_en = 1U;
+          emb_en_b.mlc_en = 0U;
+          break;
+        default:
+          /* do nothing */
+          break;
+      }
+
+      ret += iis2dulpx_write_reg(ctx, IIS2DULPX_EMB_FUNC_EN_A, (uint8_t *)&emb_en_a, 1);
+      ret += iis2dulpx_write_reg(ctx, IIS2DULPX_EMB_FUNC_EN_B, (uint8_t *)&emb_en_b, 1);
+    }
   }
 
-  val->ah_qvar_notch_en = ah_qvar_cfg.ah_qvar_notch_en;
-  val->ah_qvar_en = ah_qvar_cfg.ah_qvar_en;
+  ret += iis2dulpx_mem_bank_set(ctx, IIS2DULPX_MAIN_MEM_BANK);
 
   return ret;
 }
 
-int32_t iis2dulpx_stpcnt_mode_set(const stmdev_ctx_t *ctx, iis2dulpx_stpcnt_mode_t val)
+int32_t iis2dulpx_mlc_get(const stmdev_ctx_t *ctx, iis2dulpx_mlc_mode_t *val)
 {
-  iis2dulpx_emb_func_en_a_t emb_func_en_a = {0};
-  iis2dulpx_emb_func_en_b_t emb_func_en_b = {0};
-  iis2dulpx_emb_func_fifo_en_t emb_func_fifo_en = {0};
-  iis2dulpx_pedo_cmd_reg_t pedo_cmd_reg = {0};
+  iis2dulpx_emb_func_en_a_t emb_en_a = {0};
+  iis2dulpx_emb_func_en_b_t emb_en_b = {0};
   int32_t ret = 0;
 
   ret = iis2dulpx_mem_bank_set(ctx, IIS2DULPX_EMBED_FUNC_MEM_BANK);
-  ret += iis2dulpx_read_reg(ctx, IIS2DULPX_EMB_FUNC_EN_A, (uint8_t *)&emb_func_en_a, 1);
-  ret += iis2dulpx_read_reg(ctx, IIS2DULPX_EMB_FUNC_EN_B, (uint8_t *)&emb_func_en_b, 1);
-  ret += iis2dulpx_read_reg(ctx, IIS2DULPX_EMB_FUNC_FIFO_EN, (uint8_t *)&emb_func_fifo_en, 1);
 
   if (ret == 0)
   {
-    if ((val.false_step_rej == PROPERTY_ENABLE)
-        && ((emb_func_en_a.mlc_before_fsm_en & emb_func_en_b.mlc_en) == PROPERTY_DISABLE))
+    ret = iis2dulpx_read_reg(ctx, IIS2DULPX_EMB_FUNC_EN_A, (uint8_t *)&emb_en_a, 1);
+    ret += iis2dulpx_read_reg(ctx, IIS2DULPX_EMB_FUNC_EN_B, (uint8_t *)&emb_en_b, 1);
+
+    if (ret == 0)
     {
-      emb_func_en_a.mlc_before_fsm_en = PROPERTY_ENABLE;
+      if (emb_en_a.mlc_before_fsm_en == 0U && emb_en_b.mlc_en == 0U)
+      {
+        *val = IIS2DULPX_MLC_OFF;
+      }
+      else if (emb_en_a.mlc_before_fsm_en == 0U && emb_en_b.mlc_en == 1U)
+      {
+        *val = IIS2DULPX_MLC_ON;
+      }
+      else if (emb_en_a.mlc_before_fsm_en == 1U)
+      {
+        *val = IIS2DULPX_MLC_ON_BEFORE_FSM;
+      }
+      else
+      {
+        /* Do nothing */
+      }
     }
+  }
 
-    emb_func_fifo_en.step_counter_fifo_en = val.step_counter_in_fifo;
-    ret += iis2dulpx_write_reg(ctx, IIS2DULPX_EMB_FUNC_FIFO_EN, (uint8_t *)&emb_func_fifo_en, 1);
+  ret += iis2dulpx_mem_bank_set(ctx, IIS2DULPX_MAIN_MEM_BANK);
 
-    emb_func_en_a.pedo_en = val.step_counter_enable;
-    ret += iis2dulpx_write_reg(ctx, IIS2DULPX_EMB_FUNC_EN_A, (uint8_t *)&emb_func_en_a, 1);
+  return ret;
+}
+
+int32_t iis2dulpx_mlc_status_get(const stmdev_ctx_t *ctx,
+                                 iis2dulpx_mlc_status_mainpage_t *val)
+{
+  return iis2dulpx_read_reg(ctx, IIS2DULPX_MLC_STATUS_MAINPAGE,
+                            (uint8_t *) val, 1);
+}
+
+int32_t iis2dulpx_mlc_out_get(const stmdev_ctx_t *ctx, uint8_t *buff)
+{
+  int32_t ret = 0;
+
+  ret = iis2dulpx_mem_bank_set(ctx, IIS2DULPX_EMBED_FUNC_MEM_BANK);
+
+  if (ret == 0)
+  {
+    ret = iis2dulpx_read_reg(ctx, IIS2DULPX_MLC1_SRC, buff, 4);
   }
 
   ret += iis2dulpx_mem_bank_set(ctx, IIS2DULPX_MAIN_MEM_BANK);
 
-  ret += iis2dulpx_ln_pg_read(ctx, IIS2DULPX_EMB_ADV_PG_0 + IIS2DULPX_PEDO_CMD_REG,
-                              (uint8_t *)&pedo_cmd_reg, 1);
+  return ret;
+}
+
+int32_t iis2dulpx_mlc_data_rate_set(const stmdev_ctx_t *ctx,
+                                    iis2dulpx_mlc_odr_val_t val)
+{
+  iis2dulpx_mlc_odr_t reg = {0};
+  int32_t ret = 0;
+
+  ret = iis2dulpx_mem_bank_set(ctx, IIS2DULPX_EMBED_FUNC_MEM_BANK);
+  ret += iis2dulpx_read_reg(ctx, IIS2DULPX_MLC_ODR, (uint8_t *)&reg, 1);
 
   if (ret == 0)
   {
-    pedo_cmd_reg.fp_rejection_en = val.false_step_rej;
-    ret += iis2dulpx_ln_pg_write(ctx, IIS2DULPX_EMB_ADV_PG_0 + IIS2DULPX_PEDO_CMD_REG,
-                                 (uint8_t *)&pedo_cmd_reg, 1);
+    reg.mlc_odr = (uint8_t)val & 0x07U;
+    ret += iis2dulpx_write_reg(ctx, IIS2DULPX_MLC_ODR, (uint8_t *)&reg, 1);
+  }
+
+  if (ret == 0)
+  {
+    ret = iis2dulpx_mem_bank_set(ctx, IIS2DULPX_MAIN_MEM_BANK);
   }
 
   return ret;
 }
 
-int32_t iis2dulpx_stpcnt_mode_get(const stmdev_ctx_t *ctx, iis2dulpx_stpcnt_mode_t *val)
+int32_t iis2dulpx_mlc_data_rate_get(const stmdev_ctx_t *ctx,
+                                    iis2dulpx_mlc_odr_val_t *val)
 {
-  iis2dulpx_emb_func_en_a_t emb_func_en_a = {0};
-  iis2dulpx_emb_func_fifo_en_t emb_func_fifo_en = {0};
-  iis2dulpx_pedo_cmd_reg_t pedo_cmd_reg = {0};
+  iis2dulpx_mlc_odr_t reg = {0};
   int32_t ret = 0;
 
   ret = iis2dulpx_mem_bank_set(ctx, IIS2DULPX_EMBED_FUNC_MEM_BANK);
-  ret += iis2dulpx_read_reg(ctx, IIS2DULPX_EMB_FUNC_EN_A, (uint8_t *)&emb_func_en_a, 1);
-  ret += iis2dulpx_read_reg(ctx, IIS2DULPX_EMB_FUNC_FIFO_EN, (uint8_t *)&emb_func_fifo_en, 1);
-  ret += iis2dulpx_mem_bank_set(ctx, IIS2DULPX_MAIN_MEM_BANK);
+  ret += iis2dulpx_read_reg(ctx, IIS2DULPX_MLC_ODR, (uint8_t *)&reg, 1);
 
-  ret += iis2dulpx_ln_pg_read(ctx, IIS2DULPX_EMB_ADV_PG_0 + IIS2DULPX_PEDO_CMD_REG,
-                              (uint8_t *)&pedo_cmd_reg, 1);
+  if (ret == 0)
+  {
+
+    switch (reg.mlc_odr)
+    {
+      case 0:
+        *val = IIS2DULPX_ODR_PRGS_12Hz5;
+        break;
+
+      case 1:
+        *val = IIS2DULPX_ODR_PRGS_25Hz;
+        break;
+
+      case 2:
+        *val = IIS2DULPX_ODR_PRGS_50Hz;
+        break;
+
+      case 3:
+        *val = IIS2DULPX_ODR_PRGS_100Hz;
+        break;
+
+      case 4:
+        *val = IIS2DULPX_ODR_PRGS_200Hz;
+        break;
 
-  if (ret == 0)
-  {
-    val->false_step_rej = pedo_cmd_reg.fp_rejection_en;
-    val->step_counter_enable = emb_func_en_a.pedo_en;
-    val->step_counter_in_fifo = emb_func_fifo_en.step_counter_fifo_en;
+      default:
+        *val = IIS2DULPX_ODR_PRGS_12Hz5;
+        break;
+    }
   }
 
+  ret += iis2dulpx_mem_bank_set(ctx, IIS2DULPX_MAIN_MEM_BANK);
+
   return ret;
 }
 
-int32_t iis2dulpx_stpcnt_steps_get(const stmdev_ctx_t *ctx, uint16_t *val)
+int32_t iis2dulpx_mlc_fifo_en_set(const stmdev_ctx_t *ctx, uint8_t val)
 {
-  uint8_t buff[2] = {0};
+  iis2dulpx_emb_func_fifo_en_t fifo_reg = {0};
   int32_t ret = 0;
 
   ret = iis2dulpx_mem_bank_set(ctx, IIS2DULPX_EMBED_FUNC_MEM_BANK);
-  ret += iis2dulpx_read_reg(ctx, IIS2DULPX_STEP_COUNTER_L, &buff[0], 2);
-  ret += iis2dulpx_mem_bank_set(ctx, IIS2DULPX_MAIN_MEM_BANK);
-
+  ret += iis2dulpx_read_reg(ctx, IIS2DULPX_EMB_FUNC_FIFO_EN, (uint8_t *)&fifo_reg, 1);
   if (ret == 0)
   {
-    *val = (uint16_t)(buff[0] | ((uint16_t)buff[1] << 8));
+    fifo_reg.mlc_fifo_en = val & 0x01U;
+    ret += iis2dulpx_write_reg(ctx, IIS2DULPX_EMB_FUNC_FIFO_EN, (uint8_t *)&fifo_reg, 1);
   }
 
+  ret += iis2dulpx_mem_bank_set(ctx, IIS2DULPX_MAIN_MEM_BANK);
+
   return ret;
 }
 
-int32_t iis2dulpx_stpcnt_rst_step_set(const stmdev_ctx_t *ctx)
+int32_t iis2dulpx_mlc_fifo_en_get(const stmdev_ctx_t *ctx, uint8_t *val)
 {
-  iis2dulpx_emb_func_src_t emb_func_src = {0};
+  iis2dulpx_emb_func_fifo_en_t fifo_reg = {0};
   int32_t ret = 0;
 
   ret = iis2dulpx_mem_bank_set(ctx, IIS2DULPX_EMBED_FUNC_MEM_BANK);
+  ret += iis2dulpx_read_reg(ctx, IIS2DULPX_EMB_FUNC_FIFO_EN, (uint8_t *)&fifo_reg, 1);
+
   if (ret == 0)
   {
-    ret = iis2dulpx_read_reg(ctx, IIS2DULPX_EMB_FUNC_SRC, (uint8_t *)&emb_func_src, 1);
-  }
-  if (ret == 0)
-  {
-    emb_func_src.pedo_rst_step = 1;
-    ret += iis2dulpx_write_reg(ctx, IIS2DULPX_EMB_FUNC_SRC, (uint8_t *)&emb_func_src, 1);
+    *val = fifo_reg.mlc_fifo_en;
   }
 
   ret += iis2dulpx_mem_bank_set(ctx, IIS2DULPX_MAIN_MEM_BANK);
@@ -2357,1197 +6454,2036 @@ int32_t iis2dulpx_stpcnt_rst_step_set(const stmdev_ctx_t *ctx)
   return ret;
 }
 
-int32_t iis2dulpx_stpcnt_debounce_set(const stmdev_ctx_t *ctx, uint8_t val)
-{
-  iis2dulpx_pedo_deb_steps_conf_t pedo_deb_steps_conf = {0};
-  int32_t ret = 0;
-
-  pedo_deb_steps_conf.deb_step = val;
-  ret = iis2dulpx_ln_pg_write(ctx, IIS2DULPX_EMB_ADV_PG_0 + IIS2DULPX_PEDO_DEB_STEPS_CONF,
-                              (uint8_t *)&pedo_deb_steps_conf, 1);
-
-  return ret;
-}
-
-int32_t iis2dulpx_stpcnt_debounce_get(const stmdev_ctx_t *ctx, uint8_t *val)
+int32_t iis2dulpx_group_init(iis2dulpx_group_t *grp, const stmdev_ctx_t *dev,
+                             const uint8_t *bus, uint8_t num, const stmdev_ctx_t *bcast)
 {
-  iis2dulpx_pedo_deb_steps_conf_t pedo_deb_steps_conf = {0};
-  int32_t ret = 0;
+  uint8_t rank[IIS2DULPX_GROUP_MAX];
+  uint8_t r = 0;
+  uint8_t i = 0;
+  uint8_t j = 0;
+  uint8_t k = 0;
 
-  ret = iis2dulpx_ln_pg_read(ctx, IIS2DULPX_EMB_ADV_PG_0 + IIS2DULPX_PEDO_DEB_STEPS_CONF,
-                             (uint8_t *)&pedo_deb_steps_conf, 1);
-  if (ret == 0)
+  if ((num == 0U) || (num > IIS2DULPX_GROUP_MAX))
   {
-    *val = pedo_deb_steps_conf.deb_step;
+    return -1;
   }
 
-  return ret;
-}
-
-int32_t iis2dulpx_stpcnt_period_set(const stmdev_ctx_t *ctx, uint16_t val)
-{
-  uint8_t buff[2] = {0};
-  int32_t ret = 0;
+  grp->dev = dev;
+  grp->num = num;
+  grp->bcast = bcast;
 
-  buff[1] = (uint8_t)(val / 256U);
-  buff[0] = (uint8_t)(val - (buff[1] * 256U));
+  /* position of each device on its own bus */
+  for (i = 0U; i < num; i++)
+  {
+    rank[i] = 0U;
+    for (j = 0U; (bus != NULL) && (j < i); j++)
+    {
+      if (bus[j] == bus[i])
+      {
+        rank[i]++;
+      }
+    }
+  }
 
-  ret = iis2dulpx_ln_pg_write(ctx, IIS2DULPX_EMB_ADV_PG_0 + IIS2DULPX_PEDO_SC_DELTAT_L,
-                              (uint8_t *)buff, 2);
+  /* round robin over the buses: consecutive accesses hit different buses */
+  for (r = 0U; k < num; r++)
+  {
+    for (i = 0U; i < num; i++)
+    {
+      if (rank[i] == r)
+      {
+        grp->order[k] = i;
+        k++;
+      }
+    }
+  }
 
-  return ret;
+  return 0;
 }
 
-int32_t iis2dulpx_stpcnt_period_get(const stmdev_ctx_t *ctx, uint16_t *val)
+int32_t iis2dulpx_group_mode_set(const iis2dulpx_group_t *grp, const iis2dulpx_md_t *val)
 {
-  uint8_t buff[2] = {0};
+  iis2dulpx_ctrl5_t ctrl5 = {0};
+  iis2dulpx_ctrl3_t ctrl3 = {0};
+  const stmdev_ctx_t *ctx;
   int32_t ret = 0;
+  uint8_t i = 0;
 
-  ret = iis2dulpx_ln_pg_read(ctx, IIS2DULPX_EMB_ADV_PG_0 + IIS2DULPX_PEDO_SC_DELTAT_L,
-                             (uint8_t *)buff, 2);
-  if (ret == 0)
+  /* validate once, before touching any device */
+  ret = iis2dulpx_mode_ctrl5_get(val, &ctrl5);
+  if (ret != 0)
   {
-    *val = (uint16_t)(buff[0] | ((uint16_t)buff[1] << 8));
+    return ret;
   }
 
-  return ret;
-}
+  if (grp->bcast == NULL)
+  {
+    for (i = 0U; i < grp->num; i++)
+    {
+      ret += iis2dulpx_mode_set(&grp->dev[grp->order[i]], val);
+    }
 
-int32_t iis2dulpx_smart_power_set(const stmdev_ctx_t *ctx, iis2dulpx_smart_power_cfg_t val)
-{
-  iis2dulpx_ctrl1_t ctrl1 = {0};
-  iis2dulpx_smart_power_ctrl_t smart_power_ctrl = {0};
-  int32_t ret = 0;
+    return ret;
+  }
 
-  ret = iis2dulpx_read_reg(ctx, IIS2DULPX_CTRL1, (uint8_t *)&ctrl1, 1);
+  /* CTRL5 is fully defined by the mode: one broadcast write */
+  ret = iis2dulpx_write_reg(grp->bcast, IIS2DULPX_CTRL5, (uint8_t *)&ctrl5, 1);
   if (ret != 0)
   {
     return ret;
   }
-  ctrl1.smart_power_en = val.enable;
-  ret += iis2dulpx_write_reg(ctx, IIS2DULPX_CTRL1, (uint8_t *)&ctrl1, 1);
 
-  if (val.enable == 0U)
+  for (i = 0U; i < grp->num; i++)
   {
-    /* if disabling smart_power no need to set win/dur fields */
-    return ret;
-  }
+    ctx = &grp->dev[grp->order[i]];
+    iis2dulpx_shadow_update(ctx, IIS2DULPX_CTRL5, *(uint8_t *)&ctrl5);
 
-  smart_power_ctrl.smart_power_ctrl_win = val.window;
-  smart_power_ctrl.smart_power_ctrl_dur = val.duration;
-  ret += iis2dulpx_ln_pg_write(ctx, IIS2DULPX_EMB_ADV_PG_0 + IIS2DULPX_SMART_POWER_CTRL,
-                               (uint8_t *)&smart_power_ctrl, 1);
+    if (iis2dulpx_shadow_read(ctx, IIS2DULPX_CTRL3, (uint8_t *)&ctrl3) != 0)
+    {
+      ret = -1;
+      continue;
+    }
+    ctrl3.hp_en = (((uint8_t)val->odr & 0x30U) == 0x10U) ? 1U : 0U;
+    ret += iis2dulpx_shadow_write(ctx, IIS2DULPX_CTRL3, (uint8_t *)&ctrl3);
+  }
 
   return ret;
 }
 
-int32_t iis2dulpx_smart_power_get(const stmdev_ctx_t *ctx, iis2dulpx_smart_power_cfg_t *val)
+int32_t iis2dulpx_group_trigger_sw(const iis2dulpx_group_t *grp, const iis2dulpx_md_t *md)
 {
-  iis2dulpx_ctrl1_t ctrl1 = {0};
-  iis2dulpx_smart_power_ctrl_t smart_power_ctrl = {0};
+  iis2dulpx_ctrl4_t ctrl4 = {0};
   int32_t ret = 0;
+  uint8_t i = 0;
 
-  ret = iis2dulpx_read_reg(ctx, IIS2DULPX_CTRL1, (uint8_t *)&ctrl1, 1);
-
-  ret += iis2dulpx_ln_pg_read(ctx, IIS2DULPX_EMB_ADV_PG_0 + IIS2DULPX_SMART_POWER_CTRL,
-                              (uint8_t *)&smart_power_ctrl, 1);
-
-  if (ret == 0)
+  if (md->odr != IIS2DULPX_TRIG_SW)
   {
-    val->enable = ctrl1.smart_power_en;
-    val->window = smart_power_ctrl.smart_power_ctrl_win;
-    val->duration = smart_power_ctrl.smart_power_ctrl_dur;
+    return 0;
   }
 
-  return ret;
-}
+  if (grp->bcast == NULL)
+  {
+    for (i = 0U; i < grp->num; i++)
+    {
+      ret += iis2dulpx_trigger_sw(&grp->dev[grp->order[i]], md);
+    }
 
-int32_t iis2dulpx_tilt_mode_set(const stmdev_ctx_t *ctx, uint8_t val)
-{
-  iis2dulpx_emb_func_en_a_t emb_func_en_a = {0};
-  int32_t ret = 0;
+    return ret;
+  }
 
-  ret = iis2dulpx_mem_bank_set(ctx, IIS2DULPX_EMBED_FUNC_MEM_BANK);
-  ret += iis2dulpx_read_reg(ctx, IIS2DULPX_EMB_FUNC_EN_A, (uint8_t *)&emb_func_en_a, 1);
+  /* all devices share the same CTRL4 content: take it from the first one */
+  ret = iis2dulpx_shadow_read(&grp->dev[0], IIS2DULPX_CTRL4, (uint8_t *)&ctrl4);
   if (ret == 0)
   {
-    emb_func_en_a.tilt_en = val & 0x01U;
-    ret += iis2dulpx_write_reg(ctx, IIS2DULPX_EMB_FUNC_EN_A, (uint8_t *)&emb_func_en_a, 1);
+    ctrl4.soc = PROPERTY_ENABLE;
+    ret = iis2dulpx_write_reg(grp->bcast, IIS2DULPX_CTRL4, (uint8_t *)&ctrl4, 1);
   }
 
-  ret += iis2dulpx_mem_bank_set(ctx, IIS2DULPX_MAIN_MEM_BANK);
-
   return ret;
 }
 
-int32_t iis2dulpx_tilt_mode_get(const stmdev_ctx_t *ctx, uint8_t *val)
+int32_t iis2dulpx_group_fifo_drain(const iis2dulpx_group_t *grp, uint8_t *buff, uint16_t max,
+                                   uint16_t *num)
 {
-  iis2dulpx_emb_func_en_a_t emb_func_en_a = {0};
+  const stmdev_ctx_t *ctx;
+  uint16_t level = 0;
+  uint8_t dev = 0;
   int32_t ret = 0;
+  uint8_t i = 0;
 
-  ret = iis2dulpx_mem_bank_set(ctx, IIS2DULPX_EMBED_FUNC_MEM_BANK);
-  ret += iis2dulpx_read_reg(ctx, IIS2DULPX_EMB_FUNC_EN_A, (uint8_t *)&emb_func_en_a, 1);
-  if (ret == 0)
+  /* first pass: all FIFO levels */
+  for (i = 0U; i < grp->num; i++)
   {
-    *val = emb_func_en_a.tilt_en;
+    dev = grp->order[i];
+    if (iis2dulpx_fifo_data_level_get(&grp->dev[dev], &level) != 0)
+    {
+      level = 0U;
+      ret = -1;
+    }
+    num[dev] = (level > max) ? max : level;
   }
 
-  ret += iis2dulpx_mem_bank_set(ctx, IIS2DULPX_MAIN_MEM_BANK);
+  /* second pass: one burst per device */
+  for (i = 0U; i < grp->num; i++)
+  {
+    dev = grp->order[i];
+    ctx = &grp->dev[dev];
+    if (iis2dulpx_fifo_out_raw_batch_get(ctx, &buff[(uint32_t)dev * max * IIS2DULPX_FIFO_RECORD_LEN],
+                                         num[dev]) != 0)
+    {
+      num[dev] = 0U;
+      ret = -1;
+    }
+  }
 
   return ret;
 }
 
-int32_t iis2dulpx_sigmot_mode_set(const stmdev_ctx_t *ctx, uint8_t val)
+int32_t iis2dulpx_group_all_sources_get(const iis2dulpx_group_t *grp,
+                                        iis2dulpx_all_sources_t *val)
 {
-  iis2dulpx_emb_func_en_a_t emb_func_en_a = {0};
   int32_t ret = 0;
+  uint8_t dev = 0;
+  uint8_t i = 0;
 
-  ret = iis2dulpx_mem_bank_set(ctx, IIS2DULPX_EMBED_FUNC_MEM_BANK);
-  ret += iis2dulpx_read_reg(ctx, IIS2DULPX_EMB_FUNC_EN_A, (uint8_t *)&emb_func_en_a, 1);
-  if (ret == 0)
+  for (i = 0U; i < grp->num; i++)
   {
-    emb_func_en_a.sign_motion_en = val & 0x01U;
-    ret += iis2dulpx_write_reg(ctx, IIS2DULPX_EMB_FUNC_EN_A, (uint8_t *)&emb_func_en_a, 1);
+    dev = grp->order[i];
+    ret += iis2dulpx_all_sources_get(&grp->dev[dev], &val[dev]);
   }
 
-  ret += iis2dulpx_mem_bank_set(ctx, IIS2DULPX_MAIN_MEM_BANK);
-
   return ret;
 }
 
-int32_t iis2dulpx_sigmot_mode_get(const stmdev_ctx_t *ctx, uint8_t *val)
+/* capture time: user clock or bus transfers done so far */
+static uint32_t iis2dulpx_group_time(const iis2dulpx_group_trig_t *trig, uint32_t xfers)
 {
-  iis2dulpx_emb_func_en_a_t emb_func_en_a = {0};
+  return (trig->clock != NULL) ? trig->clock() : xfers;
+}
+
+/* one data ready poll: STATUS .. OUT_Z_H in a single burst */
+static int32_t iis2dulpx_group_capture_poll(const iis2dulpx_group_t *grp, const iis2dulpx_md_t *md,
+                                            iis2dulpx_group_capture_t *cap, uint8_t dev)
+{
+  iis2dulpx_status_register_t status;
+  uint8_t buff[9];
   int32_t ret = 0;
 
-  ret = iis2dulpx_mem_bank_set(ctx, IIS2DULPX_EMBED_FUNC_MEM_BANK);
-  ret += iis2dulpx_read_reg(ctx, IIS2DULPX_EMB_FUNC_EN_A, (uint8_t *)&emb_func_en_a, 1);
-  if (ret == 0)
+  cap->polls[dev]++;
+  ret = iis2dulpx_read_reg(&grp->dev[dev], IIS2DULPX_STATUS, buff, 9);
+  if (ret != 0)
   {
-    *val = emb_func_en_a.sign_motion_en;
+    return ret;
   }
 
-  ret += iis2dulpx_mem_bank_set(ctx, IIS2DULPX_MAIN_MEM_BANK);
+  (void)memcpy(&status, &buff[0], 1);
+  if (status.drdy == 1U)
+  {
+    iis2dulpx_xl_data_decode(&buff[3], md, &cap->data[dev]);
+    cap->valid |= (uint16_t)(1U << dev);
+  }
 
   return ret;
 }
 
-int32_t iis2dulpx_ff_duration_set(const stmdev_ctx_t *ctx, uint8_t val)
+int32_t iis2dulpx_group_capture(const iis2dulpx_group_t *grp, const iis2dulpx_md_t *md,
+                                const iis2dulpx_group_trig_t *trig,
+                                iis2dulpx_group_capture_t *cap)
 {
-  iis2dulpx_wake_up_dur_t wake_up_dur = {0};
-  iis2dulpx_free_fall_t free_fall = {0};
+  uint32_t trig_time[IIS2DULPX_GROUP_MAX];
+  uint16_t max_polls = (trig->max_polls > 0U) ? trig->max_polls : 1U;
+  uint16_t failed = 0;
+  uint16_t bit;
+  uint32_t xfers = 0;
+  uint8_t pending = 0;
+  uint8_t dev = 0;
+  uint8_t i = 0;
   int32_t ret = 0;
 
-  ret = iis2dulpx_read_reg(ctx, IIS2DULPX_WAKE_UP_DUR, (uint8_t *)&wake_up_dur, 1);
+  (void)memset(cap, 0x00, sizeof(iis2dulpx_group_capture_t));
 
-  if (ret == 0)
+  if (((md->odr != IIS2DULPX_TRIG_SW) && (md->odr != IIS2DULPX_TRIG_PIN)) ||
+      ((md->odr == IIS2DULPX_TRIG_PIN) && (trig->pin == NULL)))
   {
-    wake_up_dur.ff_dur = (val >> 5) & 0x1U;
-    ret = iis2dulpx_write_reg(ctx, IIS2DULPX_WAKE_UP_DUR, (uint8_t *)&wake_up_dur, 1);
+    return -1;
   }
 
-  ret += iis2dulpx_read_reg(ctx, IIS2DULPX_FREE_FALL, (uint8_t *)&free_fall, 1);
-  if (ret == 0)
+  if ((md->odr == IIS2DULPX_TRIG_PIN) || (grp->bcast != NULL))
   {
-    free_fall.ff_dur = val & 0x1FU;
-    ret += iis2dulpx_write_reg(ctx, IIS2DULPX_FREE_FALL, (uint8_t *)&free_fall, 1);
-  }
-
-  return ret;
-}
-
-int32_t iis2dulpx_ff_duration_get(const stmdev_ctx_t *ctx, uint8_t *val)
-{
-  iis2dulpx_wake_up_dur_t wake_up_dur = {0};
-  iis2dulpx_free_fall_t free_fall = {0};
-  int32_t ret = 0;
+    /* all the devices sample at the same time */
+    trig_time[0] = iis2dulpx_group_time(trig, xfers);
+    if (md->odr == IIS2DULPX_TRIG_PIN)
+    {
+      trig->pin(trig->arg);
+    }
+    else
+    {
+      ret = iis2dulpx_group_trigger_sw(grp, md);
+      xfers++;
+    }
 
-  ret = iis2dulpx_read_reg(ctx, IIS2DULPX_WAKE_UP_DUR, (uint8_t *)&wake_up_dur, 1);
-  ret += iis2dulpx_read_reg(ctx, IIS2DULPX_FREE_FALL, (uint8_t *)&free_fall, 1);
+    if (ret != 0)
+    {
+      return ret;
+    }
 
-  if (ret == 0)
+    for (i = 0U; i < grp->num; i++)
+    {
+      trig_time[i] = trig_time[0];
+    }
+  }
+  else
   {
-    *val = (uint8_t)((wake_up_dur.ff_dur << 5) | free_fall.ff_dur);
+    /* trigger device N+1, then read device N */
+    for (i = 0U; i < grp->num; i++)
+    {
+      dev = grp->order[i];
+      trig_time[dev] = iis2dulpx_group_time(trig, xfers);
+      if (iis2dulpx_trigger_sw(&grp->dev[dev], md) != 0)
+      {
+        failed |= (uint16_t)(1U << dev);
+        ret = -1;
+      }
+      xfers++;
+
+      if ((i > 0U) && ((failed & (uint16_t)(1U << grp->order[i - 1U])) == 0U))
+      {
+        if (iis2dulpx_group_capture_poll(grp, md, cap, grp->order[i - 1U]) != 0)
+        {
+          failed |= (uint16_t)(1U << grp->order[i - 1U]);
+          ret = -1;
+        }
+        xfers++;
+      }
+    }
   }
 
-  return ret;
-}
+  /* collect the devices not ready yet, round robin */
+  do
+  {
+    pending = 0U;
+    for (i = 0U; i < grp->num; i++)
+    {
+      dev = grp->order[i];
+      bit = (uint16_t)(1U << dev);
+      if ((((cap->valid | failed) & bit) != 0U) || (cap->polls[dev] >= max_polls))
+      {
+        continue;
+      }
 
-int32_t iis2dulpx_ff_thresholds_set(const stmdev_ctx_t *ctx, iis2dulpx_ff_thresholds_t val)
-{
-  iis2dulpx_free_fall_t free_fall = {0};
-  int32_t ret = 0;
+      if (iis2dulpx_group_capture_poll(grp, md, cap, dev) != 0)
+      {
+        failed |= bit;
+        ret = -1;
+      }
+      pending = 1U;
+    }
+  } while (pending == 1U);
 
-  ret = iis2dulpx_read_reg(ctx, IIS2DULPX_FREE_FALL, (uint8_t *)&free_fall, 1);
-  if (ret == 0)
+  dev = grp->order[0];
+  for (i = 0U; i < grp->num; i++)
   {
-    free_fall.ff_ths = ((uint8_t)val & 0x7U);
-    ret += iis2dulpx_write_reg(ctx, IIS2DULPX_FREE_FALL, (uint8_t *)&free_fall, 1);
+    cap->skew[i] = trig_time[i] - trig_time[dev];
+    if (((cap->valid & (uint16_t)(1U << i)) != 0U) && (cap->skew[i] > cap->max_skew))
+    {
+      cap->max_skew = cap->skew[i];
+    }
   }
 
   return ret;
 }
 
-int32_t iis2dulpx_ff_thresholds_get(const stmdev_ctx_t *ctx, iis2dulpx_ff_thresholds_t *val)
+void iis2dulpx_irq_init(iis2dulpx_irq_t *irq)
 {
-  iis2dulpx_free_fall_t free_fall = {0};
-  int32_t ret = 0;
+  (void)memset(irq, 0x00, sizeof(iis2dulpx_irq_t));
+}
 
-  ret = iis2dulpx_read_reg(ctx, IIS2DULPX_FREE_FALL, (uint8_t *)&free_fall, 1);
+int32_t iis2dulpx_irq_handler_set(iis2dulpx_irq_t *irq, iis2dulpx_irq_src_t src,
+                                  iis2dulpx_irq_handler_t handler, void *arg)
+{
+  uint16_t bit;
 
-  if (ret != 0)
+  if ((uint8_t)src >= (uint8_t)IIS2DULPX_IRQ_SRC_NUM)
   {
-    return ret;
+    return -1;
   }
 
-  switch (free_fall.ff_ths)
-  {
-    case 0x0:
-      *val = IIS2DULPX_156_mg;
-      break;
-
-    case 0x1:
-      *val = IIS2DULPX_219_mg;
-      break;
-
-    case 0x2:
-      *val = IIS2DULPX_250_mg;
-      break;
-
-    case 0x3:
-      *val = IIS2DULPX_312_mg;
-      break;
-
-    case 0x4:
-      *val = IIS2DULPX_344_mg;
-      break;
-
-    case 0x5:
-      *val = IIS2DULPX_406_mg;
-      break;
+  bit = (uint16_t)(1U << (uint8_t)src);
+  irq->handler[src] = handler;
+  irq->arg[src] = arg;
 
-    case 0x6:
-      *val = IIS2DULPX_469_mg;
-      break;
+  if (handler != NULL)
+  {
+    irq->mask |= bit;
+  }
+  else
+  {
+    irq->mask &= (uint16_t)~bit;
+  }
 
-    case 0x7:
-      *val = IIS2DULPX_500_mg;
-      break;
+  return 0;
+}
 
-    default:
-      *val = IIS2DULPX_156_mg;
-      break;
-  }
-  return ret;
+/* set bit src of fired when flag is set */
+static uint16_t iis2dulpx_irq_bit(uint8_t flag, iis2dulpx_irq_src_t src)
+{
+  return (flag != 0U) ? (uint16_t)(1U << (uint8_t)src) : 0U;
 }
 
-int32_t iis2dulpx_sixd_config_set(const stmdev_ctx_t *ctx, iis2dulpx_sixd_config_t val)
+int32_t iis2dulpx_irq_dispatch(const stmdev_ctx_t *ctx, iis2dulpx_irq_t *irq)
 {
-  iis2dulpx_sixd_t sixd = {0};
+  const uint16_t emb_mask = (uint16_t)((1U << (uint8_t)IIS2DULPX_IRQ_STEP_DET) |
+                                       (1U << (uint8_t)IIS2DULPX_IRQ_TILT) |
+                                       (1U << (uint8_t)IIS2DULPX_IRQ_SIGMOT) |
+                                       (1U << (uint8_t)IIS2DULPX_IRQ_FSM_LC) |
+                                       (1U << (uint8_t)IIS2DULPX_IRQ_FSM) |
+                                       (1U << (uint8_t)IIS2DULPX_IRQ_MLC));
+  iis2dulpx_irq_event_t *evt = &irq->evt;
+  iis2dulpx_emb_func_status_mainpage_t emb_status;
+  iis2dulpx_fifo_status1_t fifo_status1;
+  uint8_t fsm_out = 0;
+  uint8_t mlc_out = 0;
+  uint16_t fired = 0;
+  uint8_t buff[7];
+  uint8_t i;
   int32_t ret = 0;
 
-  ret = iis2dulpx_read_reg(ctx, IIS2DULPX_SIXD, (uint8_t *)&sixd, 1);
-
-  if (ret == 0)
+  /* main page registers are not reachable inside an embedded session */
+  if ((ctx->priv_data != NULL) && (((iis2dulpx_priv_t *)ctx->priv_data)->emb_session > 0U))
   {
-    sixd.d4d_en = ((uint8_t)val.mode) & 0x01U;
-    sixd.d6d_ths = ((uint8_t)val.threshold) & 0x03U;
-    ret = iis2dulpx_write_reg(ctx, IIS2DULPX_SIXD, (uint8_t *)&sixd, 1);
+    return -1;
   }
 
-  return ret;
-}
-
-int32_t iis2dulpx_sixd_config_get(const stmdev_ctx_t *ctx, iis2dulpx_sixd_config_t *val)
-{
-  iis2dulpx_sixd_t sixd = {0};
-  int32_t ret = 0;
+  (void)memset(evt, 0x00, sizeof(iis2dulpx_irq_event_t));
 
-  ret = iis2dulpx_read_reg(ctx, IIS2DULPX_SIXD, (uint8_t *)&sixd, 1);
+  /* WAKE_UP_SRC .. FIFO_STATUS2 in one transaction */
+  ret = iis2dulpx_read_reg(ctx, IIS2DULPX_WAKE_UP_SRC, buff, 7);
   if (ret != 0)
   {
-    return ret;
+    goto exit;
   }
 
-  val->mode = (iis2dulpx_mode_t)sixd.d4d_en;
+  iis2dulpx_all_sources_decode(buff, &evt->src);
+  (void)memcpy(&fifo_status1, &buff[5], 1);
+  evt->fifo_wtm = fifo_status1.fifo_wtm_ia;
+  evt->fifo_ovr = fifo_status1.fifo_ovr_ia;
+  evt->fifo_level = buff[6];
 
-  switch ((sixd.d6d_ths))
+  /* EMB_FUNC, FSM and MLC main page status in one transaction */
+  if ((irq->mask & emb_mask) != 0U)
   {
-    case 0x0:
-      val->threshold = IIS2DULPX_DEG_80;
-      break;
+    /* on error only the main page sources, already latched off, are dispatched */
+    ret = iis2dulpx_read_reg(ctx, IIS2DULPX_EMB_FUNC_STATUS_MAINPAGE, buff, 3);
+    if (ret == 0)
+    {
+      (void)memcpy(&emb_status, &buff[0], 1);
+      (void)memcpy(&evt->fsm_status, &buff[1], 1);
+      (void)memcpy(&evt->mlc_status, &buff[2], 1);
+      evt->emb.is_step_det = emb_status.is_step_det;
+      evt->emb.is_tilt = emb_status.is_tilt;
+      evt->emb.is_sigmot = emb_status.is_sigmot;
+      evt->is_fsm_lc = emb_status.is_fsm_lc;
+      fsm_out = buff[1];
+      mlc_out = buff[2] & 0x0FU;
+    }
+  }
 
-    case 0x1:
-      val->threshold = IIS2DULPX_DEG_70;
-      break;
+  fired |= iis2dulpx_irq_bit(evt->src.wake_up, IIS2DULPX_IRQ_WAKE_UP);
+  fired |= iis2dulpx_irq_bit(evt->src.free_fall, IIS2DULPX_IRQ_FREE_FALL);
+  fired |= iis2dulpx_irq_bit(evt->src.sleep_change, IIS2DULPX_IRQ_SLEEP_CHANGE);
+  fired |= iis2dulpx_irq_bit(evt->src.single_tap, IIS2DULPX_IRQ_SINGLE_TAP);
+  fired |= iis2dulpx_irq_bit(evt->src.double_tap, IIS2DULPX_IRQ_DOUBLE_TAP);
+  fired |= iis2dulpx_irq_bit(evt->src.triple_tap, IIS2DULPX_IRQ_TRIPLE_TAP);
+  fired |= iis2dulpx_irq_bit(evt->src.six_d, IIS2DULPX_IRQ_SIX_D);
+  fired |= iis2dulpx_irq_bit(evt->src.drdy, IIS2DULPX_IRQ_DRDY);
+  fired |= iis2dulpx_irq_bit(evt->fifo_wtm, IIS2DULPX_IRQ_FIFO_WTM);
+  fired |= iis2dulpx_irq_bit(evt->fifo_ovr, IIS2DULPX_IRQ_FIFO_OVR);
+  fired |= iis2dulpx_irq_bit(evt->emb.is_step_det, IIS2DULPX_IRQ_STEP_DET);
+  fired |= iis2dulpx_irq_bit(evt->emb.is_tilt, IIS2DULPX_IRQ_TILT);
+  fired |= iis2dulpx_irq_bit(evt->emb.is_sigmot, IIS2DULPX_IRQ_SIGMOT);
+  fired |= iis2dulpx_irq_bit(evt->is_fsm_lc, IIS2DULPX_IRQ_FSM_LC);
+  fired |= iis2dulpx_irq_bit(fsm_out, IIS2DULPX_IRQ_FSM);
+  fired |= iis2dulpx_irq_bit(mlc_out, IIS2DULPX_IRQ_MLC);
+  fired &= irq->mask;
+
+  /* FSM_OUTS and MLC_SRC with a single bank transition */
+  fsm_out = ((fired & (1U << (uint8_t)IIS2DULPX_IRQ_FSM)) != 0U) ? 1U : 0U;
+  mlc_out = ((fired & (1U << (uint8_t)IIS2DULPX_IRQ_MLC)) != 0U) ? 1U : 0U;
+  if ((fsm_out == 1U) || (mlc_out == 1U))
+  {
+    ret = iis2dulpx_mem_bank_set(ctx, IIS2DULPX_EMBED_FUNC_MEM_BANK);
+
+    if ((ret == 0) && (fsm_out == 1U))
+    {
+      ret = iis2dulpx_read_reg(ctx, IIS2DULPX_FSM_OUTS1, evt->fsm_out, 8);
+    }
 
-    case 0x2:
-      val->threshold = IIS2DULPX_DEG_60;
-      break;
+    if ((ret == 0) && (mlc_out == 1U))
+    {
+      ret = iis2dulpx_read_reg(ctx, IIS2DULPX_MLC1_SRC, evt->mlc_out, 4);
+    }
 
-    case 0x3:
-      val->threshold = IIS2DULPX_DEG_50;
-      break;
+    ret += iis2dulpx_mem_bank_set(ctx, IIS2DULPX_MAIN_MEM_BANK);
+    if (ret != 0)
+    {
+      /* dispatch the other sources and return the error */
+      fired &= (uint16_t)~((1U << (uint8_t)IIS2DULPX_IRQ_FSM) |
+                           (1U << (uint8_t)IIS2DULPX_IRQ_MLC));
+    }
+  }
 
-    default:
-      val->threshold = IIS2DULPX_DEG_80;
-      break;
+  for (i = 0U; i < (uint8_t)IIS2DULPX_IRQ_SRC_NUM; i++)
+  {
+    if ((fired & (uint16_t)(1U << i)) != 0U)
+    {
+      irq->handler[i](irq->arg[i], (iis2dulpx_irq_src_t)i, evt);
+    }
   }
 
+exit:
   return ret;
 }
 
-int32_t iis2dulpx_wakeup_config_set(const stmdev_ctx_t *ctx, iis2dulpx_wakeup_config_t val)
-{
-  iis2dulpx_wake_up_ths_t wup_ths = {0};
-  iis2dulpx_wake_up_dur_t wup_dur = {0};
-  iis2dulpx_wake_up_dur_ext_t wup_dur_ext = {0};
-  iis2dulpx_interrupt_cfg_t int_cfg = {0};
-  iis2dulpx_ctrl1_t ctrl1 = {0};
-  iis2dulpx_ctrl4_t ctrl4 = {0};
-  int32_t ret = 0;
-
-  ret = iis2dulpx_read_reg(ctx, IIS2DULPX_WAKE_UP_THS, (uint8_t *)&wup_ths, 1);
-  ret += iis2dulpx_read_reg(ctx, IIS2DULPX_WAKE_UP_DUR, (uint8_t *)&wup_dur, 1);
-  ret += iis2dulpx_read_reg(ctx, IIS2DULPX_WAKE_UP_DUR_EXT, (uint8_t *)&wup_dur_ext, 1);
-  ret += iis2dulpx_read_reg(ctx, IIS2DULPX_INTERRUPT_CFG, (uint8_t *)&int_cfg, 1);
-  ret += iis2dulpx_read_reg(ctx, IIS2DULPX_CTRL1, (uint8_t *)&ctrl1, 1);
-  ret += iis2dulpx_read_reg(ctx, IIS2DULPX_CTRL4, (uint8_t *)&ctrl4, 1);
+enum
+{
+  IIS2DULPX_ASYNC_IDLE = 0,
+  IIS2DULPX_ASYNC_FIFO_TAG,
+  IIS2DULPX_ASYNC_FIFO_RAW,
+  IIS2DULPX_ASYNC_FIFO_DECODE,
+  IIS2DULPX_ASYNC_SRC_READ,
+  IIS2DULPX_ASYNC_SRC_DECODE,
+  IIS2DULPX_ASYNC_PG_INC_READ,
+  IIS2DULPX_ASYNC_PG_INC_WRITE,
+  IIS2DULPX_ASYNC_PG_BANK_READ,
+  IIS2DULPX_ASYNC_PG_BANK_WRITE,
+  IIS2DULPX_ASYNC_PG_RW_READ,
+  IIS2DULPX_ASYNC_PG_RW_WRITE,
+  IIS2DULPX_ASYNC_PG_SEL,
+  IIS2DULPX_ASYNC_PG_ADDR,
+  IIS2DULPX_ASYNC_PG_DATA,
+  IIS2DULPX_ASYNC_PG_NEXT_PAGE,
+  IIS2DULPX_ASYNC_PG_CLOSE_SEL,
+  IIS2DULPX_ASYNC_PG_CLOSE_RW,
+  IIS2DULPX_ASYNC_PG_CLOSE_BANK,
+  IIS2DULPX_ASYNC_PG_INC_RESTORE,
+  IIS2DULPX_ASYNC_FINISH,
+};
+
+#define IIS2DULPX_ASYNC_STREAM   0x01U
+#define IIS2DULPX_ASYNC_RESTORE  0x02U
+#define IIS2DULPX_ASYNC_EMB      0x04U
+
+static void iis2dulpx_async_step(void *arg, int32_t status);
 
-  if (ret == 0)
+/*
+ * Record the first error and move to the matching exit path; a later
+ * error while already closing only keeps the first status.
+ */
+static void iis2dulpx_async_fail(iis2dulpx_async_op_t *op, int32_t status)
+{
+  if ((status != 0) && (op->status == 0))
   {
-    wup_dur.wake_dur = (uint8_t)val.wake_dur & 0x3U;
-    wup_dur_ext.wu_dur_extended = ((uint8_t)val.wake_dur >> 4) & 0x01U;
-    wup_dur.sleep_dur = val.sleep_dur & 0x0FU;
-
-    int_cfg.wake_ths_w = val.wake_ths_weight;
-    wup_ths.wk_ths = val.wake_ths & 0x3FU;
-    wup_ths.sleep_on = (uint8_t)val.wake_enable & 0x01U;
-    ctrl4.inact_odr = (uint8_t)val.inact_odr & 0x03U;
+    op->status = status;
 
-    if (val.wake_enable == IIS2DULPX_SLEEP_ON)
+    /* leave the embedded bank in a known state */
+    if (op->state < IIS2DULPX_ASYNC_PG_INC_READ)
     {
-      ctrl1.wu_x_en = 1;
-      ctrl1.wu_y_en = 1;
-      ctrl1.wu_z_en = 1;
+      op->state = IIS2DULPX_ASYNC_FINISH;
+    }
+    else if (((op->flags & IIS2DULPX_ASYNC_EMB) != 0U) && (op->state <= IIS2DULPX_ASYNC_PG_NEXT_PAGE))
+    {
+      op->state = IIS2DULPX_ASYNC_PG_CLOSE_SEL;
+    }
+    else if (op->state <= IIS2DULPX_ASYNC_PG_NEXT_PAGE)
+    {
+      op->state = IIS2DULPX_ASYNC_PG_INC_RESTORE;
     }
     else
     {
-      ctrl1.wu_x_en = 0;
-      ctrl1.wu_y_en = 0;
-      ctrl1.wu_z_en = 0;
+      /* already closing */
     }
-
-    ret += iis2dulpx_write_reg(ctx, IIS2DULPX_WAKE_UP_THS, (uint8_t *)&wup_ths, 1);
-    ret += iis2dulpx_write_reg(ctx, IIS2DULPX_WAKE_UP_DUR, (uint8_t *)&wup_dur, 1);
-    ret += iis2dulpx_write_reg(ctx, IIS2DULPX_WAKE_UP_DUR_EXT, (uint8_t *)&wup_dur_ext, 1);
-    ret += iis2dulpx_write_reg(ctx, IIS2DULPX_INTERRUPT_CFG, (uint8_t *)&int_cfg, 1);
-    ret += iis2dulpx_write_reg(ctx, IIS2DULPX_CTRL1, (uint8_t *)&ctrl1, 1);
-    ret += iis2dulpx_write_reg(ctx, IIS2DULPX_CTRL4, (uint8_t *)&ctrl4, 1);
   }
+}
+
+/*
+ * Submit helpers: on a rejected submit no callback runs, so the error
+ * path is taken here and the caller keeps stepping.
+ */
+static int32_t iis2dulpx_async_read(iis2dulpx_async_op_t *op, uint8_t reg, uint8_t *data,
+                                    uint16_t len, uint8_t next)
+{
+  int32_t ret;
+
+  op->state = next;
+  ret = op->io->read_reg(op->io->handle, reg, data, len, iis2dulpx_async_step, op);
+  iis2dulpx_async_fail(op, ret);
 
   return ret;
 }
 
-int32_t iis2dulpx_wakeup_config_get(const stmdev_ctx_t *ctx, iis2dulpx_wakeup_config_t *val)
+static int32_t iis2dulpx_async_write(iis2dulpx_async_op_t *op, uint8_t reg, const uint8_t *data,
+                                     uint16_t len, uint8_t next)
 {
-  iis2dulpx_wake_up_ths_t wup_ths = {0};
-  iis2dulpx_wake_up_dur_t wup_dur = {0};
-  iis2dulpx_wake_up_dur_ext_t wup_dur_ext = {0};
-  iis2dulpx_interrupt_cfg_t int_cfg = {0};
-  iis2dulpx_ctrl4_t ctrl4 = {0};
+  int32_t ret;
+
+  op->state = next;
+  ret = op->io->write_reg(op->io->handle, reg, data, len, iis2dulpx_async_step, op);
+  iis2dulpx_async_fail(op, ret);
+
+  return ret;
+}
+
+static uint8_t iis2dulpx_async_page_sel(uint8_t page)
+{
+  iis2dulpx_page_sel_t page_sel = {0};
+  uint8_t val;
+
+  page_sel.page_sel = page & 0x0FU;
+  page_sel.not_used0 = 1U; // Default value
+  (void)memcpy(&val, &page_sel, 1);
+
+  return val;
+}
+
+/*
+ * Run the operation up to the next bus transfer. Each state issues at
+ * most one transfer; its completion callback re-enters here.
+ */
+static void iis2dulpx_async_step(void *arg, int32_t status)
+{
+  iis2dulpx_async_op_t *op = (iis2dulpx_async_op_t *)arg;
+  iis2dulpx_priv_t *priv = (iis2dulpx_priv_t *)op->ctx->priv_data;
+  iis2dulpx_shadow_t *shadow = iis2dulpx_shadow_of(op->ctx, IIS2DULPX_SHADOW_FIRST);
+  iis2dulpx_fifo_data_out_tag_t fifo_tag;
+  iis2dulpx_func_cfg_access_t fca;
+  iis2dulpx_page_rw_t page_rw;
+  iis2dulpx_ctrl1_t ctrl1;
+  uint16_t run;
+  uint8_t lsb;
   int32_t ret = 0;
 
-  ret = iis2dulpx_read_reg(ctx, IIS2DULPX_WAKE_UP_THS, (uint8_t *)&wup_ths, 1);
-  ret += iis2dulpx_read_reg(ctx, IIS2DULPX_WAKE_UP_DUR, (uint8_t *)&wup_dur, 1);
-  ret += iis2dulpx_read_reg(ctx, IIS2DULPX_WAKE_UP_DUR_EXT, (uint8_t *)&wup_dur_ext, 1);
-  ret += iis2dulpx_read_reg(ctx, IIS2DULPX_INTERRUPT_CFG, (uint8_t *)&int_cfg, 1);
-  ret += iis2dulpx_read_reg(ctx, IIS2DULPX_CTRL4, (uint8_t *)&ctrl4, 1);
+  iis2dulpx_async_fail(op, status);
 
-  if (ret == 0)
+  while (op->state != IIS2DULPX_ASYNC_IDLE)
   {
-    switch (wup_dur.wake_dur)
+    switch (op->state)
     {
-      case 0x0:
-        val->wake_dur = (wup_dur_ext.wu_dur_extended == 1U) ?
-                        IIS2DULPX_3_ODR : IIS2DULPX_0_ODR;
+      /* iis2dulpx_fifo_data_get */
+      case IIS2DULPX_ASYNC_FIFO_TAG:
+        ret = iis2dulpx_async_read(op, IIS2DULPX_FIFO_DATA_OUT_TAG, &op->tmp[0], 1,
+                                   IIS2DULPX_ASYNC_FIFO_RAW);
+        if (ret == 0)
+        {
+          return;
+        }
+        break;
+      case IIS2DULPX_ASYNC_FIFO_RAW:
+        (void)memcpy(&fifo_tag, &op->tmp[0], 1);
+        switch (fifo_tag.tag_sensor)
+        {
+          case (uint8_t)IIS2DULPX_XL_ONLY_2X_TAG:
+          case (uint8_t)IIS2DULPX_XL_ONLY_2X_TAG_2ND:
+          case (uint8_t)IIS2DULPX_XL_AND_QVAR:
+          case (uint8_t)IIS2DULPX_XL_TEMP_TAG:
+          case (uint8_t)IIS2DULPX_TIMESTAMP_TAG:
+          case (uint8_t)IIS2DULPX_STEP_COUNTER_TAG:
+          case (uint8_t)IIS2DULPX_MLC_RESULT_TAG:
+          case (uint8_t)IIS2DULPX_MLC_FILTER_TAG:
+          case (uint8_t)IIS2DULPX_MLC_FEATURE:
+          case (uint8_t)IIS2DULPX_FSM_RESULT_TAG:
+            ret = iis2dulpx_async_read(op, IIS2DULPX_FIFO_DATA_OUT_X_L, &op->tmp[1], 6,
+                                       IIS2DULPX_ASYNC_FIFO_DECODE);
+            if (ret == 0)
+            {
+              return;
+            }
+            break;
+          default:
+            op->state = IIS2DULPX_ASYNC_FIFO_DECODE;
+            break;
+        }
+        break;
+      case IIS2DULPX_ASYNC_FIFO_DECODE:
+        (void)iis2dulpx_fifo_data_decode(op->md, op->fmd, op->tmp, (iis2dulpx_fifo_data_t *)op->out);
+        op->state = IIS2DULPX_ASYNC_FINISH;
+        break;
+
+      /* iis2dulpx_all_sources_get */
+      case IIS2DULPX_ASYNC_SRC_READ:
+        ret = iis2dulpx_async_read(op, IIS2DULPX_WAKE_UP_SRC, op->tmp, 5, IIS2DULPX_ASYNC_SRC_DECODE);
+        if (ret == 0)
+        {
+          return;
+        }
+        break;
+      case IIS2DULPX_ASYNC_SRC_DECODE:
+        iis2dulpx_all_sources_decode(op->tmp, (iis2dulpx_all_sources_t *)op->out);
+        op->state = IIS2DULPX_ASYNC_FINISH;
+        break;
+
+      /* iis2dulpx_ln_pg_write: if_add_inc off for streaming */
+      case IIS2DULPX_ASYNC_PG_INC_READ:
+        if ((op->flags & IIS2DULPX_ASYNC_STREAM) == 0U)
+        {
+          op->state = IIS2DULPX_ASYNC_PG_BANK_READ;
+        }
+        else if (iis2dulpx_shadow_hit(op->ctx, IIS2DULPX_CTRL1) == PROPERTY_ENABLE)
+        {
+          op->ctrl1 = shadow->reg[IIS2DULPX_CTRL1 - IIS2DULPX_SHADOW_FIRST];
+          op->state = IIS2DULPX_ASYNC_PG_INC_WRITE;
+        }
+        else
+        {
+          ret = iis2dulpx_async_read(op, IIS2DULPX_CTRL1, &op->ctrl1, 1, IIS2DULPX_ASYNC_PG_INC_WRITE);
+          if (ret == 0)
+          {
+            return;
+          }
+          break;
+        }
+        break;
+      case IIS2DULPX_ASYNC_PG_INC_WRITE:
+        (void)memcpy(&ctrl1, &op->ctrl1, 1);
+        op->state = IIS2DULPX_ASYNC_PG_BANK_READ;
+        if (ctrl1.if_add_inc == PROPERTY_ENABLE)
+        {
+          op->flags |= IIS2DULPX_ASYNC_RESTORE;
+          ctrl1.if_add_inc = PROPERTY_DISABLE;
+          (void)memcpy(&op->tmp[0], &ctrl1, 1);
+          iis2dulpx_shadow_update(op->ctx, IIS2DULPX_CTRL1, op->tmp[0]);
+          ret = iis2dulpx_async_write(op, IIS2DULPX_CTRL1, &op->tmp[0], 1,
+                                      IIS2DULPX_ASYNC_PG_BANK_READ);
+          if (ret == 0)
+          {
+            return;
+          }
+          break;
+        }
+        break;
+
+      /* embedded functions bank */
+      case IIS2DULPX_ASYNC_PG_BANK_READ:
+        op->flags |= IIS2DULPX_ASYNC_EMB;
+        (void)memcpy(&op->fca, &priv->func_cfg_access_main, 1);
+        if ((priv->emb_session > 0U) || (priv->func_cfg_access_main.emb_func_reg_access == 1U))
+        {
+          op->state = IIS2DULPX_ASYNC_PG_RW_READ;
+        }
+        else
+        {
+          ret = iis2dulpx_async_read(op, IIS2DULPX_FUNC_CFG_ACCESS, &op->fca, 1,
+                                     IIS2DULPX_ASYNC_PG_BANK_WRITE);
+          if (ret == 0)
+          {
+            return;
+          }
+          break;
+        }
+        break;
+      case IIS2DULPX_ASYNC_PG_BANK_WRITE:
+        (void)memcpy(&fca, &op->fca, 1);
+        fca.emb_func_reg_access = 1U;
+        (void)memcpy(&op->fca, &fca, 1);
+        priv->func_cfg_access_main = fca;
+        ret = iis2dulpx_async_write(op, IIS2DULPX_FUNC_CFG_ACCESS, &op->fca, 1,
+                                    IIS2DULPX_ASYNC_PG_RW_READ);
+        if (ret == 0)
+        {
+          return;
+        }
+        break;
+
+      /* page write */
+      case IIS2DULPX_ASYNC_PG_RW_READ:
+        if ((shadow != NULL) && (shadow->page_rw_valid == PROPERTY_ENABLE))
+        {
+          op->page_rw = shadow->page_rw;
+          op->state = IIS2DULPX_ASYNC_PG_RW_WRITE;
+        }
+        else
+        {
+          ret = iis2dulpx_async_read(op, IIS2DULPX_PAGE_RW, &op->page_rw, 1, IIS2DULPX_ASYNC_PG_RW_WRITE);
+          if (ret == 0)
+          {
+            return;
+          }
+          break;
+        }
+        break;
+      case IIS2DULPX_ASYNC_PG_RW_WRITE:
+        (void)memcpy(&page_rw, &op->page_rw, 1);
+        page_rw.page_read = PROPERTY_DISABLE;
+        page_rw.page_write = PROPERTY_ENABLE;
+        (void)memcpy(&op->page_rw, &page_rw, 1);
+        if (shadow != NULL)
+        {
+          shadow->page_rw = op->page_rw;
+          shadow->page_rw_valid = PROPERTY_ENABLE;
+        }
+        ret = iis2dulpx_async_write(op, IIS2DULPX_PAGE_RW, &op->page_rw, 1, IIS2DULPX_ASYNC_PG_SEL);
+        if (ret == 0)
+        {
+          return;
+        }
+        break;
+      case IIS2DULPX_ASYNC_PG_SEL:
+        op->tmp[0] = iis2dulpx_async_page_sel((uint8_t)(op->address >> 8));
+        ret = iis2dulpx_async_write(op, IIS2DULPX_PAGE_SEL, &op->tmp[0], 1, IIS2DULPX_ASYNC_PG_ADDR);
+        if (ret == 0)
+        {
+          return;
+        }
+        break;
+      case IIS2DULPX_ASYNC_PG_ADDR:
+        op->tmp[1] = (uint8_t)op->address & 0xFFU;
+        ret = iis2dulpx_async_write(op, IIS2DULPX_PAGE_ADDRESS, &op->tmp[1], 1, IIS2DULPX_ASYNC_PG_DATA);
+        if (ret == 0)
+        {
+          return;
+        }
+        break;
+      case IIS2DULPX_ASYNC_PG_DATA:
+        if (op->idx >= op->len)
+        {
+          op->state = IIS2DULPX_ASYNC_PG_CLOSE_SEL;
+          break;
+        }
+        lsb = (uint8_t)((op->address + op->idx) & 0xFFU);
+        run = 1U;
+        if ((op->flags & IIS2DULPX_ASYNC_STREAM) != 0U)
+        {
+          run = 256U - (uint16_t)lsb;
+          if (run > (op->len - op->idx))
+          {
+            run = op->len - op->idx;
+          }
+        }
+        op->idx += run;
+        lsb = (uint8_t)(lsb + run);
+        ret = iis2dulpx_async_write(op, IIS2DULPX_PAGE_VALUE, &op->buf[op->idx - run], run,
+                                    ((lsb == 0U) && (op->idx < op->len)) ?
+                                    (uint8_t)IIS2DULPX_ASYNC_PG_NEXT_PAGE : (uint8_t)IIS2DULPX_ASYNC_PG_DATA);
+        if (ret == 0)
+        {
+          return;
+        }
+        break;
+      case IIS2DULPX_ASYNC_PG_NEXT_PAGE:
+        op->tmp[0] = iis2dulpx_async_page_sel((uint8_t)((op->address + op->idx) >> 8));
+        ret = iis2dulpx_async_write(op, IIS2DULPX_PAGE_SEL, &op->tmp[0], 1, IIS2DULPX_ASYNC_PG_DATA);
+        if (ret == 0)
+        {
+          return;
+        }
+        break;
+
+      /* close: page 0, page write off, main bank, if_add_inc back */
+      case IIS2DULPX_ASYNC_PG_CLOSE_SEL:
+        op->tmp[0] = iis2dulpx_async_page_sel(0U);
+        ret = iis2dulpx_async_write(op, IIS2DULPX_PAGE_SEL, &op->tmp[0], 1, IIS2DULPX_ASYNC_PG_CLOSE_RW);
+        if (ret == 0)
+        {
+          return;
+        }
+        break;
+      case IIS2DULPX_ASYNC_PG_CLOSE_RW:
+        (void)memcpy(&page_rw, &op->page_rw, 1);
+        page_rw.page_read = PROPERTY_DISABLE;
+        page_rw.page_write = PROPERTY_DISABLE;
+        (void)memcpy(&op->page_rw, &page_rw, 1);
+        if (shadow != NULL)
+        {
+          shadow->page_rw = op->page_rw;
+        }
+        ret = iis2dulpx_async_write(op, IIS2DULPX_PAGE_RW, &op->page_rw, 1, IIS2DULPX_ASYNC_PG_CLOSE_BANK);
+        if (ret == 0)
+        {
+          return;
+        }
         break;
-
-      case 0x1:
-        val->wake_dur = (wup_dur_ext.wu_dur_extended == 1U) ?
-                        IIS2DULPX_7_ODR : IIS2DULPX_1_ODR;
+      case IIS2DULPX_ASYNC_PG_CLOSE_BANK:
+        op->state = IIS2DULPX_ASYNC_PG_INC_RESTORE;
+        if (priv->emb_session == 0U)
+        {
+          fca = priv->func_cfg_access_main;
+          fca.emb_func_reg_access = 0U;
+          (void)memcpy(&op->fca, &fca, 1);
+          priv->func_cfg_access_main = fca;
+          ret = iis2dulpx_async_write(op, IIS2DULPX_FUNC_CFG_ACCESS, &op->fca, 1,
+                                      IIS2DULPX_ASYNC_PG_INC_RESTORE);
+          if (ret == 0)
+          {
+            return;
+          }
+          break;
+        }
         break;
-
-      case 0x2:
-        val->wake_dur = (wup_dur_ext.wu_dur_extended == 1U) ?
-                        IIS2DULPX_11_ODR : IIS2DULPX_2_ODR;
+      case IIS2DULPX_ASYNC_PG_INC_RESTORE:
+        op->state = IIS2DULPX_ASYNC_FINISH;
+        if ((op->flags & IIS2DULPX_ASYNC_RESTORE) != 0U)
+        {
+          op->flags &= (uint8_t)~IIS2DULPX_ASYNC_RESTORE;
+          iis2dulpx_shadow_update(op->ctx, IIS2DULPX_CTRL1, op->ctrl1);
+          ret = iis2dulpx_async_write(op, IIS2DULPX_CTRL1, &op->ctrl1, 1, IIS2DULPX_ASYNC_FINISH);
+          if (ret == 0)
+          {
+            return;
+          }
+          break;
+        }
         break;
 
-      case 0x3:
+      case IIS2DULPX_ASYNC_FINISH:
       default:
-        val->wake_dur = IIS2DULPX_15_ODR;
-        break;
+        if ((op->status != 0) && (op->state == IIS2DULPX_ASYNC_FINISH) &&
+            ((op->flags & IIS2DULPX_ASYNC_EMB) != 0U))
+        {
+          /* register content unknown after a failed page write */
+          iis2dulpx_shadow_invalidate(op->ctx);
+        }
+        op->state = IIS2DULPX_ASYNC_IDLE;
+        if (op->done != NULL)
+        {
+          op->done(op);
+        }
+        return;
     }
-
-    val->sleep_dur = wup_dur.sleep_dur;
-
-    val->wake_ths_weight = int_cfg.wake_ths_w;
-    val->wake_ths = wup_ths.wk_ths;
-    val->wake_enable = (iis2dulpx_wake_enable_t)wup_ths.sleep_on;
-    val->inact_odr = (iis2dulpx_inact_odr_t)ctrl4.inact_odr;
   }
-
-  return ret;
 }
 
-int32_t iis2dulpx_tap_config_set(const stmdev_ctx_t *ctx, iis2dulpx_tap_config_t val)
+static int32_t iis2dulpx_async_start(iis2dulpx_async_op_t *op, uint8_t state, uint8_t flags)
 {
-  iis2dulpx_tap_cfg0_t tap_cfg0 = {0};
-  iis2dulpx_tap_cfg1_t tap_cfg1 = {0};
-  iis2dulpx_tap_cfg2_t tap_cfg2 = {0};
-  iis2dulpx_tap_cfg3_t tap_cfg3 = {0};
-  iis2dulpx_tap_cfg4_t tap_cfg4 = {0};
-  iis2dulpx_tap_cfg5_t tap_cfg5 = {0};
-  iis2dulpx_tap_cfg6_t tap_cfg6 = {0};
-  int32_t ret = 0;
-
-  ret = iis2dulpx_read_reg(ctx, IIS2DULPX_TAP_CFG0, (uint8_t *)&tap_cfg0, 1);
-  ret += iis2dulpx_read_reg(ctx, IIS2DULPX_TAP_CFG1, (uint8_t *)&tap_cfg1, 1);
-  ret += iis2dulpx_read_reg(ctx, IIS2DULPX_TAP_CFG2, (uint8_t *)&tap_cfg2, 1);
-  ret += iis2dulpx_read_reg(ctx, IIS2DULPX_TAP_CFG3, (uint8_t *)&tap_cfg3, 1);
-  ret += iis2dulpx_read_reg(ctx, IIS2DULPX_TAP_CFG4, (uint8_t *)&tap_cfg4, 1);
-  ret += iis2dulpx_read_reg(ctx, IIS2DULPX_TAP_CFG5, (uint8_t *)&tap_cfg5, 1);
-  ret += iis2dulpx_read_reg(ctx, IIS2DULPX_TAP_CFG6, (uint8_t *)&tap_cfg6, 1);
-
-  if (ret == 0)
+  if ((op->io == NULL) || (op->ctx == NULL) || (op->state != IIS2DULPX_ASYNC_IDLE))
   {
-    tap_cfg0.axis = (uint8_t)val.axis & 0x03U;
-    tap_cfg0.invert_t = val.inverted_peak_time & 0x1FU;
-    tap_cfg1.pre_still_ths = val.pre_still_ths & 0x0FU;
-    tap_cfg3.post_still_ths = val.post_still_ths & 0x0FU;
-    tap_cfg1.post_still_t = val.post_still_time & 0xFU;
-    tap_cfg2.post_still_t = (val.post_still_time >> 4) & 0x03U;
-    tap_cfg2.wait_t = val.shock_wait_time & 0x3FU;
-    tap_cfg3.latency_t = val.latency & 0x0FU;
-    tap_cfg4.wait_end_latency = val.wait_end_latency & 0x01U;
-    tap_cfg4.peak_ths = val.peak_ths & 0x3FU;
-    tap_cfg5.rebound_t = val.rebound & 0x1FU;
-    tap_cfg5.single_tap_en = val.single_tap_on & 0x01U;
-    tap_cfg5.double_tap_en = val.double_tap_on & 0x01U;
-    tap_cfg5.triple_tap_en = val.triple_tap_on & 0x01U;
-    tap_cfg6.pre_still_st = val.pre_still_start & 0x0FU;
-    tap_cfg6.pre_still_n = val.pre_still_n & 0x0FU;
+    return -1;
+  }
 
-    ret += iis2dulpx_write_reg(ctx, IIS2DULPX_TAP_CFG0, (uint8_t *)&tap_cfg0, 1);
-    ret += iis2dulpx_write_reg(ctx, IIS2DULPX_TAP_CFG1, (uint8_t *)&tap_cfg1, 1);
-    ret += iis2dulpx_write_reg(ctx, IIS2DULPX_TAP_CFG2, (uint8_t *)&tap_cfg2, 1);
-    ret += iis2dulpx_write_reg(ctx, IIS2DULPX_TAP_CFG3, (uint8_t *)&tap_cfg3, 1);
-    ret += iis2dulpx_write_reg(ctx, IIS2DULPX_TAP_CFG4, (uint8_t *)&tap_cfg4, 1);
-    ret += iis2dulpx_write_reg(ctx, IIS2DULPX_TAP_CFG5, (uint8_t *)&tap_cfg5, 1);
-    ret += iis2dulpx_write_reg(ctx, IIS2DULPX_TAP_CFG6, (uint8_t *)&tap_cfg6, 1);
+  /* the embedded bank selection is not covered by the lock hooks */
+  if ((state >= IIS2DULPX_ASYNC_PG_INC_READ) && (op->ctx->priv_data != NULL) &&
+      (((iis2dulpx_priv_t *)op->ctx->priv_data)->lock != NULL))
+  {
+    return -1;
   }
 
-  return ret;
+  op->status = 0;
+  op->flags = flags;
+  op->state = state;
+  iis2dulpx_async_step(op, 0);
+
+  return 0;
 }
 
-int32_t iis2dulpx_tap_config_get(const stmdev_ctx_t *ctx, iis2dulpx_tap_config_t *val)
+int32_t iis2dulpx_fifo_data_get_async(iis2dulpx_async_op_t *op, const iis2dulpx_md_t *md,
+                                      const iis2dulpx_fifo_mode_t *fmd, iis2dulpx_fifo_data_t *data)
 {
-  iis2dulpx_tap_cfg0_t tap_cfg0 = {0};
-  iis2dulpx_tap_cfg1_t tap_cfg1 = {0};
-  iis2dulpx_tap_cfg2_t tap_cfg2 = {0};
-  iis2dulpx_tap_cfg3_t tap_cfg3 = {0};
-  iis2dulpx_tap_cfg4_t tap_cfg4 = {0};
-  iis2dulpx_tap_cfg5_t tap_cfg5 = {0};
-  iis2dulpx_tap_cfg6_t tap_cfg6 = {0};
-  int32_t ret = 0;
+  op->md = md;
+  op->fmd = fmd;
+  op->out = data;
 
-  ret = iis2dulpx_read_reg(ctx, IIS2DULPX_TAP_CFG0, (uint8_t *)&tap_cfg0, 1);
-  ret += iis2dulpx_read_reg(ctx, IIS2DULPX_TAP_CFG1, (uint8_t *)&tap_cfg1, 1);
-  ret += iis2dulpx_read_reg(ctx, IIS2DULPX_TAP_CFG2, (uint8_t *)&tap_cfg2, 1);
-  ret += iis2dulpx_read_reg(ctx, IIS2DULPX_TAP_CFG3, (uint8_t *)&tap_cfg3, 1);
-  ret += iis2dulpx_read_reg(ctx, IIS2DULPX_TAP_CFG4, (uint8_t *)&tap_cfg4, 1);
-  ret += iis2dulpx_read_reg(ctx, IIS2DULPX_TAP_CFG5, (uint8_t *)&tap_cfg5, 1);
-  ret += iis2dulpx_read_reg(ctx, IIS2DULPX_TAP_CFG6, (uint8_t *)&tap_cfg6, 1);
+  return iis2dulpx_async_start(op, IIS2DULPX_ASYNC_FIFO_TAG, 0U);
+}
 
-  if (ret == 0)
-  {
-    val->axis = (iis2dulpx_axis_t)tap_cfg0.axis;
-    val->inverted_peak_time = tap_cfg0.invert_t & 0x1FU;
-    val->pre_still_ths = tap_cfg1.pre_still_ths & 0x0FU;
-    val->post_still_ths = tap_cfg3.post_still_ths & 0x0FU;
-    val->post_still_time = (uint8_t)((tap_cfg2.post_still_t << 4) | tap_cfg1.post_still_t) & 0x3FU;
-    val->shock_wait_time = tap_cfg2.wait_t & 0x3FU;
-    val->latency = tap_cfg3.latency_t & 0x0FU;
-    val->wait_end_latency = tap_cfg4.wait_end_latency & 0x01U;
-    val->peak_ths = tap_cfg4.peak_ths & 0x3FU;
-    val->rebound = tap_cfg5.rebound_t & 0x1FU;
-    val->single_tap_on = tap_cfg5.single_tap_en & 0x01U;
-    val->double_tap_on = tap_cfg5.double_tap_en & 0x01U;
-    val->triple_tap_on = tap_cfg5.triple_tap_en & 0x01U;
-    val->pre_still_start = tap_cfg6.pre_still_st & 0x0FU;
-    val->pre_still_n = tap_cfg6.pre_still_n & 0x0FU;
-  }
+int32_t iis2dulpx_all_sources_get_async(iis2dulpx_async_op_t *op, iis2dulpx_all_sources_t *val)
+{
+  op->out = val;
 
-  return ret;
+  return iis2dulpx_async_start(op, IIS2DULPX_ASYNC_SRC_READ, 0U);
 }
 
-int32_t iis2dulpx_timestamp_set(const stmdev_ctx_t *ctx, uint8_t val)
+int32_t iis2dulpx_ln_pg_write_async(iis2dulpx_async_op_t *op, uint16_t address, uint8_t *buf,
+                                    uint16_t len)
 {
-  iis2dulpx_interrupt_cfg_t int_cfg = {0};
-  int32_t ret = 0;
+  uint8_t flags = 0U;
 
-  ret = iis2dulpx_read_reg(ctx, IIS2DULPX_INTERRUPT_CFG, (uint8_t *)&int_cfg, 1);
+  if ((op->ctx == NULL) || (op->ctx->priv_data == NULL))
+  {
+    return -1;
+  }
 
-  if (ret == 0)
+  /* same streaming rule as iis2dulpx_ln_pg_write_burst */
+  if ((len > 3U) && (((iis2dulpx_priv_t *)op->ctx->priv_data)->emb_session == 0U))
   {
-    int_cfg.timestamp_en = (uint8_t)val & 0x01U;
-    ret = iis2dulpx_write_reg(ctx, IIS2DULPX_INTERRUPT_CFG, (uint8_t *)&int_cfg, 1);
+    flags = IIS2DULPX_ASYNC_STREAM;
   }
 
-  return ret;
+  op->address = address & 0x0FFFU;
+  op->buf = buf;
+  op->len = len;
+  op->idx = 0U;
+
+  return iis2dulpx_async_start(op, IIS2DULPX_ASYNC_PG_INC_READ, flags);
 }
 
-int32_t iis2dulpx_timestamp_get(const stmdev_ctx_t *ctx, uint8_t *val)
+int32_t iis2dulpx_udelay_set(const stmdev_ctx_t *ctx, iis2dulpx_udelay_ptr udelay)
 {
-  iis2dulpx_interrupt_cfg_t int_cfg = {0};
-  int32_t ret = 0;
-
-  ret = iis2dulpx_read_reg(ctx, IIS2DULPX_INTERRUPT_CFG, (uint8_t *)&int_cfg, 1);
-  if (ret == 0)
+  if (ctx->priv_data == NULL)
   {
-    *val = int_cfg.timestamp_en;
+    return -1;
   }
 
-  return ret;
+  ((iis2dulpx_priv_t *)ctx->priv_data)->udelay = udelay;
+
+  return 0;
 }
 
-int32_t iis2dulpx_timestamp_raw_get(const stmdev_ctx_t *ctx, uint32_t *val)
+enum
 {
-  uint8_t buff[4] = {0};
-  int32_t ret = 0;
-
-  ret = iis2dulpx_read_reg(ctx, IIS2DULPX_TIMESTAMP0, buff, 4);
-  if (ret != 0)
-  {
-    return ret;
-  }
-  *val = buff[3];
-  *val = (*val * 256U) +  buff[2];
-  *val = (*val * 256U) +  buff[1];
-  *val = (*val * 256U) +  buff[0];
+  IIS2DULPX_PWR_IDLE = 0,
+  IIS2DULPX_PWR_BOOT_WAIT,
+  IIS2DULPX_PWR_RESET_WAIT,
+  IIS2DULPX_PWR_DPD_WAIT,
+};
 
-  return ret;
+void iis2dulpx_pwr_init(iis2dulpx_pwr_t *pwr)
+{
+  (void)memset(pwr, 0x00, sizeof(iis2dulpx_pwr_t));
 }
 
-int32_t iis2dulpx_long_cnt_flag_data_ready_get(const stmdev_ctx_t *ctx,
-                                               uint8_t *val)
+static int32_t iis2dulpx_pwr_finish(iis2dulpx_pwr_t *pwr, int32_t status)
 {
-  iis2dulpx_emb_func_status_t emb_func_status = {0};
-  int32_t ret = 0;
+  pwr->state = IIS2DULPX_PWR_IDLE;
+  pwr->busy = 0U;
+  pwr->status = status;
+  pwr->wait_us = 0U;
 
-  ret = iis2dulpx_mem_bank_set(ctx, IIS2DULPX_EMBED_FUNC_MEM_BANK);
-  ret += iis2dulpx_read_reg(ctx, IIS2DULPX_EMB_FUNC_STATUS,
-                            (uint8_t *)&emb_func_status, 1);
-  if (ret == 0)
+  if (pwr->done != NULL)
   {
-    *val = emb_func_status.is_fsm_lc;
+    pwr->done(pwr->user, status);
   }
 
-  ret += iis2dulpx_mem_bank_set(ctx, IIS2DULPX_MAIN_MEM_BANK);
-
-  return ret;
+  return status;
 }
 
-int32_t iis2dulpx_emb_fsm_en_set(const stmdev_ctx_t *ctx, uint8_t val)
+/*
+ * Save the configuration runs: cached runs are copied from the shadow,
+ * the others are read from the device (and cached, if enabled).
+ */
+static int32_t iis2dulpx_pwr_save(const stmdev_ctx_t *ctx, iis2dulpx_shadow_t *snap)
 {
+  iis2dulpx_shadow_t *shadow = iis2dulpx_shadow_of(ctx, IIS2DULPX_SHADOW_FIRST);
+  uint8_t buff[9];
+  uint8_t reg;
+  uint8_t hit;
+  uint8_t i, j;
   int32_t ret = 0;
 
-  iis2dulpx_emb_func_en_b_t emb_func_en_b;
-  ret = iis2dulpx_mem_bank_set(ctx, IIS2DULPX_EMBED_FUNC_MEM_BANK);
-  ret += iis2dulpx_read_reg(ctx, IIS2DULPX_EMB_FUNC_EN_B,
-                            (uint8_t *)&emb_func_en_b, 1);
-  if (ret == 0)
+  (void)memset(snap, 0x00, sizeof(iis2dulpx_shadow_t));
+
+  for (i = 0U; i < (uint8_t)(sizeof(iis2dulpx_shadow_runs) / sizeof(iis2dulpx_shadow_runs[0])); i++)
   {
-    emb_func_en_b.fsm_en = (uint8_t)val & 0x01U;
+    reg = iis2dulpx_shadow_runs[i][0];
 
-    ret += iis2dulpx_write_reg(ctx, IIS2DULPX_EMB_FUNC_EN_B,
-                               (uint8_t *)&emb_func_en_b, 1);
-  }
+    hit = PROPERTY_ENABLE;
+    for (j = 0U; j < iis2dulpx_shadow_runs[i][1]; j++)
+    {
+      hit &= iis2dulpx_shadow_hit(ctx, reg + j);
+    }
 
-  ret += iis2dulpx_mem_bank_set(ctx, IIS2DULPX_MAIN_MEM_BANK);
+    if (hit == PROPERTY_ENABLE)
+    {
+      (void)memcpy(buff, &shadow->reg[reg - IIS2DULPX_SHADOW_FIRST], iis2dulpx_shadow_runs[i][1]);
+    }
+    else
+    {
+      ret = iis2dulpx_read_reg(ctx, reg, buff, iis2dulpx_shadow_runs[i][1]);
+      if (ret != 0)
+      {
+        break;
+      }
+    }
+
+    for (j = 0U; j < iis2dulpx_shadow_runs[i][1]; j++)
+    {
+      iis2dulpx_shadow_store(snap, reg + j, buff[j]);
+      if (shadow != NULL)
+      {
+        iis2dulpx_shadow_store(shadow, reg + j, buff[j]);
+      }
+    }
+  }
 
   return ret;
 }
 
-int32_t iis2dulpx_emb_fsm_en_get(const stmdev_ctx_t *ctx, uint8_t *val)
+/*
+ * Write the saved configuration back: CTRL1 first, for the address
+ * auto-increment of the following bursts, then all the runs in one
+ * transaction with CTRL5 (ODR) split out and written last. The deep
+ * power down request is not restored.
+ */
+static int32_t iis2dulpx_pwr_restore(const stmdev_ctx_t *ctx, iis2dulpx_shadow_t *snap)
 {
+  iis2dulpx_sleep_t sleep;
+  iis2dulpx_txn_t txn;
+  uint8_t reg;
+  uint8_t len;
+  uint8_t i;
   int32_t ret = 0;
 
-  iis2dulpx_emb_func_en_b_t emb_func_en_b;
-  ret = iis2dulpx_mem_bank_set(ctx, IIS2DULPX_EMBED_FUNC_MEM_BANK);
-  ret += iis2dulpx_read_reg(ctx, IIS2DULPX_EMB_FUNC_EN_B,
-                            (uint8_t *)&emb_func_en_b, 1);
-  if (ret == 0)
+  (void)memcpy(&sleep, &snap->reg[IIS2DULPX_SLEEP - IIS2DULPX_SHADOW_FIRST], 1);
+  sleep.deep_pd = PROPERTY_DISABLE;
+  (void)memcpy(&snap->reg[IIS2DULPX_SLEEP - IIS2DULPX_SHADOW_FIRST], &sleep, 1);
+
+  ret = iis2dulpx_shadow_write(ctx, IIS2DULPX_CTRL1, &snap->reg[IIS2DULPX_CTRL1 - IIS2DULPX_SHADOW_FIRST]);
+  if (ret != 0)
   {
-    *val = emb_func_en_b.fsm_en;
+    return ret;
   }
 
-  ret += iis2dulpx_mem_bank_set(ctx, IIS2DULPX_MAIN_MEM_BANK);
+  iis2dulpx_txn_init(&txn, ctx);
+  for (i = 0U; i < (uint8_t)(sizeof(iis2dulpx_shadow_runs) / sizeof(iis2dulpx_shadow_runs[0])); i++)
+  {
+    reg = iis2dulpx_shadow_runs[i][0];
+    len = iis2dulpx_shadow_runs[i][1];
+    if (reg == IIS2DULPX_CTRL1)
+    {
+      /* CTRL2 .. CTRL4, then FIFO_CTRL .. SIXD */
+      ret += iis2dulpx_txn_write(&txn, IIS2DULPX_CTRL2,
+                                 &snap->reg[IIS2DULPX_CTRL2 - IIS2DULPX_SHADOW_FIRST],
+                                 IIS2DULPX_CTRL5 - IIS2DULPX_CTRL2);
+      reg = IIS2DULPX_CTRL5 + 1U;
+      len = (uint8_t)(len - (reg - IIS2DULPX_CTRL1));
+    }
+
+    ret += iis2dulpx_txn_write(&txn, reg, &snap->reg[reg - IIS2DULPX_SHADOW_FIRST], len);
+  }
+  ret += iis2dulpx_txn_write(&txn, IIS2DULPX_CTRL5,
+                             &snap->reg[IIS2DULPX_CTRL5 - IIS2DULPX_SHADOW_FIRST], 1);
+  ret += iis2dulpx_txn_run(&txn);
 
   return ret;
 }
 
-int32_t iis2dulpx_fsm_enable_set(const stmdev_ctx_t *ctx,
-                                 iis2dulpx_emb_fsm_enable_t *val)
+int32_t iis2dulpx_pwr_start(const stmdev_ctx_t *ctx, iis2dulpx_pwr_t *pwr,
+                            iis2dulpx_pwr_cmd_t cmd, iis2dulpx_async_cb_t done, void *user)
 {
-  iis2dulpx_emb_func_en_b_t emb_func_en_b = {0};
+  iis2dulpx_en_device_config_t en_device_config = {0};
+  iis2dulpx_ctrl1_t ctrl1 = {0};
+  iis2dulpx_ctrl4_t ctrl4 = {0};
   int32_t ret = 0;
 
-  ret = iis2dulpx_mem_bank_set(ctx, IIS2DULPX_EMBED_FUNC_MEM_BANK);
-
-  if (ret == 0)
+  if (pwr->busy != 0U)
   {
-    ret = iis2dulpx_write_reg(ctx, IIS2DULPX_FSM_ENABLE,
-                              (uint8_t *)&val->fsm_enable, 1);
+    return -1;
   }
 
-  ret += iis2dulpx_read_reg(ctx, IIS2DULPX_EMB_FUNC_EN_B,
-                            (uint8_t *)&emb_func_en_b, 1);
-  if (ret == 0)
+  pwr->ctx = ctx;
+  pwr->cmd = (uint8_t)cmd;
+  pwr->done = done;
+  pwr->user = user;
+  pwr->status = 0;
+  pwr->busy = 1U;
+
+  switch (cmd)
   {
-    if ((val->fsm_enable.fsm1_en |
-         val->fsm_enable.fsm2_en |
-         val->fsm_enable.fsm3_en |
-         val->fsm_enable.fsm4_en |
-         val->fsm_enable.fsm5_en |
-         val->fsm_enable.fsm6_en |
-         val->fsm_enable.fsm7_en |
-         val->fsm_enable.fsm8_en) != PROPERTY_DISABLE)
-    {
-      emb_func_en_b.fsm_en = PROPERTY_ENABLE;
-    }
-    else
-    {
-      emb_func_en_b.fsm_en = PROPERTY_DISABLE;
-    }
+    case IIS2DULPX_PWR_REBOOT:
+      ret = iis2dulpx_shadow_read(ctx, IIS2DULPX_CTRL4, (uint8_t *)&ctrl4);
+      if (ret == 0)
+      {
+        ctrl4.boot = PROPERTY_ENABLE;
+        ret = iis2dulpx_write_reg(ctx, IIS2DULPX_CTRL4, (uint8_t *)&ctrl4, 1);
+      }
+      /* registers are reloaded from NVM */
+      iis2dulpx_shadow_invalidate(ctx);
+      pwr->state = IIS2DULPX_PWR_BOOT_WAIT;
+      pwr->wait_us = IIS2DULPX_PWR_BOOT_POLL_US;
+      pwr->left_us = IIS2DULPX_PWR_BOOT_TIMEOUT_US;
+      break;
 
-    ret += iis2dulpx_write_reg(ctx, IIS2DULPX_EMB_FUNC_EN_B,
-                               (uint8_t *)&emb_func_en_b, 1);
+    case IIS2DULPX_PWR_SW_RESET:
+      ctrl1.sw_reset = PROPERTY_ENABLE;
+      ret = iis2dulpx_write_reg(ctx, IIS2DULPX_CTRL1, (uint8_t *)&ctrl1, 1);
+      iis2dulpx_shadow_invalidate(ctx);
+      pwr->state = IIS2DULPX_PWR_RESET_WAIT;
+      pwr->wait_us = IIS2DULPX_PWR_RESET_POLL_US;
+      pwr->left_us = IIS2DULPX_PWR_RESET_TIMEOUT_US;
+      break;
+
+    case IIS2DULPX_PWR_DPD_ENTER_SAVE:
+      pwr->snap_valid = PROPERTY_DISABLE;
+      ret = iis2dulpx_pwr_save(ctx, &pwr->snap);
+      if (ret == 0)
+      {
+        pwr->snap_valid = PROPERTY_ENABLE;
+        ret = iis2dulpx_enter_deep_power_down(ctx, 1);
+      }
+      return iis2dulpx_pwr_finish(pwr, ret);
+
+    case IIS2DULPX_PWR_DPD_ENTER:
+      ret = iis2dulpx_enter_deep_power_down(ctx, 1);
+      return iis2dulpx_pwr_finish(pwr, ret);
+
+    case IIS2DULPX_PWR_SW_POR:
+    case IIS2DULPX_PWR_DPD_EXIT:
+    case IIS2DULPX_PWR_DPD_EXIT_RESTORE:
+      if ((cmd == IIS2DULPX_PWR_DPD_EXIT_RESTORE) && (pwr->snap_valid == PROPERTY_DISABLE))
+      {
+        return iis2dulpx_pwr_finish(pwr, -1);
+      }
+
+      if (cmd == IIS2DULPX_PWR_SW_POR)
+      {
+        ret = iis2dulpx_enter_deep_power_down(ctx, 1);
+        if (ret != 0)
+        {
+          return iis2dulpx_pwr_finish(pwr, ret);
+        }
+        iis2dulpx_priv_reset(ctx);
+      }
+
+      en_device_config.soft_pd = PROPERTY_ENABLE;
+      ret = iis2dulpx_write_reg(ctx, IIS2DULPX_EN_DEVICE_CONFIG, (uint8_t *)&en_device_config, 1);
+      iis2dulpx_shadow_invalidate(ctx);
+      pwr->state = IIS2DULPX_PWR_DPD_WAIT;
+      pwr->wait_us = IIS2DULPX_PWR_DPD_EXIT_US;
+      pwr->left_us = IIS2DULPX_PWR_DPD_EXIT_US;
+      break;
+
+    default:
+      ret = -1;
+      break;
   }
 
-  ret += iis2dulpx_mem_bank_set(ctx, IIS2DULPX_MAIN_MEM_BANK);
+  if (ret != 0)
+  {
+    (void)iis2dulpx_pwr_finish(pwr, ret);
+  }
 
   return ret;
 }
-
-int32_t iis2dulpx_fsm_enable_get(const stmdev_ctx_t *ctx,
-                                 iis2dulpx_emb_fsm_enable_t *val)
+
+int32_t iis2dulpx_pwr_poll(iis2dulpx_pwr_t *pwr, uint32_t elapsed_us)
 {
+  iis2dulpx_ctrl1_t ctrl1;
+  iis2dulpx_ctrl4_t ctrl4;
+  uint8_t pending = 0U;
   int32_t ret = 0;
 
-  ret = iis2dulpx_mem_bank_set(ctx, IIS2DULPX_EMBED_FUNC_MEM_BANK);
+  if (pwr->busy == 0U)
+  {
+    return 0;
+  }
 
-  if (ret == 0)
+  pwr->left_us = (pwr->left_us > elapsed_us) ? (pwr->left_us - elapsed_us) : 0U;
+  if (elapsed_us < pwr->wait_us)
   {
-    ret = iis2dulpx_read_reg(ctx, IIS2DULPX_FSM_ENABLE,
-                             (uint8_t *)&val->fsm_enable, 1);
+    pwr->wait_us -= elapsed_us;
+    return 0;
   }
 
-  ret += iis2dulpx_mem_bank_set(ctx, IIS2DULPX_MAIN_MEM_BANK);
+  switch (pwr->state)
+  {
+    case IIS2DULPX_PWR_BOOT_WAIT:
+      ret = iis2dulpx_read_reg(pwr->ctx, IIS2DULPX_CTRL4, (uint8_t *)&ctrl4, 1);
+      pending = ctrl4.boot;
+      pwr->wait_us = IIS2DULPX_PWR_BOOT_POLL_US;
+      break;
 
-  return ret;
-}
+    case IIS2DULPX_PWR_RESET_WAIT:
+      ret = iis2dulpx_read_reg(pwr->ctx, IIS2DULPX_CTRL1, (uint8_t *)&ctrl1, 1);
+      pending = ctrl1.sw_reset;
+      pwr->wait_us = IIS2DULPX_PWR_RESET_POLL_US;
+      break;
 
-int32_t iis2dulpx_long_cnt_set(const stmdev_ctx_t *ctx, uint16_t val)
-{
-  uint8_t buff[2] = {0};
-  int32_t ret = 0;
+    case IIS2DULPX_PWR_DPD_WAIT:
+      if (pwr->cmd == (uint8_t)IIS2DULPX_PWR_DPD_EXIT_RESTORE)
+      {
+        ret = iis2dulpx_pwr_restore(pwr->ctx, &pwr->snap);
+      }
+      break;
 
-  ret = iis2dulpx_mem_bank_set(ctx, IIS2DULPX_EMBED_FUNC_MEM_BANK);
+    default:
+      ret = -1;
+      break;
+  }
 
-  if (ret == 0)
+  if (ret != 0)
   {
-    buff[1] = (uint8_t)(val / 256U);
-    buff[0] = (uint8_t)(val - (buff[1] * 256U));
-    ret = iis2dulpx_write_reg(ctx, IIS2DULPX_FSM_LONG_COUNTER_L, buff, 2);
+    return iis2dulpx_pwr_finish(pwr, ret);
   }
 
-  ret += iis2dulpx_mem_bank_set(ctx, IIS2DULPX_MAIN_MEM_BANK);
+  if (pending == 0U)
+  {
+    return iis2dulpx_pwr_finish(pwr, 0);
+  }
 
-  return ret;
+  if (pwr->left_us == 0U)
+  {
+    return iis2dulpx_pwr_finish(pwr, -1); /* procedure failed */
+  }
+
+  return 0;
 }
 
-int32_t iis2dulpx_long_cnt_get(const stmdev_ctx_t *ctx, uint16_t *val)
+int32_t iis2dulpx_pwr_wait(iis2dulpx_pwr_t *pwr)
 {
-  uint8_t buff[2] = {0};
-  int32_t ret = 0;
+  iis2dulpx_udelay_ptr udelay = NULL;
+  uint32_t elapsed;
 
-  ret = iis2dulpx_mem_bank_set(ctx, IIS2DULPX_EMBED_FUNC_MEM_BANK);
+  if (pwr->busy == 0U)
+  {
+    return pwr->status;
+  }
 
-  if (ret == 0)
+  if (pwr->ctx->priv_data != NULL)
   {
-    ret = iis2dulpx_read_reg(ctx, IIS2DULPX_FSM_LONG_COUNTER_L, buff, 2);
-    *val = (uint16_t)(buff[0] | ((uint16_t)buff[1] << 8));
+    udelay = ((iis2dulpx_priv_t *)pwr->ctx->priv_data)->udelay;
   }
 
-  ret += iis2dulpx_mem_bank_set(ctx, IIS2DULPX_MAIN_MEM_BANK);
+  /* no delay available: left running for iis2dulpx_pwr_poll */
+  if ((udelay == NULL) && (pwr->ctx->mdelay == NULL))
+  {
+    return -1;
+  }
 
-  return ret;
+  while (pwr->busy != 0U)
+  {
+    elapsed = pwr->wait_us;
+    if (udelay != NULL)
+    {
+      udelay(elapsed);
+    }
+    else
+    {
+      elapsed = (elapsed + 999U) / 1000U;
+      pwr->ctx->mdelay(elapsed);
+      elapsed *= 1000U;
+    }
+
+    (void)iis2dulpx_pwr_poll(pwr, elapsed);
+  }
+
+  return pwr->status;
 }
 
-int32_t iis2dulpx_fsm_status_get(const stmdev_ctx_t *ctx,
-                                 iis2dulpx_fsm_status_mainpage_t *val)
+/* register image standing for the bus in iis2dulpx_profile_compile() */
+typedef struct
 {
-  return iis2dulpx_read_reg(ctx, IIS2DULPX_FSM_STATUS_MAINPAGE,
-                            (uint8_t *) val, 1);
-}
+  const stmdev_ctx_t *ctx;             /* source of the registers not yet known */
+  uint8_t reg[128];
+  uint8_t known[16];
+  uint8_t written[16];
+} iis2dulpx_profile_img_t;
 
-int32_t iis2dulpx_fsm_out_get(const stmdev_ctx_t *ctx, uint8_t *val)
+static int32_t iis2dulpx_profile_img_read(void *handle, uint8_t reg, uint8_t *data, uint16_t len)
 {
+  iis2dulpx_profile_img_t *img = (iis2dulpx_profile_img_t *)handle;
   int32_t ret = 0;
+  uint16_t i;
+  uint8_t addr;
+  uint8_t bit;
 
-  ret = iis2dulpx_mem_bank_set(ctx, IIS2DULPX_EMBED_FUNC_MEM_BANK);
-
-  if (ret == 0)
+  for (i = 0U; i < len; i++)
   {
-    ret = iis2dulpx_read_reg(ctx, IIS2DULPX_FSM_OUTS1, val, 8);
+    addr = (uint8_t)((reg + i) & 0x7FU);
+    bit = (uint8_t)(1U << (addr % 8U));
+    if ((img->known[addr / 8U] & bit) == 0U)
+    {
+      ret = iis2dulpx_shadow_read(img->ctx, addr, &img->reg[addr]);
+      if (ret != 0)
+      {
+        return ret;
+      }
+      img->known[addr / 8U] |= bit;
+    }
+    data[i] = img->reg[addr];
   }
 
-  ret += iis2dulpx_mem_bank_set(ctx, IIS2DULPX_MAIN_MEM_BANK);
-
   return ret;
 }
 
-int32_t iis2dulpx_fsm_data_rate_set(const stmdev_ctx_t *ctx,
-                                    iis2dulpx_fsm_val_odr_t val)
+static int32_t iis2dulpx_profile_img_write(void *handle, uint8_t reg, const uint8_t *data,
+                                           uint16_t len)
 {
-  iis2dulpx_fsm_odr_t fsm_odr_reg = {0};
-  int32_t ret = 0;
+  iis2dulpx_profile_img_t *img = (iis2dulpx_profile_img_t *)handle;
+  uint16_t i;
+  uint8_t addr;
+  uint8_t bit;
 
-  ret = iis2dulpx_mem_bank_set(ctx, IIS2DULPX_EMBED_FUNC_MEM_BANK);
-  ret += iis2dulpx_read_reg(ctx, IIS2DULPX_FSM_ODR,
-                            (uint8_t *)&fsm_odr_reg, 1);
-  if (ret == 0)
+  for (i = 0U; i < len; i++)
   {
-    fsm_odr_reg.fsm_odr = (uint8_t)val & 0x07U;
-    ret += iis2dulpx_write_reg(ctx, IIS2DULPX_FSM_ODR,
-                               (uint8_t *)&fsm_odr_reg, 1);
-  }
+    addr = (uint8_t)((reg + i) & 0x7FU);
 
-  ret += iis2dulpx_mem_bank_set(ctx, IIS2DULPX_MAIN_MEM_BANK);
+    /* main page registers only */
+    if (addr == IIS2DULPX_FUNC_CFG_ACCESS)
+    {
+      return -1;
+    }
 
-  return ret;
+    bit = (uint8_t)(1U << (addr % 8U));
+    img->reg[addr] = data[i];
+    img->known[addr / 8U] |= bit;
+    img->written[addr / 8U] |= bit;
+  }
+
+  return 0;
 }
 
-int32_t iis2dulpx_fsm_data_rate_get(const stmdev_ctx_t *ctx,
-                                    iis2dulpx_fsm_val_odr_t *val)
+int32_t iis2dulpx_profile_compile(const stmdev_ctx_t *ctx, const iis2dulpx_profile_cfg_t *cfg,
+                                  iis2dulpx_profile_t *prof)
 {
-  iis2dulpx_fsm_odr_t fsm_odr_reg = {0};
+  iis2dulpx_profile_img_t img;
+  stmdev_ctx_t bus;
+  uint8_t tmp[3];
+  uint8_t last = 0xFFU;
+  uint8_t addr = 0;
+  uint8_t pos = 0;
+  uint8_t num = 0;
+  uint8_t len;
+  uint8_t i;
   int32_t ret = 0;
 
-  ret = iis2dulpx_mem_bank_set(ctx, IIS2DULPX_EMBED_FUNC_MEM_BANK);
-  ret += iis2dulpx_read_reg(ctx, IIS2DULPX_FSM_ODR, (uint8_t *)&fsm_odr_reg, 1);
-  ret += iis2dulpx_mem_bank_set(ctx, IIS2DULPX_MAIN_MEM_BANK);
-
+  (void)memset(&img, 0x00, sizeof(iis2dulpx_profile_img_t));
+  img.ctx = ctx;
+
+  /* the setters validate cfg and do their read-modify-write on img */
+  (void)memset(&bus, 0x00, sizeof(stmdev_ctx_t));
+  bus.write_reg = iis2dulpx_profile_img_write;
+  bus.read_reg = iis2dulpx_profile_img_read;
+  bus.mdelay = ctx->mdelay;
+  bus.handle = &img;
+
+  ret = iis2dulpx_mode_set(&bus, &cfg->md);
+  ret += iis2dulpx_fifo_mode_set(&bus, cfg->fifo);
+  ret += iis2dulpx_fifo_watermark_set(&bus, cfg->fifo_wtm);
+  ret += iis2dulpx_fifo_batch_set(&bus, cfg->batch);
+  ret += iis2dulpx_pin_int1_route_set(&bus, &cfg->int1);
+  ret += iis2dulpx_int_config_set(&bus, &cfg->int_cfg);
   if (ret != 0)
   {
     return ret;
   }
 
-  switch (fsm_odr_reg.fsm_odr)
-  {
-    case 0:
-      *val = IIS2DULPX_ODR_FSM_12Hz5;
-      break;
-
-    case 1:
-      *val = IIS2DULPX_ODR_FSM_25Hz;
-      break;
+  (void)memset(prof, 0x00, sizeof(iis2dulpx_profile_t));
 
-    case 2:
-      *val = IIS2DULPX_ODR_FSM_50Hz;
-      break;
+  /* runs of written registers, CTRL5 in a run of its own */
+  while (addr < 128U)
+  {
+    len = 0U;
+    while (((addr + len) < 128U) &&
+           ((img.written[(addr + len) / 8U] & (1U << ((addr + len) % 8U))) != 0U))
+    {
+      len++;
+      if ((addr == IIS2DULPX_CTRL5) || ((addr + len) == IIS2DULPX_CTRL5))
+      {
+        break;
+      }
+    }
 
-    case 3:
-      *val = IIS2DULPX_ODR_FSM_100Hz;
-      break;
+    if (len == 0U)
+    {
+      addr++;
+      continue;
+    }
 
-    case 4:
-      *val = IIS2DULPX_ODR_FSM_200Hz;
-      break;
+    if ((num == IIS2DULPX_PROFILE_RUNS) || ((pos + len) > IIS2DULPX_PROFILE_LEN))
+    {
+      return -1;
+    }
 
-    case 5:
-      *val = IIS2DULPX_ODR_FSM_400Hz;
-      break;
+    prof->run[num][0] = addr;
+    prof->run[num][1] = len;
+    prof->run[num][2] = pos;
+    (void)memcpy(&prof->data[pos], &img.reg[addr], len);
+    if (addr == IIS2DULPX_CTRL5)
+    {
+      last = num;
+    }
 
-    case 6:
-      *val = IIS2DULPX_ODR_FSM_800Hz;
-      break;
+    num++;
+    pos += len;
+    addr += len;
+  }
 
-    default:
-      *val = IIS2DULPX_ODR_FSM_12Hz5;
-      break;
+  /* ODR once the rest, FIFO and interrupts included, is configured */
+  if (last < num)
+  {
+    (void)memcpy(tmp, prof->run[last], 3);
+    for (i = last; (i + 1U) < num; i++)
+    {
+      (void)memcpy(prof->run[i], prof->run[i + 1U], 3);
+    }
+    (void)memcpy(prof->run[num - 1U], tmp, 3);
   }
 
-  return ret;
+  prof->num = num;
+
+  return 0;
 }
 
-int32_t iis2dulpx_fsm_init_set(const stmdev_ctx_t *ctx, uint8_t val)
+int32_t iis2dulpx_profile_apply(const stmdev_ctx_t *ctx, const iis2dulpx_profile_t *prof)
 {
-  iis2dulpx_emb_func_init_b_t emb_func_init_b = {0};
+  uint8_t buff[IIS2DULPX_PROFILE_LEN];
+  iis2dulpx_txn_t txn;
   int32_t ret = 0;
+  uint8_t i;
 
-  ret = iis2dulpx_mem_bank_set(ctx, IIS2DULPX_EMBED_FUNC_MEM_BANK);
-  ret += iis2dulpx_read_reg(ctx, IIS2DULPX_EMB_FUNC_INIT_B,
-                            (uint8_t *)&emb_func_init_b, 1);
-
-  if (ret == 0)
+  if (prof->num > IIS2DULPX_PROFILE_RUNS)
   {
-    emb_func_init_b.fsm_init = (uint8_t)val & 0x01U;
-
-    ret += iis2dulpx_write_reg(ctx, IIS2DULPX_EMB_FUNC_INIT_B,
-                               (uint8_t *)&emb_func_init_b, 1);
+    return -1;
   }
 
-  ret += iis2dulpx_mem_bank_set(ctx, IIS2DULPX_MAIN_MEM_BANK);
+  /* prof may be const data, the transfers need a writable buffer */
+  (void)memcpy(buff, prof->data, IIS2DULPX_PROFILE_LEN);
+
+  iis2dulpx_txn_init(&txn, ctx);
+  for (i = 0U; i < prof->num; i++)
+  {
+    if (((uint16_t)prof->run[i][2] + prof->run[i][1]) > IIS2DULPX_PROFILE_LEN)
+    {
+      return -1;
+    }
+    ret += iis2dulpx_txn_write(&txn, prof->run[i][0], &buff[prof->run[i][2]], prof->run[i][1]);
+  }
+  ret += iis2dulpx_txn_run(&txn);
 
   return ret;
 }
 
-int32_t iis2dulpx_fsm_init_get(const stmdev_ctx_t *ctx, uint8_t *val)
+/* fail bits of one sign, strict: |delta| -/+ 3 sigma within the limits */
+static uint8_t iis2dulpx_st_judge(const iis2dulpx_st_cfg_t *cfg, const iis2dulpx_fifo_win_t *off,
+                                  const iis2dulpx_fifo_win_t *on, iis2dulpx_st_result_t *res,
+                                  uint8_t sign, uint8_t strict)
 {
-  iis2dulpx_emb_func_init_b_t emb_func_init_b = {0};
-  int32_t ret = 0;
+  iis2dulpx_fifo_feat_t f_off;
+  iis2dulpx_fifo_feat_t f_on;
+  uint64_t var;
+  uint32_t bound;
+  uint32_t mag;
+  uint8_t fail = 0;
+  uint8_t i;
 
-  ret = iis2dulpx_mem_bank_set(ctx, IIS2DULPX_EMBED_FUNC_MEM_BANK);
-  ret += iis2dulpx_read_reg(ctx, IIS2DULPX_EMB_FUNC_INIT_B,
-                            (uint8_t *)&emb_func_init_b, 1);
-  if (ret == 0)
+  if ((off->num == 0U) || (on->num == 0U))
   {
-    *val = emb_func_init_b.fsm_init;
+    return 0x07U;
   }
 
-  ret += iis2dulpx_mem_bank_set(ctx, IIS2DULPX_MAIN_MEM_BANK);
+  (void)iis2dulpx_fifo_win_features(off, cfg->md.fs, &f_off);
+  (void)iis2dulpx_fifo_win_features(on, cfg->md.fs, &f_on);
 
-  return ret;
+  for (i = 0U; i < 3U; i++)
+  {
+    res->delta[sign][i] = f_on.mean[i] - f_off.mean[i];
+
+    /* variance of the difference of the two averages */
+    var = (f_on.var[i] / f_on.num) + (f_off.var[i] / f_off.num);
+    bound = 3U * (uint32_t)iis2dulpx_isqrt(var);
+    res->bound[sign][i] = bound;
+
+    mag = (res->delta[sign][i] < 0) ? (uint32_t)(-res->delta[sign][i]) :
+          (uint32_t)res->delta[sign][i];
+
+    if (strict == PROPERTY_ENABLE)
+    {
+      if ((mag < bound) || ((mag - bound) < cfg->min_ug[i]) || ((mag + bound) > cfg->max_ug[i]))
+      {
+        fail |= (uint8_t)(1U << i);
+      }
+    }
+    else if ((mag < cfg->min_ug[i]) || (mag > cfg->max_ug[i]))
+    {
+      fail |= (uint8_t)(1U << i);
+    }
+    else
+    {
+      /* axis within limits */
+    }
+  }
+
+  return fail;
 }
 
-int32_t iis2dulpx_fsm_fifo_en_set(const stmdev_ctx_t *ctx, uint8_t val)
-{
-  iis2dulpx_emb_func_fifo_en_t fifo_reg = {0};
+/*
+ * Restart the FIFO and accumulate the samples of the current self-test
+ * state: min_samples with off == NULL, otherwise up to max_samples or
+ * until a clear pass against off.
+ */
+static int32_t iis2dulpx_st_collect(const stmdev_ctx_t *ctx, const iis2dulpx_st_cfg_t *cfg,
+                                    const iis2dulpx_fifo_win_t *off, iis2dulpx_fifo_win_t *win,
+                                    iis2dulpx_st_result_t *res, uint8_t sign)
+{
+  uint8_t buff[IIS2DULPX_ST_BURST * IIS2DULPX_FIFO_RECORD_LEN];
+  iis2dulpx_fifo_mode_t fmd = {0};
+  uint16_t target = (off == NULL) ? cfg->min_samples : cfg->max_samples;
+  uint16_t drop = cfg->discard;
+  uint16_t level = 0;
+  uint16_t idle = 0;
+  uint16_t n;
   int32_t ret = 0;
 
-  ret = iis2dulpx_mem_bank_set(ctx, IIS2DULPX_EMBED_FUNC_MEM_BANK);
-  ret += iis2dulpx_read_reg(ctx, IIS2DULPX_EMB_FUNC_FIFO_EN, (uint8_t *)&fifo_reg, 1);
-  if (ret == 0)
+  ctx->mdelay(cfg->settle_ms);
+
+  fmd.store = IIS2DULPX_FIFO_1X;
+  fmd.xl_only = PROPERTY_ENABLE;
+  fmd.operation = IIS2DULPX_BYPASS_MODE;
+  ret = iis2dulpx_fifo_mode_set(ctx, fmd);
+  fmd.operation = IIS2DULPX_FIFO_MODE;
+  ret += iis2dulpx_fifo_mode_set(ctx, fmd);
+  (void)iis2dulpx_fifo_win_reset(win);
+
+  while ((ret == 0) && (win->num < target))
   {
-    fifo_reg.fsm_fifo_en = val & 0x01U;
-    ret += iis2dulpx_write_reg(ctx, IIS2DULPX_EMB_FUNC_FIFO_EN, (uint8_t *)&fifo_reg, 1);
-  }
+    ret = iis2dulpx_fifo_data_level_get(ctx, &level);
+    if ((ret != 0) || (level == 0U))
+    {
+      idle++;
+      if (idle > IIS2DULPX_ST_TIMEOUT_MS)
+      {
+        ret = -1;
+      }
+      ctx->mdelay(1);
+      continue;
+    }
+    idle = 0U;
 
-  ret += iis2dulpx_mem_bank_set(ctx, IIS2DULPX_MAIN_MEM_BANK);
+    n = (level > IIS2DULPX_ST_BURST) ? (uint16_t)IIS2DULPX_ST_BURST : level;
+    if ((drop > 0U) && (n > drop))
+    {
+      n = drop;
+    }
+    else if ((drop == 0U) && (n > (target - win->num)))
+    {
+      n = target - (uint16_t)win->num;
+    }
+    else
+    {
+      /* full burst */
+    }
+
+    ret = iis2dulpx_fifo_out_raw_batch_get(ctx, buff, n);
+    if ((ret != 0) || (drop > 0U))
+    {
+      if (drop > 0U)
+      {
+        drop = (uint16_t)(drop - n);
+      }
+      continue;
+    }
+
+    (void)iis2dulpx_fifo_win_update(&fmd, buff, n, win);
+
+    if ((off != NULL) && (win->num >= cfg->min_samples) &&
+        (iis2dulpx_st_judge(cfg, off, win, res, sign, PROPERTY_ENABLE) == 0U))
+    {
+      break;
+    }
+  }
 
   return ret;
 }
 
-int32_t iis2dulpx_fsm_fifo_en_get(const stmdev_ctx_t *ctx, uint8_t *val)
+int32_t iis2dulpx_self_test_run(const stmdev_ctx_t *ctx, const iis2dulpx_st_cfg_t *cfg,
+                                iis2dulpx_st_result_t *res)
 {
-  iis2dulpx_emb_func_fifo_en_t fifo_reg = {0};
+  static const iis2dulpx_xl_self_test_t sign_val[2] =
+  {
+    IIS2DULPX_XL_ST_POSITIVE, IIS2DULPX_XL_ST_NEGATIVE
+  };
+  iis2dulpx_fifo_batch_t batch = {0};
+  iis2dulpx_fifo_mode_t fmd = {0};
+  iis2dulpx_fifo_win_t off;
+  iis2dulpx_fifo_win_t on;
   int32_t ret = 0;
+  uint8_t fail;
+  uint8_t s;
 
-  ret = iis2dulpx_mem_bank_set(ctx, IIS2DULPX_EMBED_FUNC_MEM_BANK);
-  ret += iis2dulpx_read_reg(ctx, IIS2DULPX_EMB_FUNC_FIFO_EN, (uint8_t *)&fifo_reg, 1);
-  if (ret == 0)
+  (void)memset(res, 0x00, sizeof(iis2dulpx_st_result_t));
+
+  if ((ctx->mdelay == NULL) || (cfg->min_samples == 0U) ||
+      (cfg->max_samples < cfg->min_samples))
   {
-    *val = fifo_reg.fsm_fifo_en;
+    return -1;
   }
 
-  ret += iis2dulpx_mem_bank_set(ctx, IIS2DULPX_MAIN_MEM_BANK);
-
-  return ret;
-}
+  batch.dec_ts = IIS2DULPX_DEC_TS_OFF;
+  batch.bdr_xl = IIS2DULPX_BDR_XL_ODR;
+  ret = iis2dulpx_mode_set(ctx, &cfg->md);
+  ret += iis2dulpx_fifo_batch_set(ctx, batch);
 
-int32_t iis2dulpx_long_cnt_int_value_set(const stmdev_ctx_t *ctx,
-                                         uint16_t val)
-{
-  uint8_t buff[2] = {0};
-  int32_t ret = 0;
+  for (s = 0U; (s < 2U) && (ret == 0); s++)
+  {
+    /* stop at the first failing step, on is never judged against an empty off */
+    ret = iis2dulpx_self_test_sign_set(ctx, sign_val[s]);
+    ret += iis2dulpx_self_test_stop(ctx);
+    if (ret == 0)
+    {
+      ret = iis2dulpx_st_collect(ctx, cfg, NULL, &off, res, s);
+    }
+    if (ret == 0)
+    {
+      ret = iis2dulpx_self_test_start(ctx, cfg->mode);
+    }
+    if (ret == 0)
+    {
+      ret = iis2dulpx_st_collect(ctx, cfg, &off, &on, res, s);
+    }
 
-  buff[1] = (uint8_t)(val / 256U);
-  buff[0] = (uint8_t)(val - (buff[1] * 256U));
-  ret = iis2dulpx_ln_pg_write(ctx, IIS2DULPX_FSM_LC_TIMEOUT_L, buff, 2);
+    if (ret == 0)
+    {
+      res->samples[s] = (uint16_t)on.num;
+      fail = iis2dulpx_st_judge(cfg, &off, &on, res, s, PROPERTY_DISABLE);
+      res->fail |= (uint8_t)(fail << (3U * s));
+    }
+  }
+
+  /* self-test off and FIFO in bypass, also after an error */
+  fmd.operation = IIS2DULPX_BYPASS_MODE;
+  ret += iis2dulpx_self_test_stop(ctx);
+  ret += iis2dulpx_fifo_mode_set(ctx, fmd);
 
   return ret;
 }
 
-int32_t iis2dulpx_long_cnt_int_value_get(const stmdev_ctx_t *ctx,
-                                         uint16_t *val)
+#ifdef IIS2DULPX_REC
+static int32_t iis2dulpx_rec_emit(iis2dulpx_rec_t *rec, const uint8_t *data, uint16_t len)
 {
-  uint8_t buff[2] = {0};
-  int32_t ret = 0;
-
-  ret = iis2dulpx_ln_pg_read(ctx, IIS2DULPX_FSM_LC_TIMEOUT_L, buff, 2);
-  if (ret == 0)
+  if (rec->status == 0)
   {
-    *val = (uint16_t)(buff[0] | ((uint16_t)buff[1] << 8));
+    rec->status = rec->sink(rec->arg, data, len);
   }
 
-  return ret;
+  return rec->status;
 }
 
-int32_t iis2dulpx_fsm_programs_num_set(const stmdev_ctx_t *ctx, uint8_t val)
+/* buffered records first, then a non DATA block */
+static int32_t iis2dulpx_rec_block(iis2dulpx_rec_t *rec, uint8_t type, const uint8_t *payload,
+                                   uint16_t len)
 {
-  int32_t ret = 0;
+  uint8_t hdr[IIS2DULPX_REC_BLOCK_LEN];
 
-  ret = iis2dulpx_ln_pg_write(ctx, IIS2DULPX_FSM_PROGRAMS, &val, 1);
+  hdr[0] = type;
+  hdr[1] = (uint8_t)(len & 0xFFU);
+  hdr[2] = (uint8_t)(len >> 8);
 
-  return ret;
+  (void)iis2dulpx_rec_flush(rec);
+  (void)iis2dulpx_rec_emit(rec, hdr, IIS2DULPX_REC_BLOCK_LEN);
+
+  return iis2dulpx_rec_emit(rec, payload, len);
 }
 
-int32_t iis2dulpx_fsm_programs_num_get(const stmdev_ctx_t *ctx, uint8_t *val)
+int32_t iis2dulpx_rec_start(const stmdev_ctx_t *ctx, iis2dulpx_rec_t *rec,
+                            iis2dulpx_rec_sink_ptr sink, void *arg)
 {
+  static const uint8_t header[IIS2DULPX_REC_HEADER_LEN] =
+  {
+    (uint8_t)'I', (uint8_t)'2', (uint8_t)'D', (uint8_t)'U', IIS2DULPX_REC_VERSION
+  };
   int32_t ret = 0;
 
-  ret = iis2dulpx_ln_pg_read(ctx, IIS2DULPX_FSM_PROGRAMS, val, 1);
+  if ((ctx->priv_data == NULL) || (sink == NULL))
+  {
+    return -1;
+  }
+
+  (void)memset(rec, 0x00, sizeof(iis2dulpx_rec_t));
+  rec->sink = sink;
+  rec->arg = arg;
+
+  ret = iis2dulpx_rec_emit(rec, header, IIS2DULPX_REC_HEADER_LEN);
+  if (ret == 0)
+  {
+    ((iis2dulpx_priv_t *)ctx->priv_data)->rec = rec;
+  }
 
   return ret;
 }
 
-
-int32_t iis2dulpx_fsm_start_address_set(const stmdev_ctx_t *ctx,
-                                        uint16_t val)
+int32_t iis2dulpx_rec_context(iis2dulpx_rec_t *rec, const iis2dulpx_md_t *md,
+                              const iis2dulpx_fifo_mode_t *fmd)
 {
-  uint8_t buff[2] = {0};
-  int32_t ret = 0;
+  uint8_t payload[7];
 
-  buff[1] = (uint8_t)(val / 256U);
-  buff[0] = (uint8_t)(val - (buff[1] * 256U));
-  ret = iis2dulpx_ln_pg_write(ctx, IIS2DULPX_FSM_START_ADD_L, buff, 2);
+  payload[0] = (uint8_t)md->odr;
+  payload[1] = (uint8_t)md->fs;
+  payload[2] = (uint8_t)md->bw;
+  payload[3] = (uint8_t)fmd->operation;
+  payload[4] = (uint8_t)fmd->store;
+  payload[5] = fmd->xl_only;
+  payload[6] = fmd->cfg_change_in_fifo;
 
-  return ret;
+  return iis2dulpx_rec_block(rec, IIS2DULPX_REC_CTX, payload, 7);
 }
 
-int32_t iis2dulpx_fsm_start_address_get(const stmdev_ctx_t *ctx,
-                                        uint16_t *val)
+int32_t iis2dulpx_rec_time(iis2dulpx_rec_t *rec, uint64_t host_ns)
 {
-  uint8_t buff[2] = {0};
-  int32_t ret = 0;
+  uint8_t payload[8];
+  uint8_t i;
 
-  ret = iis2dulpx_ln_pg_read(ctx, IIS2DULPX_FSM_START_ADD_L, buff, 2);
-  if (ret == 0)
+  for (i = 0U; i < 8U; i++)
   {
-    *val = (uint16_t)(buff[0] | ((uint16_t)buff[1] << 8));
+    payload[i] = (uint8_t)(host_ns >> (8U * i));
   }
 
-  return ret;
+  return iis2dulpx_rec_block(rec, IIS2DULPX_REC_TIME, payload, 8);
 }
 
-int32_t iis2dulpx_mlc_set(const stmdev_ctx_t *ctx, iis2dulpx_mlc_mode_t val)
+int32_t iis2dulpx_rec_flush(iis2dulpx_rec_t *rec)
 {
-  iis2dulpx_emb_func_en_a_t emb_en_a = {0};
-  iis2dulpx_emb_func_en_b_t emb_en_b = {0};
-  int32_t ret = 0;
-
-  ret = iis2dulpx_mem_bank_set(ctx, IIS2DULPX_EMBED_FUNC_MEM_BANK);
+  uint16_t len = rec->num * IIS2DULPX_FIFO_RECORD_LEN;
 
-  if (ret == 0)
+  if (rec->num == 0U)
   {
-    ret = iis2dulpx_read_reg(ctx, IIS2DULPX_EMB_FUNC_EN_A, (uint8_t *)&emb_en_a, 1);
-    ret += iis2dulpx_read_reg(ctx, IIS2DULPX_EMB_FUNC_EN_B, (uint8_t *)&emb_en_b, 1);
-
-    if (ret == 0)
-    {
-      switch (val)
-      {
-        case IIS2DULPX_MLC_OFF:
-          emb_en_a.mlc_before_fsm_en = 0U;
-          emb_en_b.mlc_en = 0U;
-          break;
-        case IIS2DULPX_MLC_ON:
-          emb_en_a.mlc_before_fsm_en = 0U;
-          emb_en_b.mlc_en = 1U;
-          break;
-        case IIS2DULPX_MLC_ON_BEFORE_FSM:
-          emb_en_a.mlc_before_fsm_en = 1U;
-          emb_en_b.mlc_en = 0U;
-          break;
-        default:
-          /* do nothing */
-          break;
-      }
-
-      ret += iis2dulpx_write_reg(ctx, IIS2DULPX_EMB_FUNC_EN_A, (uint8_t *)&emb_en_a, 1);
-      ret += iis2dulpx_write_reg(ctx, IIS2DULPX_EMB_FUNC_EN_B, (uint8_t *)&emb_en_b, 1);
-    }
+    return rec->status;
   }
 
-  ret += iis2dulpx_mem_bank_set(ctx, IIS2DULPX_MAIN_MEM_BANK);
+  rec->run[0] = IIS2DULPX_REC_DATA;
+  rec->run[1] = (uint8_t)(len & 0xFFU);
+  rec->run[2] = (uint8_t)(len >> 8);
+  rec->num = 0U;
 
-  return ret;
+  return iis2dulpx_rec_emit(rec, rec->run, IIS2DULPX_REC_BLOCK_LEN + len);
 }
 
-int32_t iis2dulpx_mlc_get(const stmdev_ctx_t *ctx, iis2dulpx_mlc_mode_t *val)
+int32_t iis2dulpx_rec_stop(const stmdev_ctx_t *ctx)
 {
-  iis2dulpx_emb_func_en_a_t emb_en_a = {0};
-  iis2dulpx_emb_func_en_b_t emb_en_b = {0};
+  iis2dulpx_priv_t *priv = (iis2dulpx_priv_t *)ctx->priv_data;
   int32_t ret = 0;
 
-  ret = iis2dulpx_mem_bank_set(ctx, IIS2DULPX_EMBED_FUNC_MEM_BANK);
-
-  if (ret == 0)
+  if ((priv == NULL) || (priv->rec == NULL))
   {
-    ret = iis2dulpx_read_reg(ctx, IIS2DULPX_EMB_FUNC_EN_A, (uint8_t *)&emb_en_a, 1);
-    ret += iis2dulpx_read_reg(ctx, IIS2DULPX_EMB_FUNC_EN_B, (uint8_t *)&emb_en_b, 1);
-
-    if (ret == 0)
-    {
-      if (emb_en_a.mlc_before_fsm_en == 0U && emb_en_b.mlc_en == 0U)
-      {
-        *val = IIS2DULPX_MLC_OFF;
-      }
-      else if (emb_en_a.mlc_before_fsm_en == 0U && emb_en_b.mlc_en == 1U)
-      {
-        *val = IIS2DULPX_MLC_ON;
-      }
-      else if (emb_en_a.mlc_before_fsm_en == 1U)
-      {
-        *val = IIS2DULPX_MLC_ON_BEFORE_FSM;
-      }
-      else
-      {
-        /* Do nothing */
-      }
-    }
+    return -1;
   }
 
-  ret += iis2dulpx_mem_bank_set(ctx, IIS2DULPX_MAIN_MEM_BANK);
+  ret = iis2dulpx_rec_flush(priv->rec);
+  priv->rec = NULL;
 
   return ret;
 }
+#endif /* IIS2DULPX_REC */
 
-int32_t iis2dulpx_mlc_status_get(const stmdev_ctx_t *ctx,
-                                 iis2dulpx_mlc_status_mainpage_t *val)
-{
-  return iis2dulpx_read_reg(ctx, IIS2DULPX_MLC_STATUS_MAINPAGE,
-                            (uint8_t *) val, 1);
-}
-
-int32_t iis2dulpx_mlc_out_get(const stmdev_ctx_t *ctx, uint8_t *buff)
+int32_t iis2dulpx_replay_init(iis2dulpx_replay_t *rp, const uint8_t *buff, uint32_t size)
 {
-  int32_t ret = 0;
-
-  ret = iis2dulpx_mem_bank_set(ctx, IIS2DULPX_EMBED_FUNC_MEM_BANK);
+  (void)memset(rp, 0x00, sizeof(iis2dulpx_replay_t));
 
-  if (ret == 0)
+  if ((size < IIS2DULPX_REC_HEADER_LEN) || (memcmp(buff, "I2DU", 4) != 0) ||
+      (buff[4] != IIS2DULPX_REC_VERSION))
   {
-    ret = iis2dulpx_read_reg(ctx, IIS2DULPX_MLC1_SRC, buff, 4);
+    return -1;
   }
 
-  ret += iis2dulpx_mem_bank_set(ctx, IIS2DULPX_MAIN_MEM_BANK);
+  rp->buff = buff;
+  rp->size = size;
+  rp->pos = IIS2DULPX_REC_HEADER_LEN;
+  rp->data_end = IIS2DULPX_REC_HEADER_LEN;
+  rp->reg[IIS2DULPX_WHO_AM_I] = IIS2DULPX_ID;
 
-  return ret;
+  return 0;
 }
 
-int32_t iis2dulpx_mlc_data_rate_set(const stmdev_ctx_t *ctx,
-                                    iis2dulpx_mlc_odr_val_t val)
+/* length of the block at pos, 0xFFFFFFFF if truncated */
+static uint32_t iis2dulpx_replay_block_len(const iis2dulpx_replay_t *rp, uint32_t pos)
 {
-  iis2dulpx_mlc_odr_t reg = {0};
-  int32_t ret = 0;
-
-  ret = iis2dulpx_mem_bank_set(ctx, IIS2DULPX_EMBED_FUNC_MEM_BANK);
-  ret += iis2dulpx_read_reg(ctx, IIS2DULPX_MLC_ODR, (uint8_t *)&reg, 1);
+  uint32_t len;
 
-  if (ret == 0)
+  if ((pos + IIS2DULPX_REC_BLOCK_LEN) > rp->size)
   {
-    reg.mlc_odr = (uint8_t)val & 0x07U;
-    ret += iis2dulpx_write_reg(ctx, IIS2DULPX_MLC_ODR, (uint8_t *)&reg, 1);
+    return 0xFFFFFFFFU;
   }
 
-  if (ret == 0)
+  len = (uint32_t)rp->buff[pos + 1U] | ((uint32_t)rp->buff[pos + 2U] << 8);
+  if ((pos + IIS2DULPX_REC_BLOCK_LEN + len) > rp->size)
   {
-    ret = iis2dulpx_mem_bank_set(ctx, IIS2DULPX_MAIN_MEM_BANK);
+    return 0xFFFFFFFFU;
   }
 
-  return ret;
+  return len;
 }
 
-int32_t iis2dulpx_mlc_data_rate_get(const stmdev_ctx_t *ctx,
-                                    iis2dulpx_mlc_odr_val_t *val)
+/*
+ * Make pos point to a record, applying the CTX and TIME blocks crossed.
+ * Returns 0 at the end of the capture.
+ */
+static uint8_t iis2dulpx_replay_next(iis2dulpx_replay_t *rp)
 {
-  iis2dulpx_mlc_odr_t reg = {0};
-  int32_t ret = 0;
+  const uint8_t *p;
+  uint32_t len;
+  uint8_t i;
 
-  ret = iis2dulpx_mem_bank_set(ctx, IIS2DULPX_EMBED_FUNC_MEM_BANK);
-  ret += iis2dulpx_read_reg(ctx, IIS2DULPX_MLC_ODR, (uint8_t *)&reg, 1);
-
-  if (ret == 0)
+  while (rp->pos >= rp->data_end)
   {
+    /* partial record at the end of the DATA block just served */
+    rp->pos += rp->data_tail;
+    rp->data_tail = 0U;
 
-    switch (reg.mlc_odr)
+    len = iis2dulpx_replay_block_len(rp, rp->pos);
+    if (len == 0xFFFFFFFFU)
     {
-      case 0:
-        *val = IIS2DULPX_ODR_PRGS_12Hz5;
-        break;
-
-      case 1:
-        *val = IIS2DULPX_ODR_PRGS_25Hz;
-        break;
+      rp->pos = rp->size;
+      rp->data_end = rp->size;
+      return 0U;
+    }
 
-      case 2:
-        *val = IIS2DULPX_ODR_PRGS_50Hz;
+    p = &rp->buff[rp->pos + IIS2DULPX_REC_BLOCK_LEN];
+    switch (rp->buff[rp->pos])
+    {
+      case IIS2DULPX_REC_CTX:
+        if (len >= 7U)
+        {
+          rp->md.odr = (iis2dulpx_odr_t)p[0];
+          rp->md.fs = (iis2dulpx_fs_t)p[1];
+          rp->md.bw = (iis2dulpx_bw_t)p[2];
+          rp->fmd.operation = (iis2dulpx_operation_t)p[3];
+          rp->fmd.store = (iis2dulpx_store_t)p[4];
+          rp->fmd.xl_only = p[5] & 0x01U;
+          rp->fmd.cfg_change_in_fifo = p[6] & 0x01U;
+        }
         break;
 
-      case 3:
-        *val = IIS2DULPX_ODR_PRGS_100Hz;
+      case IIS2DULPX_REC_TIME:
+        if (len >= 8U)
+        {
+          rp->host_ns = 0U;
+          for (i = 0U; i < 8U; i++)
+          {
+            rp->host_ns |= (uint64_t)p[i] << (8U * i);
+          }
+        }
         break;
 
-      case 4:
-        *val = IIS2DULPX_ODR_PRGS_200Hz;
+      case IIS2DULPX_REC_DATA:
+        /* whole records only */
+        rp->data_tail = (uint8_t)(len % IIS2DULPX_FIFO_RECORD_LEN);
+        rp->data_end = rp->pos + IIS2DULPX_REC_BLOCK_LEN + len - rp->data_tail;
         break;
 
       default:
-        *val = IIS2DULPX_ODR_PRGS_12Hz5;
+        /* unknown block: skipped */
         break;
     }
-  }
 
-  ret += iis2dulpx_mem_bank_set(ctx, IIS2DULPX_MAIN_MEM_BANK);
+    if (rp->buff[rp->pos] == IIS2DULPX_REC_DATA)
+    {
+      rp->pos += IIS2DULPX_REC_BLOCK_LEN;
+    }
+    else
+    {
+      rp->pos += IIS2DULPX_REC_BLOCK_LEN + len;
+      rp->data_end = rp->pos;
+    }
+  }
 
-  return ret;
+  return 1U;
 }
 
-int32_t iis2dulpx_mlc_fifo_en_set(const stmdev_ctx_t *ctx, uint8_t val)
+/*
+ * Records left before the next CTX or TIME block, up to the FIFO size,
+ * so that a batch never spans a context or timestamp change.
+ */
+static uint16_t iis2dulpx_replay_level(iis2dulpx_replay_t *rp)
 {
-  iis2dulpx_emb_func_fifo_en_t fifo_reg = {0};
-  int32_t ret = 0;
+  uint32_t pos;
+  uint32_t num = 0;
+  uint32_t len;
 
-  ret = iis2dulpx_mem_bank_set(ctx, IIS2DULPX_EMBED_FUNC_MEM_BANK);
-  ret += iis2dulpx_read_reg(ctx, IIS2DULPX_EMB_FUNC_FIFO_EN, (uint8_t *)&fifo_reg, 1);
-  if (ret == 0)
+  if (rp->rec_off == 0U)
   {
-    fifo_reg.mlc_fifo_en = val & 0x01U;
-    ret += iis2dulpx_write_reg(ctx, IIS2DULPX_EMB_FUNC_FIFO_EN, (uint8_t *)&fifo_reg, 1);
+    (void)iis2dulpx_replay_next(rp);
   }
 
-  ret += iis2dulpx_mem_bank_set(ctx, IIS2DULPX_MAIN_MEM_BANK);
+  pos = rp->data_end + rp->data_tail;
+  if (rp->pos < rp->data_end)
+  {
+    num = (rp->data_end - rp->pos) / IIS2DULPX_FIFO_RECORD_LEN;
+  }
+  else
+  {
+    pos = rp->pos;
+  }
 
-  return ret;
+  while (num < IIS2DULPX_FIFO_SIZE)
+  {
+    len = iis2dulpx_replay_block_len(rp, pos);
+    if ((len == 0xFFFFFFFFU) || (rp->buff[pos] != IIS2DULPX_REC_DATA))
+    {
+      break;
+    }
+
+    num += len / IIS2DULPX_FIFO_RECORD_LEN;
+    pos += IIS2DULPX_REC_BLOCK_LEN + len;
+  }
+
+  return (num > IIS2DULPX_FIFO_SIZE) ? (uint16_t)IIS2DULPX_FIFO_SIZE : (uint16_t)num;
 }
 
-int32_t iis2dulpx_mlc_fifo_en_get(const stmdev_ctx_t *ctx, uint8_t *val)
+/* FIFO output: captured bytes in order, zeros past the end */
+static void iis2dulpx_replay_stream(iis2dulpx_replay_t *rp, uint8_t *data, uint16_t len)
 {
-  iis2dulpx_emb_func_fifo_en_t fifo_reg = {0};
-  int32_t ret = 0;
+  uint16_t i = 0;
+  uint16_t n;
 
-  ret = iis2dulpx_mem_bank_set(ctx, IIS2DULPX_EMBED_FUNC_MEM_BANK);
-  ret += iis2dulpx_read_reg(ctx, IIS2DULPX_EMB_FUNC_FIFO_EN, (uint8_t *)&fifo_reg, 1);
+  while (i < len)
+  {
+    if ((rp->rec_off == 0U) && (iis2dulpx_replay_next(rp) == 0U))
+    {
+      (void)memset(&data[i], 0x00, (uint32_t)len - i);
+      break;
+    }
 
-  if (ret == 0)
+    n = IIS2DULPX_FIFO_RECORD_LEN - rp->rec_off;
+    if (n > (len - i))
+    {
+      n = len - i;
+    }
+
+    (void)memcpy(&data[i], &rp->buff[rp->pos + rp->rec_off], n);
+    i += n;
+    rp->rec_off += (uint8_t)n;
+
+    if (rp->rec_off == IIS2DULPX_FIFO_RECORD_LEN)
+    {
+      rp->pos += IIS2DULPX_FIFO_RECORD_LEN;
+      rp->rec_off = 0U;
+      rp->records++;
+    }
+  }
+}
+
+int32_t iis2dulpx_replay_read(void *handle, uint8_t reg, uint8_t *data, uint16_t len)
+{
+  iis2dulpx_replay_t *rp = (iis2dulpx_replay_t *)handle;
+  iis2dulpx_fifo_status1_t fifo_status1;
+  iis2dulpx_fifo_wtm_t fifo_wtm;
+  uint16_t level;
+  uint16_t i;
+  uint8_t addr;
+
+  if (reg == IIS2DULPX_FIFO_DATA_OUT_TAG)
   {
-    *val = fifo_reg.mlc_fifo_en;
+    /* a TAG read starts a new record */
+    if (rp->rec_off != 0U)
+    {
+      rp->pos += IIS2DULPX_FIFO_RECORD_LEN;
+      rp->rec_off = 0U;
+      rp->records++;
+    }
+    iis2dulpx_replay_stream(rp, data, len);
+    return 0;
   }
 
-  ret += iis2dulpx_mem_bank_set(ctx, IIS2DULPX_MAIN_MEM_BANK);
+  if (reg == IIS2DULPX_FIFO_DATA_OUT_X_L)
+  {
+    /* data read without its TAG */
+    if ((rp->rec_off == 0U) && (iis2dulpx_replay_next(rp) == 1U))
+    {
+      rp->rec_off = 1U;
+    }
+    iis2dulpx_replay_stream(rp, data, len);
+    return 0;
+  }
 
-  return ret;
+  level = iis2dulpx_replay_level(rp);
+  for (i = 0U; i < len; i++)
+  {
+    addr = (uint8_t)((reg + i) & 0x7FU);
+    if (addr == IIS2DULPX_FIFO_STATUS2)
+    {
+      data[i] = (uint8_t)level;
+    }
+    else if (addr == IIS2DULPX_FIFO_STATUS1)
+    {
+      (void)memcpy(&fifo_wtm, &rp->reg[IIS2DULPX_FIFO_WTM], 1);
+      (void)memset(&fifo_status1, 0x00, 1);
+      fifo_status1.fifo_wtm_ia = ((level > 0U) && (level >= fifo_wtm.fth)) ? 1U : 0U;
+      (void)memcpy(&data[i], &fifo_status1, 1);
+    }
+    else
+    {
+      data[i] = rp->reg[addr];
+    }
+  }
+
+  return 0;
+}
+
+int32_t iis2dulpx_replay_write(void *handle, uint8_t reg, const uint8_t *data, uint16_t len)
+{
+  iis2dulpx_replay_t *rp = (iis2dulpx_replay_t *)handle;
+  uint16_t i;
+
+  for (i = 0U; i < len; i++)
+  {
+    rp->reg[(reg + i) & 0x7FU] = data[i];
+  }
+
+  return 0;
 }
@@ -2143,6 +2143,14 @@ float_t iis2dulpx_from_fs16g_to_mg(int16_t lsb);
 float_t iis2dulpx_from_lsb_to_celsius(int16_t lsb);
 float_t iis2dulpx_from_lsb_to_mv(int16_t lsb);
 
+/* integer conversions: micro-g, hundredths of degC, micro-V */
+int32_t iis2dulpx_from_fs2g_to_ug(int16_t lsb);
+int32_t iis2dulpx_from_fs4g_to_ug(int16_t lsb);
+int32_t iis2dulpx_from_fs8g_to_ug(int16_t lsb);
+int32_t iis2dulpx_from_fs16g_to_ug(int16_t lsb);
+int16_t iis2dulpx_from_lsb_to_centi_celsius(int16_t lsb);
+int32_t iis2dulpx_from_lsb_to_uv(int16_t lsb);
+
 /**
   * @}
   *
@@ -2212,6 +2220,44 @@ int32_t iis2dulpx_sw_por(const stmdev_ctx_t *ctx);
   */
 int32_t iis2dulpx_sw_reset(const stmdev_ctx_t *ctx);
 
+/**
+  * @brief  Enable the shadow copy of the main page configuration registers
+  *         kept in ctx->priv_data. When enabled, the read-modify-write
+  *         setters take the register value from the shadow instead of
+  *         reading it from the bus. Cached content is dropped on
+  *         reboot, sw_reset, sw_por and deep power down exit.
+  *         Do not enable when an FSM program with write control
+  *         (fsm_wr_ctrl_en) can modify the configuration registers.[set]
+  *
+  * @param  ctx      read / write interface definitions
+  * @param  val      1: shadow enabled, 0: shadow disabled
+  * @retval          interface status (MANDATORY: return 0 -> no Error)
+  *
+  */
+int32_t iis2dulpx_shadow_set(const stmdev_ctx_t *ctx, uint8_t val);
+
+/**
+  * @brief  Enable the shadow copy of the main page configuration
+  *         registers.[get]
+  *
+  * @param  ctx      read / write interface definitions
+  * @param  val      1: shadow enabled, 0: shadow disabled
+  * @retval          interface status (MANDATORY: return 0 -> no Error)
+  *
+  */
+int32_t iis2dulpx_shadow_get(const stmdev_ctx_t *ctx, uint8_t *val);
+
+/**
+  * @brief  Reload the shadow copy from the device, reading only
+  *         configuration registers (data and source registers are
+  *         not touched). Device must be on main memory bank.
+  *
+  * @param  ctx      read / write interface definitions
+  * @retval          interface status (MANDATORY: return 0 -> no Error)
+  *
+  */
+int32_t iis2dulpx_shadow_refresh(const stmdev_ctx_t *ctx);
+
 typedef struct
 {
   uint8_t sw_reset                     : 1; /* Restoring configuration registers */
@@ -2410,6 +2456,38 @@ typedef struct
 } iis2dulpx_all_sources_t;
 int32_t iis2dulpx_all_sources_get(const stmdev_ctx_t *ctx, iis2dulpx_all_sources_t *val);
 
+typedef enum
+{
+  IIS2DULPX_SRC_ONLY              = 0x0, /* WAKE_UP_SRC .. STATUS */
+  IIS2DULPX_SRC_FIFO              = 0x1, /* WAKE_UP_SRC .. FIFO_STATUS2 */
+  IIS2DULPX_SRC_FIFO_DATA         = 0x2, /* WAKE_UP_SRC .. OUT_T_AH_QVAR_H */
+} iis2dulpx_src_burst_t;
+
+typedef struct
+{
+  iis2dulpx_all_sources_t src;
+  uint8_t fifo_wtm                     : 1;
+  uint8_t fifo_ovr                     : 1;
+  uint16_t fifo_level;
+  int16_t xl_raw[3];
+  int16_t t_ah_qvar_raw;
+} iis2dulpx_all_sources_data_t;
+/**
+  * @brief  Interrupt sources, FIFO status and latest sample read in a
+  *         single burst starting from WAKE_UP_SRC (0x21).[get]
+  *         Source registers are read (and latched events cleared) even
+  *         when STATUS.int_global is not set. Fields not covered by the
+  *         selected burst are left untouched.
+  *
+  * @param  ctx   communication interface handler.(ptr)
+  * @param  burst IIS2DULPX_SRC_ONLY, IIS2DULPX_SRC_FIFO, IIS2DULPX_SRC_FIFO_DATA
+  * @param  val   sources, FIFO flags/level, raw XL and T/AH_QVAR output.(ptr)
+  * @retval       interface status (MANDATORY: return 0 -> no Error)
+  *
+  */
+int32_t iis2dulpx_all_sources_data_get(const stmdev_ctx_t *ctx, iis2dulpx_src_burst_t burst,
+                                       iis2dulpx_all_sources_data_t *val);
+
 typedef struct
 {
   float_t mg[3];
@@ -2420,6 +2498,7 @@ typedef struct
   *
   * @param  ctx   communication interface handler.(ptr)
   * @param  md    the sensor conversion parameters.(ptr)
+  *               NULL: raw data only, mg[] is not updated
   * @param  data  data retrived from the sensor.(ptr)
   * @retval       interface status (MANDATORY: return 0 -> no Error)
   *
@@ -2427,6 +2506,36 @@ typedef struct
 int32_t iis2dulpx_xl_data_get(const stmdev_ctx_t *ctx, const iis2dulpx_md_t *md,
                               iis2dulpx_xl_data_t *data);
 
+/**
+  * @brief  Integer conversion of acceleration raw data to micro-g
+  *         for the given full scale (no floating point).
+  *
+  * @param  fs    full scale used to acquire the data.
+  * @param  lsb   raw acceleration data.
+  * @retval       acceleration in micro-g (0 on invalid full scale)
+  *
+  */
+int32_t iis2dulpx_from_fs_to_ug(iis2dulpx_fs_t fs, int16_t lsb);
+
+/**
+  * @brief  Linear acceleration output register, fixed full scale
+  *         variants (no per axis switch): iis2dulpx_xl_data_get_fs2g,
+  *         _fs4g, _fs8g, _fs16g. The full scale set in the device must
+  *         match.[get]
+  *
+  * @param  ctx      read / write interface definitions
+  * @param  data     linear acceleration data.(ptr)
+  * @retval          interface status (MANDATORY: return 0 -> no Error)
+  *
+  */
+#define IIS2DULPX_XL_DATA_GET_DECLARE(fs) \
+  int32_t iis2dulpx_xl_data_get_##fs(const stmdev_ctx_t *ctx, iis2dulpx_xl_data_t *data)
+
+IIS2DULPX_XL_DATA_GET_DECLARE(fs2g);
+IIS2DULPX_XL_DATA_GET_DECLARE(fs4g);
+IIS2DULPX_XL_DATA_GET_DECLARE(fs8g);
+IIS2DULPX_XL_DATA_GET_DECLARE(fs16g);
+
 typedef struct
 {
   struct
@@ -2473,6 +2582,38 @@ typedef struct
   */
 int32_t iis2dulpx_ah_qvar_data_get(const stmdev_ctx_t *ctx,
                                    iis2dulpx_ah_qvar_data_t *data);
+
+typedef enum
+{
+  IIS2DULPX_OUT_T_NONE             = 0x0, /* t_ah_qvar_dis = 1 */
+  IIS2DULPX_OUT_T_TEMP             = 0x1, /* temperature */
+  IIS2DULPX_OUT_T_AH_QVAR          = 0x2, /* ah_qvar_en = 1 */
+} iis2dulpx_out_t_src_t;
+
+typedef struct
+{
+  uint8_t drdy;                        /* 0: no new sample, data not updated */
+  iis2dulpx_out_t_src_t out_t;         /* content of OUT_T_AH_QVAR */
+  iis2dulpx_xl_data_t xl;
+  iis2dulpx_outt_data_t temp;          /* valid if out_t == OUT_T_TEMP */
+  iis2dulpx_ah_qvar_data_t ah_qvar;    /* valid if out_t == OUT_T_AH_QVAR */
+} iis2dulpx_sample_t;
+
+/**
+  * @brief  XL and temperature or AH_QVAR sample in one transaction:
+  *         STATUS .. OUT_T_AH_QVAR_H are read in a single burst, which
+  *         also clears drdy. OUT_T_AH_QVAR content follows
+  *         SELF_TEST.t_ah_qvar_dis and AH_QVAR_CFG.ah_qvar_en, taken
+  *         from the shadow copy (one more read when not cached).[get]
+  *
+  * @param  ctx   communication interface handler.(ptr)
+  * @param  md    the sensor conversion parameters, NULL for raw XL only.(ptr)
+  * @param  data  data retrived from the sensor.(ptr)
+  * @retval       interface status (MANDATORY: return 0 -> no Error)
+  *
+  */
+int32_t iis2dulpx_sample_get(const stmdev_ctx_t *ctx, const iis2dulpx_md_t *md,
+                             iis2dulpx_sample_t *data);
 /**
   * @}
   *
@@ -2591,11 +2732,182 @@ int32_t iis2dulpx_i3c_configure_set(const stmdev_ctx_t *ctx, const iis2dulpx_i3c
   */
 int32_t iis2dulpx_i3c_configure_get(const stmdev_ctx_t *ctx, iis2dulpx_i3c_cfg_t *val);
 
+/** Main page range covered by the configuration shadow **/
+#define IIS2DULPX_SHADOW_FIRST   IIS2DULPX_EXT_CLK_CFG
+#define IIS2DULPX_SHADOW_LAST    IIS2DULPX_FIFO_BATCH_DEC
+#define IIS2DULPX_SHADOW_SIZE    (IIS2DULPX_SHADOW_LAST - IIS2DULPX_SHADOW_FIRST + 1U)
+
+typedef struct
+{
+  uint8_t enable;
+  uint8_t valid[(IIS2DULPX_SHADOW_SIZE + 7U) / 8U];
+  uint8_t reg[IIS2DULPX_SHADOW_SIZE];
+  uint8_t page_rw;
+  uint8_t page_rw_valid;
+} iis2dulpx_shadow_t;
+
+/** Maximum number of transfers recorded in one iis2dulpx_txn_t **/
+#ifndef IIS2DULPX_TXN_MAX
+#define IIS2DULPX_TXN_MAX        10U
+#endif /* IIS2DULPX_TXN_MAX */
+
+typedef struct
+{
+  uint8_t read;                        /* 1: read, 0: write */
+  uint8_t reg;
+  uint16_t len;
+  uint8_t *data;
+} iis2dulpx_txn_op_t;
+
+/** Optional scatter-gather transport: runs the num transfers in order,
+  * in a single bus session (e.g. one SPI frame list, repeated I2C
+  * starts). MANDATORY: return 0 -> no Error. **/
+typedef int32_t (*iis2dulpx_txn_ptr)(void *handle, const iis2dulpx_txn_op_t *op, uint8_t num);
+
+/** Optional microsecond delay, see iis2dulpx_udelay_set **/
+typedef void (*iis2dulpx_udelay_ptr)(uint32_t usec);
+
+/** Optional lock hooks, see iis2dulpx_lock_set. MUST be recursive. **/
+typedef void (*iis2dulpx_lock_ptr)(void *arg);
+
+#ifdef IIS2DULPX_REC
+typedef struct iis2dulpx_rec_s iis2dulpx_rec_t;
+#endif /* IIS2DULPX_REC */
+
+#ifdef IIS2DULPX_STATS
+/** Cycle counter read around each transfer, e.g. DWT->CYCCNT **/
+#ifndef IIS2DULPX_STATS_CYCLES
+#define IIS2DULPX_STATS_CYCLES()  0U
+#endif /* IIS2DULPX_STATS_CYCLES */
+
+typedef struct
+{
+  uint32_t xfer;
+  uint32_t bytes;
+  uint32_t errors;
+} iis2dulpx_stats_reg_t;
+
+typedef struct
+{
+  uint32_t rd_xfer;
+  uint32_t wr_xfer;
+  uint32_t rd_bytes;
+  uint32_t wr_bytes;
+  uint32_t errors;
+  uint32_t bank_switches;
+  uint64_t cycles;                     /* spent in the transport */
+  uint8_t bank;                        /* bank of the next transfer */
+  iis2dulpx_stats_reg_t reg[2][128];   /* [main, embedded][address] */
+} iis2dulpx_stats_t;
+#endif /* IIS2DULPX_STATS */
+
 typedef struct
 {
   iis2dulpx_func_cfg_access_t func_cfg_access_main;
+  iis2dulpx_shadow_t shadow;
+  uint8_t emb_session;
+  iis2dulpx_txn_ptr txn_hook;
+  iis2dulpx_udelay_ptr udelay;
+  iis2dulpx_lock_ptr lock;
+  iis2dulpx_lock_ptr unlock;
+  void *lock_arg;
+  volatile uint32_t bank_seq;          /* odd while the embedded bank is selected */
+#ifdef IIS2DULPX_REC
+  iis2dulpx_rec_t *rec;                /* FIFO recorder, see iis2dulpx_rec_start */
+#endif /* IIS2DULPX_REC */
+#ifdef IIS2DULPX_STATS
+  iis2dulpx_stats_t stats;             /* keep last: not cleared by init */
+#endif /* IIS2DULPX_STATS */
 } iis2dulpx_priv_t;
 
+typedef struct
+{
+  const stmdev_ctx_t *ctx;
+  uint8_t num;
+  uint8_t overflow;
+  iis2dulpx_txn_op_t op[IIS2DULPX_TXN_MAX];
+} iis2dulpx_txn_t;
+
+/**
+  * @brief  Scatter-gather transport hook, kept in ctx->priv_data and
+  *         called with ctx->handle. NULL: transfers of a transaction
+  *         are run one by one through ctx->read_reg / ctx->write_reg.[set]
+  *
+  * @param  ctx      read / write interface definitions
+  * @param  hook     transport hook, NULL to disable
+  * @retval          interface status (MANDATORY: return 0 -> no Error)
+  *
+  */
+int32_t iis2dulpx_txn_hook_set(const stmdev_ctx_t *ctx, iis2dulpx_txn_ptr hook);
+
+/**
+  * @brief  Start recording a new transaction.
+  *
+  * @param  txn      transaction.(ptr)
+  * @param  ctx      read / write interface definitions
+  *
+  */
+void iis2dulpx_txn_init(iis2dulpx_txn_t *txn, const stmdev_ctx_t *ctx);
+
+/**
+  * @brief  Append a register read. data is filled by iis2dulpx_txn_run.
+  *
+  * @param  txn      transaction.(ptr)
+  * @param  reg      first register address
+  * @param  data     destination, valid until iis2dulpx_txn_run returns.(ptr)
+  * @param  len      number of bytes
+  * @retval          -1 if the transaction is full, 0 otherwise
+  *
+  */
+int32_t iis2dulpx_txn_read(iis2dulpx_txn_t *txn, uint8_t reg, uint8_t *data, uint16_t len);
+
+/**
+  * @brief  Append a register write. data is sent by iis2dulpx_txn_run.
+  *
+  * @param  txn      transaction.(ptr)
+  * @param  reg      first register address
+  * @param  data     source, valid until iis2dulpx_txn_run returns.(ptr)
+  * @param  len      number of bytes
+  * @retval          -1 if the transaction is full, 0 otherwise
+  *
+  */
+int32_t iis2dulpx_txn_write(iis2dulpx_txn_t *txn, uint8_t reg, uint8_t *data, uint16_t len);
+
+/**
+  * @brief  Run the recorded transfers in order, through the transport
+  *         hook when set. The shadow copy is updated with the registers
+  *         read and written. The transaction is empty on return.
+  *
+  * @param  txn      transaction.(ptr)
+  * @retval          interface status (MANDATORY: return 0 -> no Error),
+  *                  -1 if transfers were dropped while recording
+  *
+  */
+int32_t iis2dulpx_txn_run(iis2dulpx_txn_t *txn);
+
+#ifdef IIS2DULPX_STATS
+/**
+  * @brief  Bus traffic counters of iis2dulpx_read_reg/iis2dulpx_write_reg
+  *         and iis2dulpx_txn_run, compiled in with IIS2DULPX_STATS.
+  *         Counters survive iis2dulpx_init_set.[get]
+  *
+  * @param  ctx      read / write interface definitions
+  * @param  val      copy of the counters.(ptr)
+  * @retval          interface status (MANDATORY: return 0 -> no Error)
+  *
+  */
+int32_t iis2dulpx_stats_get(const stmdev_ctx_t *ctx, iis2dulpx_stats_t *val);
+
+/**
+  * @brief  Clear the bus traffic counters.[set]
+  *
+  * @param  ctx      read / write interface definitions
+  * @retval          interface status (MANDATORY: return 0 -> no Error)
+  *
+  */
+int32_t iis2dulpx_stats_reset(const stmdev_ctx_t *ctx);
+#endif /* IIS2DULPX_STATS */
+
 typedef enum
 {
   IIS2DULPX_MAIN_MEM_BANK       = 0x0,
@@ -2604,6 +2916,8 @@ typedef enum
 
 /**
   * @brief  Change memory bank.[set]
+  *         Nothing is written when the bank saved in ctx->priv_data is
+  *         already the requested one, or when an embedded session is open.
   *
   * @param  ctx      read / write interface definitions
   * @param  val      MAIN_MEM_BANK, EMBED_FUNC_MEM_BANK
@@ -2622,6 +2936,79 @@ int32_t iis2dulpx_mem_bank_set(const stmdev_ctx_t *ctx, iis2dulpx_mem_bank_t val
   */
 int32_t iis2dulpx_mem_bank_get(const stmdev_ctx_t *ctx, iis2dulpx_mem_bank_t *val);
 
+/**
+  * @brief  Select the embedded functions bank and hold it until the
+  *         matching iis2dulpx_emb_session_end(). Sessions can be nested.
+  *         While a session is open iis2dulpx_mem_bank_set() does nothing,
+  *         so a group of embedded accessors (e.g. iis2dulpx_fsm_out_get,
+  *         iis2dulpx_mlc_out_get, iis2dulpx_stpcnt_steps_get) shares a
+  *         single bank transition.
+  *         Only functions that access embedded registers exclusively may
+  *         be called inside a session; main page accesses and
+  *         iis2dulpx_ucf_load() are not allowed.
+  *
+  * @param  ctx      read / write interface definitions
+  * @retval          interface status (MANDATORY: return 0 -> no Error)
+  *
+  */
+int32_t iis2dulpx_emb_session_begin(const stmdev_ctx_t *ctx);
+
+/**
+  * @brief  Close an embedded functions session and, on the outermost
+  *         one, go back to main memory bank.
+  *
+  * @param  ctx      read / write interface definitions
+  * @retval          interface status (MANDATORY: return 0 -> no Error)
+  *
+  */
+int32_t iis2dulpx_emb_session_end(const stmdev_ctx_t *ctx);
+
+/**
+  * @brief  Lock hooks, kept in ctx->priv_data, for a ctx shared by
+  *         several threads (e.g. an ISR thread draining the FIFO and a
+  *         worker changing the configuration). The lock is held:
+  *           - from the selection of the embedded bank to the return to
+  *             main bank (so an embedded session holds it until
+  *             iis2dulpx_emb_session_end()),
+  *           - around each iis2dulpx_txn_run(),
+  *           - around each transfer otherwise.
+  *         Single register main page reads without read side effects
+  *         skip it: they are retried under the lock if the bank changed
+  *         meanwhile. The hooks MUST be recursive and ctx->read_reg /
+  *         ctx->write_reg safe to call concurrently. Group a
+  *         read-modify-write sequence of the caller with
+  *         iis2dulpx_lock_take() / iis2dulpx_lock_release(). The
+  *         iis2dulpx_*_async operations are not covered, and
+  *         iis2dulpx_ln_pg_write_async() is rejected while hooks are set.[set]
+  *
+  * @param  ctx      read / write interface definitions
+  * @param  lock     lock function, NULL to disable
+  * @param  unlock   unlock function, NULL to disable
+  * @param  arg      argument of lock and unlock (e.g. the mutex)
+  * @retval          interface status (MANDATORY: return 0 -> no Error)
+  *
+  */
+int32_t iis2dulpx_lock_set(const stmdev_ctx_t *ctx, iis2dulpx_lock_ptr lock,
+                           iis2dulpx_lock_ptr unlock, void *arg);
+
+/**
+  * @brief  Take the lock set by iis2dulpx_lock_set(), if any.
+  *
+  * @param  ctx      read / write interface definitions
+  * @retval          interface status (MANDATORY: return 0 -> no Error)
+  *
+  */
+int32_t iis2dulpx_lock_take(const stmdev_ctx_t *ctx);
+
+/**
+  * @brief  Release the lock taken by iis2dulpx_lock_take().
+  *
+  * @param  ctx      read / write interface definitions
+  * @retval          interface status (MANDATORY: return 0 -> no Error)
+  *
+  */
+int32_t iis2dulpx_lock_release(const stmdev_ctx_t *ctx);
+
 /**
   * @brief  FSM capability to write CTRl regs.[set]
   *
@@ -2655,6 +3042,23 @@ int32_t iis2dulpx_fsm_wr_ctrl_en_get(const stmdev_ctx_t *ctx, uint8_t *val);
   */
 int32_t iis2dulpx_ln_pg_write(const stmdev_ctx_t *ctx, uint16_t address, uint8_t *buf, uint8_t len);
 
+/**
+  * @brief  Write buffer in a page, streaming each run up to the page
+  *         boundary in a single PAGE_VALUE transfer (the page address
+  *         auto-increments on write). CTRL1.if_add_inc is cleared for
+  *         the duration of the transfer and then restored.
+  *
+  * @param  ctx      read / write interface definitions
+  * @param  address  Address of page register to be written (page number in 8-bit
+  *                  msb, register address in 8-bit lsb).
+  * @param  buf      Pointer to data buffer.
+  * @param  len      Buffer len.
+  * @retval          interface status (MANDATORY: return 0 -> no Error)
+  *
+  */
+int32_t iis2dulpx_ln_pg_write_burst(const stmdev_ctx_t *ctx, uint16_t address, uint8_t *buf,
+                                    uint16_t len);
+
 /**
   * @brief  Read buffer in a page.
   *
@@ -2668,6 +3072,30 @@ int32_t iis2dulpx_ln_pg_write(const stmdev_ctx_t *ctx, uint16_t address, uint8_t
   */
 int32_t iis2dulpx_ln_pg_read(const stmdev_ctx_t *ctx, uint16_t address, uint8_t *buf, uint8_t len);
 
+/** Max number of UCF lines sent in a single bus transfer **/
+#ifndef IIS2DULPX_UCF_BURST_LEN
+#define IIS2DULPX_UCF_BURST_LEN  32U
+#endif /* IIS2DULPX_UCF_BURST_LEN */
+
+/**
+  * @brief  Load a Unico / Unicleo configuration (ucf_line_t array).
+  *         Consecutive lines are coalesced in burst writes: ascending
+  *         addresses, or repeated address (e.g. PAGE_VALUE) for programs
+  *         where that saves more transfers, in which case
+  *         CTRL1.if_add_inc is cleared during the load and restored
+  *         afterwards. FUNC_CFG_ACCESS lines that do not change its
+  *         value are dropped; bank state is tracked in ctx->priv_data.
+  *
+  * @param  ctx      read / write interface definitions
+  * @param  ucf      configuration lines
+  * @param  len      number of lines
+  * @param  txn      number of bus transactions issued (may be NULL)
+  * @retval          interface status (MANDATORY: return 0 -> no Error)
+  *
+  */
+int32_t iis2dulpx_ucf_load(const stmdev_ctx_t *ctx, const ucf_line_t *ucf, uint16_t len,
+                           uint32_t *txn);
+
 /**
   * @}
   *
@@ -3134,6 +3562,25 @@ int32_t iis2dulpx_fifo_sensor_tag_get(const stmdev_ctx_t *ctx,
 
 int32_t iis2dulpx_fifo_out_raw_get(const stmdev_ctx_t *ctx, uint8_t *buff);
 
+typedef enum
+{
+  IIS2DULPX_EMB_EV_NONE                = 0x0,
+  IIS2DULPX_EMB_EV_STEP                = 0x1,
+  IIS2DULPX_EMB_EV_FSM                 = 0x2,
+  IIS2DULPX_EMB_EV_MLC                 = 0x3,
+  IIS2DULPX_EMB_EV_MLC_FILTER          = 0x4,
+  IIS2DULPX_EMB_EV_MLC_FEATURE         = 0x5,
+} iis2dulpx_emb_ev_type_t;
+
+typedef struct
+{
+  iis2dulpx_emb_ev_type_t type;
+  uint8_t index;                       /* FSM / MLC number, filter / feature id */
+  uint16_t value;                      /* steps, FSM / MLC output, raw half-float otherwise */
+  uint32_t timestamp;                  /* 0 for filter / feature records */
+  uint16_t smp_index;                  /* iis2dulpx_fifo_compact_decode: next sample in smp[] */
+} iis2dulpx_emb_ev_t;
+
 typedef struct
 {
   uint8_t tag;
@@ -3169,79 +3616,472 @@ typedef struct
     uint8_t odr_xl_batch               : 1; /* Accelerometer ODR is batched */
     uint32_t timestamp;
   } cfg_chg;
+  iis2dulpx_emb_ev_t emb;              /* step counter, FSM and MLC records */
 } iis2dulpx_fifo_data_t;
 int32_t iis2dulpx_fifo_data_get(const stmdev_ctx_t *ctx, const iis2dulpx_md_t *md,
                                 const iis2dulpx_fifo_mode_t *fmd,
                                 iis2dulpx_fifo_data_t *data);
+
+/** Size of one FIFO record: TAG byte + 6 data bytes **/
+#define IIS2DULPX_FIFO_RECORD_LEN                      7U
+
+/** FIFO capacity (records) **/
+#ifndef IIS2DULPX_FIFO_SIZE
+#define IIS2DULPX_FIFO_SIZE                            128U
+#endif /* IIS2DULPX_FIFO_SIZE */
+
 /**
-  * @}
+  * @brief  Read num FIFO records (TAG + 6 bytes each) in a single
+  *         burst starting from FIFO_DATA_OUT_TAG.[get]
+  *
+  * @param  ctx      read / write interface definitions
+  * @param  buff     buffer of at least num * IIS2DULPX_FIFO_RECORD_LEN bytes
+  * @param  num      number of records to read
+  * @retval          interface status (MANDATORY: return 0 -> no Error)
   *
   */
-
-/** @defgroup Ah_qvar Ah/QVAR
-  * @{
+int32_t iis2dulpx_fifo_out_raw_batch_get(const stmdev_ctx_t *ctx, uint8_t *buff, uint16_t num);
+
+/**
+  * @brief  Decode one raw FIFO record (TAG + 6 bytes).
+  *
+  * @param  md       the sensor conversion parameters.(ptr)
+  *                  NULL: raw data only, no floating point conversion
+  * @param  fmd      the FIFO configuration.(ptr)
+  * @param  buff     raw record, IIS2DULPX_FIFO_RECORD_LEN bytes
+  * @param  data     decoded sample.(ptr)
+  * @retval          0: no error
+  *
+  */
+int32_t iis2dulpx_fifo_data_decode(const iis2dulpx_md_t *md, const iis2dulpx_fifo_mode_t *fmd,
+                                   const uint8_t *buff, iis2dulpx_fifo_data_t *data);
+
+/**
+  * @brief  Decode raw FIFO records with full scale and record layout
+  *         fixed at build time: iis2dulpx_fifo_decode_<fs>_<layout>
+  *         with fs in fs2g, fs4g, fs8g, fs16g and layout in
+  *           xlonly: 16-bit XL records (xl_only = 1)
+  *           xlaux:  12-bit XL + T/AH_QVAR records
+  *           2x:     8-bit XL_ONLY_2X records, two samples each
+  *         Records of other tags (e.g. timestamp) are skipped. Decoding
+  *         stops when out is full.
+  *         Alias macros IIS2DULPX_DECODE_FS<fs>_<LAYOUT> are provided.
+  *
+  * @param  buff     raw records, num * IIS2DULPX_FIFO_RECORD_LEN bytes
+  * @param  num      number of records in buff
+  * @param  out      samples, at least out_max elements.(ptr)
+  * @param  aux      raw T or AH_QVAR of each xlaux sample, 0 for the
+  *                  other layouts, at least out_max elements (may be NULL)
+  * @param  out_max  capacity (in samples) of out and aux
+  * @param  samples  number of samples written.(ptr)
+  * @retval          0: no error
+  *
+  */
+#define IIS2DULPX_FIFO_DECODER_DECLARE(fs, layout) \
+  int32_t iis2dulpx_fifo_decode_##fs##_##layout(const uint8_t *buff, uint16_t num, \
+                                               iis2dulpx_xl_data_t *out, int16_t *aux, \
+                                               uint16_t out_max, uint16_t *samples)
+
+IIS2DULPX_FIFO_DECODER_DECLARE(fs2g, xlonly);
+IIS2DULPX_FIFO_DECODER_DECLARE(fs4g, xlonly);
+IIS2DULPX_FIFO_DECODER_DECLARE(fs8g, xlonly);
+IIS2DULPX_FIFO_DECODER_DECLARE(fs16g, xlonly);
+IIS2DULPX_FIFO_DECODER_DECLARE(fs2g, xlaux);
+IIS2DULPX_FIFO_DECODER_DECLARE(fs4g, xlaux);
+IIS2DULPX_FIFO_DECODER_DECLARE(fs8g, xlaux);
+IIS2DULPX_FIFO_DECODER_DECLARE(fs16g, xlaux);
+IIS2DULPX_FIFO_DECODER_DECLARE(fs2g, 2x);
+IIS2DULPX_FIFO_DECODER_DECLARE(fs4g, 2x);
+IIS2DULPX_FIFO_DECODER_DECLARE(fs8g, 2x);
+IIS2DULPX_FIFO_DECODER_DECLARE(fs16g, 2x);
+
+#define IIS2DULPX_DECODE_FS2G_XLONLY   iis2dulpx_fifo_decode_fs2g_xlonly
+#define IIS2DULPX_DECODE_FS4G_XLONLY   iis2dulpx_fifo_decode_fs4g_xlonly
+#define IIS2DULPX_DECODE_FS8G_XLONLY   iis2dulpx_fifo_decode_fs8g_xlonly
+#define IIS2DULPX_DECODE_FS16G_XLONLY  iis2dulpx_fifo_decode_fs16g_xlonly
+#define IIS2DULPX_DECODE_FS2G_XLAUX    iis2dulpx_fifo_decode_fs2g_xlaux
+#define IIS2DULPX_DECODE_FS4G_XLAUX    iis2dulpx_fifo_decode_fs4g_xlaux
+#define IIS2DULPX_DECODE_FS8G_XLAUX    iis2dulpx_fifo_decode_fs8g_xlaux
+#define IIS2DULPX_DECODE_FS16G_XLAUX   iis2dulpx_fifo_decode_fs16g_xlaux
+#define IIS2DULPX_DECODE_FS2G_2X       iis2dulpx_fifo_decode_fs2g_2x
+#define IIS2DULPX_DECODE_FS4G_2X       iis2dulpx_fifo_decode_fs4g_2x
+#define IIS2DULPX_DECODE_FS8G_2X       iis2dulpx_fifo_decode_fs8g_2x
+#define IIS2DULPX_DECODE_FS16G_2X      iis2dulpx_fifo_decode_fs16g_2x
+
+typedef struct
+{
+  int16_t *x;
+  int16_t *y;
+  int16_t *z;
+  int16_t *aux; /* T or AH_QVAR of 12-bit records, 0 otherwise (may be NULL) */
+} iis2dulpx_fifo_soa_t;
+/**
+  * @brief  Unpack a buffer of raw FIFO records (as read by
+  *         iis2dulpx_fifo_out_raw_batch_get) into separate x/y/z/aux
+  *         raw streams. XL_ONLY_2X records give two samples, records
+  *         that are not accelerometer data are skipped. Records sharing
+  *         the same tag are unpacked by a branch-free loop the compiler
+  *         can vectorize. Unpacking stops when the streams are full.
+  *
+  * @param  fmd      the FIFO configuration.(ptr)
+  * @param  buff     raw records, num * IIS2DULPX_FIFO_RECORD_LEN bytes
+  * @param  num      number of records in buff
+  * @param  out      output streams, each of at least max elements.(ptr)
+  * @param  max      capacity (in samples) of the output streams
+  * @param  samples  number of samples written.(ptr)
+  * @retval          0: no error
+  *
+  */
+int32_t iis2dulpx_fifo_unpack_soa(const iis2dulpx_fifo_mode_t *fmd, const uint8_t *buff,
+                                  uint16_t num, iis2dulpx_fifo_soa_t *out, uint16_t max,
+                                  uint16_t *samples);
+
+/**
+  * @brief  Drain the FIFO: read the current FIFO level and fetch up to max
+  *         records in a single bus transaction, then decode them.[get]
+  *
+  * @param  ctx      read / write interface definitions
+  * @param  md       the sensor conversion parameters.(ptr)
+  *                  NULL: raw data only, no floating point conversion
+  * @param  fmd      the FIFO configuration.(ptr)
+  * @param  buff     raw buffer of at least max * IIS2DULPX_FIFO_RECORD_LEN bytes
+  * @param  data     array of at least max decoded samples, NULL to skip decoding
+  * @param  max      capacity (in records) of buff and data
+  * @param  num      number of records actually read.(ptr)
+  * @retval          interface status (MANDATORY: return 0 -> no Error)
   *
   */
-typedef enum
+int32_t iis2dulpx_fifo_data_get_batch(const stmdev_ctx_t *ctx, const iis2dulpx_md_t *md,
+                                      const iis2dulpx_fifo_mode_t *fmd, uint8_t *buff,
+                                      iis2dulpx_fifo_data_t *data, uint16_t max,
+                                      uint16_t *num);
+
+typedef struct
 {
-  IIS2DULPX_NOTCH_50HZ       = 0x0,
-  IIS2DULPX_NOTCH_60HZ       = 0x1,
-} iis2dulpx_ah_qvar_notch_t;
+  uint8_t tag;
+  int16_t xl[3];
+  int16_t aux; /* T or AH_QVAR of 12-bit records, 0 otherwise */
+} iis2dulpx_fifo_sample_t;
 
-typedef enum
+typedef struct
 {
-  IIS2DULPX_520MOhm          = 0x0,
-  IIS2DULPX_175MOhm          = 0x1,
-  IIS2DULPX_310MOhm          = 0x2,
-  IIS2DULPX_75MOhm           = 0x3,
-} iis2dulpx_ah_qvar_zin_t;
+  uint32_t timestamp;
+  uint16_t index;                      /* index of the next sample in smp[] */
+  uint8_t cfg_change                   : 1;
+  uint8_t odr                          : 4;
+  uint8_t bw                           : 2;
+  uint8_t lp_hp                        : 1;
+  uint8_t qvar_en                      : 1;
+  uint8_t fs                           : 2;
+  uint8_t dec_ts                       : 2;
+  uint8_t odr_xl_batch                 : 1;
+} iis2dulpx_fifo_ts_t;
 
-typedef enum
+/** Per-axis integer accumulator for windowed features **/
+typedef struct
 {
-  IIS2DULPX_GAIN_0_5         = 0x0,
-  IIS2DULPX_GAIN_1           = 0x1,
-  IIS2DULPX_GAIN_2           = 0x2,
-  IIS2DULPX_GAIN_4           = 0x3,
-} iis2dulpx_ah_qvar_gain_t;
+  int64_t sum[3];                      /* LSB */
+  uint64_t sum_sq[3];                  /* LSB^2 */
+  int16_t min[3];
+  int16_t max[3];
+  uint32_t num;                        /* samples accumulated */
+} iis2dulpx_fifo_win_t;
 
 typedef struct
 {
-  uint8_t ah_qvar_en                   : 1;
-  uint8_t ah_qvar_notch_en             : 1;
-  iis2dulpx_ah_qvar_notch_t ah_qvar_notch;
-  iis2dulpx_ah_qvar_zin_t ah_qvar_zin;
-  iis2dulpx_ah_qvar_gain_t ah_qvar_gain;
-} iis2dulpx_ah_qvar_mode_t;
+  int32_t mean[3];                     /* ug */
+  uint32_t rms[3];                     /* ug */
+  uint32_t peak[3];                    /* ug, largest absolute value */
+  uint64_t var[3];                     /* ug^2 */
+  uint32_t num;
+} iis2dulpx_fifo_feat_t;
 
+typedef struct
+{
+  iis2dulpx_fifo_sample_t *smp;        /* accelerometer samples */
+  uint16_t smp_max;
+  uint16_t smp_num;
+  iis2dulpx_fifo_ts_t *ts;             /* timestamp records, may be NULL */
+  uint16_t ts_max;
+  uint16_t ts_num;
+  uint16_t rec_num;                    /* raw records consumed */
+  iis2dulpx_emb_ev_t *ev;              /* embedded function records, may be NULL */
+  uint16_t ev_max;
+  uint16_t ev_num;
+  iis2dulpx_fifo_win_t *win;           /* samples accumulated in, may be NULL */
+} iis2dulpx_fifo_compact_t;
 /**
-  * @brief  Enables AH_QVAR chain.[set]
+  * @brief  Decode raw FIFO records into compact samples (tag, raw XL and
+  *         aux: 10 bytes each). XL_ONLY_2X records give two samples.
+  *         TIMESTAMP_TAG records go out-of-band into out->ts, with the
+  *         index of the sample that follows them; step counter, FSM and
+  *         MLC records likewise go into out->ev as typed events; other
+  *         records are not stored. Decoding stops when smp[], ts[] or
+  *         ev[] is full, see out->rec_num. Stored samples are also
+  *         accumulated in out->win, if any.
+  *
+  * @param  fmd      the FIFO configuration.(ptr)
+  * @param  buff     raw records, num * IIS2DULPX_FIFO_RECORD_LEN bytes
+  * @param  num      number of records in buff
+  * @param  out      output arrays and counters.(ptr)
+  * @retval          0: no error
+  *
+  */
+int32_t iis2dulpx_fifo_compact_decode(const iis2dulpx_fifo_mode_t *fmd, const uint8_t *buff,
+                                      uint16_t num, iis2dulpx_fifo_compact_t *out);
+
+/**
+  * @brief  Drain up to max FIFO records in a single bus transaction and
+  *         decode them into compact samples.[get]
+  *         With 2X batching smp[] needs room for 2 * max samples.
   *
   * @param  ctx      read / write interface definitions
-  * @param  val      Enables and configures AH_QVAR chain.
+  * @param  fmd      the FIFO configuration.(ptr)
+  * @param  buff     raw buffer of at least max * IIS2DULPX_FIFO_RECORD_LEN bytes
+  * @param  max      capacity (in records) of buff
+  * @param  out      output arrays and counters.(ptr)
   * @retval          interface status (MANDATORY: return 0 -> no Error)
   *
   */
-int32_t iis2dulpx_ah_qvar_mode_set(const stmdev_ctx_t *ctx,
-                                   iis2dulpx_ah_qvar_mode_t val);
+int32_t iis2dulpx_fifo_compact_get(const stmdev_ctx_t *ctx, const iis2dulpx_fifo_mode_t *fmd,
+                                   uint8_t *buff, uint16_t max, iis2dulpx_fifo_compact_t *out);
+
+typedef struct
+{
+  uint8_t step_counter                 : 1;
+  uint8_t fsm                          : 1;
+  uint8_t mlc                          : 1;
+  uint8_t mlc_filter_feature           : 1;
+} iis2dulpx_emb_fifo_t;
+
 /**
-  * @brief  Enables AH_QVAR chain.[get]
+  * @brief  Embedded functions batched in FIFO, so that step counter, FSM
+  *         and MLC results are read with the accelerometer data instead
+  *         of polling the embedded bank (see iis2dulpx_fifo_compact_get,
+  *         iis2dulpx_fifo_data_get).[set]
   *
   * @param  ctx      read / write interface definitions
-  * @param  val      Enables and configures AH_QVAR chain.
+  * @param  val      embedded functions to batch
   * @retval          interface status (MANDATORY: return 0 -> no Error)
   *
   */
-int32_t iis2dulpx_ah_qvar_mode_get(const stmdev_ctx_t *ctx,
-                                   iis2dulpx_ah_qvar_mode_t *val);
+int32_t iis2dulpx_emb_fifo_set(const stmdev_ctx_t *ctx, iis2dulpx_emb_fifo_t val);
+
 /**
-  * @}
+  * @brief  Embedded functions batched in FIFO.[get]
+  *
+  * @param  ctx      read / write interface definitions
+  * @param  val      embedded functions batched
+  * @retval          interface status (MANDATORY: return 0 -> no Error)
   *
   */
+int32_t iis2dulpx_emb_fifo_get(const stmdev_ctx_t *ctx, iis2dulpx_emb_fifo_t *val);
 
 /**
-  * @defgroup step_counter Step Counter (Pedometer)
-  * @brief    Step Counter (Pedometer)
-  * @{
+  * @brief  Start a new feature window.
+  *
+  * @param  win      accumulator.(ptr)
+  * @retval          0: no error
+  *
+  */
+int32_t iis2dulpx_fifo_win_reset(iis2dulpx_fifo_win_t *win);
+
+/**
+  * @brief  Accumulate the accelerometer samples of raw FIFO records in a
+  *         single pass, straight from the unpacked LSB values (two per
+  *         XL_ONLY_2X record). Other records are skipped.
+  *
+  * @param  fmd      the FIFO configuration.(ptr)
+  * @param  buff     raw records, num * IIS2DULPX_FIFO_RECORD_LEN bytes
+  * @param  num      number of records in buff
+  * @param  win      accumulator.(ptr)
+  * @retval          0: no error
+  *
+  */
+int32_t iis2dulpx_fifo_win_update(const iis2dulpx_fifo_mode_t *fmd, const uint8_t *buff,
+                                  uint16_t num, iis2dulpx_fifo_win_t *win);
+
+/**
+  * @brief  Per-axis mean, RMS, peak and variance of a window, scaled to
+  *         the full scale in integer arithmetic. All FIFO layouts give
+  *         16-bit left-aligned LSB, so one sensitivity applies.
+  *
+  * @param  win      accumulator.(ptr)
+  * @param  fs       full scale of the window samples
+  * @param  feat     features, all zero on an empty window.(ptr)
+  * @retval          0: no error, -1: unknown full scale
+  *
+  */
+int32_t iis2dulpx_fifo_win_features(const iis2dulpx_fifo_win_t *win, iis2dulpx_fs_t fs,
+                                    iis2dulpx_fifo_feat_t *feat);
+
+typedef struct
+{
+  uint8_t *buff;                       /* caller storage, size * IIS2DULPX_FIFO_RECORD_LEN */
+  uint16_t size;                       /* capacity in records */
+  uint16_t head;                       /* next record written by the drain */
+  uint16_t tail;                       /* oldest record not released */
+  uint16_t count;                      /* records stored */
+} iis2dulpx_fifo_ring_t;
+
+typedef struct
+{
+  const iis2dulpx_fifo_ring_t *ring;
+  uint16_t pos;
+  uint16_t left;
+  const uint8_t *rec;                  /* current record, NULL at end */
+} iis2dulpx_fifo_iter_t;
+
+/**
+  * @brief  Attach caller owned storage (e.g. a DMA or radio buffer) to a
+  *         ring of raw FIFO records.
+  *
+  * @param  ring     ring descriptor.(ptr)
+  * @param  buff     storage of size * IIS2DULPX_FIFO_RECORD_LEN bytes
+  * @param  size     capacity in records
+  * @retval          -1 on invalid storage, 0 otherwise
+  *
+  */
+int32_t iis2dulpx_fifo_ring_init(iis2dulpx_fifo_ring_t *ring, uint8_t *buff, uint16_t size);
+
+/**
+  * @brief  Read the FIFO level and move up to the free ring space worth
+  *         of raw records (TAG + 6 bytes) straight into the ring storage:
+  *         one burst, two when the ring wraps. No decoding.[get]
+  *
+  * @param  ctx      read / write interface definitions
+  * @param  ring     ring descriptor.(ptr)
+  * @param  num      number of records added.(ptr)
+  * @retval          interface status (MANDATORY: return 0 -> no Error)
+  *
+  */
+int32_t iis2dulpx_fifo_ring_drain(const stmdev_ctx_t *ctx, iis2dulpx_fifo_ring_t *ring,
+                                  uint16_t *num);
+
+/**
+  * @brief  Oldest contiguous span of raw records, to be forwarded as is.
+  *         A wrapped ring needs a second peek after release.
+  *
+  * @param  ring     ring descriptor.(ptr)
+  * @param  raw      first raw record of the span.(ptr)
+  * @param  num      number of records in the span.(ptr)
+  * @retval          0: no error
+  *
+  */
+int32_t iis2dulpx_fifo_ring_peek(const iis2dulpx_fifo_ring_t *ring, const uint8_t **raw,
+                                 uint16_t *num);
+
+/**
+  * @brief  Give back the num oldest records to the drain.
+  *
+  * @param  ring     ring descriptor.(ptr)
+  * @param  num      number of records consumed
+  * @retval          -1 if num exceeds the stored records, 0 otherwise
+  *
+  */
+int32_t iis2dulpx_fifo_ring_release(iis2dulpx_fifo_ring_t *ring, uint16_t num);
+
+/**
+  * @brief  Start iterating the stored records, oldest first. Records are
+  *         not released.
+  *
+  * @param  it       iterator.(ptr)
+  * @param  ring     ring descriptor.(ptr)
+  *
+  */
+void iis2dulpx_fifo_iter_init(iis2dulpx_fifo_iter_t *it, const iis2dulpx_fifo_ring_t *ring);
+
+/**
+  * @brief  Step to the next record without decoding it.
+  *
+  * @param  it       iterator.(ptr)
+  * @retval          raw record (TAG + 6 bytes), NULL at end
+  *
+  */
+const uint8_t *iis2dulpx_fifo_iter_next(iis2dulpx_fifo_iter_t *it);
+
+/**
+  * @brief  Decode the current record, as iis2dulpx_fifo_data_get does.
+  *
+  * @param  it       iterator.(ptr)
+  * @param  md       the sensor conversion parameters.(ptr)
+  *                  NULL: raw data only, no floating point conversion
+  * @param  fmd      the FIFO configuration.(ptr)
+  * @param  data     decoded sample.(ptr)
+  * @retval          -1 if there is no current record, 0 otherwise
+  *
+  */
+int32_t iis2dulpx_fifo_iter_decode(const iis2dulpx_fifo_iter_t *it, const iis2dulpx_md_t *md,
+                                   const iis2dulpx_fifo_mode_t *fmd, iis2dulpx_fifo_data_t *data);
+/**
+  * @}
+  *
+  */
+
+/** @defgroup Ah_qvar Ah/QVAR
+  * @{
+  *
+  */
+typedef enum
+{
+  IIS2DULPX_NOTCH_50HZ       = 0x0,
+  IIS2DULPX_NOTCH_60HZ       = 0x1,
+} iis2dulpx_ah_qvar_notch_t;
+
+typedef enum
+{
+  IIS2DULPX_520MOhm          = 0x0,
+  IIS2DULPX_175MOhm          = 0x1,
+  IIS2DULPX_310MOhm          = 0x2,
+  IIS2DULPX_75MOhm           = 0x3,
+} iis2dulpx_ah_qvar_zin_t;
+
+typedef enum
+{
+  IIS2DULPX_GAIN_0_5         = 0x0,
+  IIS2DULPX_GAIN_1           = 0x1,
+  IIS2DULPX_GAIN_2           = 0x2,
+  IIS2DULPX_GAIN_4           = 0x3,
+} iis2dulpx_ah_qvar_gain_t;
+
+typedef struct
+{
+  uint8_t ah_qvar_en                   : 1;
+  uint8_t ah_qvar_notch_en             : 1;
+  iis2dulpx_ah_qvar_notch_t ah_qvar_notch;
+  iis2dulpx_ah_qvar_zin_t ah_qvar_zin;
+  iis2dulpx_ah_qvar_gain_t ah_qvar_gain;
+} iis2dulpx_ah_qvar_mode_t;
+
+/**
+  * @brief  Enables AH_QVAR chain.[set]
+  *
+  * @param  ctx      read / write interface definitions
+  * @param  val      Enables and configures AH_QVAR chain.
+  * @retval          interface status (MANDATORY: return 0 -> no Error)
+  *
+  */
+int32_t iis2dulpx_ah_qvar_mode_set(const stmdev_ctx_t *ctx,
+                                   iis2dulpx_ah_qvar_mode_t val);
+/**
+  * @brief  Enables AH_QVAR chain.[get]
+  *
+  * @param  ctx      read / write interface definitions
+  * @param  val      Enables and configures AH_QVAR chain.
+  * @retval          interface status (MANDATORY: return 0 -> no Error)
+  *
+  */
+int32_t iis2dulpx_ah_qvar_mode_get(const stmdev_ctx_t *ctx,
+                                   iis2dulpx_ah_qvar_mode_t *val);
+/**
+  * @}
+  *
+  */
+
+/**
+  * @defgroup step_counter Step Counter (Pedometer)
+  * @brief    Step Counter (Pedometer)
+  * @{
   *
   */
 
@@ -3685,6 +4525,306 @@ int32_t iis2dulpx_timestamp_get(const stmdev_ctx_t *ctx, uint8_t *val);
   */
 int32_t iis2dulpx_timestamp_raw_get(const stmdev_ctx_t *ctx, uint32_t *val);
 
+/** Timestamp resolution (ns) **/
+#define IIS2DULPX_TS_LSB_NS      10000U
+
+typedef struct
+{
+  uint64_t last_ext;                   /* last device timestamp, extended to 64-bit */
+  uint64_t anchor_ns;                  /* device time of the last timestamp record */
+  uint64_t next_q8;                    /* time of the next sample (ns, Q8) */
+  uint64_t period_q8;                  /* estimated sample period (ns, Q8) */
+  uint64_t nominal_q8;                 /* nominal sample period from ODR/BDR */
+  uint32_t since_anchor;               /* samples since the last timestamp record */
+  uint8_t odr;
+  uint8_t bdr_xl;
+  uint8_t synced;
+  /* device to host time mapping */
+  uint8_t host_pairs;
+  uint64_t sync_ext;
+  uint64_t dev_ref_ns;
+  uint64_t host_ref_ns;
+  int64_t drift_ppb;
+} iis2dulpx_fifo_ts_engine_t;
+
+/**
+  * @brief  Initialize the FIFO timestamp engine with the configuration
+  *         used until the first TIMESTAMP_TAG record.
+  *
+  * @param  eng    timestamp engine.(ptr)
+  * @param  odr    accelerometer output data rate.
+  * @param  bdr_xl accelerometer batch data rate.
+  * @retval        0: no error, -1: bdr_xl not batching
+  *
+  */
+int32_t iis2dulpx_fifo_ts_init(iis2dulpx_fifo_ts_engine_t *eng, iis2dulpx_odr_t odr,
+                               iis2dulpx_bdr_xl_t bdr_xl);
+
+/**
+  * @brief  Feed one raw FIFO record to the timestamp engine and get the
+  *         64-bit device time (ns) of its accelerometer samples.
+  *         A TIMESTAMP_TAG record is taken as the time of the following
+  *         sample; next ones are spaced by the ODR/BDR period, refined
+  *         from the distance between timestamp records. 32-bit wrap
+  *         and configuration changes (odr, cfg_change) are handled.
+  *
+  * @param  eng    timestamp engine.(ptr)
+  * @param  rec    raw record, IIS2DULPX_FIFO_RECORD_LEN bytes
+  * @param  ts_ns  sample times, room for 2 values (2X records).(ptr)
+  * @param  num    number of sample times written (0, 1 or 2).(ptr)
+  * @retval        0: no error, -1: no timestamp record seen yet
+  *                (times are relative to 0)
+  *
+  */
+int32_t iis2dulpx_fifo_ts_update(iis2dulpx_fifo_ts_engine_t *eng, const uint8_t *rec,
+                                 uint64_t *ts_ns, uint8_t *num);
+
+/**
+  * @brief  Get the 64-bit device time (ns) of each sample decoded by
+  *         iis2dulpx_fifo_compact_decode / iis2dulpx_fifo_compact_get.
+  *
+  * @param  eng    timestamp engine.(ptr)
+  * @param  cmp    compact samples and out-of-band timestamps.(ptr)
+  * @param  ts_ns  sample times, cmp->smp_num values.(ptr)
+  * @retval        0: no error, -1: no timestamp record seen yet
+  *
+  */
+int32_t iis2dulpx_fifo_ts_compact(iis2dulpx_fifo_ts_engine_t *eng,
+                                  const iis2dulpx_fifo_compact_t *cmp, uint64_t *ts_ns);
+
+/**
+  * @brief  Read the device timestamp and pair it with the host time
+  *         taken at the same moment. Two or more pairs give the device
+  *         to host clock drift: space them by at least one second. A
+  *         host time step larger than the interval between two pairs is
+  *         not taken as drift.
+  *
+  * @param  ctx     Read / write interface definitions.(ptr)
+  * @param  eng     timestamp engine.(ptr)
+  * @param  host_ns host time (ns)
+  * @retval         Interface status (MANDATORY: return 0 -> no Error).
+  *
+  */
+int32_t iis2dulpx_fifo_ts_host_sync(const stmdev_ctx_t *ctx, iis2dulpx_fifo_ts_engine_t *eng,
+                                    uint64_t host_ns);
+
+/**
+  * @brief  Convert a device time (ns) to host time (ns).
+  *
+  * @param  eng     timestamp engine.(ptr)
+  * @param  dev_ns  device time.
+  * @param  host_ns host time.(ptr)
+  * @retval         0: no error, -1: no host sync pair yet
+  *
+  */
+int32_t iis2dulpx_fifo_ts_to_host(const iis2dulpx_fifo_ts_engine_t *eng, uint64_t dev_ns,
+                                  uint64_t *host_ns);
+
+typedef struct
+{
+  uint32_t drains;
+  uint32_t records;                    /* FIFO records read */
+  uint32_t samples;                    /* accelerometer samples read */
+  uint32_t overruns;                   /* drains that found FIFO_OVR_IA set */
+  uint32_t full;                       /* drains that found the FIFO full */
+  uint32_t lost;                       /* accelerometer samples missing */
+  uint32_t resyncs;                    /* timestamp records that closed a gap */
+  uint16_t level_peak;                 /* highest FIFO level found */
+  uint32_t pending;                    /* driver internal */
+  uint64_t last_host_ns;               /* driver internal */
+} iis2dulpx_fifo_loss_t;
+
+/**
+  * @brief  Drain the FIFO and account lost samples: FIFO_STATUS1 and
+  *         FIFO_STATUS2 are read together, then up to max records in a
+  *         single burst. Each record runs through the timestamp engine;
+  *         a TIMESTAMP_TAG record later than the predicted sample time
+  *         counts the missing samples and resyncs the engine. After an
+  *         overrun with no timestamp record, losses are estimated from
+  *         host time and the expected ODR.[get]
+  *
+  * @param  ctx      read / write interface definitions
+  * @param  eng      timestamp engine, NULL: count only overrun/full.(ptr)
+  * @param  buff     raw buffer of at least max * IIS2DULPX_FIFO_RECORD_LEN bytes
+  * @param  max      capacity (in records) of buff
+  * @param  host_ns  host time of the drain (ns), 0 if not available
+  * @param  loss     counters, zero initialized once.(ptr)
+  * @param  num      number of records read.(ptr)
+  * @retval          interface status (MANDATORY: return 0 -> no Error)
+  *
+  */
+int32_t iis2dulpx_fifo_drain_tracked(const stmdev_ctx_t *ctx, iis2dulpx_fifo_ts_engine_t *eng,
+                                     uint8_t *buff, uint16_t max, uint64_t host_ns,
+                                     iis2dulpx_fifo_loss_t *loss, uint16_t *num);
+
+/**
+  * @}
+  *
+  */
+
+/**
+  * @defgroup   iis2dulpx_Wtm_Ctrl Watermark control
+  * @brief      This section groups the functions that adapt the FIFO
+  *             watermark and batch rate to a latency target.
+  * @{
+  *
+  */
+
+/** Records kept free for host jitter on top of the observed peak **/
+#ifndef IIS2DULPX_WTM_CTRL_MARGIN
+#define IIS2DULPX_WTM_CTRL_MARGIN    8U
+#endif /* IIS2DULPX_WTM_CTRL_MARGIN */
+
+typedef struct
+{
+  uint32_t latency_us;                 /* max age of the oldest record at drain */
+  uint8_t bdr_min;                     /* iis2dulpx_bdr_xl_t range allowed */
+  uint8_t bdr_max;
+  uint8_t margin;
+  uint8_t odr;
+  uint8_t dec_ts;
+  uint8_t bdr;                         /* batch rate in use */
+  uint8_t bdr_set;
+  uint8_t wtm;                         /* watermark in use */
+  uint8_t wtm_next;
+  uint16_t excess_q4;                  /* records beyond watermark at drain (avg, Q4) */
+  uint16_t excess_peak;                /* records beyond watermark at drain (peak) */
+  uint64_t period_ns;                  /* measured batch period */
+  uint64_t last_ns;                    /* host time of the last drain */
+  uint32_t wakeups;
+} iis2dulpx_wtm_ctrl_t;
+
+/**
+  * @brief  Start the watermark controller: ODR is taken from the device
+  *         (iis2dulpx_mode_get), the batch rate starts at bdr_min and
+  *         watermark and batch rate are written.
+  *         Set bdr_min == bdr_max to keep the batch rate fixed.[set]
+  *
+  * @param  ctx         read / write interface definitions
+  * @param  ctrl        controller state.(ptr)
+  * @param  latency_us  max age of the oldest record at drain (us)
+  * @param  bdr_min     finest batch rate allowed
+  * @param  bdr_max     coarsest batch rate allowed
+  * @retval             interface status (MANDATORY: return 0 -> no Error)
+  *
+  */
+int32_t iis2dulpx_wtm_ctrl_init(const stmdev_ctx_t *ctx, iis2dulpx_wtm_ctrl_t *ctrl,
+                                uint32_t latency_us, iis2dulpx_bdr_xl_t bdr_min,
+                                iis2dulpx_bdr_xl_t bdr_max);
+
+/**
+  * @brief  Feed one drain: FIFO level found by the host (e.g. from
+  *         iis2dulpx_fifo_data_level_get before draining the whole FIFO)
+  *         and host time. Watermark and batch rate are updated when the
+  *         estimate moves; ctrl->bdr tells the batch rate in use.[set]
+  *
+  * @param  ctx      read / write interface definitions
+  * @param  ctrl     controller state.(ptr)
+  * @param  level    records found in FIFO
+  * @param  now_ns   host time of the drain (ns)
+  * @retval          interface status (MANDATORY: return 0 -> no Error)
+  *
+  */
+int32_t iis2dulpx_wtm_ctrl_update(const stmdev_ctx_t *ctx, iis2dulpx_wtm_ctrl_t *ctrl,
+                                  uint16_t level, uint64_t now_ns);
+
+/**
+  * @}
+  *
+  */
+
+/**
+  * @defgroup   iis2dulpx_Duty_Cycle Duty cycling
+  * @brief      This section groups the functions that move the device
+  *             between ultra low power, low power and high performance
+  *             profiles on activity / inactivity events.
+  * @{
+  *
+  */
+
+typedef enum
+{
+  IIS2DULPX_DUTY_ULP       = 0,
+  IIS2DULPX_DUTY_LP        = 1,
+  IIS2DULPX_DUTY_HP        = 2,
+} iis2dulpx_duty_level_t;
+
+typedef enum
+{
+  IIS2DULPX_DUTY_EV_INACTIVE = 0,      /* sleep_change, sleep_state = 1 */
+  IIS2DULPX_DUTY_EV_ACTIVE   = 1,      /* sleep_change, sleep_state = 0 */
+  IIS2DULPX_DUTY_EV_MOTION   = 2,      /* wake_up while active */
+} iis2dulpx_duty_ev_t;
+
+typedef struct
+{
+  iis2dulpx_md_t md[3];                /* [iis2dulpx_duty_level_t] */
+  iis2dulpx_fifo_batch_t batch[3];
+  uint8_t wtm[3];                      /* FIFO watermark */
+  uint8_t hp_motion;                   /* wake_up events in LP before HP, 0: never */
+  iis2dulpx_wakeup_config_t wakeup;    /* wake_enable and inact_odr set by the engine */
+  iis2dulpx_smart_power_cfg_t smart_power;
+} iis2dulpx_duty_cfg_t;
+
+typedef struct
+{
+  iis2dulpx_duty_cfg_t cfg;
+  uint8_t level;                       /* iis2dulpx_duty_level_t in use */
+  uint8_t motion;
+  uint8_t hw_ulp;                      /* ULP ODR applied by the device (inact_odr) */
+  uint8_t dirty;                       /* last transition failed: write all */
+  uint8_t writes;                      /* registers written by the last transition */
+  uint8_t img[4];                      /* CTRL5, CTRL3, FIFO_WTM, FIFO_BATCH_DEC */
+} iis2dulpx_duty_t;
+
+/**
+  * @brief  Start the duty cycling engine: wakeup (with sleep enabled)
+  *         and smart power are configured and the LP profile is
+  *         applied. When the ULP profile uses a ULP ODR with the same
+  *         full scale as LP and HP, the ODR switch on inactivity is left
+  *         to the device (inact_odr) and only FIFO batching is written.
+  *         While running, the engine owns CTRL5, CTRL3.hp_en,
+  *         FIFO_WTM.fth and FIFO_BATCH_DEC.[set]
+  *
+  * @param  ctx      read / write interface definitions
+  * @param  duty     engine state.(ptr)
+  * @param  cfg      profiles and policy.(ptr)
+  * @retval          interface status (MANDATORY: return 0 -> no Error),
+  *                  -1 also if a profile is not valid
+  *
+  */
+int32_t iis2dulpx_duty_init(const stmdev_ctx_t *ctx, iis2dulpx_duty_t *duty,
+                            const iis2dulpx_duty_cfg_t *cfg);
+
+/**
+  * @brief  Feed an activity event: inactivity moves to ULP, activity to
+  *         LP, hp_motion wake_up events in LP to HP. Only the registers
+  *         that differ from the current profile are written, in one
+  *         transaction; duty->writes tells how many.[set]
+  *
+  * @param  ctx      read / write interface definitions
+  * @param  duty     engine state.(ptr)
+  * @param  ev       activity event
+  * @retval          interface status (MANDATORY: return 0 -> no Error)
+  *
+  */
+int32_t iis2dulpx_duty_event(const stmdev_ctx_t *ctx, iis2dulpx_duty_t *duty,
+                             iis2dulpx_duty_ev_t ev);
+
+/**
+  * @brief  Feed the interrupt sources (e.g. from iis2dulpx_all_sources_get
+  *         or the interrupt dispatcher): sleep_change / sleep_state and
+  *         wake_up are turned into activity events.[set]
+  *
+  * @param  ctx      read / write interface definitions
+  * @param  duty     engine state.(ptr)
+  * @param  src      interrupt sources.(ptr)
+  * @retval          interface status (MANDATORY: return 0 -> no Error)
+  *
+  */
+int32_t iis2dulpx_duty_sources_update(const stmdev_ctx_t *ctx, iis2dulpx_duty_t *duty,
+                                      const iis2dulpx_all_sources_t *src);
+
 /**
   * @}
   *
@@ -4055,6 +5195,769 @@ int32_t iis2dulpx_mlc_fifo_en_set(const stmdev_ctx_t *ctx, uint8_t val);
   */
 int32_t iis2dulpx_mlc_fifo_en_get(const stmdev_ctx_t *ctx, uint8_t *val);
 
+/**
+  * @}
+  *
+  */
+
+/**
+  * @defgroup   IIS2DULPX_Device_Group Device Group
+  * @brief      This section groups all the functions that run the same
+  *             operation on an array of devices. Accesses are scheduled
+  *             round robin over the buses: bus transfers of different
+  *             buses follow each other, ordering on each bus is kept.
+  * @{
+  *
+  */
+
+/** Max number of devices in a group **/
+#ifndef IIS2DULPX_GROUP_MAX
+#define IIS2DULPX_GROUP_MAX      16U
+#endif /* IIS2DULPX_GROUP_MAX */
+
+typedef struct
+{
+  const stmdev_ctx_t *dev;             /* array of num device contexts */
+  const stmdev_ctx_t *bcast;           /* broadcast interface (e.g. I3C), may be NULL */
+  uint8_t num;
+  uint8_t order[IIS2DULPX_GROUP_MAX];  /* access order, see iis2dulpx_group_init */
+} iis2dulpx_group_t;
+
+/**
+  * @brief  Initialize a device group.
+  *
+  * @param  grp    device group.(ptr)
+  * @param  dev    array of device contexts.(ptr)
+  * @param  bus    bus identifier of each device, NULL if all share one bus
+  * @param  num    number of devices (max IIS2DULPX_GROUP_MAX)
+  * @param  bcast  interface whose writes reach all the devices at once
+  *                (e.g. I3C broadcast, shared chip select), NULL if none.
+  *                Broadcast is only used for registers that have the same
+  *                content on all the devices.
+  * @retval        0: no error, -1: invalid number of devices
+  *
+  */
+int32_t iis2dulpx_group_init(iis2dulpx_group_t *grp, const stmdev_ctx_t *dev,
+                             const uint8_t *bus, uint8_t num, const stmdev_ctx_t *bcast);
+
+/**
+  * @brief  Set the sensor mode of all the devices. The mode is checked
+  *         once before any device is written; with a broadcast interface
+  *         CTRL5 is written once for the whole group.[set]
+  *
+  * @param  grp    device group.(ptr)
+  * @param  val    the sensor conversion parameters.(ptr)
+  * @retval        interface status (MANDATORY: return 0 -> no Error)
+  *
+  */
+int32_t iis2dulpx_group_mode_set(const iis2dulpx_group_t *grp, const iis2dulpx_md_t *val);
+
+/**
+  * @brief  Software trigger for One-Shot on all the devices. With a
+  *         broadcast interface a single write starts all of them; CTRL4
+  *         content is taken from the first device.
+  *
+  * @param  grp    device group.(ptr)
+  * @param  md     the sensor conversion parameters.(ptr)
+  * @retval        interface status (MANDATORY: return 0 -> no Error)
+  *
+  */
+int32_t iis2dulpx_group_trigger_sw(const iis2dulpx_group_t *grp, const iis2dulpx_md_t *md);
+
+/**
+  * @brief  Drain the FIFO of all the devices: first all the FIFO levels,
+  *         then one burst per device.[get]
+  *
+  * @param  grp    device group.(ptr)
+  * @param  buff   raw buffer, num devices * max * IIS2DULPX_FIFO_RECORD_LEN
+  *                bytes; records of device i start at i * max records
+  * @param  max    max number of records per device
+  * @param  num    number of records read for each device (array).(ptr)
+  * @retval        interface status (MANDATORY: return 0 -> no Error)
+  *
+  */
+int32_t iis2dulpx_group_fifo_drain(const iis2dulpx_group_t *grp, uint8_t *buff, uint16_t max,
+                                   uint16_t *num);
+
+/**
+  * @brief  Interrupt sources of all the devices.[get]
+  *
+  * @param  grp    device group.(ptr)
+  * @param  val    sources of each device (array).(ptr)
+  * @retval        interface status (MANDATORY: return 0 -> no Error)
+  *
+  */
+int32_t iis2dulpx_group_all_sources_get(const iis2dulpx_group_t *grp,
+                                        iis2dulpx_all_sources_t *val);
+
+/** Trigger and timing of a synchronized capture **/
+typedef struct
+{
+  void (*pin)(void *arg);              /* TRIG_PIN: pulse on INT2 of all the devices */
+  void *arg;
+  uint32_t (*clock)(void);             /* time base for the skew, NULL: bus transfers */
+  uint16_t max_polls;                  /* data ready polls per device */
+} iis2dulpx_group_trig_t;
+
+typedef struct
+{
+  iis2dulpx_xl_data_t data[IIS2DULPX_GROUP_MAX];
+  uint32_t skew[IIS2DULPX_GROUP_MAX];  /* trigger time from the first trigger */
+  uint32_t max_skew;
+  uint16_t valid;                      /* devices with a sample (bit mask) */
+  uint16_t polls[IIS2DULPX_GROUP_MAX];
+} iis2dulpx_group_capture_t;
+
+/**
+  * @brief  Synchronized single-shot capture on all the devices, already
+  *         set in TRIG_SW or TRIG_PIN mode (iis2dulpx_group_mode_set).
+  *         With TRIG_PIN or a broadcast interface all the devices are
+  *         triggered at once; otherwise triggers are pipelined with the
+  *         reads: device N+1 is triggered before device N is read.
+  *         Each read takes STATUS .. OUT_Z_H in one burst; devices not
+  *         ready yet are polled again, round robin, up to max_polls.[get]
+  *
+  * @param  grp    device group.(ptr)
+  * @param  md     the sensor conversion parameters.(ptr)
+  * @param  trig   trigger and timing.(ptr)
+  * @param  cap    samples, per device skew and valid mask.(ptr)
+  * @retval        interface status (MANDATORY: return 0 -> no Error),
+  *                -1 also if md is not a trigger mode
+  *
+  */
+int32_t iis2dulpx_group_capture(const iis2dulpx_group_t *grp, const iis2dulpx_md_t *md,
+                                const iis2dulpx_group_trig_t *trig,
+                                iis2dulpx_group_capture_t *cap);
+
+/**
+  * @}
+  *
+  */
+
+/**
+  * @defgroup   IIS2DULPX_Irq_Dispatch Interrupt dispatcher
+  * @brief      This section groups the functions that serve an interrupt
+  *             line: the sources are read with a bounded number of bus
+  *             transfers and only the handlers of the sources that fired
+  *             are called.
+  * @{
+  *
+  */
+
+typedef enum
+{
+  IIS2DULPX_IRQ_WAKE_UP      = 0,
+  IIS2DULPX_IRQ_FREE_FALL    = 1,
+  IIS2DULPX_IRQ_SLEEP_CHANGE = 2,
+  IIS2DULPX_IRQ_SINGLE_TAP   = 3,
+  IIS2DULPX_IRQ_DOUBLE_TAP   = 4,
+  IIS2DULPX_IRQ_TRIPLE_TAP   = 5,
+  IIS2DULPX_IRQ_SIX_D        = 6,
+  IIS2DULPX_IRQ_DRDY         = 7,
+  IIS2DULPX_IRQ_FIFO_WTM     = 8,
+  IIS2DULPX_IRQ_FIFO_OVR     = 9,
+  IIS2DULPX_IRQ_STEP_DET     = 10,
+  IIS2DULPX_IRQ_TILT         = 11,
+  IIS2DULPX_IRQ_SIGMOT       = 12,
+  IIS2DULPX_IRQ_FSM_LC       = 13,
+  IIS2DULPX_IRQ_FSM          = 14,
+  IIS2DULPX_IRQ_MLC          = 15,
+  IIS2DULPX_IRQ_SRC_NUM      = 16,
+} iis2dulpx_irq_src_t;
+
+typedef struct
+{
+  iis2dulpx_all_sources_t src;
+  iis2dulpx_embedded_status_t emb;
+  uint8_t is_fsm_lc;
+  uint8_t fifo_wtm;
+  uint8_t fifo_ovr;
+  uint8_t fifo_level;                  /* FIFO_STATUS2 content */
+  iis2dulpx_fsm_status_mainpage_t fsm_status;
+  iis2dulpx_mlc_status_mainpage_t mlc_status;
+  uint8_t fsm_out[8];                  /* FSM_OUTS1..8, valid if fsm_status != 0 */
+  uint8_t mlc_out[4];                  /* MLC1..4_SRC, valid if mlc_status != 0 */
+} iis2dulpx_irq_event_t;
+
+typedef void (*iis2dulpx_irq_handler_t)(void *arg, iis2dulpx_irq_src_t src,
+                                        const iis2dulpx_irq_event_t *evt);
+
+typedef struct
+{
+  iis2dulpx_irq_handler_t handler[IIS2DULPX_IRQ_SRC_NUM];
+  void *arg[IIS2DULPX_IRQ_SRC_NUM];
+  uint16_t mask;                       /* sources with a handler */
+  iis2dulpx_irq_event_t evt;           /* last dispatched event */
+} iis2dulpx_irq_t;
+
+/**
+  * @brief  Initialize a dispatcher with no handler registered.
+  *
+  * @param  irq    interrupt dispatcher.(ptr)
+  *
+  */
+void iis2dulpx_irq_init(iis2dulpx_irq_t *irq);
+
+/**
+  * @brief  Register (or remove, with handler NULL) the handler of a
+  *         source.[set]
+  *
+  * @param  irq      interrupt dispatcher.(ptr)
+  * @param  src      interrupt source
+  * @param  handler  function called when src fired, NULL to remove it
+  * @param  arg      user argument passed to handler
+  * @retval          0: no error, -1: invalid source
+  *
+  */
+int32_t iis2dulpx_irq_handler_set(iis2dulpx_irq_t *irq, iis2dulpx_irq_src_t src,
+                                  iis2dulpx_irq_handler_t handler, void *arg);
+
+/**
+  * @brief  Read the interrupt sources and call the handlers of the ones
+  *         that fired, in iis2dulpx_irq_src_t order.
+  *         WAKE_UP_SRC..FIFO_STATUS2 are read in one burst; the main page
+  *         EMB_FUNC/FSM/MLC status registers in a second one, only if an
+  *         embedded handler is registered. FSM_OUTS and MLC_SRC are read
+  *         from the embedded bank, with a single bank transition, only
+  *         when their status bits are set. If one of the later reads
+  *         fails, the sources already read are still dispatched and the
+  *         error is returned.
+  *         Must not be called while an embedded session is open.
+  *
+  * @param  ctx    read / write interface definitions
+  * @param  irq    interrupt dispatcher.(ptr)
+  * @retval        interface status (MANDATORY: return 0 -> no Error)
+  *
+  */
+int32_t iis2dulpx_irq_dispatch(const stmdev_ctx_t *ctx, iis2dulpx_irq_t *irq);
+
+/**
+  * @}
+  *
+  */
+
+/**
+  * @defgroup   IIS2DULPX_Async Async
+  * @brief      This section groups the non-blocking versions of the
+  *             multi-transfer functions. Each one runs as a chain of bus
+  *             transfers: the platform submits a transfer (e.g. DMA) and
+  *             calls the completion callback from its IRQ, which submits
+  *             the next one. The done callback of the operation runs at
+  *             the end of the chain.
+  * @{
+  *
+  */
+
+typedef void (*iis2dulpx_async_cb_t)(void *arg, int32_t status);
+
+/** Please note that is MANDATORY: return 0 -> transfer submitted.**/
+typedef int32_t (*iis2dulpx_async_write_ptr)(void *handle, uint8_t reg, const uint8_t *data,
+                                             uint16_t len, iis2dulpx_async_cb_t cb, void *arg);
+typedef int32_t (*iis2dulpx_async_read_ptr)(void *handle, uint8_t reg, uint8_t *data,
+                                            uint16_t len, iis2dulpx_async_cb_t cb, void *arg);
+
+typedef struct
+{
+  /** Component mandatory fields **/
+  iis2dulpx_async_write_ptr  write_reg;
+  iis2dulpx_async_read_ptr   read_reg;
+  /** Customizable optional pointer **/
+  void *handle;
+} iis2dulpx_async_io_t;
+
+typedef struct iis2dulpx_async_op_s iis2dulpx_async_op_t;
+
+typedef void (*iis2dulpx_async_done_t)(iis2dulpx_async_op_t *op);
+
+struct iis2dulpx_async_op_s
+{
+  /** Set by the caller **/
+  const iis2dulpx_async_io_t *io;
+  const stmdev_ctx_t *ctx;        /* private data: bank, shadow */
+  iis2dulpx_async_done_t done;
+  void *user;
+  /** Operation result, valid in done **/
+  int32_t status;
+  /** Driver internal **/
+  uint8_t state;
+  uint8_t flags;
+  uint8_t tmp[IIS2DULPX_FIFO_RECORD_LEN];
+  uint8_t ctrl1;
+  uint8_t fca;
+  uint8_t page_rw;
+  const iis2dulpx_md_t *md;
+  const iis2dulpx_fifo_mode_t *fmd;
+  void *out;
+  uint8_t *buf;
+  uint16_t address;
+  uint16_t len;
+  uint16_t idx;
+};
+
+/**
+  * @brief  Non-blocking iis2dulpx_fifo_data_get.[get]
+  *
+  * @param  op     operation: io, ctx and done set, zero initialized once.(ptr)
+  * @param  md     operating mode, NULL for raw data only.(ptr)
+  * @param  fmd    FIFO mode.(ptr)
+  * @param  data   FIFO record, valid in done.(ptr)
+  * @retval        -1 if op is busy or not configured, 0 if started
+  *
+  */
+int32_t iis2dulpx_fifo_data_get_async(iis2dulpx_async_op_t *op, const iis2dulpx_md_t *md,
+                                      const iis2dulpx_fifo_mode_t *fmd, iis2dulpx_fifo_data_t *data);
+
+/**
+  * @brief  Non-blocking iis2dulpx_all_sources_get.[get]
+  *
+  * @param  op     operation: io, ctx and done set, zero initialized once.(ptr)
+  * @param  val    interrupt sources, valid in done.(ptr)
+  * @retval        -1 if op is busy or not configured, 0 if started
+  *
+  */
+int32_t iis2dulpx_all_sources_get_async(iis2dulpx_async_op_t *op, iis2dulpx_all_sources_t *val);
+
+/**
+  * @brief  Non-blocking iis2dulpx_ln_pg_write. The embedded bank is
+  *         left in a known state also when a transfer fails.[set]
+  *
+  * @param  op       operation: io, ctx and done set, zero initialized once.(ptr)
+  * @param  address  page address.
+  * @param  buf      data to write, kept valid until done.(ptr)
+  * @param  len      number of bytes.
+  * @retval          -1 if op is busy or not configured, or if lock hooks
+  *                  are set, 0 if started
+  *
+  */
+int32_t iis2dulpx_ln_pg_write_async(iis2dulpx_async_op_t *op, uint16_t address, uint8_t *buf,
+                                    uint16_t len);
+
+/**
+  * @}
+  *
+  */
+
+/**
+  * @defgroup   IIS2DULPX_Power Power state transitions
+  * @brief      This section groups the non-blocking boot, reset and deep
+  *             power down sequences. A transition is started with
+  *             iis2dulpx_pwr_start() and advanced with iis2dulpx_pwr_poll()
+  *             from a timer or main loop; iis2dulpx_pwr_wait() runs it to
+  *             the end with the udelay hook (or ctx->mdelay).
+  * @{
+  *
+  */
+
+/** Boot (CTRL4.boot) poll period and timeout, in us **/
+#ifndef IIS2DULPX_PWR_BOOT_POLL_US
+#define IIS2DULPX_PWR_BOOT_POLL_US      1000U
+#endif /* IIS2DULPX_PWR_BOOT_POLL_US */
+#ifndef IIS2DULPX_PWR_BOOT_TIMEOUT_US
+#define IIS2DULPX_PWR_BOOT_TIMEOUT_US   150000U
+#endif /* IIS2DULPX_PWR_BOOT_TIMEOUT_US */
+
+/** Software reset (CTRL1.sw_reset) poll period and timeout, in us **/
+#ifndef IIS2DULPX_PWR_RESET_POLL_US
+#define IIS2DULPX_PWR_RESET_POLL_US     50U
+#endif /* IIS2DULPX_PWR_RESET_POLL_US */
+#ifndef IIS2DULPX_PWR_RESET_TIMEOUT_US
+#define IIS2DULPX_PWR_RESET_TIMEOUT_US  6000U
+#endif /* IIS2DULPX_PWR_RESET_TIMEOUT_US */
+
+/** Deep power down exit time, in us (see AN5812 - 3.1.1.1 and 3.1.1.2) **/
+#ifndef IIS2DULPX_PWR_DPD_EXIT_US
+#define IIS2DULPX_PWR_DPD_EXIT_US       25000U
+#endif /* IIS2DULPX_PWR_DPD_EXIT_US */
+
+typedef enum
+{
+  IIS2DULPX_PWR_REBOOT           = 0x0,
+  IIS2DULPX_PWR_SW_RESET         = 0x1,
+  IIS2DULPX_PWR_SW_POR           = 0x2,
+  IIS2DULPX_PWR_DPD_ENTER        = 0x3,
+  IIS2DULPX_PWR_DPD_ENTER_SAVE   = 0x4, /* save the configuration, then enter */
+  IIS2DULPX_PWR_DPD_EXIT         = 0x5,
+  IIS2DULPX_PWR_DPD_EXIT_RESTORE = 0x6, /* exit, then write the saved configuration */
+} iis2dulpx_pwr_cmd_t;
+
+typedef struct
+{
+  const stmdev_ctx_t *ctx;
+  iis2dulpx_async_cb_t done;           /* optional, called at the end */
+  void *user;
+  int32_t status;                      /* result of the last transition */
+  uint8_t cmd;
+  uint8_t state;
+  uint8_t busy;
+  uint8_t snap_valid;
+  uint32_t wait_us;                    /* time to the next step */
+  uint32_t left_us;                    /* time to the timeout */
+  iis2dulpx_shadow_t snap;             /* configuration saved by DPD_ENTER_SAVE */
+} iis2dulpx_pwr_t;
+
+/**
+  * @brief  Microsecond delay hook, kept in ctx->priv_data. NULL: delays
+  *         are rounded up to ctx->mdelay milliseconds.[set]
+  *
+  * @param  ctx      read / write interface definitions
+  * @param  udelay   delay function, NULL to disable
+  * @retval          interface status (MANDATORY: return 0 -> no Error)
+  *
+  */
+int32_t iis2dulpx_udelay_set(const stmdev_ctx_t *ctx, iis2dulpx_udelay_ptr udelay);
+
+/**
+  * @brief  Initialize a power transition, no saved configuration.
+  *
+  * @param  pwr    power transition.(ptr)
+  *
+  */
+void iis2dulpx_pwr_init(iis2dulpx_pwr_t *pwr);
+
+/**
+  * @brief  Start a power transition: the command is written and, when
+  *         the transition needs no wait (DPD_ENTER), it is completed
+  *         at once. DPD_ENTER_SAVE takes the configuration from the
+  *         shadow copy, reading from the device only the register runs
+  *         not cached. DPD_EXIT_RESTORE writes it back after wake, in
+  *         one transaction; embedded functions configuration is not
+  *         part of it.
+  *
+  * @param  ctx    read / write interface definitions
+  * @param  pwr    power transition.(ptr)
+  * @param  cmd    transition to run
+  * @param  done   called with the final status, may be NULL
+  * @param  user   argument of done
+  * @retval        interface status (MANDATORY: return 0 -> no Error),
+  *                -1 also if pwr is busy
+  *
+  */
+int32_t iis2dulpx_pwr_start(const stmdev_ctx_t *ctx, iis2dulpx_pwr_t *pwr,
+                            iis2dulpx_pwr_cmd_t cmd, iis2dulpx_async_cb_t done, void *user);
+
+/**
+  * @brief  Advance a power transition. Nothing is done until pwr->wait_us
+  *         have elapsed; then the next step runs (at most one bus read
+  *         or the configuration restore). pwr->busy is cleared at the
+  *         end, status in pwr->status.
+  *
+  * @param  pwr         power transition.(ptr)
+  * @param  elapsed_us  time elapsed since the previous call, in us
+  * @retval             interface status (MANDATORY: return 0 -> no Error)
+  *
+  */
+int32_t iis2dulpx_pwr_poll(iis2dulpx_pwr_t *pwr, uint32_t elapsed_us);
+
+/**
+  * @brief  Run a power transition to the end, waiting with the udelay
+  *         hook or ctx->mdelay. Without either, -1 is returned and the
+  *         transition is left to iis2dulpx_pwr_poll.
+  *
+  * @param  pwr    power transition.(ptr)
+  * @retval        status of the transition (MANDATORY: return 0 -> no Error)
+  *
+  */
+int32_t iis2dulpx_pwr_wait(iis2dulpx_pwr_t *pwr);
+
+/**
+  * @}
+  *
+  */
+
+/**
+  * @defgroup   IIS2DULPX_Profile Configuration profiles
+  * @brief      This section groups the functions that validate a whole
+  *             configuration once and compile it into register runs,
+  *             applied later with a few burst writes. A compiled
+  *             iis2dulpx_profile_t is plain data and can be kept const.
+  * @{
+  *
+  */
+
+/** Register runs and bytes of a compiled profile **/
+#ifndef IIS2DULPX_PROFILE_RUNS
+#define IIS2DULPX_PROFILE_RUNS        6U
+#endif /* IIS2DULPX_PROFILE_RUNS */
+#ifndef IIS2DULPX_PROFILE_LEN
+#define IIS2DULPX_PROFILE_LEN         16U
+#endif /* IIS2DULPX_PROFILE_LEN */
+
+typedef struct
+{
+  iis2dulpx_md_t md;
+  iis2dulpx_fifo_mode_t fifo;
+  uint8_t fifo_wtm;
+  iis2dulpx_fifo_batch_t batch;
+  iis2dulpx_pin_int_route_t int1;
+  iis2dulpx_int_config_t int_cfg;
+} iis2dulpx_profile_cfg_t;
+
+typedef struct
+{
+  uint8_t num;                         /* runs */
+  uint8_t run[IIS2DULPX_PROFILE_RUNS][3]; /* first register, length, offset in data[] */
+  uint8_t data[IIS2DULPX_PROFILE_LEN];
+} iis2dulpx_profile_t;
+
+/**
+  * @brief  Compile a profile: run iis2dulpx_mode_set, fifo_mode_set,
+  *         fifo_watermark_set, fifo_batch_set, pin_int1_route_set and
+  *         int_config_set on a register image instead of the bus, and
+  *         keep the final value of every register they write. Fields
+  *         outside the profile keep the value read from ctx at compile
+  *         time. Runs are ordered by address, except CTRL5 (ODR) which
+  *         is split into a run of its own and written last.
+  *
+  * @param  ctx      read / write interface definitions, source of the
+  *                  registers not fully set by the profile
+  * @param  cfg      profile configuration.(ptr)
+  * @param  prof     compiled profile.(ptr)
+  * @retval          interface status, -1 also if cfg is not valid or
+  *                  the image does not fit iis2dulpx_profile_t
+  *
+  */
+int32_t iis2dulpx_profile_compile(const stmdev_ctx_t *ctx, const iis2dulpx_profile_cfg_t *cfg,
+                                  iis2dulpx_profile_t *prof);
+
+/**
+  * @brief  Write a compiled profile, one burst per run in a single
+  *         transaction (see iis2dulpx_txn_hook_set), and update the
+  *         shadow copy. Needs register address auto-increment
+  *         (CTRL1.if_add_inc, default).[set]
+  *
+  * @param  ctx      read / write interface definitions
+  * @param  prof     compiled profile.(ptr)
+  * @retval          interface status (MANDATORY: return 0 -> no Error)
+  *
+  */
+int32_t iis2dulpx_profile_apply(const stmdev_ctx_t *ctx, const iis2dulpx_profile_t *prof);
+
+/**
+  * @}
+  *
+  */
+
+/**
+  * @defgroup   IIS2DULPX_Self_Test_Run Self-test procedure
+  * @brief      This section groups the complete self-test procedure:
+  *             samples drained from the FIFO in bursts, integer
+  *             statistics and early exit on a clear pass.
+  * @{
+  *
+  */
+
+/** FIFO records read per burst during the self-test **/
+#ifndef IIS2DULPX_ST_BURST
+#define IIS2DULPX_ST_BURST            16U
+#endif /* IIS2DULPX_ST_BURST */
+
+/** Time without a new sample that aborts the self-test (ms) **/
+#ifndef IIS2DULPX_ST_TIMEOUT_MS
+#define IIS2DULPX_ST_TIMEOUT_MS       200U
+#endif /* IIS2DULPX_ST_TIMEOUT_MS */
+
+typedef struct
+{
+  iis2dulpx_md_t md;                   /* mode during the test */
+  uint8_t mode;                        /* value for iis2dulpx_self_test_start */
+  uint16_t settle_ms;                  /* delay after each self-test change */
+  uint8_t discard;                     /* samples dropped after each change */
+  uint16_t min_samples;                /* per average, and before an early exit */
+  uint16_t max_samples;                /* self-test on samples, upper bound */
+  uint32_t min_ug[3];                  /* limits of |delta| per axis */
+  uint32_t max_ug[3];
+} iis2dulpx_st_cfg_t;
+
+typedef struct
+{
+  int32_t delta[2][3];                 /* ug, [positive, negative][x, y, z] */
+  uint32_t bound[2][3];                /* ug, 3 sigma uncertainty of delta */
+  uint16_t samples[2];                 /* self-test on samples per sign */
+  uint8_t fail;                        /* bit 3 * sign + axis set on failure, 0: pass */
+} iis2dulpx_st_result_t;
+
+/**
+  * @brief  Run the self-test procedure. For each sign, average
+  *         min_samples with self-test off, then average the samples
+  *         with self-test on: as soon as min_samples are in and every
+  *         |delta| +/- 3 sigma lies within [min_ug, max_ug], the sign
+  *         passes, otherwise sampling goes on up to max_samples and
+  *         |delta| alone is judged. Samples come from the FIFO (16-bit
+  *         XL only, FIFO mode) in IIS2DULPX_ST_BURST record bursts.
+  *         Mode, FIFO and batching are changed: the device is left
+  *         with self-test off and FIFO in bypass, restore the
+  *         configuration afterwards (e.g. iis2dulpx_profile_apply).
+  *         Requires ctx->mdelay.
+  *
+  * @param  ctx      read / write interface definitions
+  * @param  cfg      test configuration and limits.(ptr)
+  * @param  res      result, res->fail == 0 on pass.(ptr)
+  * @retval          interface status, -1 also on timeout or bad cfg
+  *
+  */
+int32_t iis2dulpx_self_test_run(const stmdev_ctx_t *ctx, const iis2dulpx_st_cfg_t *cfg,
+                                iis2dulpx_st_result_t *res);
+
+/**
+  * @}
+  *
+  */
+
+/**
+  * @defgroup   IIS2DULPX_Recorder FIFO recorder
+  * @brief      This section groups the FIFO stream recorder (build with
+  *             IIS2DULPX_REC) and the replay transport that feeds a
+  *             capture back to the FIFO functions without hardware.
+  *             Capture format: magic "I2DU", version byte, then blocks
+  *             made of type (1 byte), payload length (2 bytes, little
+  *             endian) and payload.
+  * @{
+  *
+  */
+
+#define IIS2DULPX_REC_VERSION         1U
+#define IIS2DULPX_REC_HEADER_LEN      5U
+#define IIS2DULPX_REC_BLOCK_LEN       3U
+
+/** Block types **/
+#define IIS2DULPX_REC_CTX             0x01U /* odr, fs, bw, operation, store, xl_only, cfg_change_in_fifo */
+#define IIS2DULPX_REC_TIME            0x02U /* host time in ns, 8 bytes little endian */
+#define IIS2DULPX_REC_DATA            0x03U /* FIFO records, IIS2DULPX_FIFO_RECORD_LEN bytes each */
+
+#ifdef IIS2DULPX_REC
+/** Records buffered in one DATA block **/
+#ifndef IIS2DULPX_REC_RUN
+#define IIS2DULPX_REC_RUN             32U
+#endif /* IIS2DULPX_REC_RUN */
+
+/** Capture output, e.g. a file or a RAM buffer. MANDATORY: return 0 -> no Error. **/
+typedef int32_t (*iis2dulpx_rec_sink_ptr)(void *arg, const uint8_t *data, uint16_t len);
+
+struct iis2dulpx_rec_s
+{
+  iis2dulpx_rec_sink_ptr sink;
+  void *arg;
+  int32_t status;                      /* first sink error, 0 if none */
+  uint32_t records;                    /* records captured */
+  uint8_t tag;                         /* tag waiting for its data bytes */
+  uint8_t tag_valid;
+  uint16_t num;                        /* records in run */
+  uint8_t run[IIS2DULPX_REC_BLOCK_LEN + (IIS2DULPX_REC_RUN * IIS2DULPX_FIFO_RECORD_LEN)];
+};
+
+/**
+  * @brief  Start recording: the capture header is written and every FIFO
+  *         record read from the main page through iis2dulpx_read_reg
+  *         (tag and data reads, single or batch) is appended.
+  *
+  * @param  ctx    read / write interface definitions
+  * @param  rec    recorder state, kept valid until iis2dulpx_rec_stop.(ptr)
+  * @param  sink   capture output
+  * @param  arg    argument of sink
+  * @retval        interface status (MANDATORY: return 0 -> no Error)
+  *
+  */
+int32_t iis2dulpx_rec_start(const stmdev_ctx_t *ctx, iis2dulpx_rec_t *rec,
+                            iis2dulpx_rec_sink_ptr sink, void *arg);
+
+/**
+  * @brief  Append the decoding context; the following records are
+  *         decoded with it on replay.
+  *
+  * @param  rec    recorder state.(ptr)
+  * @param  md     the sensor conversion parameters.(ptr)
+  * @param  fmd    FIFO mode.(ptr)
+  * @retval        interface status (MANDATORY: return 0 -> no Error)
+  *
+  */
+int32_t iis2dulpx_rec_context(iis2dulpx_rec_t *rec, const iis2dulpx_md_t *md,
+                              const iis2dulpx_fifo_mode_t *fmd);
+
+/**
+  * @brief  Append a host timestamp (e.g. taken at each drain).
+  *
+  * @param  rec      recorder state.(ptr)
+  * @param  host_ns  host time (ns)
+  * @retval          interface status (MANDATORY: return 0 -> no Error)
+  *
+  */
+int32_t iis2dulpx_rec_time(iis2dulpx_rec_t *rec, uint64_t host_ns);
+
+/**
+  * @brief  Write the buffered records as a DATA block.
+  *
+  * @param  rec    recorder state.(ptr)
+  * @retval        interface status (MANDATORY: return 0 -> no Error)
+  *
+  */
+int32_t iis2dulpx_rec_flush(iis2dulpx_rec_t *rec);
+
+/**
+  * @brief  Flush and detach the recorder.
+  *
+  * @param  ctx    read / write interface definitions
+  * @retval        interface status (MANDATORY: return 0 -> no Error)
+  *
+  */
+int32_t iis2dulpx_rec_stop(const stmdev_ctx_t *ctx);
+#endif /* IIS2DULPX_REC */
+
+typedef struct
+{
+  const uint8_t *buff;                 /* capture, e.g. a memory mapped file */
+  uint32_t size;
+  uint32_t pos;                        /* next unread byte */
+  uint32_t data_end;                   /* end of the whole records of the DATA block */
+  uint8_t data_tail;                   /* partial record bytes after data_end */
+  uint8_t rec_off;                     /* next byte of the current record */
+  uint8_t reg[128];                    /* other registers, written by the driver */
+  iis2dulpx_md_t md;                   /* context of the next record */
+  iis2dulpx_fifo_mode_t fmd;
+  uint64_t host_ns;                    /* last host time crossed */
+  uint32_t records;                    /* records served */
+} iis2dulpx_replay_t;
+
+/**
+  * @brief  Open a capture for replay. Use iis2dulpx_replay_read and
+  *         iis2dulpx_replay_write as ctx->read_reg / ctx->write_reg with
+  *         ctx->handle = rp: FIFO_STATUS reports the records left in the
+  *         DATA blocks ahead (up to IIS2DULPX_FIFO_SIZE), FIFO output
+  *         registers serve the captured records, the other registers
+  *         keep what is written. rp->md and rp->fmd follow the CTX
+  *         blocks crossed.
+  *
+  * @param  rp     replay state.(ptr)
+  * @param  buff   capture.(ptr)
+  * @param  size   capture size in bytes
+  * @retval        0: no error, -1: not a capture
+  *
+  */
+int32_t iis2dulpx_replay_init(iis2dulpx_replay_t *rp, const uint8_t *buff, uint32_t size);
+
+/**
+  * @brief  Replay transport read function (stmdev_read_ptr).
+  *
+  * @param  handle   replay state, iis2dulpx_replay_t.(ptr)
+  * @param  reg      register address
+  * @param  data     data read.(ptr)
+  * @param  len      number of bytes
+  * @retval          0: no error, FIFO output reads past the end give zeros
+  *
+  */
+int32_t iis2dulpx_replay_read(void *handle, uint8_t reg, uint8_t *data, uint16_t len);
+
+/**
+  * @brief  Replay transport write function (stmdev_write_ptr).
+  *
+  * @param  handle   replay state, iis2dulpx_replay_t.(ptr)
+  * @param  reg      register address
+  * @param  data     data to write.(ptr)
+  * @param  len      number of bytes
+  * @retval          0: no error
+  *
+  */
+int32_t iis2dulpx_replay_write(void *handle, uint8_t reg, const uint8_t *data, uint16_t len);
+
 /**
   * @}
   *